@@ -240,7 +240,7 @@ void csp_orc_sa_global_read_add_list(CSOUND *csound, struct set_t *set)
 
 static void csp_orc_sa_interlocksf(CSOUND *csound, int code, char *name)
 {
-    if (code&0xfff8) {
+    if (code&0xfff8&~_CF) {            /* _CF is no interlock */
       /* zak etc */
       struct set_t *rr = NULL;
       struct set_t *ww = NULL;
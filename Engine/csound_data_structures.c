@@ -99,95 +99,160 @@ PUBLIC void cs_cons_free_complete(CSOUND* csound, CONS_CELL* head) {
 
 /* FUNCTION FOR HASH SET */
 
+/* Open addressing with linear probing and Robin Hood insertion: an entry
+   being inserted takes the slot of any entry closer to its home slot,
+   which keeps probe sequences short and lets lookups stop as soon as
+   they pass an entry closer to home than the key would be.  Each slot
+   stores the full hash of its key, so probing compares hashes before
+   strings, and resizing does not rehash.  Removal shifts the following
+   entries back, so there are no tombstones. */
+
+#define HASH_MIN_SIZE 64
+
+static inline uint32_t cs_name_hash(const char *s)
+{
+    uint32_t h = 0;
+    while (*s != '\0')
+      h = h * 31 + (unsigned char) *s++;
+    /* mix, as the low bits select the slot */
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    return h ^ (h >> 13);
+}
+
+/* distance of the entry in slot i from its home slot */
+static inline uint32_t cs_hash_dist(CS_HASH_TABLE* table, uint32_t i)
+{
+    uint32_t mask = (uint32_t) table->table_size - 1;
+    return (i - (table->buckets[i].hash & mask)) & mask;
+}
+
+static CS_HASH_TABLE_ITEM* cs_hash_table_find(CS_HASH_TABLE* table,
+                                              const char* key, uint32_t h)
+{
+    uint32_t mask = (uint32_t) table->table_size - 1;
+    uint32_t i = h & mask, d = 0;
+
+    for (;;) {
+      CS_HASH_TABLE_ITEM* item = &table->buckets[i];
+      if (item->key == NULL || cs_hash_dist(table, i) < d)
+        return NULL;
+      if (item->hash == h && strcmp(key, item->key) == 0)
+        return item;
+      i = (i + 1) & mask;
+      d++;
+    }
+}
+
+/* inserts a key known not to be in the table, which has room for it */
+static void cs_hash_table_insert(CS_HASH_TABLE* table,
+                                 char* key, void* value, uint32_t h)
+{
+    uint32_t mask = (uint32_t) table->table_size - 1;
+    uint32_t i = h & mask, d = 0, e;
+    CS_HASH_TABLE_ITEM cur, tmp;
+
+    cur.key = key;
+    cur.value = value;
+    cur.hash = h;
+    for (;;) {
+      CS_HASH_TABLE_ITEM* item = &table->buckets[i];
+      if (item->key == NULL) {
+        *item = cur;
+        table->count++;
+        return;
+      }
+      if ((e = cs_hash_dist(table, i)) < d) {
+        tmp = *item;
+        *item = cur;
+        cur = tmp;
+        d = e;
+      }
+      i = (i + 1) & mask;
+      d++;
+    }
+}
+
+static void cs_hash_table_rehash(CSOUND* csound,
+                                 CS_HASH_TABLE* table, int newSize)
+{
+    CS_HASH_TABLE_ITEM* oldTable = table->buckets;
+    int oldSize = table->table_size, i;
+
+    table->buckets =
+      csound->Calloc(csound, newSize * sizeof(CS_HASH_TABLE_ITEM));
+    table->table_size = newSize;
+    table->count = 0;
+    for (i = 0; i < oldSize; i++) {
+      if (oldTable[i].key != NULL)
+        cs_hash_table_insert(table, oldTable[i].key, oldTable[i].value,
+                             oldTable[i].hash);
+    }
+    csound->Free(csound, oldTable);
+}
+
+static void cs_hash_table_check_resize(CSOUND* csound, CS_HASH_TABLE* table) {
+    if (table->count + 1 > table->table_size * HASH_LOAD_FACTOR)
+      cs_hash_table_rehash(csound, table, table->table_size * 2);
+}
+
 PUBLIC CS_HASH_TABLE* cs_hash_table_create(CSOUND* csound) {
     CS_HASH_TABLE* table =
       (CS_HASH_TABLE*) csound->Calloc(csound, sizeof(CS_HASH_TABLE));
     table->count = 0;
-    table->table_size = 8192;
-    table->buckets = csound->Calloc(csound, sizeof(CS_HASH_TABLE_ITEM*) * 8192);
+    table->table_size = HASH_MIN_SIZE;
+    table->buckets =
+      csound->Calloc(csound, sizeof(CS_HASH_TABLE_ITEM) * HASH_MIN_SIZE);
 
     return table;
 }
 
-static int cs_hash_table_check_resize(CSOUND* csound, CS_HASH_TABLE* table) {
-    if (table->count + 1 > table->table_size * HASH_LOAD_FACTOR) {
-        int oldSize = table->table_size;
-        int newSize = oldSize * 2;
-        CS_HASH_TABLE_ITEM** oldTable = table->buckets;
-        CS_HASH_TABLE_ITEM** newTable =
-          csound->Calloc(csound, newSize * sizeof(CS_HASH_TABLE_ITEM*));
-
-        table->buckets = newTable;
-        table->table_size = newSize;
-
-        for (int i = 0; i < oldSize; i++) {
-            CS_HASH_TABLE_ITEM* item = oldTable[i];
-            while (item != NULL) {
-                cs_hash_table_put_no_key_copy(csound, table, item->key,
-                                              item->value);
-                item->key = NULL;
-                CS_HASH_TABLE_ITEM* next = item->next;
-                csound->Free(csound, item);
-                item = next;
-            }
-        }
-        return 1;
-    }
-    return 0;
+PUBLIC void cs_hash_table_reserve(CSOUND* csound,
+                                  CS_HASH_TABLE* hashTable, int count) {
+    int size = hashTable->table_size;
+    while (count > size * HASH_LOAD_FACTOR)
+      size *= 2;
+    if (size > hashTable->table_size)
+      cs_hash_table_rehash(csound, hashTable, size);
 }
 
-static unsigned int cs_name_hash(CS_HASH_TABLE* table, char *s)
-{
-    unsigned int h = 0;
-    while (*s != '\0') {
-      h = (h<<4) ^ *s++;
+PUBLIC int cs_hash_table_next(CS_HASH_TABLE* hashTable, int* pos,
+                              char** key, void** value) {
+    int i;
+    for (i = *pos; i < hashTable->table_size; i++) {
+      if (hashTable->buckets[i].key != NULL) {
+        if (key != NULL) *key = hashTable->buckets[i].key;
+        if (value != NULL) *value = hashTable->buckets[i].value;
+        *pos = i + 1;
+        return 1;
+      }
     }
-    return (h % table->table_size);
+    *pos = i;
+    return 0;
 }
 
 PUBLIC void* cs_hash_table_get(CSOUND* csound,
                                CS_HASH_TABLE* hashTable, char* key) {
-    IGN(csound);
-    unsigned int index;
     CS_HASH_TABLE_ITEM* item;
+    IGN(csound);
 
     if (key == NULL) {
       return NULL;
     }
-
-    index = cs_name_hash(hashTable, key);
-    item = hashTable->buckets[index];
-    while (item != NULL) {
-      if (strcmp(key, item->key) == 0) {
-        return item->value;
-      }
-      item = item->next;
-    }
-
-    return NULL;
+    item = cs_hash_table_find(hashTable, key, cs_name_hash(key));
+    return item != NULL ? item->value : NULL;
 }
 
 PUBLIC char* cs_hash_table_get_key(CSOUND* csound,
                                    CS_HASH_TABLE* hashTable, char* key) {
-    unsigned int index;
     CS_HASH_TABLE_ITEM* item;
     IGN(csound);
 
     if (key == NULL) {
       return NULL;
     }
-
-    index = cs_name_hash(hashTable, key);
-    item = hashTable->buckets[index];
-
-    while (item != NULL) {
-      if (strcmp(key, item->key) == 0) {
-        return item->key;
-      }
-      item = item->next;
-    }
-
-    return NULL;
+    item = cs_hash_table_find(hashTable, key, cs_name_hash(key));
+    return item != NULL ? item->key : NULL;
 }
 
 /*
@@ -197,161 +262,133 @@ PUBLIC char* cs_hash_table_get_key(CSOUND* csound,
 char* cs_hash_table_put_no_key_copy(CSOUND* csound,
                                    CS_HASH_TABLE* hashTable,
                                     char* key, void* value) {
+    CS_HASH_TABLE_ITEM* item;
+    uint32_t h;
+
     if (key == NULL) {
       return NULL;
     }
-
-    unsigned int index = cs_name_hash(hashTable, key);
-
-    CS_HASH_TABLE_ITEM* item = hashTable->buckets[index];
-
-    while (item != NULL) {
-        if (strcmp(key, item->key) == 0) {
-            item->value = value;
-            return item->key;
-        }
-        item = item->next;
+    h = cs_name_hash(key);
+    item = cs_hash_table_find(hashTable, key, h);
+    if (item != NULL) {
+      item->value = value;
+      return item->key;
     }
+    cs_hash_table_check_resize(csound, hashTable);
+    cs_hash_table_insert(hashTable, key, value, h);
+    return key;
+}
 
-    int modified = cs_hash_table_check_resize(csound, hashTable);
+/* only copies the key when it is not in the table yet */
+static char* cs_hash_table_put_copy(CSOUND* csound, CS_HASH_TABLE* hashTable,
+                                    char* key, void* value) {
+    CS_HASH_TABLE_ITEM* item;
+    uint32_t h;
 
-    if (modified) {
-        index = cs_name_hash(hashTable, key);
+    if (key == NULL) {
+      return NULL;
     }
-    CS_HASH_TABLE_ITEM* newItem = csound->Malloc(csound,
-                                                   sizeof(CS_HASH_TABLE_ITEM));
-    newItem->key = key;
-    newItem->value = value;
-    newItem->next = NULL;
-
-    item = hashTable->buckets[index];
-    hashTable->count++;
-
-    if (item) {
-        while (item->next != NULL) {
-            item = item->next;
-        }
-
-        item->next = newItem;
-    } else {
-        hashTable->buckets[index] = newItem;
+    h = cs_name_hash(key);
+    item = cs_hash_table_find(hashTable, key, h);
+    if (item != NULL) {
+      item->value = value;
+      return item->key;
     }
-
+    key = cs_strdup(csound, key);
+    cs_hash_table_check_resize(csound, hashTable);
+    cs_hash_table_insert(hashTable, key, value, h);
     return key;
 }
 
 PUBLIC void cs_hash_table_put(CSOUND* csound,
                               CS_HASH_TABLE* hashTable, char* key, void* value) {
-    cs_hash_table_put_no_key_copy(csound, hashTable,
-                                  cs_strdup(csound, key), value);
+    cs_hash_table_put_copy(csound, hashTable, key, value);
 }
 
 PUBLIC char* cs_hash_table_put_key(CSOUND* csound,
                                    CS_HASH_TABLE* hashTable, char* key) {
-    return cs_hash_table_put_no_key_copy(csound, hashTable,
-                                         cs_strdup(csound, key), NULL);
+    return cs_hash_table_put_copy(csound, hashTable, key, NULL);
 }
 
 PUBLIC void cs_hash_table_remove(CSOUND* csound,
                                  CS_HASH_TABLE* hashTable, char* key) {
-    CS_HASH_TABLE_ITEM *previous, *item;
-    unsigned int index;
+    CS_HASH_TABLE_ITEM* item;
+    uint32_t mask, i, j;
+    IGN(csound);
 
     if (key == NULL) {
       return;
     }
-
-    index = cs_name_hash(hashTable, key);
-
-    previous = NULL;
-    item = hashTable->buckets[index];
-
-    while (item != NULL) {
-      if (strcmp(key, item->key) == 0) {
-        if (previous == NULL) {
-          hashTable->buckets[index] = item->next;
-        } else {
-          previous->next = item->next;
-        }
-        csound->Free(csound, item);
-        hashTable->count--;
-        return;
-      }
-      previous = item;
-      item = item->next;
+    item = cs_hash_table_find(hashTable, key, cs_name_hash(key));
+    if (item == NULL) {
+      return;
+    }
+    /* shift the entries displaced by this one back */
+    mask = (uint32_t) hashTable->table_size - 1;
+    i = (uint32_t) (item - hashTable->buckets);
+    for (j = (i + 1) & mask;
+         hashTable->buckets[j].key != NULL && cs_hash_dist(hashTable, j) != 0;
+         i = j, j = (j + 1) & mask) {
+      hashTable->buckets[i] = hashTable->buckets[j];
     }
+    memset(&hashTable->buckets[i], 0, sizeof(CS_HASH_TABLE_ITEM));
+    hashTable->count--;
 }
 
 PUBLIC CONS_CELL* cs_hash_table_keys(CSOUND* csound, CS_HASH_TABLE* hashTable) {
     CONS_CELL* head = NULL;
+    char* key;
+    int pos = 0;
 
-    int i = 0;
-
-    for (i = 0; i < hashTable->table_size; i++) {
-      CS_HASH_TABLE_ITEM* item = hashTable->buckets[i];
-
-      while (item != NULL) {
-        head = cs_cons(csound, item->key, head);
-        item = item->next;
-      }
+    while (cs_hash_table_next(hashTable, &pos, &key, NULL)) {
+      head = cs_cons(csound, key, head);
     }
     return head;
 }
 
 PUBLIC CONS_CELL* cs_hash_table_values(CSOUND* csound, CS_HASH_TABLE* hashTable) {
     CONS_CELL* head = NULL;
+    void* value;
+    int pos = 0;
 
-    int i = 0;
-
-    for (i = 0; i < hashTable->table_size; i++) {
-      CS_HASH_TABLE_ITEM* item = hashTable->buckets[i];
-
-      while (item != NULL) {
-        head = cs_cons(csound, item->value, head);
-        item = item->next;
-      }
+    while (cs_hash_table_next(hashTable, &pos, NULL, &value)) {
+      head = cs_cons(csound, value, head);
     }
     return head;
 }
 
 PUBLIC void cs_hash_table_merge(CSOUND* csound,
                                 CS_HASH_TABLE* target, CS_HASH_TABLE* source) {
-    // TODO - check if this is the best strategy for merging
-    int i = 0;
+    int i;
 
+    cs_hash_table_reserve(csound, target, target->count + source->count);
     for (i = 0; i < source->table_size; i++) {
-      CS_HASH_TABLE_ITEM* item = source->buckets[i];
-
-      while (item != NULL) {
-        CS_HASH_TABLE_ITEM* next = item->next;
-        char* new_key =
-          cs_hash_table_put_no_key_copy(csound, target, item->key, item->value);
-
-        if (new_key != item->key) {
-          csound->Free(csound, item->key);
-        }
+      CS_HASH_TABLE_ITEM* item = &source->buckets[i];
+      CS_HASH_TABLE_ITEM* old;
 
-        csound->Free(csound, item);
-        item = next;
+      if (item->key == NULL) continue;
+      old = cs_hash_table_find(target, item->key, item->hash);
+      if (old != NULL) {
+        old->value = item->value;
+        csound->Free(csound, item->key);
+      }
+      else {
+        cs_hash_table_check_resize(csound, target);
+        cs_hash_table_insert(target, item->key, item->value, item->hash);
       }
-      source->buckets[i] = NULL;
     }
-
+    memset(source->buckets, 0, source->table_size * sizeof(CS_HASH_TABLE_ITEM));
+    source->count = 0;
 }
 
 PUBLIC void cs_hash_table_free(CSOUND* csound, CS_HASH_TABLE* hashTable) {
     int i;
 
     for (i = 0; i < hashTable->table_size; i++) {
-      CS_HASH_TABLE_ITEM* item = hashTable->buckets[i];
-
-      while(item != NULL) {
-        CS_HASH_TABLE_ITEM* next = item->next;
-        csound->Free(csound, item->key);
-        csound->Free(csound, item);
-        item = next;
-      }
+      if (hashTable->buckets[i].key != NULL)
+        csound->Free(csound, hashTable->buckets[i].key);
     }
+    csound->Free(csound, hashTable->buckets);
     csound->Free(csound, hashTable);
 }
 
@@ -360,16 +397,14 @@ PUBLIC void cs_hash_table_mfree_complete(CSOUND* csound, CS_HASH_TABLE* hashTabl
     int i;
 
     for (i = 0; i < hashTable->table_size; i++) {
-      CS_HASH_TABLE_ITEM* item = hashTable->buckets[i];
+      CS_HASH_TABLE_ITEM* item = &hashTable->buckets[i];
 
-      while(item != NULL) {
-        CS_HASH_TABLE_ITEM* next = item->next;
+      if (item->key != NULL) {
         csound->Free(csound, item->key);
         csound->Free(csound, item->value);
-        csound->Free(csound, item);
-        item = next;
       }
     }
+    csound->Free(csound, hashTable->buckets);
     csound->Free(csound, hashTable);
 }
 
@@ -378,33 +413,29 @@ PUBLIC void cs_hash_table_free_complete(CSOUND* csound, CS_HASH_TABLE* hashTable
     int i;
 
     for (i = 0; i < hashTable->table_size; i++) {
-      CS_HASH_TABLE_ITEM* item = hashTable->buckets[i];
+      CS_HASH_TABLE_ITEM* item = &hashTable->buckets[i];
 
-      while(item != NULL) {
-        CS_HASH_TABLE_ITEM* next = item->next;
+      if (item->key != NULL) {
         csound->Free(csound, item->key);
 
         /* NOTE: This needs to be free, not csound->Free.
            To use mfree on keys, use cs_hash_table_mfree_complete
            TODO: Check if this is even necessary anymore... */
         free(item->value);
-        csound->Free(csound, item);
-        item = next;
       }
     }
+    csound->Free(csound, hashTable->buckets);
     csound->Free(csound, hashTable);
 }
 
 char *cs_inverse_hash_get(CSOUND* csound, CS_HASH_TABLE* hashTable, int n)
 {
-    int k;
+    char *key;
+    void *value;
+    int pos = 0;
     IGN(csound);
-    for (k=0; k<hashTable->table_size;k++) {
-      CS_HASH_TABLE_ITEM* item = hashTable->buckets[k];
-      while (item) {
-        if (n==*(int*)item->value) return item->key;
-        item = item->next;
-      }
+    while (cs_hash_table_next(hashTable, &pos, &key, &value)) {
+      if (n==*(int*)value) return key;
     }
     return "";
 }
@@ -0,0 +1,356 @@
+/*
+    csound_orc_cache.c:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+/* Persistent cache of parsed orchestras.
+ *
+ * The tree produced by the Bison parser (after constant folding, before
+ * semantic analysis) is written to <dir>/<key>.ast, where <dir> is set
+ * with -+orc_cache=<dir>.  The key combines a hash of the preprocessed
+ * orchestra text with a fingerprint of the parser symbol table, which
+ * holds every opcode name known at parse time (built-ins, plugins and
+ * UDOs from earlier compilations), so a change in either invalidates it.
+ *
+ * On a hit the lexer and parser are skipped.  The only side effect of
+ * parsing that the rest of the compiler relies on, the registration of
+ * UDO signatures, is replayed from the cached tree.  Semantic analysis
+ * still runs as normal, since it builds the variable pools and type
+ * information for the compilation.
+ *
+ * The file ends with a hash of the tree data.  A file that is truncated,
+ * has strings running past its end, nests deeper than ORC_CACHE_MAXDEPTH
+ * or fails the hash is ignored, and the orchestra is parsed instead.
+ */
+
+#include "csoundCore.h"
+#include "csound_orc.h"
+#ifndef WIN32
+#include <unistd.h>
+#include <sys/stat.h>
+#else
+#include <process.h>
+#endif
+
+#define ORC_CACHE_MAGIC    (0x54534143)   /* "CAST" */
+#define ORC_CACHE_VERSION  (2)
+#define ORC_CACHE_ENDIAN   (0x01020304)
+#define ORC_CACHE_MAXDEPTH (4096)
+#define ORC_CACHE_SEED     UINT64_C(0xcbf29ce484222325)
+
+extern int add_udo_definition(CSOUND*, char *, char *, char *);
+extern void delete_tree(CSOUND *, TREE *);
+
+typedef struct {
+    CSOUND  *csound;
+    FILE    *f;
+    int     err;
+    uint64_t hash;          /* of the tree data read or written so far */
+    long    remain;         /* bytes left in the file, when reading */
+} ORC_CACHE_IO;
+
+static uint64_t fnv1a(uint64_t h, const void *p, size_t n)
+{
+    const unsigned char *s = (const unsigned char*) p;
+    while (n--) {
+      h ^= (uint64_t) *s++;
+      h *= UINT64_C(0x100000001b3);
+    }
+    return h;
+}
+
+static uint64_t mix64(uint64_t x)
+{
+    x ^= x >> 30; x *= UINT64_C(0xbf58476d1ce4e5b9);
+    x ^= x >> 27; x *= UINT64_C(0x94d049bb133111eb);
+    x ^= x >> 31;
+    return x;
+}
+
+/* order independent fingerprint of the parser symbol table */
+static uint64_t symbtab_fingerprint(CSOUND *csound)
+{
+    CONS_CELL *head, *items;
+    uint64_t  h = 0, n = 0;
+
+    if (csound->symbtab == NULL) return 0;
+    head = items = cs_hash_table_values(csound, csound->symbtab);
+    while (items != NULL) {
+      ORCTOKEN *tok = (ORCTOKEN*) items->value;
+      uint64_t  t = fnv1a(UINT64_C(0xcbf29ce484222325),
+                          tok->lexeme, strlen(tok->lexeme));
+      h += mix64(t ^ (uint64_t) tok->type);
+      n++;
+      items = items->next;
+    }
+    cs_cons_free(csound, head);
+    return mix64(h ^ n);
+}
+
+/* Computes the cache key for the preprocessed text body[0..len-1].
+   Returns 0 if the cache is disabled for this compilation. */
+int csound_orc_cache_key(CSOUND *csound, const char *body, size_t len,
+                         ORC_CACHE_KEY *key)
+{
+    char    *dir = (char*) csound->QueryGlobalVariable(csound, "_ORC_CACHE");
+    uint64_t sym;
+
+    if (dir == NULL || *dir == '\0' || body == NULL) return 0;
+    /* the parser also collects data for the parallel dispatcher */
+    if (csound->oparms->numThreads > 1) return 0;
+    sym = symbtab_fingerprint(csound);
+    key->text = fnv1a(UINT64_C(0xcbf29ce484222325), body, len);
+    key->check = fnv1a(UINT64_C(0x84222325cbf29ce4), body, len) ^ sym;
+    key->symbols = sym;
+    key->len = (uint64_t) len;
+    snprintf(key->path, sizeof(key->path), "%s/%016llx%016llx.ast", dir,
+             (unsigned long long) key->text,
+             (unsigned long long) mix64(sym ^ key->len));
+    return 1;
+}
+
+/* WRITING */
+
+static void put_bytes(ORC_CACHE_IO *io, const void *p, size_t n)
+{
+    if (!io->err && n > 0 && fwrite(p, 1, n, io->f) != n) io->err = 1;
+    io->hash = fnv1a(io->hash, p, n);
+}
+
+static void put_int(ORC_CACHE_IO *io, int32_t v)
+{
+    put_bytes(io, &v, sizeof(int32_t));
+}
+
+static void put_string(ORC_CACHE_IO *io, const char *s)
+{
+    if (s == NULL) {
+      put_int(io, -1);
+      return;
+    }
+    put_int(io, (int32_t) strlen(s));
+    put_bytes(io, s, strlen(s));
+}
+
+/* writes a next-linked list of trees; left and right are lists too.
+   A tree too deep to be read back is not stored. */
+static void put_tree(ORC_CACHE_IO *io, TREE *l, int depth)
+{
+    if (depth > ORC_CACHE_MAXDEPTH) io->err = 1;
+    for (; l != NULL && !io->err; l = l->next) {
+      put_int(io, 1);
+      put_int(io, l->type);
+      put_int(io, l->rate);
+      put_int(io, l->len);
+      put_int(io, l->line);
+      put_bytes(io, &l->locn, sizeof(uint64_t));
+      if (l->value != NULL) {
+        put_int(io, 1);
+        put_int(io, l->value->type);
+        put_int(io, l->value->value);
+        put_bytes(io, &l->value->fvalue, sizeof(double));
+        put_string(io, l->value->lexeme);
+        put_string(io, l->value->optype);
+      }
+      else put_int(io, 0);
+      put_tree(io, l->left, depth + 1);
+      put_tree(io, l->right, depth + 1);
+    }
+    put_int(io, 0);
+}
+
+void csound_orc_cache_store(CSOUND *csound, ORC_CACHE_KEY *key, TREE *root)
+{
+    ORC_CACHE_IO io;
+    char         tmp[1040];
+    uint64_t     hash;
+
+    io.csound = csound;
+    io.err = 0;
+    /* a name of its own, also among processes sharing the directory */
+#ifndef WIN32
+    {
+      int fd;
+      snprintf(tmp, sizeof(tmp), "%s.XXXXXX", key->path);
+      io.f = NULL;
+      if ((fd = mkstemp(tmp)) >= 0) {
+        fchmod(fd, 0644);
+        if ((io.f = fdopen(fd, "wb")) == NULL) {
+          close(fd);
+          remove(tmp);
+        }
+      }
+    }
+#else
+    snprintf(tmp, sizeof(tmp), "%s.%d.%p.tmp", key->path,
+             (int) _getpid(), (void*) csound);
+    io.f = fopen(tmp, "wb");
+#endif
+    if (io.f == NULL) {
+      csound->Warning(csound, Str("orc_cache: cannot write %s\n"), tmp);
+      return;
+    }
+    put_int(&io, ORC_CACHE_MAGIC);
+    put_int(&io, ORC_CACHE_VERSION);
+    put_int(&io, ORC_CACHE_ENDIAN);
+    put_int(&io, (int32_t) csoundGetVersion());
+    put_bytes(&io, &key->len, sizeof(uint64_t));
+    put_bytes(&io, &key->check, sizeof(uint64_t));
+    io.hash = ORC_CACHE_SEED;
+    put_tree(&io, root, 0);
+    hash = io.hash;
+    put_bytes(&io, &hash, sizeof(uint64_t));
+    if (fclose(io.f) != 0) io.err = 1;
+    /* rename is atomic, so a concurrent reader never sees a partial file */
+    if (io.err || rename(tmp, key->path) != 0) {
+      remove(tmp);
+      csound->Warning(csound, Str("orc_cache: cannot write %s\n"), key->path);
+    }
+    else if (UNLIKELY(csound->oparms->odebug))
+      csound->Message(csound, Str("orc_cache: stored %s\n"), key->path);
+}
+
+/* READING */
+
+static void get_bytes(ORC_CACHE_IO *io, void *p, size_t n)
+{
+    if (io->err) memset(p, 0, n);
+    else if (n > 0 && fread(p, 1, n, io->f) != n) {
+      memset(p, 0, n);
+      io->err = 1;
+    }
+    else {
+      io->remain -= (long) n;
+      io->hash = fnv1a(io->hash, p, n);
+    }
+}
+
+static int32_t get_int(ORC_CACHE_IO *io)
+{
+    int32_t v;
+    get_bytes(io, &v, sizeof(int32_t));
+    return v;
+}
+
+static char *get_string(ORC_CACHE_IO *io)
+{
+    CSOUND  *csound = io->csound;
+    int32_t n = get_int(io);
+    char    *s;
+
+    if (n < 0 || io->err) return NULL;
+    if (n > io->remain) {                 /* runs past the end of file */
+      io->err = 1;
+      return NULL;
+    }
+    s = (char*) csound->Malloc(csound, (size_t) n + 1);
+    get_bytes(io, s, (size_t) n);
+    s[n] = '\0';
+    return s;
+}
+
+static TREE *get_tree(ORC_CACHE_IO *io, int depth)
+{
+    CSOUND *csound = io->csound;
+    TREE   *head = NULL, *last = NULL;
+
+    if (depth > ORC_CACHE_MAXDEPTH) {
+      io->err = 1;
+      return NULL;
+    }
+    while (!io->err && get_int(io) == 1) {
+      TREE *l = (TREE*) csound->Calloc(csound, sizeof(TREE));
+      if (last == NULL) head = l;
+      else last->next = l;
+      last = l;
+      l->type = get_int(io);
+      l->rate = get_int(io);
+      l->len = get_int(io);
+      l->line = get_int(io);
+      get_bytes(io, &l->locn, sizeof(uint64_t));
+      if (get_int(io) == 1) {
+        ORCTOKEN *tok = (ORCTOKEN*) csound->Calloc(csound, sizeof(ORCTOKEN));
+        l->value = tok;
+        tok->type = get_int(io);
+        tok->value = get_int(io);
+        get_bytes(io, &tok->fvalue, sizeof(double));
+        tok->lexeme = get_string(io);
+        tok->optype = get_string(io);
+      }
+      l->left = get_tree(io, depth + 1);
+      l->right = get_tree(io, depth + 1);
+    }
+    return head;
+}
+
+TREE *csound_orc_cache_load(CSOUND *csound, ORC_CACHE_KEY *key)
+{
+    ORC_CACHE_IO io;
+    TREE         *root, *t;
+    uint64_t     len, check, hash;
+
+    io.csound = csound;
+    io.err = 0;
+    if ((io.f = fopen(key->path, "rb")) == NULL) return NULL;
+    if (fseek(io.f, 0L, SEEK_END) != 0 || (io.remain = ftell(io.f)) < 0 ||
+        fseek(io.f, 0L, SEEK_SET) != 0) {
+      fclose(io.f);
+      return NULL;
+    }
+    if (get_int(&io) != ORC_CACHE_MAGIC ||
+        get_int(&io) != ORC_CACHE_VERSION ||
+        get_int(&io) != ORC_CACHE_ENDIAN ||
+        get_int(&io) != (int32_t) csoundGetVersion()) {
+      fclose(io.f);
+      return NULL;
+    }
+    get_bytes(&io, &len, sizeof(uint64_t));
+    get_bytes(&io, &check, sizeof(uint64_t));
+    if (io.err || len != key->len || check != key->check) {
+      fclose(io.f);
+      return NULL;
+    }
+    io.hash = ORC_CACHE_SEED;
+    root = get_tree(&io, 0);
+    hash = io.hash;
+    get_bytes(&io, &check, sizeof(uint64_t));
+    fclose(io.f);
+    if (UNLIKELY(io.err || root == NULL || check != hash)) {
+      csound->Warning(csound, Str("orc_cache: ignoring corrupt file %s\n"),
+                      key->path);
+      delete_tree(csound, root);
+      return NULL;
+    }
+    /* replay the UDO registrations done by the parser actions */
+    for (t = root; t != NULL; t = t->next) {
+      if (t->type == UDO_TOKEN && t->left != NULL &&
+          t->left->left != NULL && t->left->right != NULL &&
+          t->left->value != NULL && t->left->left->value != NULL &&
+          t->left->right->value != NULL)
+        add_udo_definition(csound,
+                           t->left->value->lexeme,
+                           t->left->left->value->lexeme,
+                           t->left->right->value->lexeme);
+    }
+    if (UNLIKELY(csound->oparms->odebug))
+      csound->Message(csound, Str("orc_cache: using %s\n"), key->path);
+    return root;
+}
@@ -44,6 +44,7 @@ static const char *INSTR_NAME_FIRST = "::^inm_first^::";
 static ARG *createArg(CSOUND *csound, INSTRTXT *ip, char *s,
                       ENGINE_STATE *engineState);
 static void insprep(CSOUND *, INSTRTXT *, ENGINE_STATE *engineState);
+static void insprep_instruments(CSOUND *, INSTRTXT *, ENGINE_STATE *, int);
 static void lgbuild(CSOUND *, INSTRTXT *, char *, int inarg,
                     ENGINE_STATE *engineState);
 int pnum(char *s);
@@ -1001,6 +1002,8 @@ void free_instrtxt(CSOUND *csound, INSTRTXT *instrtxt) {
   }
 
   csoundFreeVarPool(csound, ip->varPool);
+  if (ip->opdsoffs != NULL)
+    csound->Free(csound, ip->opdsoffs);
   csound->Free(csound, ip);
   if (UNLIKELY(csound->oparms->odebug))
     csound->Message(csound, Str("-- deleted instr from deadpool\n"));
@@ -1388,7 +1391,8 @@ OPCODINFO *find_opcode_info(CSOUND *csound, char *opname, char *outargs,
    4) Call insprep() and recalculateVarPoolMemory() for each new instrument
    5) patch up nxtinstxt order
 */
-int engineState_merge(CSOUND *csound, ENGINE_STATE *engineState) {
+int engineState_merge(CSOUND *csound, ENGINE_STATE *engineState,
+                      int parallel) {
   int i, end = engineState->maxinsno;
   ENGINE_STATE *current_state = &csound->engineState;
   INSTRTXT *current, *old_instr0;
@@ -1490,14 +1494,8 @@ int engineState_merge(CSOUND *csound, ENGINE_STATE *engineState) {
   insert_opcodes(csound, csound->opcodeInfo, current_state);
   /* this needs to be called in a separate loop
      in case of multiple instr numbers, so insprep() is called only once */
-  current = (&(engineState->instxtanchor)); //->nxtinstxt;
-  while ((current = current->nxtinstxt) != NULL) {
-    if (UNLIKELY(csound->oparms->odebug))
-      csound->Message(csound, "insprep %p\n", current);
-    insprep(csound, current, current_state); /* run insprep() to connect ARGS */
-    recalculateVarPoolMemory(csound,
-                             current->varPool); /* recalculate var pool */
-  }
+  insprep_instruments(csound, &(engineState->instxtanchor), current_state,
+                      parallel);
   /* now we need to patch up instr order */
   end = current_state->maxinsno;
   end = end < current_state->maxopcno ? current_state->maxopcno : end;
@@ -1553,10 +1551,10 @@ static char *node2string(int type) {
     and run global i-time code
 */
 void merge_state(CSOUND *csound, ENGINE_STATE *engineState,
-                 TYPE_TABLE *typetable, OPDS *ids) {
+                 TYPE_TABLE *typetable, OPDS *ids, int parallel) {
   if (csound->init_pass_threadlock)
     csoundLockMutex(csound->init_pass_threadlock);
-  engineState_merge(csound, engineState);
+  engineState_merge(csound, engineState, parallel);
   engineState_free(csound, engineState);
   free_typetable(csound, typetable);
   /* run global i-time code */
@@ -1838,7 +1836,7 @@ int csoundCompileTreeInternal(CSOUND *csound, TREE *root, int async) {
     if (!async) {
       if (!csound->oparms->realtime)
         csoundLockMutex(csound->API_lock);
-      merge_state(csound, engineState, typeTable, ids);
+      merge_state(csound, engineState, typeTable, ids, 1);
       if (!csound->oparms->realtime)
         csoundUnlockMutex(csound->API_lock);
     } else {
@@ -1876,11 +1874,8 @@ int csoundCompileTreeInternal(CSOUND *csound, TREE *root, int async) {
       }
     }
 
-    ip = &(engineState->instxtanchor);
-    while ((ip = ip->nxtinstxt) != NULL) { /* add all other entries */
-      insprep(csound, ip, engineState);    /*   as combined offsets */
-      recalculateVarPoolMemory(csound, ip->varPool);
-    }
+    /* add all other entries as combined offsets */
+    insprep_instruments(csound, &(engineState->instxtanchor), engineState, 1);
 
     CS_VARIABLE *var;
     var = csoundFindVariableWithName(csound, engineState->varPool, "sr");
@@ -2096,6 +2091,90 @@ static void insprep(CSOUND *csound, INSTRTXT *tp, ENGINE_STATE *engineState) {
   }
 }
 
+/* insprep() and the var pool size calculation only write to the
+   instrument they are given; constants and strings are already in the
+   pools and only looked up.  So for large orchestras the instruments
+   are shared out over the -j worker threads, each taking a fixed
+   stride of the list, which leaves the result independent of timing.
+   Parsing and the semantic analysis (verify_tree(), run by
+   csoundParseOrc()) stay on one thread: they add to the constant,
+   string and global variable pools, the opcode signature cache and
+   the label lists, and number synthetic variables in order.
+   tests/c/orc_compile_bench.c times the two parts separately. */
+
+#define INSPREP_PARALLEL_MIN (64)
+
+typedef struct {
+  CSOUND *csound;
+  ENGINE_STATE *engineState;
+  INSTRTXT **instrs;
+  int count, first, stride;
+} INSPREP_JOB;
+
+static void insprep_range(INSPREP_JOB *job) {
+  int i;
+  for (i = job->first; i < job->count; i += job->stride) {
+    insprep(job->csound, job->instrs[i], job->engineState);
+    recalculateVarPoolMemory(job->csound, job->instrs[i]->varPool);
+  }
+}
+
+static uintptr_t insprep_thread(void *p) {
+  insprep_range((INSPREP_JOB *)p);
+  return 0;
+}
+
+static void insprep_instruments(CSOUND *csound, INSTRTXT *anchor,
+                                ENGINE_STATE *engineState, int parallel) {
+  int nthreads = csound->oparms->numThreads, count = 0, i;
+  INSTRTXT *ip = anchor;
+  INSPREP_JOB *jobs;
+  void **threads;
+
+  while ((ip = ip->nxtinstxt) != NULL)
+    count++;
+  if (nthreads > count / INSPREP_PARALLEL_MIN)
+    nthreads = count / INSPREP_PARALLEL_MIN;
+  if (!parallel || nthreads < 2 || csound->oparms->odebug) {
+    ip = anchor;
+    while ((ip = ip->nxtinstxt) != NULL) {
+      if (UNLIKELY(csound->oparms->odebug))
+        csound->Message(csound, "insprep %p\n", ip);
+      insprep(csound, ip, engineState); /* run insprep() to connect ARGS */
+      recalculateVarPoolMemory(csound, ip->varPool); /* recalculate var pool */
+    }
+    return;
+  }
+
+  jobs = (INSPREP_JOB *)csound->Calloc(csound, nthreads * sizeof(INSPREP_JOB));
+  threads = (void **)csound->Calloc(csound, nthreads * sizeof(void *));
+  jobs[0].instrs = (INSTRTXT **)csound->Malloc(csound,
+                                               count * sizeof(INSTRTXT *));
+  for (i = 0, ip = anchor; (ip = ip->nxtinstxt) != NULL; i++)
+    jobs[0].instrs[i] = ip;
+  for (i = 0; i < nthreads; i++) {
+    jobs[i].csound = csound;
+    jobs[i].engineState = engineState;
+    jobs[i].instrs = jobs[0].instrs;
+    jobs[i].count = count;
+    jobs[i].first = i;
+    jobs[i].stride = nthreads;
+  }
+  /* the calling thread takes the first share */
+  for (i = 1; i < nthreads; i++)
+    threads[i] = csoundCreateThread(insprep_thread, &jobs[i]);
+  insprep_range(&jobs[0]);
+  for (i = 1; i < nthreads; i++) {
+    if (threads[i] != NULL)
+      csoundJoinThread(threads[i]);
+    else
+      insprep_range(&jobs[i]); /* thread creation failed: do it here */
+  }
+  csound->Free(csound, jobs[0].instrs);
+  csound->Free(csound, threads);
+  csound->Free(csound, jobs);
+}
+
 /* build pool of floating const values  */
 /* build lcl/gbl list of ds names, offsets */
 /* (no need to save the returned values) */
@@ -491,6 +491,144 @@ static char* create_out_arg_for_expression(CSOUND* csound, char* op, TREE* left,
                           typeTable->localPool->synthArgCount++, typeTable);
 }
 
+/* FUSED ARRAY EXPRESSIONS */
+
+#define FUSED_MAX_ARGS (26)
+
+typedef struct {
+    TREE  *args;            /* operands, linked by next */
+    int   nargs, nops;
+    char  rate;             /* 'k' if any operand is k-rate, else 'i' */
+    char  prog[3 * FUSED_MAX_ARGS + 2];
+    int   plen;
+} FUSED_EXPR;
+
+/* Element type of an operand of a fused expression: 'k' or 'i' with
+   *isarray set for k- and i-rate arrays, 'k', 'i' or 'c' for scalars,
+   0 if the operand cannot be fused.  Unknown variables are left to the
+   normal path so that errors are only reported once. */
+static char fused_leaf_type(CSOUND *csound, TREE *leaf, TYPE_TABLE *typeTable,
+                            int *isarray)
+{
+    char *s, *type, c;
+    CS_VARIABLE *var;
+
+    *isarray = 0;
+    if (leaf->type == NUMBER_TOKEN || leaf->type == INTEGER_TOKEN)
+      return 'c';
+    if (leaf->type != T_IDENT || leaf->value == NULL ||
+        (s = leaf->value->lexeme) == NULL)
+      return 0;
+    if (*s == 'g') {
+      var = csoundFindVariableWithName(csound, csound->engineState.varPool, s);
+      if (var == NULL)
+        var = csoundFindVariableWithName(csound, typeTable->globalPool, s);
+    }
+    else var = csoundFindVariableWithName(csound, typeTable->localPool, s);
+    if (var == NULL) return 0;
+    type = get_arg_type2(csound, leaf, typeTable);
+    if (type == NULL) return 0;
+    s = type;
+    while (*s == '[') {
+      *isarray = 1;
+      s++;
+    }
+    c = *s;
+    csound->Free(csound, type);
+    if (c != 'k' && c != 'i') return 0;
+    return c;
+}
+
+/* Flattens a tree of + - * / into a postfix program over its operands.
+   Operands are coded as one letter each, upper case for arrays and
+   lower case for scalars ('A' is the first operand).  Returns 0 if
+   any node or operand cannot be fused. */
+static int fused_flatten(CSOUND *csound, TREE *node, TYPE_TABLE *typeTable,
+                         FUSED_EXPR *fx, int *arrays)
+{
+    int isarray;
+    char c;
+
+    switch (node->type) {
+    case '+': case '-': case '*': case '/':
+      if (node->left == NULL || node->right == NULL ||
+          node->left->next != NULL || node->right->next != NULL)
+        return 0;
+      if (!fused_flatten(csound, node->left, typeTable, fx, arrays) ||
+          !fused_flatten(csound, node->right, typeTable, fx, arrays))
+        return 0;
+      fx->prog[fx->plen++] = (char) node->type;
+      fx->nops++;
+      return 1;
+    default:
+      if (is_expression_node(node) || fx->nargs == FUSED_MAX_ARGS)
+        return 0;
+      if ((c = fused_leaf_type(csound, node, typeTable, &isarray)) == 0)
+        return 0;
+      if (c == 'k') fx->rate = 'k';
+      if (isarray) (*arrays)++;
+      fx->prog[fx->plen++] = (char) ((isarray ? 'A' : 'a') + fx->nargs);
+      fx->nargs++;
+      return 1;
+    }
+}
+
+static void fused_collect(TREE *node, TREE **last)
+{
+    switch (node->type) {
+    case '+': case '-': case '*': case '/':
+      fused_collect(node->left, last);
+      fused_collect(node->right, last);
+      return;
+    default:
+      node->next = NULL;
+      (*last)->next = node;
+      *last = node;
+    }
+}
+
+/**
+ * An arithmetic expression of two or more operators over k- or i-rate
+ * arrays and scalars is compiled to a single ##array_expr call, which
+ * evaluates the whole expression in one pass over the elements instead
+ * of one pass (and one temporary array) per operator.  Returns NULL if
+ * the expression is not of that form.
+ */
+static TREE *create_fused_array_expression(CSOUND *csound, TREE *root,
+                                           int line, int locn,
+                                           TYPE_TABLE* typeTable)
+{
+    FUSED_EXPR fx;
+    TREE       *opTree, *prog, head, *last = &head;
+    char       *outarg, *str;
+    int        arrays = 0;
+
+    memset(&fx, 0, sizeof(FUSED_EXPR));
+    fx.rate = 'i';
+    if (!fused_flatten(csound, root, typeTable, &fx, &arrays) ||
+        arrays == 0 || fx.nops < 2)
+      return NULL;
+    fx.prog[fx.plen] = '\0';
+
+    head.next = NULL;
+    fused_collect(root, &last);
+    str = (char*) csound->Malloc(csound, fx.plen + 3);
+    snprintf(str, fx.plen + 3, "\"%s\"", fx.prog);
+    prog = make_leaf(csound, line, locn, STRING_TOKEN, make_token(csound, str));
+    csound->Free(csound, str);
+    prog->next = head.next;
+
+    outarg = create_out_arg(csound, fx.rate == 'k' ? "[k]" : "[i]",
+                            typeTable->localPool->synthArgCount++, typeTable);
+    opTree = create_opcode_token(csound, "##array_expr");
+    opTree->right = prog;
+    opTree->left = create_ans_token(csound, outarg);
+    opTree->line = line;
+    opTree->locn = locn;
+    csound->Free(csound, outarg);
+    return opTree;
+}
+
 /**
  * Create a chain of Opcode (OPTXT) text from the AST node given. Called from
  * create_opcode when an expression node has been found as an argument
@@ -506,6 +644,9 @@ static TREE *create_expression(CSOUND *csound, TREE *root, int line, int locn,
 
     if (root->type=='?') return create_cond_expression(csound, root, line,
                                                        locn, typeTable);
+    if ((opTree = create_fused_array_expression(csound, root, line, locn,
+                                                typeTable)) != NULL)
+      return opTree;
     memset(op, 0, 80);
     current = root->left;
     newArgList = NULL;
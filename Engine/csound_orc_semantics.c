@@ -60,6 +60,14 @@ void do_baktrace(CSOUND *csound, uint64_t files);
 
 const char* SYNTHESIZED_ARG = "_synthesized";
 
+#define SIG_KEYLEN 256          /* longest opcode signature indexed */
+
+static int opcode_sig_key(char *key, char tag,
+                          const char *outArgTypes, const char *inArgTypes);
+static void *opcode_sig_get(CSOUND *csound, OENTRIES *entries, char *key);
+static void opcode_sig_put(CSOUND *csound, OENTRIES *entries,
+                           char *key, void *value);
+
 char* cs_strdup(CSOUND* csound, char* str) {
     size_t len;
     char* retVal;
@@ -201,11 +209,18 @@ char* create_array_arg_type(CSOUND* csound, CS_VARIABLE* arrayVar) {
 /* this checks if the annotated type exists */
 char *check_annotated_type(CSOUND* csound, OENTRIES* entries,
                            char* outArgTypes) {
-    int i;
+    char key[SIG_KEYLEN];
+    int i, cache = opcode_sig_key(key, 'a', outArgTypes, NULL);
+
+    if (cache && opcode_sig_get(csound, entries, key) != NULL)
+      return outArgTypes;
     for (i = 0; i < entries->count; i++) {
       OENTRY* temp = entries->entries[i];
-      if (check_out_args(csound, outArgTypes, temp->outypes))
+      if (check_out_args(csound, outArgTypes, temp->outypes)) {
+        if (cache)
+          opcode_sig_put(csound, entries, key, temp);
         return outArgTypes;
+      }
     }
     return NULL;
 }
@@ -617,21 +632,36 @@ char* get_opcode_short_name(CSOUND* csound, char* opname) {
 /* find opcode with the specified name in opcode list */
 /* returns index to opcodlst[], or zero if the opcode cannot be found */
 
+/* copies the part of opname before any '.' to buf, or returns NULL if
+   it does not fit */
+static char *opcode_short_name(char *buf, size_t size, const char *opname)
+{
+    size_t len = strcspn(opname, ".");
+
+    if (len >= size) return NULL;
+    memcpy(buf, opname, len);
+    buf[len] = '\0';
+    return buf;
+}
+
 OENTRY* find_opcode(CSOUND *csound, char *opname)
 {
-    char *shortName;
+    char *shortName, buf[64];
     CONS_CELL* head;
     OENTRY* retVal;
 
     if (opname[0] == '\0' || isdigit(opname[0]))
       return 0;
 
-    shortName = get_opcode_short_name(csound, opname);
+    shortName = opcode_short_name(buf, sizeof(buf), opname);
+    if (shortName == NULL)
+      shortName = get_opcode_short_name(csound, opname);
 
     head = cs_hash_table_get(csound, csound->opcodes, shortName);
 
     retVal = (head != NULL) ? head->value : NULL;
-    if (shortName != opname) csound->Free(csound, shortName);
+    if (shortName != opname && shortName != buf)
+      csound->Free(csound, shortName);
 
     return retVal;
 }
@@ -649,7 +679,7 @@ static OENTRIES* get_entries(CSOUND* csound, int count)
 OENTRIES* find_opcode2(CSOUND* csound, char* opname)
 {
     int i = 0;
-    char *shortName;
+    char *shortName, buf[64];
     CONS_CELL *head;
     OENTRIES* retVal;
 
@@ -657,7 +687,9 @@ OENTRIES* find_opcode2(CSOUND* csound, char* opname)
       return NULL;
     }
 
-    shortName = get_opcode_short_name(csound, opname);
+    shortName = opcode_short_name(buf, sizeof(buf), opname);
+    if (shortName == NULL)
+      shortName = get_opcode_short_name(csound, opname);
     head = cs_hash_table_get(csound, csound->opcodes, shortName);
     retVal = get_entries(csound, cs_cons_length(head));
     while (head != NULL) {
@@ -665,7 +697,7 @@ OENTRIES* find_opcode2(CSOUND* csound, char* opname)
       head = head->next;
     }
 
-    if (shortName != opname) {
+    if (shortName != opname && shortName != buf) {
       csound->Free(csound, shortName);
     }
 
@@ -673,6 +705,94 @@ OENTRIES* find_opcode2(CSOUND* csound, char* opname)
 
 }
 
+/* Signature index.  Resolving an opcode means splitting and matching
+ * the argument types of every entry of its name; as the same opcode is
+ * mostly used with the same types all over an orchestra, the result is
+ * kept in csound->opcodeSigs, a table of opcode names each holding a
+ * table from the argument types to the resolved entry.  The types of a
+ * name are dropped when an opcode of that name is added (a new UDO or
+ * plugin may override the entry found before).
+ */
+
+static CS_HASH_TABLE *opcode_sigs(CSOUND *csound, OENTRIES *entries,
+                                  int create)
+{
+    CS_HASH_TABLE *names = (CS_HASH_TABLE *) csound->opcodeSigs, *sigs;
+    char buf[64], *name;
+
+    if (entries->count == 0 ||
+        (name = opcode_short_name(buf, sizeof(buf),
+                                  entries->entries[0]->opname)) == NULL)
+      return NULL;
+    if (names == NULL) {
+      if (!create) return NULL;
+      csound->opcodeSigs = names = cs_hash_table_create(csound);
+    }
+    sigs = cs_hash_table_get(csound, names, name);
+    if (sigs == NULL && create) {
+      sigs = cs_hash_table_create(csound);
+      cs_hash_table_put(csound, names, name, sigs);
+    }
+    return sigs;
+}
+
+/* key of a lookup: a tag for the kind of lookup, then the argument
+   types; returns 0 if they are too long to index */
+static int opcode_sig_key(char *key, char tag,
+                          const char *outArgTypes, const char *inArgTypes)
+{
+    size_t outLen = (outArgTypes != NULL) ? strlen(outArgTypes) : 0;
+    size_t inLen = (inArgTypes != NULL) ? strlen(inArgTypes) : 0;
+
+    if (outLen + inLen + 3 > SIG_KEYLEN) return 0;
+    key[0] = tag;
+    if (outLen) memcpy(key + 1, outArgTypes, outLen);
+    key[outLen + 1] = '|';
+    if (inLen) memcpy(key + outLen + 2, inArgTypes, inLen);
+    key[outLen + inLen + 2] = '\0';
+    return 1;
+}
+
+static void *opcode_sig_get(CSOUND *csound, OENTRIES *entries, char *key)
+{
+    CS_HASH_TABLE *sigs = opcode_sigs(csound, entries, 0);
+    return (sigs != NULL) ? cs_hash_table_get(csound, sigs, key) : NULL;
+}
+
+static void opcode_sig_put(CSOUND *csound, OENTRIES *entries,
+                           char *key, void *value)
+{
+    CS_HASH_TABLE *sigs = opcode_sigs(csound, entries, 1);
+    if (sigs != NULL)
+      cs_hash_table_put(csound, sigs, key, value);
+}
+
+/* Drops the signatures of the opcode named opname, or all of them if
+   opname is NULL */
+void opcode_signatures_reset(CSOUND *csound, char *opname)
+{
+    CS_HASH_TABLE *names = (CS_HASH_TABLE *) csound->opcodeSigs, *sigs;
+    char buf[64], *name;
+    void *value;
+    int pos = 0;
+
+    if (names == NULL)
+      return;
+    if (opname != NULL &&
+        (name = opcode_short_name(buf, sizeof(buf), opname)) != NULL) {
+      if ((sigs = cs_hash_table_get(csound, names, name)) != NULL) {
+        cs_hash_table_free(csound, sigs);
+        cs_hash_table_put(csound, names, name, NULL);
+      }
+      return;
+    }
+    while (cs_hash_table_next(names, &pos, NULL, &value))
+      if (value != NULL)
+        cs_hash_table_free(csound, (CS_HASH_TABLE *) value);
+    cs_hash_table_free(csound, names);
+    csound->opcodeSigs = NULL;
+}
+
 inline static int is_in_optional_arg(char arg) {
     return (strchr("opqvjhOJVP?", arg) != NULL);
 }
@@ -975,37 +1095,41 @@ int check_out_args(CSOUND* csound, char* outArgsFound, char* opOutArgs)
  * are multiple opcode entries with same types and last one should
  * override previous definitions.
  */
-OENTRY* resolve_opcode(CSOUND* csound, OENTRIES* entries,
-                       char* outArgTypes, char* inArgTypes) {
-
-//    OENTRY* retVal = NULL;
-  int i, check;
+static OENTRY* resolve_opcode_scan(CSOUND* csound, OENTRIES* entries,
+                                   char* outArgTypes, char* inArgTypes,
+                                   int *cache) {
+    int i, check;
 
     for (i = 0; i < entries->count; i++) {
-        OENTRY* temp = entries->entries[i];
-//        if (temp->intypes == NULL && temp->outypes == NULL) {
-//            if (outArgTypes == NULL && inArgTypes == NULL) {
-//
-//            }
-//            continue;
-//        }
-        if ((check = check_in_args(csound, inArgTypes, temp->intypes)) &&
-            check_out_args(csound, outArgTypes, temp->outypes)) {
-//            if (retVal != NULL) {
-//                return NULL;
-//            }
-//            retVal = temp;
-          if (check == -1)
-              synterr(csound,
-                      Str("Found %d inputs for %s which is more than "
-                          "the %d allowed\n"),
-                      argsRequired(inArgTypes), temp->opname, VARGMAX);
-
-            return temp;
+      OENTRY* temp = entries->entries[i];
+      if ((check = check_in_args(csound, inArgTypes, temp->intypes)) &&
+          check_out_args(csound, outArgTypes, temp->outypes)) {
+        if (check == -1) {
+          synterr(csound,
+                  Str("Found %d inputs for %s which is more than "
+                      "the %d allowed\n"),
+                  argsRequired(inArgTypes), temp->opname, VARGMAX);
+          *cache = 0;
         }
+        return temp;
+      }
     }
     return NULL;
-//    return retVal;
+}
+
+OENTRY* resolve_opcode(CSOUND* csound, OENTRIES* entries,
+                       char* outArgTypes, char* inArgTypes) {
+    char key[SIG_KEYLEN];
+    int cache = opcode_sig_key(key, 'r', outArgTypes, inArgTypes);
+    OENTRY* retVal;
+
+    if (cache && (retVal = opcode_sig_get(csound, entries, key)) != NULL)
+      return retVal;
+    retVal = resolve_opcode_scan(csound, entries,
+                                 outArgTypes, inArgTypes, &cache);
+    if (cache && retVal != NULL)
+      opcode_sig_put(csound, entries, key, retVal);
+    return retVal;
 }
 
 OENTRY* resolve_opcode_exact(CSOUND* csound, OENTRIES* entries,
@@ -1028,17 +1152,22 @@ OENTRY* resolve_opcode_exact(CSOUND* csound, OENTRIES* entries,
 /* used when creating T_FUNCTION's */
 char* resolve_opcode_get_outarg(CSOUND* csound, OENTRIES* entries,
                               char* inArgTypes) {
-    int i;
+    char key[SIG_KEYLEN], *retVal;
+    int i, check, cache = opcode_sig_key(key, 'o', NULL, inArgTypes);
 
+    if (cache && (retVal = opcode_sig_get(csound, entries, key)) != NULL)
+      return retVal;
     for (i = 0; i < entries->count; i++) {
       OENTRY* temp = entries->entries[i];
       if (temp->intypes == NULL && temp->outypes == NULL) {
         continue;
       }
-      if (check_in_args(csound, inArgTypes, temp->intypes)) {
+      if ((check = check_in_args(csound, inArgTypes, temp->intypes))) {
         // FIXME this is only returning the first match, we need to check
         // if there are multiple matches and if so, return NULL to signify
         // ambiguity
+        if (cache && check == 1 && temp->outypes != NULL)
+          opcode_sig_put(csound, entries, key, temp->outypes);
         return temp->outypes;
       }
     }
@@ -125,20 +125,25 @@ void array_copy_value(void* csound, void* dest, void* src) {
        aSrc->dimensions != aDest->dimensions ||
        aSrc->arrayType != aDest->arrayType ||
        arrayNumMembers != array_get_num_members(aDest)) {
+        size_t ss = aSrc->arrayMemberSize * arrayNumMembers;
 
         aDest->arrayMemberSize = aSrc->arrayMemberSize;
-        aDest->dimensions = aSrc->dimensions;
-        if(aDest->sizes != NULL) {
-            cs->Free(cs, aDest->sizes);
+        if(aDest->sizes == NULL || aDest->dimensions != aSrc->dimensions) {
+            aDest->sizes = cs->ReAlloc(cs, aDest->sizes,
+                                       sizeof(int) * aSrc->dimensions);
         }
-        aDest->sizes = cs->Malloc(cs, sizeof(int) * aSrc->dimensions);
+        aDest->dimensions = aSrc->dimensions;
         memcpy(aDest->sizes, aSrc->sizes, sizeof(int) * aSrc->dimensions);
         aDest->arrayType = aSrc->arrayType;
 
-        if(aDest->data != NULL) {
-            cs->Free(cs, aDest->data);
+        /* the storage is kept unless it is too small */
+        if(aDest->data == NULL || ss > aDest->allocated) {
+            if(aDest->data != NULL) {
+                cs->Free(cs, aDest->data);
+            }
+            aDest->data = cs->Calloc(cs, ss);
+            aDest->allocated = ss;
         }
-        aDest->data = cs->Calloc(cs, aSrc->arrayMemberSize * arrayNumMembers);
     }
 
     for (j = 0; j < arrayNumMembers; j++) {
@@ -221,41 +221,68 @@ int csoundAddVariable(CSOUND* csound, CS_VAR_POOL* pool, CS_VARIABLE* var) {
     cs_hash_table_put(csound, pool->table, var->varName, var);
     // may need to revise this; var pools are accessed as MYFLT*,
     // so need to ensure all memory is aligned to sizeof(MYFLT)
-    var->memBlockIndex = (pool->poolSize / sizeof(MYFLT)) +
-      ((pool->varCount + 1) * (CS_FLOAT_ALIGN(CS_VAR_TYPE_OFFSET) / sizeof(MYFLT)));
+    pool->poolSize += CS_FLOAT_ALIGN(CS_VAR_TYPE_OFFSET);
+    var->memBlockIndex = pool->poolSize / sizeof(MYFLT);
     pool->poolSize += var->memBlockSize;
     pool->varCount += 1;
     return 0;
   } else return -1;
 }
 
+/* layout class of a local variable: a-rate vectors first, then other
+   variables updated at perf time, then i-time only variables last so
+   they do not share cache lines with the perf-time state */
+static int var_layout_class(CS_VARIABLE* var)
+{
+    const char* name = var->varType->varTypeName;
+    if (strcmp(name, "a") == 0) return 0;
+    if (strcmp(name, "i") == 0) return 2;
+    return 1;
+}
+
+/* assigns memBlockIndex and poolSize from the current memBlockSizes;
+   offsets are relative to the instance's lclbas, which instance()
+   aligns to CS_VAR_VECTOR_ALIGN */
+static void layoutVarPool(CS_VAR_POOL* pool)
+{
+    CS_VARIABLE* current;
+    size_t offset = 0;
+    int pass;
+
+    for (pass = 0; pass < 3; pass++) {
+      for (current = pool->head; current != NULL; current = current->next) {
+        if (var_layout_class(current) != pass) continue;
+        offset += CS_FLOAT_ALIGN(CS_VAR_TYPE_OFFSET);
+        if (pass == 0)
+          offset = (offset + CS_VAR_VECTOR_ALIGN - 1) &
+            ~((size_t) CS_VAR_VECTOR_ALIGN - 1);
+        current->memBlockIndex = (int) (offset / sizeof(MYFLT));
+        offset += current->memBlockSize;
+      }
+    }
+    /* keep the opcode data that follows on a cache line boundary too */
+    pool->poolSize = (int) ((offset + CS_VAR_VECTOR_ALIGN - 1) &
+                            ~((size_t) CS_VAR_VECTOR_ALIGN - 1));
+}
+
 void recalculateVarPoolMemory(void* csound, CS_VAR_POOL* pool)
 {
-    CS_VARIABLE* current = pool->head;
-    int varCount = 1;
-    pool->poolSize = 0;
+    CS_VARIABLE* current;
 
-    while (current != NULL) {
+    for (current = pool->head; current != NULL; current = current->next) {
       /* VL 26-12-12: had to revert these lines to avoid memory crashes
          with higher ksmps */
       if(current->updateMemBlockSize != NULL) {
         current->updateMemBlockSize(csound, current);
       }
-
-      current->memBlockIndex = (pool->poolSize / sizeof(MYFLT)) +
-        (varCount * CS_FLOAT_ALIGN(CS_VAR_TYPE_OFFSET) / sizeof(MYFLT));
-      pool->poolSize += current->memBlockSize;
-
-      current = current->next;
-      varCount++;
     }
+    layoutVarPool(pool);
 }
 
 void reallocateVarPoolMemory(void* csound, CS_VAR_POOL* pool) {
     CS_VARIABLE* current = pool->head;
     CS_VAR_MEM* varMem = NULL;
     size_t memSize;
-    pool->poolSize = 0;
 
     while (current != NULL) {
       varMem = current->memBlock;
@@ -272,9 +299,9 @@ void reallocateVarPoolMemory(void* csound, CS_VAR_POOL* pool) {
                                              memSize);
           current->memBlock = varMem;
        }
-       pool->poolSize += current->memBlockSize;
        current = current->next;
     }
+    layoutVarPool(pool);
 }
 
 void deleteVarPoolMemory(void* csnd, CS_VAR_POOL* pool) {
@@ -117,7 +117,7 @@ OENTRY opcodlst_1[] = {
   { "insglobal",S(INSGLOBAL),0,1,   "",     "Sm", insglobal, NULL, NULL, NULL},
   { "midglobal",S(MIDGLOBAL),0,1,   "",     "Sm", midglobal, NULL, NULL, NULL},
   { "ihold",  S(LINK),0,    1,      "",     "",     ihold, NULL, NULL, NULL  },
-  { "turnoff",S(LINK),0,    2,      "",     "",     NULL,   turnoff, NULL, NULL },
+  { "turnoff",S(LINK),_CF,  2,      "",     "",     NULL,   turnoff, NULL, NULL },
   {  "=.S",   S(STRCPY_OP),0,   1,  "S",    "S",
      (SUBR) strcpy_opcode_S, NULL, (SUBR) NULL, NULL    },
   {  "=.T",   S(STRGET_OP),0,   1,  "S",    "i",
@@ -519,13 +519,13 @@ OENTRY opcodlst_1[] = {
   { "outq3",  S(OUTM),IR,    3,      "",     "a",    och3,   outq3   },
   { "outq4",  S(OUTM),IR,    3,      "",     "a",    och2,   outq4   },
   { "igoto",  S(GOTO),0,    1,      "",     "l",    igoto                   },
-  { "kgoto",  S(GOTO),0,    2,      "",     "l",    NULL,   kgoto           },
-  { "goto",   S(GOTO),0,    3,      "",     "l",    igoto,  kgoto           },
+  { "kgoto",  S(GOTO),_CF,  2,      "",     "l",    NULL,   kgoto           },
+  { "goto",   S(GOTO),_CF,  3,      "",     "l",    igoto,  kgoto           },
   { "cigoto", S(CGOTO),0,   1,      "",     "Bl",   icgoto                  },
-  { "ckgoto", S(CGOTO),0,   2,      "",     "Bl",   NULL,   kcgoto          },
-  { "cggoto.0", S(CGOTO),0, 3,      "",     "Bl",   icgoto, kcgoto          },
-  { "timout", S(TIMOUT),0,  3,      "",     "iil",  timset, timout          },
-  { "reinit", S(GOTO),0,    2,      "",     "l",    NULL,   reinit          },
+  { "ckgoto", S(CGOTO),_CF, 2,      "",     "Bl",   NULL,   kcgoto          },
+  { "cggoto.0", S(CGOTO),_CF, 3,      "",     "Bl",   icgoto, kcgoto          },
+  { "timout", S(TIMOUT),_CF, 3,      "",     "iil",  timset, timout          },
+  { "reinit", S(GOTO),_CF,  2,      "",     "l",    NULL,   reinit          },
   { "rigoto", S(GOTO),0,    1,      "",     "l",    rigoto                  },
   { "rireturn",S(LINK),0,   1,      "",     "",     rireturn                },
   { "tigoto", S(GOTO),0,    1,      "",     "l",    tigoto                  },
@@ -823,7 +823,7 @@ OENTRY opcodlst_1[] = {
   { "nstance.kS", S(LINEVENT2),0, 2, "k",  "SSz",  NULL, instanceOpcode_S, NULL },
   { "nstance.S", S(LINEVENT2),0, 1,  "i",  "Siim",  instanceOpcode_S, NULL, NULL},
   { "turnoff.i", S(KILLOP),0,1,     "",     "i", kill_instance, NULL, NULL  },
-  { "turnoff.k", S(KILLOP),0,2,     "",     "k", NULL, kill_instance, NULL},
+  { "turnoff.k", S(KILLOP),_CF,2,     "",     "k", NULL, kill_instance, NULL},
   { "lfo", S(LFO),0,         3,     "k",    "kko",  lfoset,   lfok,   NULL   },
   { "lfo.a", S(LFO),0,         3,     "a",    "kko",  lfoset,   lfoa    },
   { "oscils",   S(OSCILS),0, 3,     "a", "iiio",
@@ -906,22 +906,22 @@ OENTRY opcodlst_1[] = {
   { "outvalue.SS", S(OUTVAL), _CW, 3, "", "SS",
                                    (SUBR) outvalset_string_S, (SUBR)koutvalS, NULL},
   /* IV - Oct 20 2002 */
-  { "subinstr", S(SUBINST),0, 3, "mmmmmmmm", "SN",  subinstrset_S, subinstr },
+  { "subinstr", S(SUBINST),_CF, 3, "mmmmmmmm", "SN",  subinstrset_S, subinstr },
   { "subinstrinit", S(SUBINST),0, 1, "",    "SN",   subinstrset_S, NULL, NULL     },
-  { "subinstr.i", S(SUBINST),0, 3, "mmmmmmmm", "iN",  subinstrset, subinstr },
+  { "subinstr.i", S(SUBINST),_CF, 3, "mmmmmmmm", "iN",  subinstrset, subinstr },
   { "subinstrinit.i", S(SUBINST),0, 1, "",    "iN",   subinstrset, NULL, NULL     },
   { "nstrnum", S(NSTRNUM),0, 1,     "i",    "S",    nstrnumset_S, NULL, NULL      },
   { "nstrnum.i", S(NSTRNUM),0, 1,     "i",    "i",    nstrnumset, NULL, NULL      },
   { "nstrstr", S(NSTRSTR),0, 1,       "S",    "i",    nstrstr, NULL, NULL      },
   { "nstrstr.k", S(NSTRSTR),0, 2,     "S",    "k",    NULL, nstrstr, NULL      },
   //{ "turnoff2",   0xFFFB,   _CW,    0, NULL,   NULL,   NULL, NULL, NULL          },
-  { "turnoff2.S",S(TURNOFF2),_CW,2,     "",     "Skk",  NULL, turnoff2S, NULL     },
-  { "turnoff2.c",S(TURNOFF2),_CW,2,     "",     "ikk",  NULL, turnoff2k, NULL     },
-  { "turnoff2.k",S(TURNOFF2),_CW,2,     "",     "kkk",  NULL, turnoff2k, NULL     },
-  { "turnoff2.i",S(TURNOFF2),_CW,2,     "",     "ikk",  NULL, turnoff2k, NULL     },
-  { "turnoff2.r",S(TURNOFF2),_CW,2,     "",     "ikk",  NULL, turnoff2k, NULL     },
-  { "cngoto", S(CGOTO),0,   3,      "",     "Bl",   ingoto, kngoto, NULL     },
-  { "cnkgoto", S(CGOTO),0,   2,      "",     "Bl",   NULL,  kngoto, NULL     },
+  { "turnoff2.S",S(TURNOFF2),_CW|_CF,2,     "",     "Skk",  NULL, turnoff2S, NULL     },
+  { "turnoff2.c",S(TURNOFF2),_CW|_CF,2,     "",     "ikk",  NULL, turnoff2k, NULL     },
+  { "turnoff2.k",S(TURNOFF2),_CW|_CF,2,     "",     "kkk",  NULL, turnoff2k, NULL     },
+  { "turnoff2.i",S(TURNOFF2),_CW|_CF,2,     "",     "ikk",  NULL, turnoff2k, NULL     },
+  { "turnoff2.r",S(TURNOFF2),_CW|_CF,2,     "",     "ikk",  NULL, turnoff2k, NULL     },
+  { "cngoto", S(CGOTO),_CF, 3,      "",     "Bl",   ingoto, kngoto, NULL     },
+  { "cnkgoto", S(CGOTO),_CF, 2,      "",     "Bl",   NULL,  kngoto, NULL     },
   { "cingoto", S(CGOTO),0,   1,      "",     "Bl",   ingoto, NULL, NULL     },
   { "tempoval", S(GTEMPO),0, 2,  "k", "",      NULL, (SUBR)gettempo, NULL    },
   { "downsamp",S(DOWNSAMP),0,3, "k", "ao",   (SUBR)downset,(SUBR)downsamp        },
@@ -1061,10 +1061,10 @@ OENTRY opcodlst_1[] = {
   { "loop_le.i", S(LOOP_OPS),0,  1,  "", "iiil", (SUBR) loop_le_i, NULL, NULL  },
   { "loop_gt.i", S(LOOP_OPS),0,  1,  "", "iiil", (SUBR) loop_g_i, NULL, NULL   },
   { "loop_ge.i", S(LOOP_OPS),0,  1,  "", "iiil", (SUBR) loop_ge_i, NULL, NULL  },
-  { "loop_lt.k", S(LOOP_OPS),0,  2,  "", "kkkl", NULL, (SUBR) loop_l_p, NULL   },
-  { "loop_le.k", S(LOOP_OPS),0,  2,  "", "kkkl", NULL, (SUBR) loop_le_p, NULL  },
-  { "loop_gt.k", S(LOOP_OPS),0,  2,  "", "kkkl", NULL, (SUBR) loop_g_p, NULL   },
-  { "loop_ge.k", S(LOOP_OPS),0,  2,  "", "kkkl", NULL, (SUBR) loop_ge_p, NULL  },
+  { "loop_lt.k", S(LOOP_OPS),_CF,2,  "", "kkkl", NULL, (SUBR) loop_l_p, NULL   },
+  { "loop_le.k", S(LOOP_OPS),_CF,2,  "", "kkkl", NULL, (SUBR) loop_le_p, NULL  },
+  { "loop_gt.k", S(LOOP_OPS),_CF,2,  "", "kkkl", NULL, (SUBR) loop_g_p, NULL   },
+  { "loop_ge.k", S(LOOP_OPS),_CF,2,  "", "kkkl", NULL, (SUBR) loop_ge_p, NULL  },
   { "chnget",      0xFFFF,    _CR                                             },
   { "chnget.i",    S(CHNGET),_CR,           1,      "i",            "S",
     (SUBR) chnget_opcode_init_i, NULL, NULL               },
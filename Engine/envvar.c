@@ -33,7 +33,11 @@
 
 #if defined(WIN32) && !defined(__CYGWIN__)
 #  include <direct.h>
+#  include <io.h>
 #  define getcwd(x,y) _getcwd(x,y)
+#  define fsync(x) _commit(x)
+#else
+#  include <unistd.h>
 #endif
 
 
@@ -73,6 +77,11 @@ typedef struct CSFILE_ {
     int             pos;
     MYFLT           *buf;
     int             bufsize;
+    int             columns;    /* values per ring element of writers */
+    int             format;     /* ASYNC_FMT_ of CSFILE_STD writers */
+    int             sync;       /* file_sync policy */
+    float           *obuf;      /* ASYNC_FMT_COLUMNS output */
+    uint32          dropped;    /* frames lost to a full ring */
     char            fullName[1];
 } CSFILE;
 
@@ -1088,6 +1097,10 @@ void *csoundFileOpenWithType(CSOUND *csound, void *fd, int type,
     p->fd = tmp_fd;
     p->f = tmp_f;
     p->sf = (SNDFILE*) NULL;
+    p->async_flag = 0;
+    p->format = 0;
+    p->obuf = NULL;
+    p->dropped = 0;
     strcpy(&(p->fullName[0]), fullName);
     if (env != NULL) {
       csound->Free(csound, fullName);
@@ -1279,12 +1292,20 @@ char *csoundGetFileName(void *fd)
  * Close a file previously opened with csoundFileOpen().
  */
 
+static int write_async(CSOUND *csound, CSFILE *p);
+
 int csoundFileClose(CSOUND *csound, void *fd)
 {
     CSFILE  *p = (CSFILE*) fd;
     int     retval = -1;
     if (p->async_flag == ASYNC_GLOBAL) {
       csound->WaitThreadLockNoTimeout(csound->file_io_threadlock);
+      /* write what is left in the ring */
+      if (p->type == CSFILE_SND_W || (p->type == CSFILE_STD && p->format))
+        while (write_async(csound, p) > 0);
+      if (UNLIKELY(p->dropped))
+        csound->Warning(csound, Str("%u frames were dropped writing '%s'"),
+                        p->dropped, p->fullName);
       /* close file */
       switch (p->type) {
       case CSFILE_FD_R:
@@ -1311,6 +1332,7 @@ int csoundFileClose(CSOUND *csound, void *fd)
       if (p->nxt != NULL)
         p->nxt->prv = p->prv;
       if (p->buf != NULL) csound->Free(csound, p->buf);
+      if (p->obuf != NULL) csound->Free(csound, p->obuf);
       p->bufsize = 0;
       csound->DestroyCircularBuffer(csound, p->cb);
       csound->NotifyThreadLock(csound->file_io_threadlock);
@@ -1395,6 +1417,48 @@ void *fopen_path(CSOUND *csound, FILE **fp, char *name, char *basename,
 
 uintptr_t file_iothread(void *p);
 
+/* Moves a batch of frames from the ring of a writer to its file,
+   returns the number of frames */
+
+static int write_async(CSOUND *csound, CSFILE *p)
+{
+    int     i, j, frames;
+    MYFLT   *buf = p->buf;
+
+    frames = csound->ReadCircularBuffer(csound, p->cb, buf,
+                                        p->bufsize / p->columns);
+    if (frames == 0)
+      return 0;
+    if (p->type == CSFILE_SND_W) {
+      sf_write_MYFLT(p->sf, buf, frames * p->columns);
+      if (p->sync)
+        sf_write_sync(p->sf);
+      return frames;
+    }
+    if (p->format == ASYNC_FMT_TEXT) {
+      for (i = 0; i < frames; i++) {
+        for (j = 0; j < p->columns; j++)
+          fprintf(p->f, "%g ", buf[i * p->columns + j]);
+        fprintf(p->f, "\n");
+      }
+    }
+    else {
+      uint32 n = (uint32) frames;
+      float  *out = p->obuf;
+      for (j = 0; j < p->columns; j++)
+        for (i = 0; i < frames; i++)
+          *out++ = (float) buf[i * p->columns + j];
+      fwrite(&n, sizeof(uint32), 1, p->f);
+      fwrite(p->obuf, sizeof(float), frames * p->columns, p->f);
+    }
+    if (p->sync) {
+      fflush(p->f);
+      if (p->sync > 1)
+        fsync(fileno(p->f));
+    }
+    return frames;
+}
+
 void *csoundFileOpenWithType_Async(CSOUND *csound, void *fd, int type,
                                    const char *name, void *param, const char *env,
                                    int csFileType, int buffsize, int isTemporary)
@@ -1415,11 +1479,19 @@ void *csoundFileOpenWithType_Async(CSOUND *csound, void *fd, int type,
     csound->WaitThreadLockNoTimeout(csound->file_io_threadlock);
     p->async_flag = ASYNC_GLOBAL;
 
-    p->cb = csound->CreateCircularBuffer(csound, buffsize*4, sizeof(MYFLT));
+    /* a sound file writer queues whole frames, so that a full ring
+       drops frames rather than shifting the channels */
+    p->columns = (type == CSFILE_SND_W ? ((SF_INFO*) param)->channels : 1);
+    if (buffsize < p->columns)
+      buffsize = p->columns;
+    p->cb = csound->CreateCircularBuffer(csound, buffsize*4 / p->columns,
+                                         sizeof(MYFLT) * p->columns);
     p->items = 0;
     p->pos = 0;
     p->bufsize = buffsize;
     p->buf = (MYFLT *) csound->Calloc(csound, sizeof(MYFLT)*buffsize);
+    p->sync = *((int*) csound->QueryGlobalVariableNoCheck(csound,
+                                                          "_FILE_SYNC"));
     csound->NotifyThreadLock(csound->file_io_threadlock);
 
     if (p->cb == NULL || p->buf == NULL) {
@@ -1442,13 +1514,68 @@ unsigned int csoundReadAsync(CSOUND *csound, void *handle,
     else return 0;
 }
 
+/* Queues 'items' values, whole frames only.  In real time a full ring
+   drops the frames that do not fit, otherwise this writes the ring to
+   the file itself to make room. */
+
 unsigned int csoundWriteAsync(CSOUND *csound, void *handle,
                               MYFLT *buf, int items)
 {
     CSFILE *p = handle;
-    if (p != NULL &&  p->cb != NULL)
-      return csound->WriteCircularBuffer(csound, p->cb, buf, items);
-    else return 0;
+    int    frames, n = 0;
+    if (p == NULL || p->cb == NULL)
+      return 0;
+    frames = items / p->columns;
+    while (1) {
+      n += csound->WriteCircularBuffer(csound, p->cb,
+                                       buf + n * p->columns, frames - n);
+      if (n == frames || csound->oparms->realtime ||
+          (p->type != CSFILE_SND_W && !p->format))
+        break;
+      csound->WaitThreadLockNoTimeout(csound->file_io_threadlock);
+      write_async(csound, p);
+      csound->NotifyThreadLock(csound->file_io_threadlock);
+    }
+    p->dropped += (uint32) (frames - n);
+    return (unsigned int) (n * p->columns);
+}
+
+int csoundSetAsyncFormat(CSOUND *csound, void *handle,
+                         int format, int columns)
+{
+    CSFILE *p = handle;
+    if (UNLIKELY(p == NULL || p->async_flag != ASYNC_GLOBAL ||
+                 p->type != CSFILE_STD || columns < 1 ||
+                 (format != ASYNC_FMT_TEXT && format != ASYNC_FMT_COLUMNS)))
+      return CSOUND_ERROR;
+    if (p->format != 0)
+      return (format == p->format && columns == p->columns ?
+              CSOUND_SUCCESS : CSOUND_ERROR);
+    csound->WaitThreadLockNoTimeout(csound->file_io_threadlock);
+    csound->DestroyCircularBuffer(csound, p->cb);
+    if (p->bufsize < columns) {
+      p->bufsize = columns;
+      p->buf = (MYFLT *) csound->ReAlloc(csound, p->buf,
+                                         sizeof(MYFLT) * columns);
+    }
+    p->cb = csound->CreateCircularBuffer(csound, p->bufsize*4 / columns,
+                                         sizeof(MYFLT) * columns);
+    p->columns = columns;
+    p->format = format;
+    if (format == ASYNC_FMT_COLUMNS) {
+      uint32 hdr[4];
+      double sr = (double) csound->esr;
+      p->obuf = (float *) csound->ReAlloc(csound, p->obuf,
+                                          sizeof(float) * p->bufsize);
+      memcpy(hdr, "CSCF", 4);
+      hdr[1] = 1;
+      hdr[2] = (uint32) columns;
+      hdr[3] = (uint32) sizeof(float);
+      fwrite(hdr, sizeof(uint32), 4, p->f);
+      fwrite(&sr, sizeof(double), 1, p->f);
+    }
+    csound->NotifyThreadLock(csound->file_io_threadlock);
+    return (p->cb == NULL ? CSOUND_MEMORY : CSOUND_SUCCESS);
 }
 
 int csoundFSeekAsync(CSOUND *csound, void *handle, int pos, int whence){
@@ -1489,6 +1616,8 @@ static int read_files(CSOUND *csound){
         case CSFILE_FD_W:
           break;
         case CSFILE_STD:
+          if (current->format)
+            write_async(csound, current);
           break;
         case CSFILE_SND_R:
           if (n == 0) {
@@ -1502,9 +1631,7 @@ static int read_files(CSOUND *csound){
           current->pos = m;
           break;
         case CSFILE_SND_W:
-          items = csound->ReadCircularBuffer(csound, current->cb, buf, items);
-          if (items == 0) { csoundSleep(10); break;}
-          sf_write_MYFLT(current->sf, buf, items);
+          write_async(csound, current);
           break;
         }
       }
@@ -757,10 +757,47 @@ static int gen08(FGDATA *ff, FUNC *ftp)
     return OK;
 }
 
+/* Harmonic summation of GEN09 and GEN19: adds amp * sin(phs + i*inc) + dc
+   to the n points of fp without a sin() per point.  The points of a block
+   of GENSUM_BLOCK are the first one turned by the precomputed angles
+   j*inc, in a loop that vectorises, and the first points of successive
+   blocks are turned by GENSUM_BLOCK*inc, restarting from sin() and cos()
+   every GENSUM_SYNC points so that the rounding errors cannot grow. */
+
+#define GENSUM_BLOCK    16
+#define GENSUM_SYNC     256
+
+static void gen_addsine(MYFLT *fp, int32 n, double phs, double inc,
+                        double amp, double dc)
+{
+    double  sj[GENSUM_BLOCK], cj[GENSUM_BLOCK], sb, cb, s = 0.0, c = 0.0, t;
+    int32   i, j, m;
+
+    for (j = 0; j < GENSUM_BLOCK; j++) {
+      sj[j] = sin(j * inc) * amp;
+      cj[j] = cos(j * inc) * amp;
+    }
+    sb = sin(GENSUM_BLOCK * inc);
+    cb = cos(GENSUM_BLOCK * inc);
+    for (i = 0; i < n; i += GENSUM_BLOCK) {
+      if (i % GENSUM_SYNC == 0) {
+        t = phs + i * inc;
+        s = sin(t);
+        c = cos(t);
+      }
+      m = (n - i < GENSUM_BLOCK ? n - i : GENSUM_BLOCK);
+      for (j = 0; j < m; j++)
+        fp[i + j] += (MYFLT) (s * cj[j] + c * sj[j] + dc);
+      t = s * cb + c * sb;
+      c = c * cb - s * sb;
+      s = t;
+    }
+}
+
 static int gen09(FGDATA *ff, FUNC *ftp)
 {
     int     hcnt;
-    MYFLT   *valp, *fp, *finp;
+    MYFLT   *valp;
     double  phs, inc, amp;
     double  tpdlen = TWOPI / (double) ff->flen;
     CSOUND  *csound = ff->csound;
@@ -771,7 +808,6 @@ static int gen09(FGDATA *ff, FUNC *ftp)
     if ((hcnt = (ff->e.pcnt - 4) / 3) <= 0)         /* hcnt = nargs / 3 */
       return OK;
     valp = &ff->e.p[5];
-    finp = &ftp->ftable[ff->flen];
     do {
       inc = *(valp++) * tpdlen;
       if (UNLIKELY(nsw && valp>&ff->e.p[PMAX])) {
@@ -797,11 +833,7 @@ static int gen09(FGDATA *ff, FUNC *ftp)
         nsw = 0;                /* only switch once */
         valp = &(ff->e.c.extra[1]);
       }
-      for (fp = ftp->ftable; fp <= finp; fp++) {
-        *fp += (MYFLT) (sin(phs) * amp);
-        if (UNLIKELY((phs += inc) >= TWOPI))
-          phs -= TWOPI;
-      }
+      gen_addsine(ftp->ftable, ff->flen + 1, phs, inc, amp, 0.0);
     } while (--hcnt);
 
     return OK;
@@ -809,8 +841,8 @@ static int gen09(FGDATA *ff, FUNC *ftp)
 
 static int gen10(FGDATA *ff, FUNC *ftp)
 {
-    int32   phs, hcnt;
-    MYFLT   amp, *fp, *finp;
+    int32   phs, hcnt, hinc, n;
+    MYFLT   amp, *fp, *finp, *sines;
     int32   flen = ff->flen;
     double  tpdlen = TWOPI / (double) flen;
     CSOUND  *csound = ff->csound;
@@ -819,16 +851,29 @@ static int gen10(FGDATA *ff, FUNC *ftp)
       csound->Warning(csound, Str("using extended arguments\n"));
     hcnt = ff->e.pcnt - 4;                              /* hcnt is nargs    */
     finp = &ftp->ftable[flen];
+    /* harmonics land on the points of one period, so their sines are
+       looked up rather than computed */
+    sines = (MYFLT *) csound->Malloc(csound, flen * sizeof(MYFLT));
+    for (phs = 0; phs < flen; phs++)
+      sines[phs] = (MYFLT) sin(phs * tpdlen);
     do {
       MYFLT *valp = (hcnt+4>=PMAX ? &ff->e.c.extra[hcnt+5-PMAX] :
                                     &ff->e.p[hcnt + 4]);
-      if ((amp = *valp) != FL(0.0))         /* for non-0 amps,  */
-        for (phs = 0, fp = ftp->ftable; fp <= finp; fp++) {
-          *fp += (MYFLT) sin(phs * tpdlen) * amp;         /* accum sin pts    */
-          phs += hcnt;                                    /* phsinc is hno    */
-          phs %= flen;
-        }
+      if ((amp = *valp) != FL(0.0)) {       /* for non-0 amps,  */
+        hinc = hcnt % flen;                 /* phsinc is hno    */
+        if (!(flen & (flen - 1)))           /* power of 2: no   */
+          for (n = 0; n <= flen; n++)       /*   dependency     */
+            ftp->ftable[n] += sines[((uint32) n * (uint32) hinc)
+                                    & (uint32) (flen - 1)] * amp;
+        else
+          for (phs = 0, fp = ftp->ftable; fp <= finp; fp++) {
+            *fp += sines[phs] * amp;                      /* accum sin pts    */
+            if ((phs += hinc) >= flen)
+              phs -= flen;
+          }
+      }
     } while (--hcnt);
+    csound->Free(csound, sines);
 
     return OK;
 }
@@ -1205,7 +1250,7 @@ static int gen18(FGDATA *ff, FUNC *ftp)
 static int gen19(FGDATA *ff, FUNC *ftp)
 {
     int     hcnt;
-    MYFLT   *valp, *fp, *finp;
+    MYFLT   *valp;
     double  phs, inc, amp, dc, tpdlen = TWOPI / (double) ff->flen;
     int     nargs = ff->e.pcnt - 4;
     CSOUND  *csound = ff->csound;
@@ -1216,7 +1261,6 @@ static int gen19(FGDATA *ff, FUNC *ftp)
     if ((hcnt = nargs / 4) <= 0)                /* hcnt = nargs / 4 */
       return OK;
     valp = &ff->e.p[5];
-    finp = &ftp->ftable[ff->flen];
     do {
       inc = *(valp++) * tpdlen;
       if (UNLIKELY(nsw && valp>=&ff->e.p[PMAX-1]))
@@ -1230,11 +1274,8 @@ static int gen19(FGDATA *ff, FUNC *ftp)
       dc = *(valp++);
       if (UNLIKELY(nsw && valp>=&ff->e.p[PMAX-1]))
         nsw =0, valp = &(ff->e.c.extra[1]);
-      for (fp = ftp->ftable; fp <= finp; fp++) {
-        *fp += (MYFLT) (sin(phs) * amp + dc);   /* dc after str scale */
-        if ((phs += inc) >= TWOPI)
-          phs -= TWOPI;
-      }
+      /* dc after str scale */
+      gen_addsine(ftp->ftable, ff->flen + 1, phs, inc, amp, dc);
     } while (--hcnt);
 
     return OK;
@@ -33,6 +33,8 @@
 #include "interlocks.h"
 #include "csound_type_system.h"
 #include "csound_standard_types.h"
+#include "csprofile.h"
+#include "cluster.h"
 #include <inttypes.h>
 
 static  void    showallocs(CSOUND *);
@@ -293,6 +295,9 @@ static void set_xtratim(CSOUND *csound, INSDS *ip)
 /*      then run an init pass            */
 int insert(CSOUND *csound, int insno, EVTBLK *newevtp) {
 
+  /* in a cluster, another node may perform this instrument */
+  if (UNLIKELY(csound->cluster != NULL) && !csoundClusterOwns(csound, insno))
+    return 0;
   if(csound->oparms->realtime) {
     unsigned long wp = csound->alloc_queue_wp;
     csound->alloc_queue[wp].insno = insno;
@@ -564,6 +569,9 @@ int insert_event(CSOUND *csound, int insno, EVTBLK *newevtp)
 /*  then run an init pass                    */
 int MIDIinsert(CSOUND *csound, int insno, MCHNBLK *chn, MEVENT *mep) {
 
+  /* in a cluster, another node may perform this instrument */
+  if (UNLIKELY(csound->cluster != NULL) && !csoundClusterOwns(csound, insno))
+    return 0;
   if(csound->oparms->realtime) {
     unsigned long wp = csound->alloc_queue_wp;
     csound->alloc_queue[wp].insno = insno;
@@ -677,6 +685,16 @@ int insert_midi(CSOUND *csound, int insno, MCHNBLK *chn, MEVENT *mep)
   ip->p1.value     = (MYFLT) insno;     /* set these required p-fields */
   ip->p2.value     = (MYFLT) (csound->icurTime/csound->esr - csound->timeOffs);
   ip->p3.value     = FL(-1.0);
+  /* with a timestamped MIDI driver, start at the sample the note on was
+     received in the control period, as for sample-accurate score events */
+  if (O->sampleAccurate && mep->offset > 0 &&
+      mep->offset < (int32) csound->ksmps) {
+    ip->ksmps_offset = mep->offset;
+    ip->p2.value    += (MYFLT) (mep->offset/csound->esr);
+  }
+  else ip->ksmps_offset = 0;
+  ip->ksmps_no_end = 0;
+  ip->no_end       = 0;
   ip->ksmps        = csound->ksmps;
   ip->ekr          = csound->ekr;
   ip->kcounter     = csound->kcounter;
@@ -1175,6 +1193,7 @@ int csoundPerfError(CSOUND *csound, OPDS *h, const char *s, ...)
   va_list args;
   char    buf[512];
   INSDS *ip = h->insdshead;
+  OPDS  *cur = h;
   TEXT t = h->optext->t;
   if (csound->mode != 2)
     csound->Message(csound, Str("PerfError in wrong mode %d\n"), csound->mode);
@@ -1184,6 +1203,7 @@ int csoundPerfError(CSOUND *csound, OPDS *h, const char *s, ...)
     do {
       ip = ((OPCOD_IOBUFS*) ip->opcod_iobufs)->parent_ip;
     } while (ip->opcod_iobufs);
+    cur = ip->pds;            /* the UDO or subinstr call, a PCHAIN_CF op */
     if (op)
       snprintf(buf, 512, Str("PERF ERROR in instr %d (opcode %s) line %d: "),
                ip->insno, op->name, t.linenum);
@@ -1193,13 +1213,13 @@ int csoundPerfError(CSOUND *csound, OPDS *h, const char *s, ...)
   }
   else
     snprintf(buf, 512, Str("PERF ERROR in instr %d (opcode %s) line %d: "),
-             ip->insno, csound->op, t.linenum);
+             ip->insno, t.opcod, t.linenum);
   va_start(args, s);
   csoundErrMsgV(csound, buf, s, args);
   va_end(args);
   do_baktrace(csound, t.locn);
-  if (ip->pds)
-    putop(csound, &(ip->pds->optext->t));
+  if (cur)
+    putop(csound, &(cur->optext->t));
   csoundMessage(csound, Str("   note aborted\n"));
   csound->perferrcnt++;
   xturnoff_now((CSOUND*) csound, ip);       /* rm ins fr actlist */
@@ -1791,6 +1811,45 @@ void timexpire(CSOUND *csound, double time)
   }
 }
 
+/* Runs the perf chain of an instance, or of the instance of a UDO or
+   subinstr, for one k-period.  The chain is walked through the array of
+   opcode pointers built by instance(), so fetching the next opcode does
+   not wait on the previous one's nxtp link.  Only the PCHAIN_CF opcodes,
+   which can jump, reinit or turn the instance off, get ip->pds set and
+   are checked afterwards; after a jump the links are followed from
+   wherever the opcode left pds. */
+int perf_chain(CSOUND *csound, INSDS *ip, int thread)
+{
+  OPDS **pc = INSDS_PCHAIN(ip), *op;
+  void *prof = csound->profiler;
+  int  error;
+
+  if (UNLIKELY(prof != NULL))
+    return csoundProfileInstance(csound, prof, ip, thread);
+  while ((op = *pc++) != NULL) {
+    if (LIKELY(!((uintptr_t) op & PCHAIN_CF))) {
+      if (UNLIKELY((error = (*op->opadr)(csound, op)) != 0))
+        return error;
+      continue;
+    }
+    op = (OPDS*) ((uintptr_t) op & ~PCHAIN_CF);
+    ip->pds = op;
+    error = (*op->opadr)(csound, op);
+    if (UNLIKELY(error != 0 || !ip->actflg))
+      return error;
+    if (UNLIKELY(ip->pds != op)) {              /* jumped */
+      op = ip->pds;
+      while (error == 0 && (op = op->nxtp) != NULL && ip->actflg) {
+        ip->pds = op;
+        error = (*op->opadr)(csound, op);
+        op = ip->pds;
+      }
+      return error;
+    }
+  }
+  return 0;
+}
+
 /**
    this was rewritten for Csound 6 to allow
    PARCS and local ksmps instruments
@@ -1824,17 +1883,8 @@ int subinstr(CSOUND *csound, SUBINST *p)
 
   /*  run each opcode  */
   if (csound->ksmps == ip->ksmps) {
-    int error = 0;
-    if ((CS_PDS = (OPDS *) (ip->nxtp)) != NULL) {
-      CS_PDS->insdshead->pds = NULL;
-      do {
-        error = (*CS_PDS->opadr)(csound, CS_PDS);
-        if (CS_PDS->insdshead->pds != NULL) {
-          CS_PDS = CS_PDS->insdshead->pds;
-          CS_PDS->insdshead->pds = NULL;
-        }
-      } while (error == 0 && (CS_PDS = CS_PDS->nxtp));
-    }
+    ip->pds = NULL;
+    (void) perf_chain(csound, ip, -1);
     ip->kcounter++;
   }
   else {
@@ -1861,21 +1911,12 @@ int subinstr(CSOUND *csound, SUBINST *p)
     }
 
     for (i=start; i < n; i+=incr, ip->spin+=incr, ip->spout+=incr) {
-      if ((CS_PDS = (OPDS *) (ip->nxtp)) != NULL) {
-        int error = 0;
-        CS_PDS->insdshead->pds = NULL;
-        do {
-          if(UNLIKELY(!ATOMIC_GET8(p->ip->actflg))){
-            memset(p->ar, 0, sizeof(MYFLT)*CS_KSMPS*p->OUTCOUNT);
-            goto endin;
-          }
-          error = (*CS_PDS->opadr)(csound, CS_PDS);
-          if (CS_PDS->insdshead->pds != NULL) {
-            CS_PDS = CS_PDS->insdshead->pds;
-            CS_PDS->insdshead->pds = NULL;
-          }
-        } while (error == 0 && (CS_PDS = CS_PDS->nxtp));
+      if (UNLIKELY(!ATOMIC_GET8(ip->actflg))) {
+        memset(p->ar, 0, sizeof(MYFLT)*CS_KSMPS*p->OUTCOUNT);
+        goto endin;
       }
+      ip->pds = NULL;
+      (void) perf_chain(csound, ip, -1);
       ip->kcounter++;
     }
     ip->spout = (MYFLT*) p->saved_spout.auxp;
@@ -1980,20 +2021,9 @@ int useropcd1(CSOUND *csound, UOPCODE *p)
         current = current->next;
       }
 
-      if ((CS_PDS = (OPDS *) (this_instr->nxtp)) != NULL) {
-        int error = 0;
-        CS_PDS->insdshead->pds = NULL;
-        do {
-          if(UNLIKELY(!ATOMIC_GET8(p->ip->actflg))) goto endop;
-          error = (*CS_PDS->opadr)(csound, CS_PDS);
-          if (CS_PDS->insdshead->pds != NULL &&
-              CS_PDS->insdshead->pds->insdshead) {
-            CS_PDS = CS_PDS->insdshead->pds;
-            CS_PDS->insdshead->pds = NULL;
-          }
-        } while (error == 0 && p->ip != NULL
-                 && (CS_PDS = CS_PDS->nxtp));
-      }
+      if (UNLIKELY(!ATOMIC_GET8(this_instr->actflg))) goto endop;
+      this_instr->pds = NULL;
+      (void) perf_chain(csound, this_instr, -1);
 
       /* copy a-sig outputs, accounting for offset */
       current = inm->out_arg_pool->head;
@@ -2091,20 +2121,9 @@ int useropcd1(CSOUND *csound, UOPCODE *p)
       }
 
       /*  run each opcode  */
-      if ((CS_PDS = (OPDS *) (this_instr->nxtp)) != NULL) {
-        int error = 0;
-        CS_PDS->insdshead->pds = NULL;
-        do {
-          if(UNLIKELY(!ATOMIC_GET8(p->ip->actflg))) goto endop;
-          error = (*CS_PDS->opadr)(csound, CS_PDS);
-          if (CS_PDS->insdshead->pds != NULL &&
-              CS_PDS->insdshead->pds->insdshead) {
-            CS_PDS = CS_PDS->insdshead->pds;
-            CS_PDS->insdshead->pds = NULL;
-          }
-        } while (error == 0 && p->ip != NULL
-                 && (CS_PDS = CS_PDS->nxtp));
-      }
+      if (UNLIKELY(!ATOMIC_GET8(this_instr->actflg))) goto endop;
+      this_instr->pds = NULL;
+      (void) perf_chain(csound, this_instr, -1);
 
       /* copy a-sig outputs, accounting for offset */
       current = inm->out_arg_pool->head;
@@ -2228,7 +2247,7 @@ int useropcd2(CSOUND *csound, UOPCODE *p)
   p->ip->spin = p->parent_ip->spin;
   p->ip->spout = p->parent_ip->spout;
 
-  if (UNLIKELY(!(CS_PDS = (OPDS*) (p->ip->nxtp))))
+  if (UNLIKELY(this_instr->nxtp == NULL))
     goto endop; /* no perf code */
 
 
@@ -2261,20 +2280,9 @@ int useropcd2(CSOUND *csound, UOPCODE *p)
   }
 
   /*  run each opcode  */
-  {
-  int error = 0;
-  CS_PDS->insdshead->pds = NULL;
-  do {
-    if(UNLIKELY(!ATOMIC_GET8(p->ip->actflg))) goto endop;
-    error = (*CS_PDS->opadr)(csound, CS_PDS);
-    if (CS_PDS->insdshead->pds != NULL &&
-        CS_PDS->insdshead->pds->insdshead) {
-      CS_PDS = CS_PDS->insdshead->pds;
-      CS_PDS->insdshead->pds = NULL;
-    }
-  } while (error == 0 && p->ip != NULL
-           && (CS_PDS = CS_PDS->nxtp));
-  }
+  if (UNLIKELY(!ATOMIC_GET8(this_instr->actflg))) goto endop;
+  this_instr->pds = NULL;
+  (void) perf_chain(csound, this_instr, -1);
   this_instr->kcounter++;
 
   /* copy outputs */
@@ -2316,32 +2324,77 @@ int useropcd2(CSOUND *csound, UOPCODE *p)
 int findLabelMemOffset(CSOUND* csound, INSTRTXT* ip, char* labelName) {
   IGN(csound);
   OPTXT* optxt = (OPTXT*) ip;
-  int offset = 0;
+  int offset = 0, n = 0;
 
   while ((optxt = optxt->nxtop) != NULL) {
     TEXT* t = &optxt->t;
     if (strcmp(t->oentry->opname, "$label") == 0 &&
         strcmp(t->opcod, labelName) == 0) {
+      if (ip->opdsoffs != NULL)
+        offset = ip->opdsoffs[n];
       break;
     }
     offset += t->oentry->dsblksiz;
+    n++;
   }
 
   return offset;
 }
 
+/* Opcode data layout of an instance, computed on first use and kept
+   in the INSTRTXT.  The blocks of opcodes in the perf chain are packed
+   together at the start so kperf() walks contiguous memory; i-time only
+   opcodes and labels follow.  Returns the total size, and counts the
+   perf chain in tp->perfcnt. */
+static int32 instr_opds_layout(CSOUND *csound, INSTRTXT *tp)
+{
+  OPTXT *optxt;
+  int32 offset = 0;
+  int   count = 0, pass, n;
+
+  for (optxt = (OPTXT*) tp; (optxt = optxt->nxtop) != NULL; )
+    count++;
+  tp->perfcnt = 0;
+  if (tp->opdsoffs == NULL)
+    tp->opdsoffs = (int32*) csound->Calloc(csound,
+                                           (count + 1) * sizeof(int32));
+  for (pass = 0; pass < 2; pass++) {
+    for (n = 0, optxt = (OPTXT*) tp; (optxt = optxt->nxtop) != NULL; n++) {
+      const OENTRY *ep = optxt->t.oentry;
+      int perf = (ep->thread & 02) != 0 ||
+        ((ep->thread & 03) == 0 && optxt->t.pftype != 'b');
+      if (strcmp(ep->opname, "$label") == 0)
+        perf = 0;
+      if (perf != (pass == 0)) continue;
+      if (perf) tp->perfcnt++;
+      tp->opdsoffs[n] = offset;
+      offset += ep->dsblksiz;
+    }
+  }
+  return offset;
+}
+
 /* create instance of an instr template */
 /*   allocates and sets up all pntrs    */
 
+/* the perf chain entry of an opcode, marked PCHAIN_CF if it can jump,
+   reinit or turn its instance off */
+static inline OPDS *pchain_entry(const OENTRY *ep, OPDS *opds)
+{
+  if (ep->useropinfo != NULL || (ep->flags & _CF))
+    return (OPDS*) ((uintptr_t) opds | PCHAIN_CF);
+  return opds;
+}
+
 static void instance(CSOUND *csound, int insno)
 {
   INSTRTXT  *tp;
   INSDS     *ip;
   OPTXT     *optxt;
-  OPDS      *opds, *prvids, *prvpds;
+  OPDS      *opds, *prvids, *prvpds, **pchain;
   const OENTRY  *ep;
-  int       i, n, pextent, pextra, pextrab;
-  char      *nxtopds, *opdslim;
+  int       i, n, pextent, pextra, pextrab, opnum;
+  char      *nxtopds;
   MYFLT     **argpp, *lclbas;
   CS_VAR_MEM *lcloffbas; // start of pfields
   char*     opMemStart;
@@ -2363,14 +2416,18 @@ static void instance(CSOUND *csound, int insno)
   pextra = n-3;
   pextrab = ((i = tp->pmax - 3L) > 0 ? (int) i * sizeof(CS_VAR_MEM) : 0);
   /* alloc new space,  */
-  pextent = sizeof(INSDS) + pextrab + pextra*sizeof(CS_VAR_MEM);
+  /* INSDS, the p-fields and the perf chain pointer (INSDS_PCHAIN) */
+  pextent = sizeof(INSDS) + pextrab + pextra*sizeof(CS_VAR_MEM) +
+            sizeof(OPDS**);
+  if (UNLIKELY(tp->opdsoffs == NULL))
+    tp->opdstot = instr_opds_layout(csound, tp);
   ip =
     (INSDS*) csound->Calloc(csound,
-                            (size_t) pextent + tp->varPool->poolSize +
-                            (tp->varPool->varCount *
-                             CS_FLOAT_ALIGN(CS_VAR_TYPE_OFFSET)) +
+                            (size_t) pextent + (CS_VAR_VECTOR_ALIGN - 1) +
+                            tp->varPool->poolSize +
                             (tp->varPool->varCount * sizeof(CS_VARIABLE*)) +
-                            tp->opdstot);
+                            tp->opdstot +
+                            (tp->perfcnt + 2) * sizeof(OPDS*));
   ip->csound = csound;
   ip->m_chnbp = (MCHNBLK*) NULL;
   ip->instr = tp;
@@ -2401,12 +2458,17 @@ static void instance(CSOUND *csound, int insno)
 
   /* gbloffbas = csound->globalVarPool; */
   lcloffbas = (CS_VAR_MEM*)&ip->p0;
-  lclbas = (MYFLT*) ((char*) ip + pextent);   /* split local space */
+  /* split local space, with a-rate vectors on cache line boundaries */
+  lclbas = (MYFLT*) (((uintptr_t) ip + pextent + (CS_VAR_VECTOR_ALIGN - 1)) &
+                     ~((uintptr_t) CS_VAR_VECTOR_ALIGN - 1));
+  ip->lclbas = lclbas;
   initializeVarPool((void *)csound, lclbas, tp->varPool);
 
-  opMemStart = nxtopds = (char*) lclbas + tp->varPool->poolSize +
-    (tp->varPool->varCount * CS_FLOAT_ALIGN(CS_VAR_TYPE_OFFSET));
-  opdslim = nxtopds + tp->opdstot;
+  opMemStart = nxtopds = (char*) lclbas + tp->varPool->poolSize;
+  /* the perf chain array follows the opcode data, pointer aligned */
+  pchain = (OPDS**) (((uintptr_t) opMemStart + tp->opdstot +
+                      sizeof(OPDS*) - 1) & ~((uintptr_t) sizeof(OPDS*) - 1));
+  INSDS_PCHAIN(ip) = pchain;
   if (UNLIKELY(odebug))
     csound->Message(csound,
                     Str("instr %d allocated at %p\n\tlclbas %p, opds %p\n"),
@@ -2422,11 +2484,10 @@ static void instance(CSOUND *csound, int insno)
     *typePtr = current->varType;
   }
 
-  while ((optxt = optxt->nxtop) != NULL) {    /* for each op in instr */
+  for (opnum = 0; (optxt = optxt->nxtop) != NULL; opnum++) { /* each op */
     TEXT *ttp = &optxt->t;
     ep = ttp->oentry;
-    opds = (OPDS*) nxtopds;                   /*   take reqd opds */
-    nxtopds += ep->dsblksiz;
+    opds = (OPDS*) (opMemStart + tp->opdsoffs[opnum]); /* take reqd opds */
     if (UNLIKELY(strcmp(ep->opname, "endin") == 0         /*  (until ENDIN)  */
                  || strcmp(ep->opname, "endop") == 0))    /*  (or ENDOP)     */
       break;
@@ -2454,6 +2515,7 @@ static void instance(CSOUND *csound, int insno)
       }
       else {
         prvpds = prvpds->nxtp = opds;
+        *pchain++ = pchain_entry(ep, opds);
         opds->opadr = ep->kopadr;
       }
       goto args;
@@ -2466,6 +2528,7 @@ static void instance(CSOUND *csound, int insno)
     }
     if ((n = ep->thread & 02) != 0) {         /* thread 2     :   */
       prvpds = prvpds->nxtp = opds;           /* link into pchain */
+      *pchain++ = pchain_entry(ep, opds);
       /* if (!(n & 04) || */
       /*     ((ttp->pftype == 'k' || ttp->pftype == 'c') && ep->kopadr != NULL)) */
         opds->opadr = ep->kopadr;             /*      krate or    */
@@ -2510,7 +2573,6 @@ static void instance(CSOUND *csound, int insno)
       argpp[n] = NULL;
 
     arg = ttp->inArgs;
-    ip->lclbas = lclbas;
     for (; arg != NULL; n++, arg = arg->next) {
       CS_VARIABLE* var = (CS_VARIABLE*)(arg->argPtr);
       if (arg->type == ARG_CONSTANT) {
@@ -2558,9 +2620,6 @@ static void instance(CSOUND *csound, int insno)
     var->memBlock->value = csound->ekr;
   }
 
-  if (UNLIKELY(nxtopds > opdslim))
-    csoundDie(csound, Str("inconsistent opds total"));
-
 }
 
 int prealloc_(CSOUND *csound, AOP *p, int instname)
@@ -29,6 +29,7 @@
 #endif
 
 #include "linevent.h"
+#include "cluster.h"
 
 #ifdef PIPES
 # if defined(SGI) || defined(LINUX) || defined(NeXT) || defined(__MACH__)
@@ -502,6 +503,10 @@ int eventOpcode_(CSOUND *csound, LINEVENT *p, int insname, char p1)
       evt.p[1] *= -1;
     }
 
+    /* in a cluster, the node of the instrument performs it */
+    if (UNLIKELY(csound->cluster != NULL) &&
+        csoundClusterForward(csound, p->h.insdshead, &evt, csound->icurTime))
+      return OK;
     if (UNLIKELY(insert_score_event_at_sample(csound, &evt, csound->icurTime) != 0))
       return csound->PerfError(csound, &(p->h),
                                Str("event: error creating '%c' event"),
@@ -590,6 +595,10 @@ int eventOpcodeI_(CSOUND *csound, LINEVENT *p, int insname, char p1)
       FUNC  *dummyftp;
       err = csound->hfgens(csound, &dummyftp, &evt, 0);
     }
+    else if (UNLIKELY(csound->cluster != NULL) &&
+             csoundClusterForward(csound, p->h.insdshead, &evt,
+                                  csound->icurTime))
+      err = 0;      /* the node of the instrument performs it */
     else
       err = insert_score_event_at_sample(csound, &evt, csound->icurTime);
     if (UNLIKELY(err))
@@ -642,6 +651,11 @@ int instanceOpcode_(CSOUND *csound, LINEVENT2 *p, int insname)
       for (i = 2; i <= evt.pcnt; i++)
         evt.p[i] = *p->args[i-1];
     }
+    /* in a cluster, the node of the instrument performs it, and the
+       handle stays 0 */
+    if (UNLIKELY(csound->cluster != NULL) &&
+        csoundClusterForward(csound, p->h.insdshead, &evt, csound->icurTime))
+      return OK;
     if (insert_score_event_at_sample(csound, &evt, csound->icurTime) != 0)
       return csound->PerfError(csound, &(p->h),
                                Str("instance: error creating event"));
@@ -32,6 +32,9 @@
 #include "corfile.h"
 
 #include "csdebug.h"
+#include "csprofile.h"
+#include "bus.h"
+#include "cluster.h"
 
 #define SEGAMPS AMPLMSG
 #define SORMSG  RNGEMSG
@@ -470,6 +473,9 @@ PUBLIC int csoundCleanup(CSOUND *csound)
     csoundLockMutex(csound->API_lock);
     if (csound->QueryGlobalVariable(csound,"::UDPCOM")
         != NULL) csoundUDPServerClose(csound);
+    csoundClusterClose(csound);
+    if (csound->chnShm != NULL)
+      csoundChannelShmEnd(csound);
 
 
 
@@ -537,6 +543,8 @@ PUBLIC int csoundCleanup(CSOUND *csound)
       csound->Message(csound, Str("\n%d errors in performance\n"),
                       csound->perferrcnt);
       print_benchmark_info(csound, Str("end of performance"));
+      if (csound->profiler != NULL)
+        csoundProfilerReport(csound, 20);
     }
     /* close line input (-L) */
     RTclose(csound);
@@ -974,6 +982,8 @@ int sensevents(CSOUND *csound)
   if (UNLIKELY(data && data->status == CSDEBUG_STATUS_STOPPED)) {
     return 0; /* don't process events if we're in debug mode and stopped */
   }
+  if (UNLIKELY(csound->chnShm != NULL))
+    csoundChannelShmBegin(csound);
   if (UNLIKELY(csound->MTrkend && O->termifend)) {   /* end of MIDI file:  */
     deactivate_all_notes(csound);
     csound->Message(csound, Str("terminating.\n"));
@@ -1160,14 +1170,19 @@ int sensevents(CSOUND *csound)
                 goto scode;
               }
             }
-            else if (bp->type == MIDI_EVT) {
-              MEVENT *mep = (MEVENT *)bp->data;
-              MCHNBLK *chn = csound->m_chnbp[mep->chan];
-              process_midi_event(csound, mep, chn);
-            }
-            else if (bp->type == MIDI_MSG) {
-              MEVENT *mep = (MEVENT *)bp->data;
-              if (UNLIKELY(mep->type == 0xFF && mep->dat1 == 0x2F)) {
+            else if (bp->type == MIDI_EVT || bp->type == MIDI_MSG) {
+              REMOT_MEVENT *rmep = (REMOT_MEVENT *)bp->data;
+              MEVENT mev, *mep = &mev;
+              mev.type = rmep->type;
+              mev.chan = rmep->chan;
+              mev.dat1 = rmep->dat1;
+              mev.dat2 = rmep->dat2;
+              mev.offset = 0;
+              if (bp->type == MIDI_EVT) {
+                MCHNBLK *chn = csound->m_chnbp[mep->chan];
+                process_midi_event(csound, mep, chn);
+              }
+              else if (UNLIKELY(mep->type == 0xFF && mep->dat1 == 0x2F)) {
                 csound->MTrkend = 1;                     /* catch a Trkend    */
                 csound->Message(csound, "SERVER%c: ", remoteID(csound));
                 csound->Message(csound, "caught a Trkend\n");
@@ -1501,3 +1516,26 @@ PUBLIC int csoundRegisterSenseEventCallback(CSOUND *csound,
 
   return 0;
 }
+
+/**
+ * Remove a function registered with csoundRegisterSenseEventCallback().
+ * Returns zero on success, or CSOUND_ERROR if it was not registered.
+ */
+PUBLIC int csoundRemoveSenseEventCallback(CSOUND *csound,
+                                          void (*func)(CSOUND *, void *),
+                                          void *userData)
+{
+  EVT_CB_FUNC *fp = (EVT_CB_FUNC*) csound->evtFuncChain, *prv = NULL;
+
+  for ( ; fp != NULL; prv = fp, fp = fp->nxt) {
+    if (fp->func == func && fp->userData == userData) {
+      if (prv == NULL)
+        csound->evtFuncChain = (void*) fp->nxt;
+      else
+        prv->nxt = fp->nxt;
+      csound->Free(csound, fp);
+      return 0;
+    }
+  }
+  return CSOUND_ERROR;
+}
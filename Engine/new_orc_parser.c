@@ -214,6 +214,8 @@ TREE *csoundParseOrc(CSOUND *csound, const char *str)
       TREE* newRoot;
       PARSE_PARM  pp;
       TYPE_TABLE* typeTable = NULL;
+      ORC_CACHE_KEY cacheKey;
+      int useCache;
 
       /* Parse */
       memset(&pp, '\0', sizeof(PARSE_PARM));
@@ -224,21 +226,38 @@ TREE *csoundParseOrc(CSOUND *csound, const char *str)
 
 
       csound_orcset_extra(&pp, pp.yyscanner);
-      csound_orc_scan_buffer(corfile_body(csound->expanded_orc),
-                             corfile_tell(csound->expanded_orc), pp.yyscanner);
-
-      //csound_orcset_lineno(csound->orcLineOffset, pp.yyscanner);
-      //printf("%p\n", astTree);
-      err = csound_orcparse(&pp, pp.yyscanner, csound, &astTree);
-      //printf("%p\n", astTree);
-      //print_tree(csound, "AST - AFTER csound_orcparse()\n", astTree);
-      //csp_orc_sa_cleanup(csound);
-      corfile_rm(csound, &csound->expanded_orc);
-      if (UNLIKELY(csound->oparms->odebug)) csp_orc_sa_print_list(csound);
+      useCache = csound_orc_cache_key(csound,
+                                      corfile_body(csound->expanded_orc),
+                                      corfile_tell(csound->expanded_orc),
+                                      &cacheKey);
+      if (useCache &&
+          (astTree = csound_orc_cache_load(csound, &cacheKey)) != NULL) {
+        /* warm start: the cached tree replaces lexing and parsing */
+        corfile_rm(csound, &csound->expanded_orc);
+        err = csound->synterrcnt ? 3 : 0;
+        useCache = 0;
+      }
+      else {
+        csound_orc_scan_buffer(corfile_body(csound->expanded_orc),
+                               corfile_tell(csound->expanded_orc),
+                               pp.yyscanner);
+
+        //csound_orcset_lineno(csound->orcLineOffset, pp.yyscanner);
+        //printf("%p\n", astTree);
+        err = csound_orcparse(&pp, pp.yyscanner, csound, &astTree);
+        //printf("%p\n", astTree);
+        //print_tree(csound, "AST - AFTER csound_orcparse()\n", astTree);
+        //csp_orc_sa_cleanup(csound);
+        corfile_rm(csound, &csound->expanded_orc);
+        if (UNLIKELY(csound->oparms->odebug)) csp_orc_sa_print_list(csound);
+      }
       if (UNLIKELY(csound->synterrcnt)) err = 3;
       if (LIKELY(err == 0)) {
         if (csound->oparms->odebug) csound->Message(csound,
                                                     Str("Parsing successful!\n"));
+        /* store before verify_tree(), which rewrites the tree in place */
+        if (useCache && astTree != NULL)
+          csound_orc_cache_store(csound, &cacheKey, astTree);
       }
       else {
         if (err == 1){
@@ -603,6 +603,8 @@ int add_udo_definition(CSOUND *csound, char *opname,
     //printf("****Calling parse_opcode_args\n");
     if (UNLIKELY(parse_opcode_args(csound, newopc) != 0))
       return -3;
+    /* the types are only known now */
+    opcode_signatures_reset(csound, opname);
 
     return 0;
 }
@@ -64,9 +64,19 @@ typedef struct channelEntry_s {
     spin_lock_t lock;               /* Multi-thread protection */
     int32_t     type;
     int32_t     datasize;  /* size of allocated chn data */
+    int32_t     step;      /* frame offset of the last timed control write, */
+    uint64_t    stepk;     /* the control period it was applied in */
+    MYFLT       prev;      /* and the value before it */
+    int32_t     written;   /* CHN_WRITE_ flags, cleared by the cluster */
     char        name[1];
 } CHNENTRY;
 
+/* how the opcodes wrote a channel in the control period: the cluster
+   (Top/cluster.c) overwrites channels that were set and sums those that
+   were mixed into */
+#define CHN_WRITE_SET   (1)
+#define CHN_WRITE_MIX   (2)
+
 typedef struct {
     OPDS        h;
     MYFLT       *arg;
@@ -75,6 +85,7 @@ typedef struct {
     spin_lock_t *lock;
     int32_t     pos;
     char        chname[MAX_CHAN_NAME+1];
+    CHNENTRY    *chn;       /* control channel read at a-rate, or written */
 } CHNGET;
 
 typedef struct {
@@ -95,6 +106,7 @@ typedef struct {
     STRINGDAT   *iname[MAX_CHAN_NAME+1];
     MYFLT   *fp[MAX_CHAN_NAME+1];
     spin_lock_t *lock[MAX_CHAN_NAME+1];
+    CHNENTRY *chn[MAX_CHAN_NAME+1];
 } CHNCLEAR;
 
 typedef struct {
@@ -217,6 +229,10 @@ int32_t outvalset_string_S(CSOUND *csound, OUTVAL *p);
 int32_t outvalset_S(CSOUND *csound, OUTVAL *p);
 int32_t outvalsetgo(CSOUND *csound, OUTVAL *p);
 int32_t outvalsetSgo(CSOUND *csound, OUTVAL *p);
+
+/* shared memory bus: lock the channels for a control period, release them */
+void csoundChannelShmBegin(CSOUND *csound);
+void csoundChannelShmEnd(CSOUND *csound);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,37 @@
+/*
+    cluster.h:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+#ifndef CSOUND_CLUSTER_H
+#define CSOUND_CLUSTER_H
+
+/* distributed rendering over several processes (Top/cluster.c) */
+
+int  csoundClusterStart(CSOUND *csound);
+void csoundClusterClose(CSOUND *csound);
+void csoundClusterSync(CSOUND *csound);
+int  csoundClusterOwns(CSOUND *csound, int insno);
+int  csoundClusterForward(CSOUND *csound, INSDS *from, EVTBLK *evt,
+                          int64_t time_ofs);
+void csoundClusterInputMessage(CSOUND *csound, const char *message);
+
+#endif
@@ -64,4 +64,7 @@ typedef struct RtJackGlobals_ {
     int     xrunFlag;                   /* non-zero if an xrun has occured  */
     jack_client_t   *listclient;
     int outDevNum, inDevNum;            /* select devs by number */
+    int     callback;                   /* -+jack_callback: run Csound in   */
+                                        /* the process callback if possible */
+    volatile int cbActive;              /* non-zero if it does              */
 } RtJackGlobals;
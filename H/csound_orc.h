@@ -46,6 +46,15 @@ typedef struct type_table {
     CONS_CELL* labelList;
 } TYPE_TABLE;
 
+/* key of a parsed orchestra in the persistent cache (csound_orc_cache.c) */
+typedef struct orc_cache_key {
+    uint64_t text;       /* hash of the preprocessed orchestra */
+    uint64_t check;      /* second hash, verified against the file header */
+    uint64_t symbols;    /* fingerprint of the parser symbol table */
+    uint64_t len;        /* length of the preprocessed orchestra */
+    char     path[1024];
+} ORC_CACHE_KEY;
+
 
 #ifndef PARSER_DEBUG
 
@@ -57,6 +66,9 @@ TREE* make_leaf(CSOUND *, int, int, int, ORCTOKEN*);
 ORCTOKEN* make_int(CSOUND *,char *);
 ORCTOKEN* make_num(CSOUND *,char *);
 ORCTOKEN *make_token(CSOUND *csound, char *s);
+int csound_orc_cache_key(CSOUND *, const char *, size_t, ORC_CACHE_KEY *);
+TREE *csound_orc_cache_load(CSOUND *, ORC_CACHE_KEY *);
+void csound_orc_cache_store(CSOUND *, ORC_CACHE_KEY *, TREE *);
 /*void instr0(CSOUND *, ORCTOKEN*, TREE*, TREE*);*/
 /* extern TREE* statement_list; */
 /* double get_num(TREE*); */
@@ -0,0 +1,90 @@
+/*
+    delayline.h:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+#ifndef CSOUND_DELAYLINE_H
+#define CSOUND_DELAYLINE_H
+
+/* delay line engine of the vdelay family and multitap (OOps/delayline.c)
+
+   A delay line of len samples behaves like the ring of len samples the
+   opcodes used to keep: left is the index in that ring of the next
+   input, and the read positions are computed from it with the index
+   arithmetic of the original opcodes, so that the output is bit for bit
+   the same.  A position v is then found as the sample written
+   (left - v) mod len inputs ago.
+
+   The samples are stored in a ring of a power of two size, at least len
+   plus a control period, so that a whole block of input can be written
+   before it is read, and positions are masked rather than compared.  The
+   first guard samples are copied after the end of the ring, so that the
+   window of an interpolator never has to wrap.  A block is processed by
+   writing its n input samples, then reading n outputs, output i being
+   relative to input i.  Delays are given per sample (step 1) or once for
+   the block (step 0), and converted to samples by multiplying by scale.
+
+   Only the constant delays of multitap and of a k-rate vdelay3 read
+   contiguous runs of the ring; the other reads compute their positions
+   per sample, as before.  The windowed sinc weights of vdelayx are
+   computed once per sample for all its channels.
+
+   The recirculating delays of reverbx, comb, alpass, reverbsc and
+   freeverb do not use this engine: a feedback loop can be shorter than
+   a control period, so its block cannot be written before it is read. */
+
+typedef struct {
+    MYFLT   *buf;
+    uint32  mask;       /* size of the ring - 1 */
+    uint32  guard;      /* samples copied after the end of the ring */
+    uint32  len;        /* logical length, delays wrap modulo len */
+    uint32  wp;         /* next sample written, not masked */
+    int32   left;       /* index of the next sample in a ring of len */
+    AUXCH   aux;
+} DELAYLINE;
+
+/* width is the widest interpolation window that will be read, keep
+   reuses the samples of an initialised line (the istor arguments) */
+void delayline_init(CSOUND *, DELAYLINE *, uint32 len, uint32 width,
+                    int keep);
+void delayline_write(DELAYLINE *, const MYFLT *in, uint32 n);
+
+/* linear interpolation of vdelay */
+void delayline_read_linear(DELAYLINE *, MYFLT *out, const MYFLT *del,
+                           uint32 step, MYFLT scale, uint32 n);
+/* cubic interpolation of vdelay3, linear for lines shorter than four */
+void delayline_read_cubic(DELAYLINE *, MYFLT *out, const MYFLT *del,
+                          uint32 step, MYFLT scale, uint32 n);
+/* windowed sinc of wsize points, reads nlines lines of the same length
+   with the same delays, out is an array of nlines outputs */
+void delayline_read_sinc(DELAYLINE *, int nlines, MYFLT **out,
+                         const MYFLT *del, uint32 step, MYFLT scale,
+                         int wsize, uint32 n);
+/* the vdelayxw family: each input is added, through a windowed sinc,
+   to the output del samples later, so nothing is read back here */
+void delayline_write_sinc(DELAYLINE *, int nlines, MYFLT **out,
+                          MYFLT **in, const MYFLT *del, uint32 step,
+                          MYFLT scale, int wsize, uint32 n);
+/* sum of ntaps taps of constant delays in samples, no interpolation */
+void delayline_read_taps(DELAYLINE *, MYFLT *out, const int32 *del,
+                         const MYFLT *gain, int ntaps, uint32 n);
+
+#endif
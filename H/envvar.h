@@ -241,6 +241,27 @@ extern "C" {
 
   int csoundFSeekAsync(CSOUND *csound, void *handle, int pos, int whence);
 
+  /**
+   * Makes 'handle', a CSFILE_STD file opened for writing with
+   * csoundFileOpenWithType_Async(), take frames of 'columns' values and
+   * write them from the file thread in 'format':
+   *
+   *   ASYNC_FMT_TEXT     one line of "%g " values per frame
+   *   ASYNC_FMT_COLUMNS  a header of the characters "CSCF", then the
+   *                      version (1), the number of columns and the
+   *                      bytes per value (4) as uint32, and the sample
+   *                      rate as a double; then blocks of a uint32
+   *                      frame count followed by each column in turn
+   *                      as floats.  Native byte order.
+   *
+   * Must be called before the first write.  A file that already has a
+   * format, being written by another opcode, keeps it: the call then
+   * succeeds only if format and columns are the same.  Returns zero on
+   * success.
+   */
+  int csoundSetAsyncFormat(CSOUND *csound, void *handle,
+                           int format, int columns);
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,85 @@
+/*
+    filtcoefs.h:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+#ifndef CSOUND_FILTCOEFS_H
+#define CSOUND_FILTCOEFS_H
+
+#include "fastmath.h"
+
+/* Filter coefficients for a-rate parameters.
+
+   A filter with an a-rate frequency needs the tangent or cosine of the
+   frequency at every sample at which it changes, which with libm costs
+   more than the filter itself.  The filters instead compute the
+   coefficients of up to FILT_CHUNK samples at a time, in loops with no
+   dependency between samples, before running the recursion over them.
+   filt_tan and fm_cos (H/fastmath.h) have no calls or data dependent
+   branches, so these loops vectorise.
+
+   filt_tan uses the argument reduction of fm_cos and the rational
+   approximation of the Cephes library.  Measured against libm over the
+   arguments of audio frequencies, PI*f/sr for f between 0 and the
+   Nyquist frequency, it is within 2 ulps of tan, and stays accurate for
+   arguments of a few thousand; fm_cos is within 1 ulp over 2*PI*f/sr
+   (tests/c/filtcoefs_test.c).
+
+   The butterworth filters (Opcodes/afilters.c) and fofilter compute
+   their a-rate coefficients in chunks; statevar and the a-rate
+   moogladder and moogladder2 use the fastmath kernels for the
+   coefficients they recompute when a parameter changes.  The tanh of
+   the moogladder stages is part of the signal path, not a coefficient,
+   and still calls libm. */
+
+#define FILT_CHUNK 64
+
+/* whether the n values of an a-rate parameter all equal the one the
+   current coefficients were computed for */
+static inline int filt_unchanged(const MYFLT *x, uint32_t n, MYFLT last)
+{
+    uint32_t i;
+    for (i = 0; i < n; i++)
+      if (x[i] != last) return 0;
+    return 1;
+}
+
+static inline double filt_tan(double x)
+{
+    /* |x| = j*PI/4 + z, j even and |z| <= PI/4, and tan(x) is
+       -1/tan(z) when j/2 is odd */
+    double a = fabs(x), y, z, zz, p, q, t;
+    int    j = (int) (a * 1.27323954473516268615);
+
+    j += (j & 1);
+    y = (double) j;
+    z = ((a - y * FM_DP1) - y * FM_DP2) - y * FM_DP3;
+    zz = z * z;
+    p = (-1.30936939181383777646E4 * zz + 1.15351664838587416140E6) * zz
+        - 1.79565251976484877988E7;
+    q = (((zz + 1.36812963470692954678E4) * zz - 1.32089234440210967447E6)
+         * zz + 2.50083801823357915839E7) * zz - 5.38695755929454629881E7;
+    t = z + z * (zz * p / q);
+    t = fm_select(j & 2, -1.0 / t, t);
+    return fm_select(x < 0.0, -t, t);
+}
+
+#endif
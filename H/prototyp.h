@@ -86,6 +86,7 @@ void    remove_tmpfiles(CSOUND *);
 void    add_tmpfile(CSOUND *, char *);
 void    xturnoff(CSOUND *, INSDS *);
 void    xturnoff_now(CSOUND *, INSDS *);
+int     perf_chain(CSOUND *, INSDS *, int);
 int     insert_score_event(CSOUND *, EVTBLK *, double);
 //MEMFIL  *ldmemfile(CSOUND *, const char *);
 //MEMFIL  *ldmemfile2(CSOUND *, const char *, int);
@@ -72,6 +72,10 @@ char remoteID(CSOUND *csound);
 #define MAXSEND (sizeof(EVTBLK) + 2*sizeof(int))
 #define GLOBAL_REMOT -99
 
+typedef struct {                        /* a MIDI event as sent, the MEVENT     */
+    int16       type, chan, dat1, dat2; /* without its local sample offset     */
+} REMOT_MEVENT;
+
 typedef struct {                        /* Remote Communication buffer          */
     int         len;                    /* lentot = len + type + data used      */
     int         type;
@@ -25,47 +25,40 @@
 /*      Berklee College of Music Csound development team                */
 /*      Copyright (c) December 1994.  All rights reserved               */
 
+#include "delayline.h"
+
 typedef struct {
         OPDS    h;
         MYFLT   *sr, *ain, *adel, *imaxd, *istod;
-        uint32 maxd;
-        AUXCH   aux;
-        int32   left;
+        DELAYLINE dl;
 } VDEL;
 
 typedef struct {
         OPDS    h;
         MYFLT   *sr1, *sr2, *sr3, *sr4;
         MYFLT   *ain1, *ain2, *ain3, *ain4, *adel, *imaxd, *iquality, *istod;
-        AUXCH   aux1, aux2, aux3, aux4;
-        uint32 maxd;
+        DELAYLINE dl[4];
         int     interp_size;
-        int32   left;
 } VDELXQ;
 
 typedef struct {
         OPDS    h;
         MYFLT   *sr1, *sr2, *ain1, *ain2, *adel, *imaxd, *iquality, *istod;
-        AUXCH   aux1, aux2;
-        uint32 maxd;
+        DELAYLINE dl[2];
         int     interp_size;
-        int32   left;
 } VDELXS;
 
 typedef struct {
         OPDS    h;
         MYFLT   *sr1, *ain1, *adel, *imaxd, *iquality, *istod;
-        AUXCH   aux1;
-        uint32 maxd;
+        DELAYLINE dl;
         int     interp_size;
-        int32   left;
 } VDELX;
 
 typedef struct {
         OPDS    h;
         MYFLT   *sr, *ain, *ndel[VARGMAX-1];
-        AUXCH   aux;
-        int32   left, max;
+        DELAYLINE dl;
 } MDEL;
 
 #if 0
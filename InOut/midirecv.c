@@ -43,6 +43,22 @@
       as a note on status without the data bytes) should not be
       returned.
 
+    int (*MidiReadTimedCallback)(CSOUND *csound, void *userData,
+                                 unsigned char *buf, int *offsets,
+                                 int nbytes);
+
+      Optional, used instead of MidiReadCallback if set. Reads MIDI
+      data as above, and for each byte buf[i] also stores in offsets[i]
+      the sample offset in the current control period (0 to ksmps - 1)
+      at which its message was received. Drivers that get timestamped
+      events (JACK MIDI, the ALSA sequencer) should queue them with
+      the timestamps, map these onto the sample clock of the
+      performance (GetCurrentTimeSamples() is the first sample of the
+      control period being read for), and return each message in the
+      control period its sample falls in, so that their spacing is kept.
+      With --sample-accurate, note on messages start the instrument at
+      the offset (ksmps_offset), as score events do.
+
     int (*MidiInCloseCallback)(CSOUND *csound, void *userData);
 
       Close MIDI input device associated with 'userData'.
@@ -84,6 +100,10 @@
     void csoundSetExternalMidiReadCallback(CSOUND *csound,
                     int (*func)(CSOUND *, void *, unsigned char *, int));
 
+    void csoundSetExternalMidiReadTimedCallback(CSOUND *csound,
+                    int (*func)(CSOUND *, void *, unsigned char *,
+                                int *, int));
+
     void csoundSetExternalMidiInCloseCallback(CSOUND *csound,
                     int (*func)(CSOUND *, void *));
 
@@ -130,7 +150,7 @@ void MidiOpen(CSOUND *csound)
     if (O->Midiin) {
       if (p->MidiInOpenCallback == NULL)
         csound->Die(csound, Str(" *** no callback for opening MIDI input"));
-      if (p->MidiReadCallback == NULL)
+      if (p->MidiReadCallback == NULL && p->MidiReadTimedCallback == NULL)
         csound->Die(csound, Str(" *** no callback for reading MIDI data"));
       err = p->MidiInOpenCallback(csound, &(p->midiInUserData), O->Midiname);
       if (err != 0) {
@@ -437,6 +457,7 @@ int m_chinsno(CSOUND *csound, int chan, int insno, int reset_ctls)
         mev.chan = (int16) chan;
         mev.dat1 = chn->pgmno;
         mev.dat2 = 0;
+        mev.offset = 0;
         m_chanmsg(csound, &mev);
       }
     }
@@ -487,7 +508,15 @@ int sensMidi(CSOUND *csound)
       p->bufp = &(p->mbuf[0]);
       p->endatp = p->bufp;
       if (O->Midiin && !csound->advanceCnt) {   /* read MIDI device */
-        n = p->MidiReadCallback(csound, p->midiInUserData, p->bufp, MBUFSIZ);
+        if (p->MidiReadTimedCallback != NULL)
+          n = p->MidiReadTimedCallback(csound, p->midiInUserData, p->bufp,
+                                       &(p->mofs[0]), MBUFSIZ);
+        else {
+          n = p->MidiReadCallback(csound, p->midiInUserData, p->bufp,
+                                  MBUFSIZ);
+          if (n > 0)
+            memset(&(p->mofs[0]), 0, n * sizeof(int));
+        }
         if (n < 0)
           csoundErrorMsg(csound, Str(" *** error reading MIDI device: %d (%s)"),
                                  n, csoundExternalMidiErrorString(csound, n));
@@ -497,8 +526,10 @@ int sensMidi(CSOUND *csound)
       if (O->FMidiin) {                         /* read MIDI file */
         n = csoundMIDIFileRead(csound, p->endatp,
                                MBUFSIZ - (int) (p->endatp - p->bufp));
-        if (n > 0)
+        if (n > 0) {
+          memset(&(p->mofs[p->endatp - p->bufp]), 0, n * sizeof(int));
           p->endatp += (int) n;
+        }
       }
       if (p->endatp <= p->bufp)
         return 0;               /* no events were received */
@@ -582,6 +613,9 @@ int sensMidi(CSOUND *csound)
     else mep->dat2 = c;
     if (++p->datcnt < p->datreq)        /* if msg incomplete    */
       goto nxtchr;                      /*   get next char      */
+    mep->offset = p->mofs[p->bufp - 1 - p->mbuf];
+    if (UNLIKELY(mep->offset < 0 || mep->offset >= (int32) csound->ksmps))
+      mep->offset = 0;
     /* Enter the input event into a buffer used by 'midiin'. */
     /* VL -- changed to allow higher-mapped channels */
     if (mep->type != SYSTEM_TYPE) {
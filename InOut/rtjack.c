@@ -177,6 +177,7 @@ static inline void rtJack_DestroyLock(CSOUND *csound, void **p)
 static CS_NORETURN void rtJack_Error(CSOUND *, int errCode, const char *msg);
 
 static int processCallback(jack_nframes_t nframes, void *arg);
+static int processCallbackDriven(jack_nframes_t nframes, void *arg);
 
 /* callback functions */
 
@@ -234,6 +235,12 @@ static void shutDownCallback(void *arg)
     RtJackGlobals *p = (RtJackGlobals*) arg;
 
     p->jackState = 2;
+    /* no reconnection in callback mode: end the performance, and stop
+       rtrecord_ and rtplay_ from using the port buffers */
+    if (p->cbActive) {
+      p->cbActive = 0;
+      p->csound->SetAudioDriven(p->csound, 0);
+    }
     if (p->bufs != NULL) {
       int   i;
       for (i = 0; i < p->nBuffers; i++) {
@@ -412,8 +419,23 @@ static void openJackStreams(RtJackGlobals *p)
     /* register ports */
     rtJack_RegisterPorts(p);
 
+    /* in callback mode Csound runs in the process callback for whole */
+    /* periods, which needs -b to be the JACK period */
+    p->cbActive = 0;
+    if (p->callback) {
+      int period = (int) jack_get_buffer_size(p->client);
+      if (UNLIKELY(!p->outputEnabled || p->bufSize != period ||
+                   period % csound->GetKsmps(csound) != 0))
+        csound->Warning(csound,
+                        Str("rtjack: callback mode needs output and -b equal "
+                            "to the JACK period (%d), a multiple of ksmps; "
+                            "using buffered mode\n"), period);
+      else if (csound->SetAudioDriven(csound, 1) == CSOUND_SUCCESS)
+        p->cbActive = 1;
+    }
+
     /* allocate ring buffers if not done yet */
-    if (p->bufs == NULL)
+    if (p->bufs == NULL && !p->cbActive)
       rtJack_AllocateBuffers(p);
 
     /* initialise ring buffers */
@@ -421,7 +443,7 @@ static void openJackStreams(RtJackGlobals *p)
     p->csndBufPos = 0;
     p->jackBufCnt = 0;
     p->jackBufPos = 0;
-    for (i = 0; i < p->nBuffers; i++) {
+    for (i = 0; i < p->nBuffers && !p->cbActive; i++) {
       rtJack_TryLock(p->csound, &(p->bufs[i]->csndLock));
       rtJack_Unlock(p->csound, &(p->bufs[i]->jackLock));
       if (p->inputEnabled) {
@@ -461,7 +483,8 @@ static void openJackStreams(RtJackGlobals *p)
       rtJack_Error(csound, -1, Str("error setting xrun callback"));
     jack_on_shutdown(p->client, shutDownCallback, (void*) p);
     if (UNLIKELY(jack_set_process_callback(p->client,
-                                           processCallback, (void*) p) != 0))
+                                           p->cbActive ? processCallbackDriven
+                                           : processCallback, (void*) p) != 0))
       rtJack_Error(csound, -1, Str("error setting process callback"));
 
     /* activate client */
@@ -768,6 +791,40 @@ static int processCallback(jack_nframes_t nframes, void *arg)
     return 0;
 }
 
+/* the process callback in callback mode: Csound performs the whole */
+/* period here, and rtrecord_ and rtplay_ access the port buffers    */
+/* directly */
+
+static int processCallbackDriven(jack_nframes_t nframes, void *arg)
+{
+    RtJackGlobals *p = (RtJackGlobals*) arg;
+    CSOUND        *csound = p->csound;
+    int           i;
+
+    if (p->inputEnabled) {
+      for (i = 0; i < p->nChannels_i; i++)
+        p->inPortBufs[i] = (jack_default_audio_sample_t*)
+          jack_port_get_buffer(p->inPorts[i], nframes);
+    }
+    for (i = 0; i < p->nChannels; i++)
+      p->outPortBufs[i] = (jack_default_audio_sample_t*)
+        jack_port_get_buffer(p->outPorts[i], nframes);
+    p->jackBufPos = 0;          /* input frames read in this period   */
+    p->csndBufPos = 0;          /* output frames written              */
+    if (LIKELY((int) nframes == p->bufSize))
+      csound->PerformAudioDriven(csound, (int) nframes);
+    else
+      p->xrunFlag = 1;          /* period size changed, cannot perform */
+    /* silence if not running, or the performance ended in this period */
+    if (p->csndBufPos < (int) nframes) {
+      for (i = 0; i < p->nChannels; i++)
+        memset(&(p->outPortBufs[i][p->csndBufPos]), 0,
+               sizeof(jack_default_audio_sample_t)
+               * (nframes - p->csndBufPos));
+    }
+    return 0;
+}
+
 static CS_NOINLINE CS_NORETURN void rtJack_Abort(CSOUND *csound, int err)
 {
     switch (err) {
@@ -799,6 +856,23 @@ static int rtrecord_(CSOUND *csound, MYFLT *inbuf_, int bytes_)
 
     p = (RtJackGlobals*) *(csound->GetRtPlayUserData(csound));
     if (UNLIKELY(p==NULL)) rtJack_Abort(csound, 0);
+    if (p->cbActive) {
+      /* called from processCallbackDriven: read the port buffers */
+      nframes = bytes_ / (p->nChannels_i * (int) sizeof(MYFLT));
+      bufpos = p->jackBufPos;
+      for (i = j = 0; i < nframes; i++, bufpos++) {
+        for (k = 0; k < p->nChannels_i; k++)
+          inbuf_[j++] = (bufpos < p->bufSize ?
+                         (MYFLT) p->inPortBufs[k][bufpos] : FL(0.0));
+      }
+      p->jackBufPos = bufpos;
+      return bytes_;
+    }
+    if (UNLIKELY(p->bufs == NULL)) {
+      /* callback mode, after the JACK server has shut down */
+      memset(inbuf_, 0, bytes_);
+      return bytes_;
+    }
     if (p->jackState != 0) {
       if (p->jackState < 0)
         openJackStreams(p);     /* open audio input */
@@ -864,6 +938,25 @@ static void rtplay_(CSOUND *csound, const MYFLT *outbuf_, int bytes_)
     p = (RtJackGlobals*) *(csound->GetRtPlayUserData(csound));
     if (p == NULL)
       return;
+    if (p->cbActive) {
+      /* called from processCallbackDriven: write the port buffers */
+      nframes = bytes_ / (p->nChannels * (int) sizeof(MYFLT));
+      if (nframes > p->bufSize - p->csndBufPos)
+        nframes = p->bufSize - p->csndBufPos;
+      for (k = 0; k < p->nChannels; k++) {
+        jack_default_audio_sample_t *dst = &(p->outPortBufs[k][p->csndBufPos]);
+        for (i = 0, j = k; i < nframes; i++, j += p->nChannels)
+          dst[i] = (jack_default_audio_sample_t) outbuf_[j];
+      }
+      p->csndBufPos += nframes;
+      if (UNLIKELY(p->xrunFlag)) {
+        p->xrunFlag = 0;
+        csound->Warning(csound, "%s", Str("rtjack: xrun in real time audio"));
+      }
+      return;
+    }
+    if (UNLIKELY(p->bufs == NULL))
+      return;       /* callback mode, after the JACK server has shut down */
     if (p->jackState != 0) {
       if (p->jackState == 2)
         rtJack_Restart(p);
@@ -944,6 +1037,8 @@ static CS_NOINLINE void rtclose_(CSOUND *csound)
       //                ((int) ((double) (p.bufSize * p.nBuffers)
       //                        * 1000.0 / (double) p.sampleRate + 0.999)));
       jack_deactivate(p.client);
+      if (p.cbActive)
+        csound->SetAudioDriven(csound, 0);
       //}
       csound->Sleep((size_t) 50);
       /* unregister and free all ports */
@@ -1115,6 +1210,13 @@ PUBLIC int csoundModuleCreate(CSOUND *csound)
                                         (void*) &(p->sleepTime),
                                         CSOUNDCFG_INTEGER, 0, &i, &j,
                                         Str("Deprecated"), NULL);
+    /* callback mode */
+    csound->CreateConfigurationVariable(csound, "jack_callback",
+                                        (void*) &(p->callback),
+                                        CSOUNDCFG_BOOLEAN, 0, NULL, NULL,
+                                        Str("Run Csound in the JACK process "
+                                            "callback when -b is the JACK "
+                                            "period (default: 0)"), NULL);
     /* done */
     p->listclient = NULL;
 
@@ -1168,25 +1270,49 @@ PUBLIC int csoundModuleCreate(CSOUND *csound)
 }
 
 #define JACK_MIDI_BUFFSIZE 1024
+
+/* an input message with its JACK frame time; longer messages (sysex)
+   are not queued, as Csound skips them */
+typedef struct jackMidiEvent_ {
+  jack_nframes_t time;
+  int size;
+  unsigned char data[4];
+} jackMidiEvent;
+
 typedef struct jackMidiDevice_ {
   jack_client_t *client;
   jack_port_t *port;
   CSOUND *csound;
   void *cb;
+  volatile jack_nframes_t cycle;    /* first frame of the last JACK cycle */
+  volatile jack_nframes_t period;   /* and its length */
+  jackMidiEvent pending;            /* read, but for a later period */
+  int havePending;
+  int synced;                       /* frame0 is played at sample0 */
+  jack_nframes_t frame0;
+  int64_t sample0;
 } jackMidiDevice;
 
 int MidiInProcessCallback(jack_nframes_t nframes, void *userData){
 
     jack_midi_event_t event;
+    jackMidiEvent msg;
     jackMidiDevice *dev = (jackMidiDevice *) userData;
     CSOUND *csound = dev->csound;
+    jack_nframes_t start = jack_last_frame_time(dev->client);
     int n = 0;
+    dev->cycle = start;
+    dev->period = nframes;
     while(jack_midi_event_get(&event,
                               jack_port_get_buffer(dev->port,nframes),
                               n++) == 0) {
+      if (event.size > sizeof(msg.data))
+        continue;
+      msg.time = start + event.time;
+      msg.size = (int) event.size;
+      memcpy(msg.data, event.buffer, event.size);
       if (UNLIKELY(csound->WriteCircularBuffer(csound,dev->cb,
-                                              event.buffer,event.size)
-                  != (int) event.size)){
+                                              &msg,1) != 1)){
         csound->Warning(csound, "%s", Str("Jack MIDI module: buffer overflow"));
         return 1;
       }
@@ -1236,7 +1362,7 @@ static int midi_in_open(CSOUND *csound,
     dev->csound = csound;
     dev->cb = csound->CreateCircularBuffer(csound,
                                            JACK_MIDI_BUFFSIZE,
-                                           sizeof(char));
+                                           sizeof(jackMidiEvent));
 
     if (UNLIKELY(jack_set_process_callback(jack_client,
                                           MidiInProcessCallback,
@@ -1272,11 +1398,51 @@ static int midi_in_open(CSOUND *csound,
     return OK;
 }
 
-static int midi_in_read(CSOUND *csound,
-                        void *userData, unsigned char *buf, int nbytes)
+/* Messages are placed on the sample clock of the performance: frame f
+   is rendered at sample sample0 + (f - frame0), a JACK period after the
+   cycle it was received in, so that the messages of a cycle keep their
+   spacing.  A message is returned in the control period holding its
+   sample, at its offset there, and one for a later period stays queued.
+   The clocks are matched at the first message, and again when one comes
+   out more than a JACK period late or early (after an xrun, or when
+   Csound was paused). */
+static int midi_in_read(CSOUND *csound, void *userData,
+                        unsigned char *buf, int *offsets, int nbytes)
 {
     jackMidiDevice *dev = (jackMidiDevice *) userData;
-    return csound->ReadCircularBuffer(csound,dev->cb,buf,nbytes);
+    jackMidiEvent *msg = &dev->pending;
+    int64_t cur = csound->GetCurrentTimeSamples(csound), s;
+    int ksmps = (int) csound->GetKsmps(csound), n = 0, i, ofs;
+    int period;
+
+    while (n + (int) sizeof(msg->data) <= nbytes) {
+      if (!dev->havePending) {
+        if (csound->ReadCircularBuffer(csound, dev->cb, msg, 1) != 1)
+          break;
+        dev->havePending = 1;
+      }
+      period = (int) dev->period;
+      if (!dev->synced) {
+        dev->frame0 = dev->cycle;
+        dev->sample0 = cur + period;
+        dev->synced = 1;
+      }
+      s = dev->sample0 + (int32_t) (msg->time - dev->frame0);
+      if (s < cur - period || s >= cur + ksmps + 2 * period) {
+        dev->frame0 = msg->time;                /* the clocks moved apart */
+        dev->sample0 = cur;
+        s = cur;
+      }
+      if (s >= cur + ksmps)                     /* for a later period */
+        break;
+      ofs = (s > cur ? (int) (s - cur) : 0);
+      for (i = 0; i < msg->size; i++) {
+        buf[n] = msg->data[i];
+        offsets[n++] = ofs;
+      }
+      dev->havePending = 0;
+    }
+    return n;
 }
 
 static int midi_in_close(CSOUND *csound, void *userData){
@@ -1528,7 +1694,7 @@ PUBLIC int csoundModuleInit(CSOUND *csound)
     csound->Message(csound, "%s", Str("rtmidi: JACK module enabled\n"));
     {
       csound->SetExternalMidiInOpenCallback(csound, midi_in_open);
-      csound->SetExternalMidiReadCallback(csound, midi_in_read);
+      csound->SetExternalMidiReadTimedCallback(csound, midi_in_read);
       csound->SetExternalMidiInCloseCallback(csound, midi_in_close);
       csound->SetExternalMidiOutOpenCallback(csound, midi_out_open);
       csound->SetExternalMidiWriteCallback(csound, midi_out_write);
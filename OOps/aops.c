@@ -22,6 +22,7 @@
 
 #include "csoundCore.h" /*                                      AOPS.C  */
 #include "aops.h"
+#include "fastmath.h"
 #include <math.h>
 #include <time.h>
 
@@ -857,12 +858,37 @@ int32_t atan21(CSOUND *csound, AOP *p)
       r[n] = LIBNAME(a[n]);                                             \
     return OK;                                                          \
   }
+
+/* as LIBA, with -+fast_math computing the blocks that pass DOMAIN with
+   FMNAME of H/fastmath.h */
+#define LIBAF(OPNAME,LIBNAME,FMNAME,DOMAIN)                             \
+  int32_t OPNAME(CSOUND *csound, EVAL *p) {                             \
+    uint32_t offset = p->h.insdshead->ksmps_offset;                     \
+    uint32_t early  = p->h.insdshead->ksmps_no_end;                     \
+    uint32_t n, nsmps =CS_KSMPS;                                        \
+    MYFLT   *r, *a;                                                     \
+    r = p->r;                                                           \
+    a = p->a;                                                           \
+    if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));        \
+    if (UNLIKELY(early)) {                                              \
+      nsmps -= early;                                                   \
+      memset(&r[nsmps], '\0', early*sizeof(MYFLT));                     \
+    }                                                                   \
+    if (csound->fastMath && DOMAIN(&a[offset], nsmps - offset))         \
+      for (n = offset; n < nsmps; n++)                                  \
+        r[n] = (MYFLT) FMNAME((double) a[n]);                           \
+    else                                                                \
+      for (n = offset; n < nsmps; n++)                                  \
+        r[n] = LIBNAME(a[n]);                                           \
+    return OK;                                                          \
+  }
+#define FM_ANY(x, n) 1
 LIBA(absa,FABS)
-LIBA(expa,EXP)
-LIBA(loga,LOG)
+LIBAF(expa,EXP,fm_exp,FM_ANY)
+LIBAF(loga,LOG,fm_log,FM_ANY)
 LIBA(sqrta,SQRT)
-LIBA(sina,SIN)
-LIBA(cosa,COS)
+LIBAF(sina,SIN,fm_sin,fm_trig_domain)
+LIBAF(cosa,COS,fm_cos,fm_trig_domain)
 LIBA(tana,TAN)
 LIBA(asina,ASIN)
 LIBA(acosa,ACOS)
@@ -870,8 +896,8 @@ LIBA(atana,ATAN)
 LIBA(sinha,SINH)
 LIBA(cosha,COSH)
 LIBA(tanha,TANH)
-LIBA(log10a,LOG10)
-LIBA(log2a,LOG2)
+LIBAF(log10a,LOG10,fm_log10,FM_ANY)
+LIBAF(log2a,LOG2,fm_log2,FM_ANY)
 
 int32_t atan2aa(CSOUND *csound, AOP *p)
 {
@@ -913,15 +939,18 @@ int32_t aampdb(CSOUND *csound, EVAL *p)
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     uint32_t n, nsmps =CS_KSMPS;
     MYFLT   *r = p->r, *a = p->a;
-    IGN(csound);
 
     if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
       memset(&r[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n = offset; n < nsmps; n++)
-      r[n] = EXP(a[n] * LOG10D20);
+    if (csound->fastMath)
+      for (n = offset; n < nsmps; n++)
+        r[n] = (MYFLT) fm_exp((double) (a[n] * LOG10D20));
+    else
+      for (n = offset; n < nsmps; n++)
+        r[n] = EXP(a[n] * LOG10D20);
     return OK;
 }
 
@@ -951,8 +980,12 @@ int32_t aampdbfs(CSOUND *csound, EVAL *p)
       nsmps -= early;
       memset(&r[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n = offset; n < nsmps; n++)
-      r[n] = csound->e0dbfs * EXP(a[n] * LOG10D20);
+    if (csound->fastMath)
+      for (n = offset; n < nsmps; n++)
+        r[n] = csound->e0dbfs * (MYFLT) fm_exp((double) (a[n] * LOG10D20));
+    else
+      for (n = offset; n < nsmps; n++)
+        r[n] = csound->e0dbfs * EXP(a[n] * LOG10D20);
     return OK;
 }
 
@@ -1306,8 +1339,12 @@ int32_t powoftwoa(CSOUND *csound, EVAL *p)
       nsmps -= early;
       memset(&r[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n = offset; n < nsmps; n++)
-      r[n] = POWER(FL(2.0), a[n]);
+    if (csound->fastMath)
+      for (n = offset; n < nsmps; n++)
+        r[n] = (MYFLT) fm_exp2((double) a[n]);
+    else
+      for (n = offset; n < nsmps; n++)
+        r[n] = POWER(FL(2.0), a[n]);
     return OK;
 }
 
@@ -1334,10 +1371,14 @@ int32_t asemitone(CSOUND *csound, EVAL *p)            /* JPff */
       nsmps -= early;
       memset(&r[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n = offset; n < nsmps; n++) {
-      MYFLT aa = (a[n])*ONEd12;
-      r[n] = POWER(FL(2.0), aa);
-    }
+    if (csound->fastMath)
+      for (n = offset; n < nsmps; n++)
+        r[n] = (MYFLT) fm_exp2((double) (a[n]*ONEd12));
+    else
+      for (n = offset; n < nsmps; n++) {
+        MYFLT aa = (a[n])*ONEd12;
+        r[n] = POWER(FL(2.0), aa);
+      }
     return OK;
 }
 
@@ -1361,11 +1402,15 @@ int32_t acent(CSOUND *csound, EVAL *p)        /* JPff */
       nsmps -= early;
       memset(&r[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n = offset; n < nsmps; n++) {
-      MYFLT aa = (a[n])*ONEd1200;
-      r[n] = POWER(FL(2.0), aa);
-  }
-  return OK;
+    if (csound->fastMath)
+      for (n = offset; n < nsmps; n++)
+        r[n] = (MYFLT) fm_exp2((double) (a[n]*ONEd1200));
+    else
+      for (n = offset; n < nsmps; n++) {
+        MYFLT aa = (a[n])*ONEd1200;
+        r[n] = POWER(FL(2.0), aa);
+      }
+    return OK;
 }
 
 #define LOG2_10D20      (FL(0.166096404744368117393515971474))
@@ -1389,10 +1434,14 @@ int32_t dba(CSOUND *csound, EVAL *p)          /* JPff */
       nsmps -= early;
       memset(&r[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n = offset; n < nsmps; n++) {
-      MYFLT aa = a[n];
-      r[n] = POWER(FL(2.0), aa*LOG2_10D20);
-    }
+    if (csound->fastMath)
+      for (n = offset; n < nsmps; n++)
+        r[n] = (MYFLT) fm_exp2((double) (a[n]*LOG2_10D20));
+    else
+      for (n = offset; n < nsmps; n++) {
+        MYFLT aa = a[n];
+        r[n] = POWER(FL(2.0), aa*LOG2_10D20);
+      }
     return OK;
 }
 
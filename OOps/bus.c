@@ -50,6 +50,19 @@
 #  include <conio.h>
 #endif
 
+/* For the shared memory bus */
+#if (defined(__unix) || defined(__unix__) || defined(__MACH__)) && \
+    !defined(ANDROID) && !defined(__EMSCRIPTEN__) && !defined(NACL)
+#  define CHN_SHM
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <sched.h>
+#  include <errno.h>
+#  include "csound_shm.h"
+#endif
+
 
 /* ------------------------------------------------------------------------ */
 
@@ -303,11 +316,18 @@ int32_t pvsout_perf(CSOUND *csound, FCHAN *p)
 
 /* "chn" opcodes and bus interface by Istvan Varga */
 
+/* The host looks up and creates channels while the performance does, and
+   adding an entry can move the others within chn_db or reallocate it, so
+   chn_db is only used with chn_db_lock held.  The entries themselves are
+   allocated one by one, and a CHNENTRY stays where it is once found. */
+
 static int32_t delete_channel_db(CSOUND *csound, void *p)
 {
     CONS_CELL *head, *values;
     IGN(p);
+    csoundLockMutex(csound->chn_db_lock);
     if (csound->chn_db == NULL) {
+        csoundUnlockMutex(csound->chn_db_lock);
         return 0;
     }
 
@@ -333,15 +353,21 @@ static int32_t delete_channel_db(CSOUND *csound, void *p)
 
     cs_hash_table_mfree_complete(csound, csound->chn_db);
     csound->chn_db = NULL;
+    csoundUnlockMutex(csound->chn_db_lock);
     return 0;
 }
 
 static inline CHNENTRY *find_channel(CSOUND *csound, const char *name)
 {
-    if (csound->chn_db != NULL && name[0]) {
-        return (CHNENTRY*) cs_hash_table_get(csound, csound->chn_db, (char*) name);
+    CHNENTRY *pp = NULL;
+    if (name[0]) {
+        csoundLockMutex(csound->chn_db_lock);
+        if (csound->chn_db != NULL)
+            pp = (CHNENTRY*) cs_hash_table_get(csound, csound->chn_db,
+                                               (char*) name);
+        csoundUnlockMutex(csound->chn_db_lock);
     }
-    return NULL;
+    return pp;
 }
 
 void set_channel_data_ptr(CSOUND *csound,
@@ -351,6 +377,319 @@ void set_channel_data_ptr(CSOUND *csound,
     find_channel(csound, name)->datasize = newSize;
 }
 
+/* ------------------------------------------------------------------------ */
+
+/* Shared memory bus (-+chn_shm=/name): control and audio channels created
+   with CSOUND_SHARED_CHANNEL live in a POSIX shared memory object laid out
+   as described in csound_shm.h.  The opcodes and the API use the private
+   data of the channel, which is copied in from the segment at the start
+   of sensevents() and copied out at the end of kperf(), or whenever this
+   instance has changed it.  The seqlock of a channel is only held for
+   the copy, so other processes are never kept waiting for a period. */
+
+#ifdef CHN_SHM
+
+/* a channel of this instance on the bus */
+typedef struct {
+    csound_shm_slot *slot;
+    MYFLT   *data;          /* the channel data the opcodes use */
+    MYFLT   *prev;          /* ... as last copied in or out */
+} CHN_SHM_CHN;
+
+typedef struct {
+    csound_shm_header *hdr;
+    size_t  size;
+    int     owner;          /* created the segment, unlinks it at reset */
+    int     held;           /* channels copied in for the current period */
+    int     nown;
+    CHN_SHM_CHN *own;
+    char    name[256];
+} CHN_SHM_BUS;
+
+static void chn_shm_lock(csound_shm_slot *s)
+{
+    int n = 0;
+    while (!csound_shm_trylock(s)) {
+      if (++n > 1000) sched_yield();
+    }
+}
+
+static void chn_shm_copy_in(CHN_SHM_BUS *shm, CHN_SHM_CHN *c)
+{
+    int n = 0;
+    while (!csound_shm_tryread(shm->hdr, c->slot, c->data)) {
+      if (++n > 1000) sched_yield();
+    }
+    memcpy(c->prev, c->data, c->slot->size);
+}
+
+/* copies the channel out if this instance has changed it: channels left
+   as they were are not, so that what another process wrote is kept */
+static int chn_shm_copy_out(CHN_SHM_BUS *shm, CHN_SHM_CHN *c)
+{
+    if (memcmp(c->data, c->prev, c->slot->size) == 0)
+      return 0;
+    chn_shm_lock(c->slot);
+    memcpy(csound_shm_data(shm->hdr, c->slot), c->data, c->slot->size);
+    csound_shm_unlock(c->slot);
+    memcpy(c->prev, c->data, c->slot->size);
+    return 1;
+}
+
+void csoundChannelShmBegin(CSOUND *csound)
+{
+    CHN_SHM_BUS *shm = (CHN_SHM_BUS *) csound->chnShm;
+    int i;
+    if (shm->held) return;
+    /* a channel set through the API since the last period is written,
+       the others are read */
+    for (i = 0; i < shm->nown; i++)
+      if (!chn_shm_copy_out(shm, &shm->own[i]))
+        chn_shm_copy_in(shm, &shm->own[i]);
+    shm->held = 1;
+}
+
+void csoundChannelShmEnd(CSOUND *csound)
+{
+    CHN_SHM_BUS *shm = (CHN_SHM_BUS *) csound->chnShm;
+    int i;
+    if (!shm->held) return;
+    for (i = 0; i < shm->nown; i++)
+      chn_shm_copy_out(shm, &shm->own[i]);
+    shm->held = 0;
+    if (shm->owner)
+      __atomic_add_fetch(&shm->hdr->block, 1, __ATOMIC_RELEASE);
+}
+
+static int32_t chn_shm_close(CSOUND *csound, void *p)
+{
+    CHN_SHM_BUS *shm = (CHN_SHM_BUS *) csound->chnShm;
+    int i;
+    IGN(p);
+    if (shm == NULL) return 0;
+    csoundChannelShmEnd(csound);
+    munmap((void *) shm->hdr, shm->size);
+    if (shm->owner)
+      shm_unlink(shm->name);
+    for (i = 0; i < shm->nown; i++)
+      csound->Free(csound, shm->own[i].prev);
+    csound->Free(csound, shm->own);
+    csound->Free(csound, shm);
+    csound->chnShm = NULL;
+    return 0;
+}
+
+/* map the segment of another instance; returns 1 if it is compatible,
+   0 if it is not and -1 if its creator has not initialised it yet */
+static int chn_shm_attach(CSOUND *csound, int fd,
+                          csound_shm_header **hp, size_t *size)
+{
+    struct stat st;
+    csound_shm_header *h;
+    uint32_t magic;
+    if (fstat(fd, &st) != 0)
+      return 0;
+    if ((size_t) st.st_size < sizeof(csound_shm_header))
+      return -1;
+    h = (csound_shm_header *) mmap(NULL, (size_t) st.st_size,
+                                   PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (h == MAP_FAILED)
+      return 0;
+    magic = __atomic_load_n(&h->magic, __ATOMIC_ACQUIRE);
+    if (magic != CSOUND_SHM_MAGIC ||
+        h->version != CSOUND_SHM_VERSION ||
+        h->ksmps != (uint32_t) csound->ksmps ||
+        h->flt_size != (uint32_t) sizeof(MYFLT) ||
+        csound_shm_size(h) > (size_t) st.st_size) {
+      munmap((void *) h, (size_t) st.st_size);
+      return magic == 0 ? -1 : 0;
+    }
+    *hp = h;
+    *size = (size_t) st.st_size;
+    return 1;
+}
+
+static CHN_SHM_BUS *chn_shm_open(CSOUND *csound)
+{
+    CHN_SHM_BUS *shm;
+    csound_shm_header *h = NULL;
+    const char *name;
+    int     *nslots, fd, res, tries, owner = 0;
+    size_t  size = 0;
+
+    if (csound->chnShm != NULL)
+      return (CHN_SHM_BUS *) csound->chnShm;
+    name = (const char *) csound->QueryGlobalVariable(csound, "_CHN_SHM");
+    nslots = (int *) csound->QueryGlobalVariable(csound, "_CHN_SHM_SLOTS");
+    if (name == NULL || name[0] == '\0' || nslots == NULL)
+      return NULL;
+    if (*nslots < 1 || *nslots > 65536) {
+      csound->Warning(csound, Str("chn_shm_slots must be 1 to 65536"));
+      return NULL;
+    }
+    /* another instance may be creating the segment: wait up to a
+       second for it to be sized and initialised */
+    for (tries = 0; ; tries++) {
+      fd = shm_open(name, O_RDWR, 0);
+      if (fd >= 0) {
+        res = chn_shm_attach(csound, fd, &h, &size);
+        close(fd);
+        if (res > 0)
+          break;
+        if (res < 0 && tries < 1000) {
+          csound->Sleep(1);
+          continue;
+        }
+        csound->Warning(csound,
+                        res < 0 ?
+                        Str("shared memory bus %s exists but was never "
+                            "initialised; remove it or use another name") :
+                        Str("shared memory bus %s exists but does not match "
+                            "this performance (ksmps, precision); remove it "
+                            "or use another name"), name);
+        return NULL;
+      }
+      fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+      if (fd >= 0)
+        break;
+      if (UNLIKELY(errno != EEXIST || tries >= 1000)) {
+        csound->Warning(csound, Str("could not create shared memory bus %s: %s"),
+                        name, strerror(errno));
+        return NULL;
+      }
+    }
+    if (h == NULL) {
+      csound_shm_header tmp;
+      memset(&tmp, 0, sizeof(tmp));
+      tmp.nslots = (uint32_t) *nslots;
+      tmp.ksmps = (uint32_t) csound->ksmps;
+      tmp.flt_size = (uint32_t) sizeof(MYFLT);
+      size = csound_shm_size(&tmp);
+      if (ftruncate(fd, (off_t) size) != 0 ||
+          (h = (csound_shm_header *)
+           mmap(NULL, size, PROT_READ | PROT_WRITE,
+                MAP_SHARED, fd, 0)) == MAP_FAILED) {
+        csound->Warning(csound, Str("could not map shared memory bus %s: %s"),
+                        name, strerror(errno));
+        close(fd);
+        shm_unlink(name);
+        return NULL;
+      }
+      close(fd);
+      tmp.version = CSOUND_SHM_VERSION;
+      tmp.sr = (double) csound->esr;
+      memcpy(h, &tmp, sizeof(tmp));
+      __atomic_store_n(&h->magic, CSOUND_SHM_MAGIC, __ATOMIC_RELEASE);
+      owner = 1;
+    }
+    shm = (CHN_SHM_BUS *) csound->Calloc(csound, sizeof(CHN_SHM_BUS));
+    shm->own = (CHN_SHM_CHN *) csound->Calloc(csound, h->nslots *
+                                              sizeof(CHN_SHM_CHN));
+    shm->hdr = h;
+    shm->size = size;
+    shm->owner = owner;
+    strNcpy(shm->name, name, sizeof(shm->name));
+    csound->chnShm = (void *) shm;
+    csound->RegisterResetCallback(csound, NULL, chn_shm_close);
+    if (owner)
+      csound->Message(csound, Str("created shared memory bus %s "
+                                  "(%u channels)\n"), name, h->nslots);
+    else
+      csound->Message(csound, Str("attached to shared memory bus %s\n"), name);
+    return shm;
+}
+
+/* find or add the directory entry of a channel, and copy it in and out
+   of data; returns 0 if the channel stays private */
+static int chn_shm_bind(CSOUND *csound, const char *name, int32_t type,
+                        MYFLT *data)
+{
+    CHN_SHM_BUS *shm;
+    csound_shm_header *h;
+    csound_shm_slot *s = NULL;
+    CHN_SHM_CHN *c;
+    uint32_t  i, n, t, ctype = (uint32_t) (type & CSOUND_CHANNEL_TYPE_MASK);
+
+    if (UNLIKELY(strlen(name) >= CSOUND_SHM_NAMELEN)) {
+      csound->Warning(csound, Str("channel %s: name too long for the shared "
+                                  "memory bus"), name);
+      return 0;
+    }
+    if ((shm = chn_shm_open(csound)) == NULL) {
+      csound->Warning(csound, Str("channel %s: no shared memory bus "
+                                  "(-+chn_shm), using private memory"), name);
+      return 0;
+    }
+    h = shm->hdr;
+    /* look for the name up to the first free entry and claim that one;
+       an instance adding the same name at the same time claims the same
+       entry, so whichever loses the swap finds the name there */
+    for (i = 0; i < h->nslots; i++) {
+      s = &csound_shm_slots(h)[i];
+      t = __atomic_load_n(&s->type, __ATOMIC_ACQUIRE);
+      if (t == 0 &&
+          __atomic_compare_exchange_n(&s->type, &t, CSOUND_SHM_CLAIMED, 0,
+                                      __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        strNcpy(s->name, name, CSOUND_SHM_NAMELEN);
+        s->size = (ctype == CSOUND_AUDIO_CHANNEL ?
+                   (uint32_t) (csound->ksmps * sizeof(MYFLT)) :
+                   (uint32_t) sizeof(MYFLT));
+        s->offset = sizeof(csound_shm_header) +
+          h->nslots * sizeof(csound_shm_slot) +
+          i * csound_shm_stride(h->ksmps, h->flt_size);
+        s->seq = 0;
+        __atomic_store_n(&s->type, (uint32_t) type, __ATOMIC_RELEASE);
+        n = __atomic_load_n(&h->nchannels, __ATOMIC_ACQUIRE);
+        while (n < i + 1 &&
+               !__atomic_compare_exchange_n(&h->nchannels, &n, i + 1, 0,
+                                            __ATOMIC_ACQ_REL,
+                                            __ATOMIC_ACQUIRE)) ;
+        break;
+      }
+      /* t is now the type of the entry, or it is still being set */
+      while (t == CSOUND_SHM_CLAIMED) {
+        sched_yield();
+        t = __atomic_load_n(&s->type, __ATOMIC_ACQUIRE);
+      }
+      if (strncmp(s->name, name, CSOUND_SHM_NAMELEN) == 0) {
+        if (UNLIKELY((t & CSOUND_CHANNEL_TYPE_MASK) != ctype)) {
+          csound->Warning(csound, Str("channel %s: different type on the "
+                                      "shared memory bus"), name);
+          return 0;
+        }
+        break;
+      }
+    }
+    if (UNLIKELY(i == h->nslots)) {
+      csound->Warning(csound, Str("channel %s: shared memory bus is full "
+                                  "(-+chn_shm_slots)"), name);
+      return 0;
+    }
+    c = &shm->own[shm->nown++];
+    c->slot = s;
+    c->data = data;
+    c->prev = (MYFLT *) csound->Malloc(csound, s->size);
+    chn_shm_copy_in(shm, c);
+    return 1;
+}
+
+#else
+
+void csoundChannelShmBegin(CSOUND *csound) { IGN(csound); }
+void csoundChannelShmEnd(CSOUND *csound) { IGN(csound); }
+
+static int chn_shm_bind(CSOUND *csound, const char *name, int32_t type,
+                        MYFLT *data)
+{
+    IGN(type);
+    IGN(data);
+    csound->Warning(csound, Str("channel %s: the shared memory bus is not "
+                                "available on this platform"), name);
+    return 0;
+}
+
+#endif
+
 #define INIT_STRING_CHANNEL_DATASIZE 256
 
 static CS_NOINLINE CHNENTRY *alloc_channel(CSOUND *csound,
@@ -398,22 +737,33 @@ static CS_NOINLINE int32_t create_new_channel(CSOUND *csound, const char *name,
 
     /* create new empty database if not allocated */
     if (csound->chn_db == NULL) {
-        csound->chn_db = cs_hash_table_create(csound);
+        CS_HASH_TABLE *db = cs_hash_table_create(csound);
+        if (UNLIKELY(db == NULL))
+            return CSOUND_MEMORY;
         if (UNLIKELY(csound->RegisterResetCallback(csound, NULL,
                                                    delete_channel_db) != 0))
             return CSOUND_MEMORY;
-        if (UNLIKELY(csound->chn_db == NULL))
-            return CSOUND_MEMORY;
+        csoundLockMutex(csound->chn_db_lock);
+        csound->chn_db = db;
+        csoundUnlockMutex(csound->chn_db_lock);
     }
     /* allocate new entry */
     pp = alloc_channel(csound, name, type);
     if (UNLIKELY(pp == NULL))
         return CSOUND_MEMORY;
+    if (type & CSOUND_SHARED_CHANNEL) {
+      if (((type & CSOUND_CHANNEL_TYPE_MASK) != CSOUND_CONTROL_CHANNEL &&
+           (type & CSOUND_CHANNEL_TYPE_MASK) != CSOUND_AUDIO_CHANNEL) ||
+          !chn_shm_bind(csound, name, type, pp->data))
+        type &= ~CSOUND_SHARED_CHANNEL;
+    }
     pp->hints.behav = 0;
     pp->type = type;
     strcpy(&(pp->name[0]), name);
 
+    csoundLockMutex(csound->chn_db_lock);
     cs_hash_table_put(csound, csound->chn_db, (char*)name, pp);
+    csoundUnlockMutex(csound->chn_db_lock);
 
     return CSOUND_SUCCESS;
 }
@@ -429,9 +779,15 @@ PUBLIC int32_t csoundGetChannelPtr(CSOUND *csound,
         return CSOUND_ERROR;
     pp = find_channel(csound, name);
     if (!pp) {
-        if (create_new_channel(csound, name, type) == CSOUND_SUCCESS) {
+        /* another thread may be creating it: look again, and create it,
+           holding the lock */
+        csoundLockMutex(csound->chn_db_lock);
+        pp = find_channel(csound, name);
+        if (pp == NULL &&
+            create_new_channel(csound, name, type) == CSOUND_SUCCESS) {
             pp = find_channel(csound, name);
         }
+        csoundUnlockMutex(csound->chn_db_lock);
     }
     if (pp != NULL) {
         if ((pp->type ^ type) & CSOUND_CHANNEL_TYPE_MASK)
@@ -443,6 +799,16 @@ PUBLIC int32_t csoundGetChannelPtr(CSOUND *csound,
     return CSOUND_ERROR;
 }
 
+PUBLIC CS_CHANNEL *csoundGetChannelHandle(CSOUND *csound,
+                                          const char *name, int32_t type)
+{
+    MYFLT *p;
+    if (UNLIKELY(csoundGetChannelPtr(csound, &p, name, type)
+                 != CSOUND_SUCCESS))
+      return NULL;
+    return (CS_CHANNEL *) find_channel(csound, name);
+}
+
 PUBLIC int32_t csoundGetChannelDatasize(CSOUND *csound, const char *name){
 
     CHNENTRY  *pp;
@@ -486,10 +852,10 @@ PUBLIC int32_t csoundListChannels(CSOUND *csound, controlChannelInfo_t **lst)
     CONS_CELL* channels;
 
     *lst = (controlChannelInfo_t*) NULL;
-    if (csound->chn_db == NULL)
-        return 0;
-
-    channels = cs_hash_table_values(csound, csound->chn_db);
+    csoundLockMutex(csound->chn_db_lock);
+    channels = (csound->chn_db == NULL ? NULL :
+                cs_hash_table_values(csound, csound->chn_db));
+    csoundUnlockMutex(csound->chn_db_lock);
     n = cs_cons_length(channels);
 
     if (!n)
@@ -726,6 +1092,56 @@ static int32_t chnget_opcode_perf_a(CSOUND* csound, CHNGET* p)
     return OK;
 }
 
+/* receive control channel as audio at performance time; a timed write
+   from the host (csoundSetControlChannelsAt) steps at its frame */
+static int32_t chnget_opcode_perf_ak(CSOUND* csound, CHNGET* p)
+{
+    CHNENTRY *chn = p->chn;
+    uint32_t offset = p->h.insdshead->ksmps_offset;
+    uint32_t early = p->h.insdshead->ksmps_no_end;
+    uint32_t n, nsmps = CS_KSMPS, step = 0;
+    MYFLT    val, prev;
+
+    if (UNLIKELY(strncmp(p->chname, p->iname->data, MAX_CHAN_NAME))) {
+        chnget_opcode_init_a(csound, p);
+        return p->h.opadr(csound, p);
+    }
+#if defined(MSVC)
+    volatile union {
+    MYFLT d;
+    MYFLT_INT_TYPE i;
+    } x;
+    x.i = InterlockedExchangeAdd64((MYFLT_INT_TYPE *) p->fp, 0);
+    val = x.d;
+#elif defined(HAVE_ATOMIC_BUILTIN)
+    volatile union {
+        MYFLT d;
+        MYFLT_INT_TYPE i;
+    } x;
+    x.i = __atomic_load_n((MYFLT_INT_TYPE*) p->fp, __ATOMIC_SEQ_CST);
+    val = x.d;
+#else
+    val = *(p->fp);
+#endif
+    prev = val;
+    if (chn->stepk == csound->kcounter) {
+        step = (uint32_t) chn->step;
+        prev = chn->prev;
+    }
+    if (UNLIKELY(offset)) memset(p->arg, '\0', offset*sizeof(MYFLT));
+    if (UNLIKELY(early)) {
+        nsmps -= early;
+        memset(&p->arg[nsmps], '\0', early*sizeof(MYFLT));
+    }
+    for (n = offset; n < nsmps; n++)
+        p->arg[n] = ((uint32_t) p->pos + n < step ? prev : val);
+    if (CS_KSMPS != (uint32_t) csound->ksmps) {
+        p->pos += CS_KSMPS;
+        p->pos %= csound->ksmps;
+    }
+    return OK;
+}
+
 /* receive control value from bus at init time */
 int32_t chnget_opcode_init_i(CSOUND *csound, CHNGET *p)
 {
@@ -1170,6 +1586,16 @@ int32_t chnget_opcode_init_a(CSOUND* csound, CHNGET* p)
     p->pos = 0;
     err = csoundGetChannelPtr(csound, &(p->fp), (char*) p->iname->data,
                               CSOUND_AUDIO_CHANNEL | CSOUND_INPUT_CHANNEL);
+    if (err > 0 &&
+        (err & CSOUND_CHANNEL_TYPE_MASK) == CSOUND_CONTROL_CHANNEL) {
+        /* existing control channel, read at a-rate */
+        p->chn = find_channel(csound, (char*) p->iname->data);
+        p->fp = p->chn->data;
+        p->lock = &p->chn->lock;
+        strNcpy(p->chname, p->iname->data, MAX_CHAN_NAME);
+        p->h.opadr = (SUBR) chnget_opcode_perf_ak;
+        return OK;
+    }
 
     if (LIKELY(!err))
     {
@@ -1253,11 +1679,13 @@ static int32_t chnset_opcode_perf_k(CSOUND *csound, CHNGET *p)
                                           CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL);
         if(err == 0) {
             p->lock = (spin_lock_t *) csoundGetChannelLock(csound, (char*) p->iname->data);
+            p->chn = find_channel(csound, (char*) p->iname->data);
             strNcpy(p->chname, p->iname->data, MAX_CHAN_NAME);
         }
         else
             print_chn_err_perf(p, err);
     }
+    if (p->chn != NULL) p->chn->written |= CHN_WRITE_SET;
 
 #if defined(MSVC)
     volatile union {
@@ -1287,6 +1715,7 @@ static int32_t chnset_opcode_perf_a(CSOUND *csound, CHNGET *p)
 {
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
+    p->chn->written |= CHN_WRITE_SET;
     if(CS_KSMPS == (uint32_t) csound->ksmps){
         /* Need lock for the channel */
         csoundSpinLock(p->lock);
@@ -1326,6 +1755,7 @@ static int32_t chnmix_opcode_perf(CSOUND *csound, CHNGET *p)
     for (n=offset; n<nsmps; n++) {
         p->fp[n] += p->arg[n];
     }
+    p->chn->written |= CHN_WRITE_MIX;
     csoundSpinUnLock(p->lock);
     return OK;
 }
@@ -1340,6 +1770,7 @@ static int32_t chnclear_opcode_perf(CSOUND *csound, CHNCLEAR *p)
     for (i=0; i<n; i++) {
         csoundSpinLock(p->lock[i]);
         memset(p->fp[i], 0, CS_KSMPS*sizeof(MYFLT)); /* Should this leave start? */
+        p->chn[i]->written |= CHN_WRITE_SET;
         csoundSpinUnLock(p->lock[i]);
     }
     return OK;
@@ -1355,6 +1786,7 @@ int32_t chnset_opcode_init_i(CSOUND *csound, CHNGET *p)
                               CSOUND_CONTROL_CHANNEL | CSOUND_OUTPUT_CHANNEL);
     if (UNLIKELY(err))
         return print_chn_err(p, err);
+    find_channel(csound, (char*) p->iname->data)->written |= CHN_WRITE_SET;
 
 
 #if defined(MSVC)
@@ -1394,7 +1826,9 @@ int32_t chnset_opcode_init_k(CSOUND* csound, CHNGET* p)
                               CSOUND_CONTROL_CHANNEL | CSOUND_OUTPUT_CHANNEL);
     if (LIKELY(!err)) {
         p->lock = (spin_lock_t*) csoundGetChannelLock(csound, (char*) p->iname->data);
+        p->chn = find_channel(csound, (char*) p->iname->data);
     }
+    else p->chn = NULL;
 
     p->h.opadr = (SUBR) chnset_opcode_perf_k;
     return OK;
@@ -1410,6 +1844,7 @@ int32_t chnset_opcode_init_a(CSOUND* csound, CHNGET* p)
                               CSOUND_AUDIO_CHANNEL | CSOUND_OUTPUT_CHANNEL);
     if (!err) {
         p->lock = (spin_lock_t*) csoundGetChannelLock(csound, (char*) p->iname->data);
+        p->chn = find_channel(csound, (char*) p->iname->data);
     }
 
     p->h.opadr = (SUBR) chnset_opcode_perf_a;
@@ -1426,6 +1861,7 @@ int32_t chnmix_opcode_init(CSOUND *csound, CHNGET *p)
                               CSOUND_AUDIO_CHANNEL | CSOUND_OUTPUT_CHANNEL);
     if (LIKELY(!err)) {
         p->lock = (spin_lock_t *)csoundGetChannelLock(csound, (char*) p->iname->data);
+        p->chn = find_channel(csound, (char*) p->iname->data);
         p->h.opadr = (SUBR) chnmix_opcode_perf;
         return OK;
     }
@@ -1445,6 +1881,7 @@ int32_t chnclear_opcode_init(CSOUND *csound, CHNCLEAR *p)
         if (LIKELY(!err)) {
             p->lock[i] = (spin_lock_t *)csoundGetChannelLock(csound,
                                                              (char*) p->iname[i]->data);
+            p->chn[i] = find_channel(csound, (char*) p->iname[i]->data);
         }
         else return print_chn_err(p, err);
     }
@@ -1522,6 +1959,16 @@ int32_t chnset_opcode_perf_S(CSOUND* csound, CHNGET* p)
     return OK;
 }
 
+/* a channel declared shared after it was created stays private */
+
+static void check_shared_channel(CSOUND *csound, const char *name)
+{
+    CHNENTRY *pp = find_channel(csound, name);
+    if (pp != NULL && !(pp->type & CSOUND_SHARED_CHANNEL))
+      csound->Warning(csound, Str("channel %s is not on the shared memory "
+                                  "bus"), name);
+}
+
 /* declare control channel, optionally with special parameters */
 
 int32_t chn_k_opcode_init_(CSOUND *csound, CHN_OPCODE_K *p, int mode)
@@ -1534,13 +1981,17 @@ int32_t chn_k_opcode_init_(CSOUND *csound, CHN_OPCODE_K *p, int mode)
     hints.x = hints.y = hints.height = hints.width = 0;
 
     // mode = (int32_t)MYFLT2LRND(*(p->imode));
-    if (UNLIKELY(mode < 1 || mode > 3))
+    if (UNLIKELY(!(mode & 3) || mode > 7))
         return csound->InitError(csound, Str("invalid mode parameter"));
     type = CSOUND_CONTROL_CHANNEL;
     if (mode & 1)
         type |= CSOUND_INPUT_CHANNEL;
     if (mode & 2)
         type |= CSOUND_OUTPUT_CHANNEL;
+    if (mode & 4) {
+        type |= CSOUND_SHARED_CHANNEL;
+        check_shared_channel(csound, (char*) p->iname->data);
+    }
 
     err = csoundGetChannelPtr(csound, &dummy, (char*) p->iname->data, type);
     if (err)
@@ -1591,8 +2042,15 @@ int32_t chn_k_opcode_init_S(CSOUND *csound, CHN_OPCODE_K *p)
         mode = 1;
     else if(!strcmp("w", smode->data))
         mode = 2;
+    else if(!strcmp("rws", smode->data))
+        mode = 7;
+    else if(!strcmp("rs", smode->data))
+        mode = 5;
+    else if(!strcmp("ws", smode->data))
+        mode = 6;
     else
-        return csound->InitError(csound, Str("invalid mode, should be r, w, rw"));
+        return csound->InitError(csound, Str("invalid mode, should be r, w, rw, "
+                                             "or one of them followed by s"));
     return chn_k_opcode_init_(csound, p, mode);
 }
 
@@ -1605,13 +2063,17 @@ int32_t chn_a_opcode_init(CSOUND *csound, CHN_OPCODE *p)
     int32_t   type, mode, err;
 
     mode = (int32_t)MYFLT2LRND(*(p->imode));
-    if (UNLIKELY(mode < 1 || mode > 3))
+    if (UNLIKELY(!(mode & 3) || mode > 7))
         return csound->InitError(csound, Str("invalid mode parameter"));
     type = CSOUND_AUDIO_CHANNEL;
     if (mode & 1)
         type |= CSOUND_INPUT_CHANNEL;
     if (mode & 2)
         type |= CSOUND_OUTPUT_CHANNEL;
+    if (mode & 4) {
+        type |= CSOUND_SHARED_CHANNEL;
+        check_shared_channel(csound, (char*) p->iname->data);
+    }
     err = csoundGetChannelPtr(csound, &dummy, (char*) p->iname->data, type);
     if (UNLIKELY(err))
         return print_chn_err(p, err);
@@ -1679,20 +2141,20 @@ int32_t chnexport_opcode_init(CSOUND *csound, CHNEXPORT_OPCODE *p)
         type |= CSOUND_INPUT_CHANNEL;
     if (mode & 2)
         type |= CSOUND_OUTPUT_CHANNEL;
-    /* check if the channel already exists (it should not) */
+    /* check if the channel already exists (it should not), and create
+       it, so that no other thread can create it in between */
+    csoundLockMutex(csound->chn_db_lock);
     err = csoundGetChannelPtr(csound, &dummy, (char*) p->iname->data, 0);
-    if (UNLIKELY(err >= 0))
+    if (UNLIKELY(err >= 0)) {
+        csoundUnlockMutex(csound->chn_db_lock);
         return csound->InitError(csound, Str("channel already exists"));
+    }
     /* now create new channel, using output variable for data storage */
-//    dummy = p->arg;
-    /* THIS NEEDS A LOCK BUT DOES NOT EXIST YET */
-    /* lock = csoundGetChannelLock(csound, (char*) p->iname->data); */
-    /* csoundSpinLock(lock); */
     err = create_new_channel(csound, (char*) p->iname->data, type);
-
-    /* csoundSpinLock(lock); */
-    if (err)
+    if (err) {
+        csoundUnlockMutex(csound->chn_db_lock);
         return print_chn_err(p, err);
+    }
 
     /* Now we need to find the channel entry */
     chn = find_channel(csound, (char*) p->iname->data);
@@ -1700,6 +2162,7 @@ int32_t chnexport_opcode_init(CSOUND *csound, CHNEXPORT_OPCODE *p)
     csound->Free(csound, chn->data);
     /* point to the arg var */
     chn->data = p->arg;
+    csoundUnlockMutex(csound->chn_db_lock);
 
     /* if control channel, set additional parameters */
     if ((type & CSOUND_CHANNEL_TYPE_MASK) != CSOUND_CONTROL_CHANNEL)
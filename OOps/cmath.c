@@ -26,6 +26,7 @@
 
 #include "csoundCore.h"
 #include "cmath.h"
+#include "fastmath.h"
 #include <math.h>
 
 int32_t ipow(CSOUND *csound, POW *p)        /*      Power for i-rate */
@@ -66,6 +67,10 @@ int32_t apow(CSOUND *csound, POW *p)        /* Power routine for a-rate  */
           out[n] = yy;
       }
     }
+    else if (csound->fastMath && fm_pow_domain(&in[offset], nsmps - offset)) {
+      for (n = offset; n < nsmps; n++)
+        out[n] = (MYFLT) fm_pow((double) in[n], (double) powerOf) / norm;
+    }
     else {
       for (n = offset; n < nsmps; n++)
         out[n] = POWER(in[n], powerOf) / norm;
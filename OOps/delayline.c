@@ -0,0 +1,347 @@
+/*
+    delayline.c:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+#include "csoundCore.h"
+
+#include <math.h>
+#include "delayline.h"
+
+#define MAXWINDOW 1024  /* widest sinc interpolator of vdelayx */
+
+void delayline_init(CSOUND *csound, DELAYLINE *d, uint32 len, uint32 width,
+                    int keep)
+{
+    uint32 size = 1, guard;
+    size_t nbytes;
+
+    if (UNLIKELY(len == 0)) len = 1;            /* Degenerate case */
+    if (UNLIKELY(width == 0)) width = 1;
+    guard = csound->ksmps + width;
+    if (keep && d->buf != NULL && d->buf == (MYFLT*) d->aux.auxp &&
+        d->mask + 1 >= len + csound->ksmps && d->guard >= guard) {
+      d->len = len;
+      if (UNLIKELY(d->left >= (int32) len)) d->left = 0;
+      return;
+    }
+    while (size < len + csound->ksmps || size < guard)
+      size <<= 1;
+    nbytes = (size_t) (size + guard) * sizeof(MYFLT);
+    if (d->aux.auxp == NULL || nbytes > d->aux.size)
+      csound->AuxAlloc(csound, nbytes, &d->aux);
+    else
+      memset(d->aux.auxp, 0, nbytes);
+    d->buf = (MYFLT*) d->aux.auxp;
+    d->mask = size - 1;
+    d->guard = guard;
+    d->len = len;
+    d->wp = 0;
+    d->left = 0;
+}
+
+void delayline_write(DELAYLINE *d, const MYFLT *in, uint32 n)
+{
+    uint32 size = d->mask + 1, pos = d->wp & d->mask;
+
+    if (pos + n <= size)
+      memcpy(&d->buf[pos], in, n * sizeof(MYFLT));
+    else {
+      memcpy(&d->buf[pos], in, (size - pos) * sizeof(MYFLT));
+      memcpy(d->buf, &in[size - pos], (n - (size - pos)) * sizeof(MYFLT));
+    }
+    if (pos < d->guard || pos + n > size)       /* refresh the guard */
+      memcpy(&d->buf[size], d->buf, d->guard * sizeof(MYFLT));
+    d->wp += n;
+    d->left = (int32) ((d->left + n) % d->len);
+}
+
+/* the index of the first input of the block of n just written */
+
+static inline int32 block_index(const DELAYLINE *d, uint32 n)
+{
+    return (int32) ((d->left + d->len - n % d->len) % d->len);
+}
+
+/* The sample at index v, as seen from the input at 'at' whose index is
+   indx */
+
+static inline MYFLT delay_at(const DELAYLINE *d, uint32 at, int32 indx,
+                             int32 v)
+{
+    int32 dist = indx - v;
+    if (dist < 0) dist += (int32) d->len;
+    return d->buf[(at - (uint32) dist) & d->mask];
+}
+
+/* The width samples from index v on, oldest first.  Points into the ring
+   unless the window runs past the input at 'at', then the samples are
+   copied to tmp, wrapping around the line as the indices did. */
+
+static inline const MYFLT *delay_window(const DELAYLINE *d, uint32 at,
+                                        int32 indx, int32 v, int32 width,
+                                        MYFLT *tmp)
+{
+    int32 j, len = (int32) d->len, dist = indx - v;
+
+    if (dist < 0) dist += len;
+    if (LIKELY(dist - width + 1 >= 0))
+      return &d->buf[(at - (uint32) dist) & d->mask];
+    for (j = 0; j < width; j++) {
+      tmp[j] = d->buf[(at - (uint32) dist) & d->mask];
+      if (--dist < 0) dist += len;
+    }
+    return tmp;
+}
+
+void delayline_read_linear(DELAYLINE *d, MYFLT *out, const MYFLT *del,
+                           uint32 step, MYFLT scale, uint32 n)
+{
+    uint32 i, at = d->wp - n;
+    int32  maxd = (int32) d->len, indx = block_index(d, n), v1, v2;
+    MYFLT  fv1, fv2, b1, b2;
+
+    for (i = 0; i < n; i++) {
+      fv1 = indx - del[i * step] * scale;
+      while (UNLIKELY(fv1 < FL(0.0)))
+        fv1 += (MYFLT)maxd;
+      while (UNLIKELY(fv1 >= (MYFLT)maxd))
+        fv1 -= (MYFLT)maxd;
+      if (LIKELY(fv1 < maxd - 1)) /* Find next sample for interpolation */
+        fv2 = fv1 + FL(1.0);
+      else
+        fv2 = FL(0.0);
+      v1 = (int32)fv1;
+      v2 = (int32)fv2;
+      b1 = delay_at(d, at + i, indx, v1);
+      /* fv2 can round up to maxd, the slot after the end of the
+         original buffer, which stayed zero */
+      b2 = LIKELY(v2 < maxd) ? delay_at(d, at + i, indx, v2) : FL(0.0);
+      out[i] = b1 + (fv1 - v1) * (b2 - b1);
+      if (UNLIKELY(++indx == maxd))
+        indx = 0;
+    }
+}
+
+/* cubic interpolation coefficients, optimized by Istvan Varga (Oct 2001) */
+
+#define CUBIC_COEFS(fv, w, x, y, z) {                                   \
+      z = fv * fv; z--; z *= FL(0.1666666667);                          \
+      y = fv; y++; w = (y *= FL(0.5)); w--;                             \
+      x = FL(3.0) * z; y -= x; w -= z; x -= fv;                         \
+    }
+
+/* index v1 of the older of the two middle points and the fraction fv1
+   for a delay of x samples from index indx, as vdelay3 found them */
+
+static inline int32 cubic_split(int32 maxd, int32 indx, MYFLT x, MYFLT *fv)
+{
+    MYFLT  fv1 = -x;
+    int32  v1 = (int32)fv1;
+
+    fv1 -= (MYFLT) v1;
+    v1 += indx;
+    if ((v1 < 0) || (fv1 < FL(0.0))) {
+      fv1++; v1--; while (UNLIKELY(v1 < 0)) v1 += maxd;
+    }
+    else {
+      while (UNLIKELY(v1 >= maxd)) v1 -= maxd;
+    }
+    *fv = fv1;
+    return v1;
+}
+
+void delayline_read_cubic(DELAYLINE *d, MYFLT *out, const MYFLT *del,
+                          uint32 step, MYFLT scale, uint32 n)
+{
+    uint32 i, at = d->wp - n;
+    int32  maxd = (int32) d->len, indx = block_index(d, n), v1, v2, dist;
+    const MYFLT *b;
+    MYFLT  fv1, w, x, y, z, b1, tmp[4];
+
+    if (step == 0) {
+      /* the index of the points advances with the input: a constant
+         distance, and constant coefficients */
+      v1 = cubic_split(maxd, indx, *del * scale, &fv1);
+      dist = indx - v1;
+      if (dist < 0) dist += maxd;
+      if (maxd >= 4 && dist >= 2 && dist + 1 < maxd) {
+        b = &d->buf[(at - (uint32) (dist + 1)) & d->mask];
+        CUBIC_COEFS(fv1, w, x, y, z);
+        for (i = 0; i < n; i++)
+          out[i] = (w*b[i] + x*b[i + 1] + y*b[i + 2] + z*b[i + 3]) * fv1
+                   + b[i + 1];
+        return;
+      }
+    }
+    for (i = 0; i < n; i++) {
+      if (step != 0 || i == 0)
+        v1 = cubic_split(maxd, indx, del[i * step] * scale, &fv1);
+      /* Find next sample for interpolation      */
+      v2 = (v1 == maxd - 1 ? 0 : v1 + 1);
+      if (maxd < 4) {
+        b1 = delay_at(d, at + i, indx, v1);
+        out[i] = b1 + fv1 * (delay_at(d, at + i, indx, v2) - b1);
+      }
+      else {
+        b = delay_window(d, at + i, indx, v1 == 0 ? maxd - 1 : v1 - 1, 4,
+                         tmp);
+        CUBIC_COEFS(fv1, w, x, y, z);
+        out[i] = (w*b[0] + x*b[1] + y*b[2] + z*b[3]) * fv1 + b[1];
+      }
+      if (UNLIKELY(++v1 >= maxd)) v1 -= maxd;
+      if (UNLIKELY(++indx >= maxd)) indx -= maxd;
+    }
+}
+
+/* Windowed sinc weights of vdelayx (Istvan Varga, Mar 2001), with the
+   alternating sign folded in, for a sample at fraction f between the
+   two middle points of the window */
+
+static void sinc_weights(double *wts, double f, int32 i2, double d2x)
+{
+    double w, d = (double) (1 - i2) - f;
+    int32  j;
+
+    for (j = 0; j < 2 * i2; j += 2) {
+      w = 1.0 - d*d*d2x; w *= (w / d++);
+      wts[j] = w;
+      w = 1.0 - d*d*d2x; w *= (w / d++);
+      wts[j + 1] = -w;
+    }
+}
+
+void delayline_read_sinc(DELAYLINE *d, int nlines, MYFLT **out,
+                         const MYFLT *del, uint32 step, MYFLT scale,
+                         int wsize, uint32 n)
+{
+    uint32 i, at = d->wp - n;
+    int32  c, j, xpos, i2 = (wsize >> 1);
+    int32  maxd = (int32) d->len, indx = block_index(d, n);
+    double x1, x2, n1, d2x, wts[MAXWINDOW];
+    MYFLT  tmp[MAXWINDOW];
+    const MYFLT *b;
+
+    d2x = (1.0 - pow((double) wsize * 0.85172, -0.89624)) / (double) (i2 * i2);
+    for (i = 0; i < n; i++) {
+      /* x1: fractional part of delay time */
+      /* x2: sine of x1 (for interpolation) */
+      /* xpos: integer part of delay time (buffer position to read from) */
+      x1 = (double)indx - ((double)del[i * step] * (double)scale);
+      while (UNLIKELY(x1 < 0.0)) x1 += (double)maxd;
+      xpos = (int32)x1;
+      x1 -= (double)xpos;
+      while (UNLIKELY(xpos >= maxd)) xpos -= maxd;
+      if (x1 * (1.0 - x1) > 0.00000001) {
+        x2 = sin(PI * x1) / PI;
+        xpos += (1 - i2);
+        while (UNLIKELY(xpos < 0)) xpos += maxd;
+        sinc_weights(wts, x1, i2, d2x);
+        for (c = 0; c < nlines; c++) {
+          b = delay_window(&d[c], at + i, indx, xpos, 2 * i2, tmp);
+          n1 = 0.0;
+          for (j = 0; j < 2 * i2; j++)
+            n1 += (double) b[j] * wts[j];
+          out[c][i] = (MYFLT) (n1 * x2);
+        }
+      }
+      else {                                    /* integer sample */
+        xpos = (int32)((double)xpos + x1 + 0.5);        /* position */
+        if (UNLIKELY(xpos >= maxd)) xpos -= maxd;
+        for (c = 0; c < nlines; c++)
+          out[c][i] = delay_at(&d[c], at + i, indx, xpos);
+      }
+      if (UNLIKELY(++indx == maxd)) indx = 0;
+    }
+}
+
+void delayline_write_sinc(DELAYLINE *d, int nlines, MYFLT **out,
+                          MYFLT **in, const MYFLT *del, uint32 step,
+                          MYFLT scale, int wsize, uint32 n)
+{
+    uint32 i, pos;
+    int32  c, j, xpos, fwd, i2 = (wsize >> 1);
+    int32  maxd = (int32) d->len, indx = d->left;
+    double x1, x2, d2x, wts[MAXWINDOW], n1[4];
+
+    d2x = (1.0 - pow((double) wsize * 0.85172, -0.89624)) / (double) (i2 * i2);
+    for (i = 0; i < n; i++, d->wp++) {
+      /* the index del samples from now, and the fraction past it */
+      x1 = (double)indx + ((double)del[i * step] * (double)scale);
+      while (UNLIKELY(x1 < 0.0)) x1 += (double)maxd;
+      xpos = (int32)x1;
+      x1 -= (double)xpos;
+      while (UNLIKELY(xpos >= maxd)) xpos -= maxd;
+      if (LIKELY(x1 * (1.0 - x1) > 0.00000001)) {
+        x2 = sin(PI * x1) / PI;
+        for (c = 0; c < nlines; c++)
+          n1[c] = (double) in[c][i] * x2;
+        xpos += (1 - i2);
+        while (UNLIKELY(xpos < 0)) xpos += maxd;
+        sinc_weights(wts, x1, i2, d2x);
+        /* the output at index xpos is the one fwd samples from now */
+        fwd = xpos - indx;
+        if (fwd < 0) fwd += maxd;
+        for (j = 0; j < 2 * i2; j++) {
+          pos = (d->wp + (uint32) fwd) & d->mask;
+          for (c = 0; c < nlines; c++)
+            d[c].buf[pos] += (MYFLT) (n1[c] * wts[j]);
+          if (UNLIKELY(++fwd >= maxd)) fwd -= maxd;
+        }
+      }
+      else {                                    /* integer sample */
+        xpos = (int32)((double)xpos + x1 + 0.5);        /* position */
+        if (UNLIKELY(xpos >= maxd)) xpos -= maxd;
+        fwd = xpos - indx;
+        if (fwd < 0) fwd += maxd;
+        pos = (d->wp + (uint32) fwd) & d->mask;
+        for (c = 0; c < nlines; c++)
+          d[c].buf[pos] += in[c][i];
+      }
+      pos = d->wp & d->mask;
+      for (c = 0; c < nlines; c++) {
+        out[c][i] = d[c].buf[pos];
+        d[c].buf[pos] = FL(0.0);
+      }
+      if (UNLIKELY(++indx == maxd)) indx = 0;
+    }
+    for (c = 0; c < nlines; c++) {
+      d[c].wp = d->wp;
+      d[c].left = indx;
+    }
+}
+
+void delayline_read_taps(DELAYLINE *d, MYFLT *out, const int32 *del,
+                         const MYFLT *gain, int ntaps, uint32 n)
+{
+    uint32 i, at = d->wp - n;
+    const MYFLT *b;
+    MYFLT  g;
+    int    t;
+
+    memset(out, 0, n * sizeof(MYFLT));
+    for (t = 0; t < ntaps; t++) {
+      b = &d->buf[(at - (uint32) del[t]) & d->mask];
+      g = gain[t];
+      for (i = 0; i < n; i++)
+        out[i] += b[i] * g;
+    }
+}
@@ -629,10 +629,13 @@ int32_t insGlobevt(CSOUND *csound, EVTBLK *evt)
 int32_t MIDIsendevt(CSOUND *csound, MEVENT *evt, int32_t rfd)
 {
     REMOT_BUF *bp = &ST(CLsendbuf);
-    MEVENT *mep = (MEVENT *)bp->data;       /* align an MEVENT struct */
-    *mep = *evt;                            /*      & copy the data   */
+    REMOT_MEVENT *mep = (REMOT_MEVENT *)bp->data; /* the wire layout */
+    mep->type = evt->type;                  /*      & copy the data   */
+    mep->chan = evt->chan;
+    mep->dat1 = evt->dat1;
+    mep->dat2 = evt->dat2;
     bp->type = MIDI_EVT;                    /* insert type and len    */
-    bp->len = sizeof(int32_t) * 2 + sizeof(MEVENT);
+    bp->len = sizeof(int32_t) * 2 + sizeof(REMOT_MEVENT);
 
     if (UNLIKELY(CLsend(csound, rfd, (void *)bp, (size_t)bp->len) < 0)) {
       csound->ErrorMsg(csound, Str("CLsend failed"));
@@ -654,10 +657,13 @@ int32_t MIDIGlobevt(CSOUND *csound, MEVENT *evt)
 int32_t MIDIsend_msg(CSOUND *csound, MEVENT *evt, int32_t rfd)
 {
     REMOT_BUF *bp = &ST(CLsendbuf);
-    MEVENT *mep = (MEVENT *)bp->data;       /* align an MEVENT struct */
-    *mep = *evt;                            /*      & copy the data   */
+    REMOT_MEVENT *mep = (REMOT_MEVENT *)bp->data; /* the wire layout */
+    mep->type = evt->type;                  /*      & copy the data   */
+    mep->chan = evt->chan;
+    mep->dat1 = evt->dat1;
+    mep->dat2 = evt->dat2;
     bp->type = MIDI_MSG;                    /* insert type and len    */
-    bp->len = sizeof(int32_t) * 2 + sizeof(MEVENT);
+    bp->len = sizeof(int32_t) * 2 + sizeof(REMOT_MEVENT);
 
     if (UNLIKELY(CLsend(csound, rfd, (void *)bp, (size_t)bp->len) < 0)) {
       csound->ErrorMsg(csound, Str("CLsend failed"));
@@ -26,6 +26,7 @@
 #include "csoundCore.h"
 #include "namedins.h"
 #include "linevent.h"
+#include "cluster.h"
 /* Keep Microsoft's schedule.h from being used instead of our schedule.h. */
 #ifdef _MSC_VER
 #include "H/schedule.h"
@@ -506,6 +507,10 @@ static int32_t ktriginstr_(CSOUND *csound, TRIGINSTR *p, int32_t stringname)
       p->timrem = (int32_t) (*p->mintime * CS_EKR + FL(0.5));
     else
       p->timrem = 0;
+    /* in a cluster, the node of the instrument performs it */
+    if (UNLIKELY(csound->cluster != NULL) &&
+        csoundClusterForward(csound, p->h.insdshead, &evt, starttime))
+      return OK;
     return
       (insert_score_event_at_sample(csound, &evt, starttime) == 0 ? OK : NOTOK);
 }
@@ -38,16 +38,8 @@ int32_t vdelset(CSOUND *csound, VDEL *p)            /*  vdelay set-up   */
 {
     uint32 n = (int32_t)(*p->imaxd * ESR)+1;
 
-    if (!*p->istod) {
-      if (p->aux.auxp == NULL || (uint32_t)(n * sizeof(MYFLT)) > p->aux.size)
-        /* allocate space for delay buffer */
-        csound->AuxAlloc(csound, n * sizeof(MYFLT), &p->aux);
-      else {     /*    make sure buffer is empty       */
-        memset(p->aux.auxp, '\0', n*sizeof(MYFLT));
-      }
-      p->left = 0;
-    }
-    p->maxd = n - 1;
+    /* a line of n - 1 samples, wide enough for the cubic interpolator */
+    delayline_init(csound, &p->dl, n - 1, 4, *p->istod != FL(0.0));
     return OK;
 }
 
@@ -55,89 +47,25 @@ int32_t vdelay(CSOUND *csound, VDEL *p)               /*      vdelay  routine */
 {
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t nn, nsmps = CS_KSMPS;
-    int32_t  maxd, indx;
+    uint32_t nsmps = CS_KSMPS;
     MYFLT *out = p->sr;     /* assign object data to local variables   */
-    MYFLT *in = p->ain;
     MYFLT *del = p->adel;
-    MYFLT *buf = (MYFLT *)p->aux.auxp;
-    MYFLT esr = ESR;
 
-    if (UNLIKELY(buf==NULL)) goto err1;        /* RWD fix */
-    maxd = p->maxd;
-    indx = p->left;
+    if (UNLIKELY(p->dl.buf==NULL)) goto err1;        /* RWD fix */
     if (UNLIKELY(offset)) memset(out, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
       memset(&out[nsmps], '\0', early*sizeof(MYFLT));
     }
+    if (UNLIKELY(offset >= nsmps)) return OK;
 
-    if (IS_ASIG_ARG(p->adel)) {          /*      if delay is a-rate      */
-      for (nn=offset; nn<nsmps; nn++) {
-        MYFLT  fv1, fv2;
-        int32_t   v1, v2;
-
-        buf[indx] = in[nn];
-        fv1 = indx - (del[nn]) * esr;
-        /* Make sure Inside the buffer      */
-        /*
-         * The following has been fixed by adding a cast and making a
-         * ">=" instead of a ">" comparison. The order of the comparisons
-         * has been swapped as well (a bit of a nit, but comparing a
-         * possibly negative number to an unsigned isn't a good idea--and
-         * broke on Alpha).
-         * heh 981101
-         */
-        while (UNLIKELY(fv1 < FL(0.0)))
-          fv1 += (MYFLT)maxd;
-        while (UNLIKELY(fv1 >= (MYFLT)maxd))
-          fv1 -= (MYFLT)maxd;
-
-        if (LIKELY(fv1 < maxd - 1)) /* Find next sample for interpolation      */
-          fv2 = fv1 + FL(1.0);
-        else
-          fv2 = FL(0.0);
-
-        v1 = (int32_t)fv1;
-        v2 = (int32_t)fv2;
-        out[nn] = buf[v1] + (fv1 - v1) * ( buf[v2] - buf[v1]);
-
-        if (UNLIKELY(++indx == maxd))
-          indx = 0;             /* Advance current pointer */
-
-      }
-    }
-    else {                      /* and, if delay is k-rate */
-      MYFLT fdel=*del;
-      for (nn=offset; nn<nsmps; nn++) {
-        MYFLT  fv1, fv2;
-        int32_t   v1, v2;
-
-        buf[indx] = in[nn];
-        fv1 = indx - fdel * esr;
-        /* Make sure inside the buffer      */
-        /*
-         * See comment above--same fix applied here.  heh 981101
-         */
-        while (UNLIKELY(fv1 < FL(0.0)))
-          fv1 += (MYFLT)maxd;
-        while (UNLIKELY(fv1 >= (MYFLT)maxd))
-          fv1 -= (MYFLT)maxd;
-
-        if (LIKELY(fv1 < maxd - 1)) /* Find next sample for interpolation      */
-          fv2 = fv1 + FL(1.0);
-        else
-          fv2 = FL(0.0);
-
-        v1 = (int32_t)fv1;
-        v2 = (int32_t)fv2;
-        out[nn] = buf[v1] + (fv1 - v1) * ( buf[v2] - buf[v1]);
-
-        if (UNLIKELY(++indx == maxd)) indx = 0;   /*      Advance current pointer */
-
-      }
-    }
-    p->left = indx;             /*      and keep track of where you are */
+    delayline_write(&p->dl, &p->ain[offset], nsmps - offset);
+    if (IS_ASIG_ARG(p->adel))          /*      if delay is a-rate      */
+      delayline_read_linear(&p->dl, &out[offset], &del[offset], 1, ESR,
+                            nsmps - offset);
+    else                               /* and, if delay is k-rate */
+      delayline_read_linear(&p->dl, &out[offset], del, 0, ESR,
+                            nsmps - offset);
     return OK;
  err1:
     return csound->PerfError(csound, &(p->h),
@@ -148,107 +76,22 @@ int32_t vdelay3(CSOUND *csound, VDEL *p)    /*  vdelay routine with cubic interp
 {
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t nn, nsmps = CS_KSMPS;
-    int32_t  maxd, indx;
+    uint32_t nsmps = CS_KSMPS;
     MYFLT *out = p->sr;  /* assign object data to local variables   */
-    MYFLT *in = p->ain;
     MYFLT *del = p->adel;
-    MYFLT *buf = (MYFLT *)p->aux.auxp;
-    MYFLT esr = ESR;
+    int32_t a_rate = IS_ASIG_ARG(p->adel);
 
-    if (UNLIKELY(buf==NULL)) goto err1;            /* RWD fix */
-    maxd = p->maxd;
-    if (UNLIKELY(maxd == 0)) maxd = 1;    /* Degenerate case */
-    indx = p->left;
+    if (UNLIKELY(p->dl.buf==NULL)) goto err1;            /* RWD fix */
     if (UNLIKELY(offset)) memset(out, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
       memset(&out[nsmps], '\0', early*sizeof(MYFLT));
     }
+    if (UNLIKELY(offset >= nsmps)) return OK;
 
-    if (IS_ASIG_ARG(p->adel)) {              /*      if delay is a-rate      */
-      for (nn=offset; nn<nsmps; nn++) {
-        MYFLT  fv1;
-        int32_t   v0, v1, v2, v3;
-
-        buf[indx] = in[nn];      /* IV Oct 2001 */
-        fv1 = del[nn] * (-esr);
-        v1 = (int32_t)fv1;
-        fv1 -= (MYFLT) v1;
-        v1 += (int32_t)indx;
-        /* Make sure Inside the buffer      */
-        if ((v1 < 0L) || (fv1 < FL(0.0))) {
-          fv1++; v1--; while (UNLIKELY(v1 < 0L)) v1 += (int32_t)maxd;
-        }
-        else {
-          while (UNLIKELY(v1 >= (int32_t)maxd)) v1 -= (int32_t)maxd;
-        }
-        /* Find next sample for interpolation      */
-        v2 = (v1 == (int32_t)(maxd - 1UL) ? 0L : v1 + 1L);
-
-        if (maxd<4) {
-          out[nn] = buf[v1] + fv1 * (buf[v2] - buf[v1]);
-        }
-        else {
-          v0 = (v1==0 ? maxd-1 : v1-1);
-          v3 = (v2==(int32_t)maxd-1 ? 0 : v2+1);
-          {                     /* optimized by Istvan Varga (Oct 2001) */
-            MYFLT w, x, y, z;
-            z = fv1 * fv1; z--; z *= FL(0.1666666667);
-            y = fv1; y++; w = (y *= FL(0.5)); w--;
-            x = FL(3.0) * z; y -= x; w -= z; x -= fv1;
-            out[nn] = (w*buf[v0] + x*buf[v1] + y*buf[v2] + z*buf[v3])
-              * fv1 + buf[v1];
-          }
-        }
-        if (UNLIKELY(++indx == maxd))
-          indx = 0;             /* Advance current pointer */
-
-      };
-    }
-    else {                      /* and, if delay is k-rate */
-      MYFLT  fv1, w, x, y, z;
-      int32_t   v0, v1, v2, v3;
-
-      fv1 = *del * -esr; v1 = (int32_t)fv1; fv1 -= (MYFLT) v1;
-      v1 += (int32_t)indx;
-      /* Make sure Inside the buffer      */
-      if ((v1 < 0L) || (fv1 < FL(0.0))) {
-        fv1++; v1--; while (UNLIKELY(v1 < 0L)) v1 += (int32_t)maxd;
-      }
-      else {
-        while (UNLIKELY(v1 >= (int32_t)maxd)) v1 -= (int32_t)maxd;
-      }
-
-      if (maxd<4) {
-        for (nn=offset; nn<nsmps; nn++) {
-          /* Find next sample for interpolation      */
-          v2 = (v1 == (int32_t)(maxd - 1UL) ? 0L : v1 + 1L);
-          out[nn] = buf[v1] + fv1 * (buf[v2] - buf[v1]);
-          if (UNLIKELY(++v1 >= (int32_t)maxd)) v1 -= (int32_t)maxd;
-              if (UNLIKELY(++indx >= maxd)) indx -= maxd;
-        }
-      }
-      else {
-        /* calculate interpolation coeffs */
-        z = fv1 * fv1; z--; z *= FL(0.1666666667);      /* IV Oct 2001 */
-        y = fv1; y++; w = (y *= FL(0.5)); w--;
-        x = FL(3.0) * z; y -= x; w -= z; x -= fv1;
-        for (nn=offset; nn<nsmps; nn++) {
-          buf[indx] = in[nn];
-          /* Find next sample for interpolation      */
-          v2 = (v1 == (int32_t)(maxd - 1UL) ? 0L : v1 + 1L);
-          v0 = (v1 == 0L ? (int32_t)(maxd - 1UL) : v1 - 1L);
-          v3 = (v2 == (int32_t)(maxd - 1UL) ? 0L : v2 + 1L);
-          out[nn] = (w*buf[v0] + x*buf[v1] + y*buf[v2] + z*buf[v3])
-                     * fv1 + buf[v1];
-          if (UNLIKELY(++v1 >= (int32_t)maxd)) v1 -= (int32_t)maxd;
-          if (UNLIKELY(++indx >= maxd))
-            indx -= maxd;     /* Advance current pointer */
-        }
-      }
-    }
-    p->left = indx;             /*      and keep track of where you are */
+    delayline_write(&p->dl, &p->ain[offset], nsmps - offset);
+    delayline_read_cubic(&p->dl, &out[offset], a_rate ? &del[offset] : del,
+                         a_rate, ESR, nsmps - offset);
     return OK;
  err1:
     return csound->PerfError(csound, &(p->h),
@@ -258,575 +101,139 @@ int32_t vdelay3(CSOUND *csound, VDEL *p)    /*  vdelay routine with cubic interp
 /* vdelayx, vdelayxs, vdelayxq, vdelayxw, vdelayxws, vdelayxwq */
 /* coded by Istvan Varga, Mar 2001 */
 
-int32_t vdelxset(CSOUND *csound, VDELX *p)      /*  vdelayx set-up (1 channel) */
+static void vdelx_init(CSOUND *csound, DELAYLINE *dl, int nlines,
+                       MYFLT imaxd, MYFLT iquality, MYFLT istod,
+                       int *interp_size)
 {
-    uint32_t n = (int32_t)(*p->imaxd * csound->esr);
+    uint32_t n = (int32_t)(imaxd * csound->esr);
+    int i;
 
     if (UNLIKELY(n == 0)) n = 1;          /* fix due to Troxler */
 
-    if (!*p->istod) {
-      if (p->aux1.auxp == NULL || (uint32_t)(n * sizeof(MYFLT)) > p->aux1.size)
-        /* allocate space for delay buffer */
-        csound->AuxAlloc(csound, n * sizeof(MYFLT), &p->aux1);
-      else
-        memset(p->aux1.auxp, 0, n*sizeof(MYFLT));
-      p->left = 0;
-      p->interp_size = 4 * (int32_t) (FL(0.5) + FL(0.25) * *(p->iquality));
-      p->interp_size = (p->interp_size < 4 ? 4 : p->interp_size);
-      p->interp_size = (p->interp_size > 1024 ? 1024 : p->interp_size);
+    if (!istod) {
+      *interp_size = 4 * (int32_t) (FL(0.5) + FL(0.25) * iquality);
+      *interp_size = (*interp_size < 4 ? 4 : *interp_size);
+      *interp_size = (*interp_size > 1024 ? 1024 : *interp_size);
     }
-    p->maxd = (uint32) n;
+    for (i = 0; i < nlines; i++)
+      delayline_init(csound, &dl[i], n, *interp_size, istod != FL(0.0));
+}
+
+int32_t vdelxset(CSOUND *csound, VDELX *p)      /*  vdelayx set-up (1 channel) */
+{
+    vdelx_init(csound, &p->dl, 1, *p->imaxd, *p->iquality, *p->istod,
+               &p->interp_size);
     return OK;
 }
 
 int32_t vdelxsset(CSOUND *csound, VDELXS *p)    /*  vdelayxs set-up (stereo) */
 {
-    uint32_t n = (int32_t)(*p->imaxd * csound->esr);
-
-    if (UNLIKELY(n == 0)) n = 1;          /* fix due to Troxler */
-
-    if (!*p->istod) {
-      if (p->aux1.auxp == NULL || (uint32_t)(n * sizeof(MYFLT)) > p->aux1.size)
-        /* allocate space for delay buffer */
-        csound->AuxAlloc(csound, n * sizeof(MYFLT), &p->aux1);
-      else
-        memset(p->aux1.auxp, 0, n*sizeof(MYFLT));
-      if (p->aux2.auxp == NULL || (uint32_t)(n * sizeof(MYFLT)) > p->aux2.size)
-        csound->AuxAlloc(csound, n * sizeof(MYFLT), &p->aux2);
-      else
-        memset(p->aux2.auxp, 0, n*sizeof(MYFLT));
-
-      p->left = 0;
-      p->interp_size = 4 * (int32_t) (FL(0.5) + FL(0.25) * *(p->iquality));
-      p->interp_size = (p->interp_size < 4 ? 4 : p->interp_size);
-      p->interp_size = (p->interp_size > 1024 ? 1024 : p->interp_size);
-    }
-    p->maxd = (uint32) n;
+    vdelx_init(csound, p->dl, 2, *p->imaxd, *p->iquality, *p->istod,
+               &p->interp_size);
     return OK;
 }
 
 int32_t vdelxqset(CSOUND *csound, VDELXQ *p) /* vdelayxq set-up (quad channels) */
 {
-    uint32_t n = (int32_t)(*p->imaxd * csound->esr);
+    vdelx_init(csound, p->dl, 4, *p->imaxd, *p->iquality, *p->istod,
+               &p->interp_size);
+    return OK;
+}
 
-    if (UNLIKELY(n == 0)) n = 1;          /* fix due to Troxler */
+/* Runs nlines channels of the vdelayx family through lines dl, reading
+   (write == 0) or writing (vdelayxw) the delayed signal */
 
-    if (!*p->istod) {
-      if (p->aux1.auxp == NULL || (uint32_t)(n * sizeof(MYFLT)) > p->aux1.size)
-        /* allocate space for delay buffer */
-        csound->AuxAlloc(csound, n * sizeof(MYFLT), &p->aux1);
-      else
-        memset(p->aux1.auxp, 0, n*sizeof(MYFLT));
-      if (p->aux2.auxp == NULL || (uint32_t)(n * sizeof(MYFLT)) > p->aux2.size)
-        csound->AuxAlloc(csound, n * sizeof(MYFLT), &p->aux2);
-      else
-        memset(p->aux2.auxp, 0, n*sizeof(MYFLT));
-      if (p->aux3.auxp == NULL || (uint32_t)(n * sizeof(MYFLT)) > p->aux3.size)
-        csound->AuxAlloc(csound, n * sizeof(MYFLT), &p->aux3);
-      else
-        memset(p->aux3.auxp, 0, n*sizeof(MYFLT));
-      if (p->aux4.auxp == NULL || (uint32_t)(n * sizeof(MYFLT)) > p->aux4.size)
-        csound->AuxAlloc(csound, n * sizeof(MYFLT), &p->aux4);
-      else
-        memset(p->aux4.auxp, 0, n*sizeof(MYFLT));
-
-      p->left = 0;
-      p->interp_size = 4 * (int32_t) (FL(0.5) + FL(0.25) * *(p->iquality));
-      p->interp_size = (p->interp_size < 4 ? 4 : p->interp_size);
-      p->interp_size = (p->interp_size > 1024 ? 1024 : p->interp_size);
+static int32_t vdelx_perf(CSOUND *csound, OPDS *h, DELAYLINE *dl, int nlines,
+                          MYFLT **out, MYFLT **in, MYFLT *del,
+                          int interp_size, int write)
+{
+    uint32_t offset = h->insdshead->ksmps_offset;
+    uint32_t early  = h->insdshead->ksmps_no_end;
+    uint32_t nsmps = h->insdshead->ksmps;
+    MYFLT *o[4], *ii[4];
+    int i;
+
+    for (i = 0; i < nlines; i++)
+      if (UNLIKELY(dl[i].buf == NULL)) goto err1;          /* RWD fix */
+    if (UNLIKELY(early)) nsmps -= early;
+    for (i = 0; i < nlines; i++) {
+      if (UNLIKELY(offset)) memset(out[i], '\0', offset*sizeof(MYFLT));
+      if (UNLIKELY(early))
+        memset(&out[i][nsmps], '\0', early*sizeof(MYFLT));
+      o[i] = &out[i][offset];
+      ii[i] = &in[i][offset];
+    }
+    if (UNLIKELY(offset >= nsmps)) return OK;
+
+    if (write)
+      delayline_write_sinc(dl, nlines, o, ii, &del[offset], 1, csound->esr,
+                           interp_size, nsmps - offset);
+    else {
+      for (i = 0; i < nlines; i++)
+        delayline_write(&dl[i], ii[i], nsmps - offset);
+      delayline_read_sinc(dl, nlines, o, &del[offset], 1, csound->esr,
+                          interp_size, nsmps - offset);
     }
-    p->maxd = (uint32) n;
     return OK;
+ err1:
+    return csound->PerfError(csound, h, Str("vdelay: not initialised"));
 }
 
 int32_t vdelayx(CSOUND *csound, VDELX *p)               /*      vdelayx routine  */
 {
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t nn, nsmps = CS_KSMPS;
-    int32_t indx, maxd;
-    MYFLT *out1 = p->sr1;  /* assign object data to local variables   */
-    MYFLT *in1 = p->ain1;
-    MYFLT *del = p->adel;
-    MYFLT *buf1 = (MYFLT *)p->aux1.auxp;
-    int32_t   wsize = p->interp_size;
-    double x1, x2, w, d, d2x, n1;
-    int32_t   i, i2, xpos;
-
-    if (UNLIKELY(buf1 == NULL)) goto err1;                          /* RWD fix */
-    maxd = p->maxd;
-    if (UNLIKELY(maxd == 0)) maxd = 1;    /* Degenerate case */
-    indx = p->left;
-    i2 = (wsize >> 1);
-    d2x = (1.0 - pow ((double)wsize * 0.85172, -0.89624)) / (double)(i2 * i2);
-    if (UNLIKELY(offset)) memset(out1, '\0', offset*sizeof(MYFLT));
-    if (UNLIKELY(early)) {
-      nsmps -= early;
-      memset(&out1[nsmps], '\0', early*sizeof(MYFLT));
-    }
-
-    for (nn=offset; nn<nsmps; nn++) {
-      buf1[indx] = in1[nn];
-      n1 = 0.0;
-
-      /* x1: fractional part of delay time */
-      /* x2: sine of x1 (for interpolation) */
-      /* xpos: integer part of delay time (buffer position to read from) */
-
-      x1 = (double)indx - ((double)del[nn] * (double)csound->esr);
-      while (x1 < 0.0) x1 += (double)maxd;
-      xpos = (int32_t)x1;
-      x1 -= (double)xpos;
-      x2 = sin (PI * x1) / PI;
-      while (xpos >= maxd) xpos -= maxd;
-
-      if (x1 * (1.0 - x1) > 0.00000001) {
-        xpos += (1 - i2);
-        while (xpos < 0) xpos += maxd;
-        d = (double)(1 - i2) - x1;
-        for (i = i2; i--;) {
-          w = 1.0 - d*d*d2x; w *= (w / d++);
-          n1 += (double)buf1[xpos] * w;
-          if (UNLIKELY(++xpos >= maxd)) xpos -= maxd;
-          w = 1.0 - d*d*d2x; w *= (w / d++);
-          n1 -= (double)buf1[xpos] * w;
-          if (UNLIKELY(++xpos >= maxd)) xpos -= maxd;
-        }
-        out1[nn] = (MYFLT) (n1 * x2);
-      }
-      else {                                            /* integer sample */
-        xpos = (int32_t)((double)xpos + x1 + 0.5);      /* position */
-        if (UNLIKELY(xpos >= maxd)) xpos -= maxd;
-        out1[nn] = buf1[xpos];
-      }
-
-      if (UNLIKELY(++indx == maxd)) indx = 0;
-    }
-
-    p->left = indx;
-    return OK;
- err1:
-    return csound->PerfError(csound, &(p->h),
-                             Str("vdelay: not initialised"));
+    MYFLT *out[1], *in[1];
+    out[0] = p->sr1; in[0] = p->ain1;
+    return vdelx_perf(csound, &(p->h), &p->dl, 1, out, in, p->adel,
+                      p->interp_size, 0);
 }
 
 int32_t vdelayxw(CSOUND *csound, VDELX *p)      /*      vdelayxw routine  */
 {
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t nn, nsmps = CS_KSMPS;
-    int32_t  maxd, indx;
-    MYFLT *out1 = p->sr1;  /* assign object data to local variables   */
-    MYFLT *in1 = p->ain1;
-    MYFLT *del = p->adel;
-    MYFLT *buf1 = (MYFLT *)p->aux1.auxp;
-    int32_t   wsize = p->interp_size;
-    double x1, x2, w, d, d2x, n1;
-    int32_t   i, i2, xpos;
-
-    if (UNLIKELY(buf1 == NULL)) goto err1;                          /* RWD fix */
-    maxd =  p->maxd;
-    if (UNLIKELY(maxd == 0)) maxd = 1;    /* Degenerate case */
-    indx = p->left;
-    i2 = (wsize >> 1);
-    d2x = (1.0 - pow ((double)wsize * 0.85172, -0.89624)) / (double)(i2 * i2);
-
-    if (UNLIKELY(offset)) memset(out1, '\0', offset*sizeof(MYFLT));
-    if (UNLIKELY(early)) {
-      nsmps -= early;
-      memset(&out1[nsmps], '\0', early*sizeof(MYFLT));
-    }
-    for (nn=offset;nn<nsmps;nn++) {
-      /* x1: fractional part of delay time */
-      /* x2: sine of x1 (for interpolation) */
-      /* xpos: integer part of delay time (buffer position to read from) */
-
-      x1 = (double)indx + ((double)del[nn] * (double)csound->esr);
-      while (x1 < 0.0) x1 += (double)maxd;
-      xpos = (int32_t)x1;
-      x1 -= (double)xpos;
-      x2 = sin (PI * x1) / PI;
-      while (xpos >= maxd) xpos -= maxd;
-
-      if (LIKELY(x1 * (1.0 - x1) > 0.00000001)) {
-        n1 = (double)in1[nn] * x2;
-        xpos += (1 - i2);
-        while (xpos < 0) xpos += maxd;
-        d = (double)(1 - i2) - x1;
-        for (i = i2; i--;) {
-          w = 1.0 - d*d*d2x; w *= (w / d++);
-          buf1[xpos] += (MYFLT) (n1 * w);
-          if (UNLIKELY(++xpos >= maxd)) xpos -= maxd;
-          w = 1.0 - d*d*d2x; w *= (w / d++);
-          buf1[xpos] -= (MYFLT) (n1 * w);
-          if (UNLIKELY(++xpos >= maxd)) xpos -= maxd;
-        }
-      }
-      else {                                            /* integer sample */
-        xpos = (int32_t)((double)xpos + x1 + 0.5);      /* position */
-        if (UNLIKELY(xpos >= maxd)) xpos -= maxd;
-        buf1[xpos] += in1[nn];
-      }
-
-      out1[nn] = buf1[indx]; buf1[indx] = FL(0.0);
-      if (UNLIKELY(++indx == maxd)) indx = 0;
-    }
-
-    p->left = indx;
-    return OK;
- err1:
-    return csound->PerfError(csound, &(p->h),
-                             Str("vdelay: not initialised"));
+    MYFLT *out[1], *in[1];
+    out[0] = p->sr1; in[0] = p->ain1;
+    return vdelx_perf(csound, &(p->h), &p->dl, 1, out, in, p->adel,
+                      p->interp_size, 1);
 }
 
 int32_t vdelayxs(CSOUND *csound, VDELXS *p)     /*      vdelayxs routine  */
 {
-    int32_t  maxd, indx;
-    MYFLT *out1 = p->sr1;  /* assign object data to local variables   */
-    MYFLT *out2 = p->sr2;
-    MYFLT *in1 = p->ain1;
-    MYFLT *in2 = p->ain2;
-    MYFLT *del = p->adel;
-    MYFLT *buf1 = (MYFLT *)p->aux1.auxp;
-    MYFLT *buf2 = (MYFLT *)p->aux2.auxp;
-    int32_t   wsize = p->interp_size;
-    double x1, x2, w, d, d2x, n1, n2;
-    int32_t   i, i2, xpos;
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps = CS_KSMPS;
-
-    if (UNLIKELY((buf1 == NULL) || (buf2 == NULL))) goto err1; /* RWD fix */
-    maxd =  p->maxd;
-    if (UNLIKELY(maxd == 0)) maxd = 1;    /* Degenerate case */
-    indx = p->left;
-    i2 = (wsize >> 1);
-    d2x = (1.0 - pow ((double)wsize * 0.85172, -0.89624)) / (double)(i2 * i2);
-    if (UNLIKELY(offset)) {
-      memset(out1, '\0', offset*sizeof(MYFLT));
-      memset(out2, '\0', offset*sizeof(MYFLT));
-    }
-    if (UNLIKELY(early)) {
-      nsmps -= early;
-      memset(&out1[nsmps], '\0', early*sizeof(MYFLT));
-      memset(&out2[nsmps], '\0', early*sizeof(MYFLT));
-    }
-
-    for (n=offset; n<nsmps; n++) {
-      buf1[indx] = in1[n]; buf2[indx] = in2[n];
-      n1 = 0.0; n2 = 0.0;
-
-      /* x1: fractional part of delay time */
-      /* x2: sine of x1 (for interpolation) */
-      /* xpos: integer part of delay time (buffer position to read from) */
-
-      x1 = (double)indx - ((double)del[n] * (double)csound->esr);
-      while (UNLIKELY(x1 < 0.0)) x1 += (double)maxd;
-      xpos = (int32_t)x1;
-      x1 -= (double)xpos;
-      x2 = sin (PI * x1) / PI;
-      while (UNLIKELY(xpos >= maxd)) xpos -= maxd;
-
-      if (x1 * (1.0 - x1) > 0.00000001) {
-        xpos += (1 - i2);
-        while (UNLIKELY(xpos < 0)) xpos += maxd;
-        d = (double)(1 - i2) - x1;
-        for (i = i2; i--;) {
-          w = 1.0 - d*d*d2x; w *= (w / d++);
-          n1 += (double)buf1[xpos] * w; n2 += (double)buf2[xpos] * w;
-          if (UNLIKELY(++xpos >= maxd)) xpos -= maxd;
-          w = 1.0 - d*d*d2x; w *= (w / d++);
-          n1 -= (double)buf1[xpos] * w; n2 -= (double)buf2[xpos] * w;
-          if (UNLIKELY(++xpos >= maxd)) xpos -= maxd;
-        }
-        out1[n] = (MYFLT) (n1 * x2); out2[n] = (MYFLT) (n2 * x2);
-      }
-      else {                                            /* integer sample */
-        xpos = (int32_t)((double)xpos + x1 + 0.5);      /* position */
-        if (UNLIKELY(xpos >= maxd)) xpos -= maxd;
-        out1[n] = buf1[xpos]; out2[n] = buf2[xpos];
-      }
-
-      if (UNLIKELY(++indx == maxd)) indx = 0;
-    }
-
-    p->left = indx;
-    return OK;
- err1:
-    return csound->PerfError(csound, &(p->h),
-                             Str("vdelay: not initialised"));
+    MYFLT *out[2], *in[2];
+    out[0] = p->sr1; out[1] = p->sr2;
+    in[0] = p->ain1; in[1] = p->ain2;
+    return vdelx_perf(csound, &(p->h), p->dl, 2, out, in, p->adel,
+                      p->interp_size, 0);
 }
 
 int32_t vdelayxws(CSOUND *csound, VDELXS *p)    /*      vdelayxws routine  */
 {
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps = CS_KSMPS;
-    int32_t  maxd, indx;
-    MYFLT *out1 = p->sr1;  /* assign object data to local variables   */
-    MYFLT *out2 = p->sr2;
-    MYFLT *in1 = p->ain1;
-    MYFLT *in2 = p->ain2;
-    MYFLT *del = p->adel;
-    MYFLT *buf1 = (MYFLT *)p->aux1.auxp;
-    MYFLT *buf2 = (MYFLT *)p->aux2.auxp;
-    int32_t   wsize = p->interp_size;
-    double x1, x2, w, d, d2x, n1, n2;
-    int32_t   i, i2, xpos;
-
-    if (UNLIKELY((buf1 == NULL) || (buf2 == NULL))) goto err1;     /* RWD fix */
-    maxd =  p->maxd;
-    if (UNLIKELY(maxd == 0)) maxd = 1;    /* Degenerate case */
-    indx = p->left;
-    i2 = (wsize >> 1);
-    d2x = (1.0 - pow ((double)wsize * 0.85172, -0.89624)) / (double)(i2 * i2);
-
-    if (UNLIKELY(offset)) {
-      memset(out1, '\0', offset*sizeof(MYFLT));
-      memset(out2, '\0', offset*sizeof(MYFLT));
-    }
-    if (UNLIKELY(early)) {
-      nsmps -= early;
-      memset(&out1[nsmps], '\0', early*sizeof(MYFLT));
-      memset(&out2[nsmps], '\0', early*sizeof(MYFLT));
-    }
-    for (n=offset; n<nsmps; n++) {
-      /* x1: fractional part of delay time */
-      /* x2: sine of x1 (for interpolation) */
-      /* xpos: integer part of delay time (buffer position to read from) */
-
-      x1 = (double)indx + ((double)del[n] * (double)csound->esr);
-      while (UNLIKELY(x1 < 0.0)) x1 += (double)maxd;
-      xpos = (int32_t)x1;
-      x1 -= (double)xpos;
-      x2 = sin (PI * x1) / PI;
-      while (UNLIKELY(xpos >= maxd)) xpos -= maxd;
-
-      if (x1 * (1.0 - x1) > 0.00000001) {
-        n1 = (double)in1[n] * x2; n2 = (double)in2[n] * x2;
-        xpos += (1 - i2);
-        while (UNLIKELY(xpos < 0)) xpos += maxd;
-        d = (double)(1 - i2) - x1;
-        for (i = i2; i--;) {
-          w = 1.0 - d*d*d2x; w *= (w / d++);
-          buf1[xpos] += (MYFLT) (n1 * w); buf2[xpos] += (MYFLT) (n2 * w);
-          if (UNLIKELY(++xpos >= maxd)) xpos -= maxd;
-          w = 1.0 - d*d*d2x; w *= (w / d++);
-          buf1[xpos] -= (MYFLT) (n1 * w); buf2[xpos] -= (MYFLT) (n2 * w);
-          if (UNLIKELY(++xpos >= maxd)) xpos -= maxd;
-        }
-      }
-      else {                                            /* integer sample */
-        xpos = (int32_t)((double)xpos + x1 + 0.5);       /* position */
-        if (UNLIKELY(xpos >= maxd)) xpos -= maxd;
-        buf1[xpos] += in1[n]; buf2[xpos] += in2[n];
-      }
-
-      out1[n] = buf1[indx]; buf1[indx] = FL(0.0);
-      out2[n] = buf2[indx]; buf2[indx] = FL(0.0);
-      if (UNLIKELY(++indx == maxd)) indx = 0;
-    }
-
-    p->left = indx;
-    return OK;
- err1:
-    return csound->PerfError(csound, &(p->h),
-                             Str("vdelay: not initialised"));
+    MYFLT *out[2], *in[2];
+    out[0] = p->sr1; out[1] = p->sr2;
+    in[0] = p->ain1; in[1] = p->ain2;
+    return vdelx_perf(csound, &(p->h), p->dl, 2, out, in, p->adel,
+                      p->interp_size, 1);
 }
 
 int32_t vdelayxq(CSOUND *csound, VDELXQ *p)     /*      vdelayxq routine  */
 {
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps = CS_KSMPS;
-    int32_t  maxd, indx;
-    MYFLT *out1 = p->sr1;  /* assign object data to local variables   */
-    MYFLT *out2 = p->sr2;
-    MYFLT *out3 = p->sr3;
-    MYFLT *out4 = p->sr4;
-    MYFLT *in1 = p->ain1;
-    MYFLT *in2 = p->ain2;
-    MYFLT *in3 = p->ain3;
-    MYFLT *in4 = p->ain4;
-    MYFLT *del = p->adel;
-    MYFLT *buf1 = (MYFLT *)p->aux1.auxp;
-    MYFLT *buf2 = (MYFLT *)p->aux2.auxp;
-    MYFLT *buf3 = (MYFLT *)p->aux3.auxp;
-    MYFLT *buf4 = (MYFLT *)p->aux4.auxp;
-    int32_t   wsize = p->interp_size;
-    double x1, x2, w, d, d2x, n1, n2, n3, n4;
-    int32_t   i, i2, xpos;
-    /* RWD fix */
-    if (UNLIKELY((buf1 == NULL) || (buf2 == NULL) ||
-                 (buf3 == NULL) || (buf4 == NULL))) goto err1;
-    maxd =  p->maxd;
-    if (UNLIKELY(maxd == 0)) maxd = 1;    /* Degenerate case */
-    indx = p->left;
-    i2 = (wsize >> 1);
-    d2x = (1.0 - pow ((double)wsize * 0.85172, -0.89624)) / (double)(i2 * i2);
-
-    if (UNLIKELY(offset)) {
-      memset(out1, '\0', offset*sizeof(MYFLT));
-      memset(out2, '\0', offset*sizeof(MYFLT));
-      memset(out3, '\0', offset*sizeof(MYFLT));
-      memset(out4, '\0', offset*sizeof(MYFLT));
-    }
-    if (UNLIKELY(early)) {
-      nsmps -= early;
-      memset(&out1[nsmps], '\0', early*sizeof(MYFLT));
-      memset(&out2[nsmps], '\0', early*sizeof(MYFLT));
-      memset(&out3[nsmps], '\0', early*sizeof(MYFLT));
-      memset(&out4[nsmps], '\0', early*sizeof(MYFLT));
-    }
-
-    for (n=offset; n<nsmps; n++) {
-      buf1[indx] = in1[n]; buf2[indx] = in2[n];
-      buf3[indx] = in3[n]; buf4[indx] = in4[n];
-      n1 = 0.0; n2 = 0.0; n3 = 0.0; n4 = 0.0;
-
-      /* x1: fractional part of delay time */
-      /* x2: sine of x1 (for interpolation) */
-      /* xpos: integer part of delay time (buffer position to read from) */
-
-      x1 = (double)indx - ((double)*del++ * (double)csound->esr);
-      while (UNLIKELY(x1 < 0.0)) x1 += (double)maxd;
-      xpos = (int32_t)x1;
-      x1 -= (double)xpos;
-      x2 = sin (PI * x1) / PI;
-      while (UNLIKELY(xpos >= maxd)) xpos -= maxd;
-
-      if (LIKELY(x1 * (1.0 - x1) > 0.00000001)) {
-        xpos += (1 - i2);
-        while (UNLIKELY(xpos < 0)) xpos += maxd;
-        d = (double)(1 - i2) - x1;
-        for (i = i2; i--;) {
-          w = 1.0 - d*d*d2x; w *= (w / d++);
-          n1 += (double)buf1[xpos] * w; n2 += (double)buf2[xpos] * w;
-          n3 += (double)buf3[xpos] * w; n4 += (double)buf4[xpos] * w;
-          if (UNLIKELY(++xpos >= maxd)) xpos -= maxd;
-          w = 1.0 - d*d*d2x; w *= (w / d++);
-          n1 -= (double)buf1[xpos] * w; n2 -= (double)buf2[xpos] * w;
-          n3 -= (double)buf3[xpos] * w; n4 -= (double)buf4[xpos] * w;
-          if (UNLIKELY(++xpos >= maxd)) xpos -= maxd;
-        }
-        out1[n] = (MYFLT) (n1 * x2); out2[n] = (MYFLT) (n2 * x2);
-        out3[n] = (MYFLT) (n3 * x2); out4[n] = (MYFLT) (n4 * x2);
-      }
-      else {                                            /* integer sample */
-        xpos = (int32_t)((double)xpos + x1 + 0.5);       /* position */
-        if (UNLIKELY(xpos >= maxd)) xpos -= maxd;
-        out1[n] = buf1[xpos]; out2[n] = buf2[xpos];
-        out3[n] = buf3[xpos]; out4[n] = buf4[xpos];
-      }
-
-      if (UNLIKELY(++indx == maxd)) indx = 0;
-    }
-
-    p->left = indx;
-    return OK;
- err1:
-    return csound->PerfError(csound, &(p->h),
-                             Str("vdelay: not initialised"));
+    MYFLT *out[4], *in[4];
+    out[0] = p->sr1; out[1] = p->sr2; out[2] = p->sr3; out[3] = p->sr4;
+    in[0] = p->ain1; in[1] = p->ain2; in[2] = p->ain3; in[3] = p->ain4;
+    return vdelx_perf(csound, &(p->h), p->dl, 4, out, in, p->adel,
+                      p->interp_size, 0);
 }
 
 int32_t vdelayxwq(CSOUND *csound, VDELXQ *p)    /*      vdelayxwq routine  */
 {
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps = CS_KSMPS;
-    int32_t  maxd, indx;
-    MYFLT *out1 = p->sr1;  /* assign object data to local variables   */
-    MYFLT *out2 = p->sr2;
-    MYFLT *out3 = p->sr3;
-    MYFLT *out4 = p->sr4;
-    MYFLT *in1 = p->ain1;
-    MYFLT *in2 = p->ain2;
-    MYFLT *in3 = p->ain3;
-    MYFLT *in4 = p->ain4;
-    MYFLT *del = p->adel;
-    MYFLT *buf1 = (MYFLT *)p->aux1.auxp;
-    MYFLT *buf2 = (MYFLT *)p->aux2.auxp;
-    MYFLT *buf3 = (MYFLT *)p->aux3.auxp;
-    MYFLT *buf4 = (MYFLT *)p->aux4.auxp;
-    int32_t   wsize = p->interp_size;
-    double x1, x2, w, d, d2x, n1, n2, n3, n4;
-    int32_t   i, i2, xpos;
-    /* RWD fix */
-    if (UNLIKELY((buf1 == NULL) || (buf2 == NULL) ||
-                 (buf3 == NULL) || (buf4 == NULL))) goto err1;
-    maxd =  p->maxd;
-    if (UNLIKELY(maxd == 0)) maxd = 1;    /* Degenerate case */
-    indx = p->left;
-    i2 = (wsize >> 1);
-    d2x = (1.0 - pow ((double)wsize * 0.85172, -0.89624)) / (double)(i2 * i2);
-
-    if (UNLIKELY(offset)) {
-      memset(out1, '\0', offset*sizeof(MYFLT));
-      memset(out2, '\0', offset*sizeof(MYFLT));
-      memset(out3, '\0', offset*sizeof(MYFLT));
-      memset(out4, '\0', offset*sizeof(MYFLT));
-    }
-    if (UNLIKELY(early)) {
-      nsmps -= early;
-      memset(&out1[nsmps], '\0', early*sizeof(MYFLT));
-      memset(&out2[nsmps], '\0', early*sizeof(MYFLT));
-      memset(&out3[nsmps], '\0', early*sizeof(MYFLT));
-      memset(&out4[nsmps], '\0', early*sizeof(MYFLT));
-    }
-
-    for (n=offset; n<nsmps; n++) {
-      /* x1: fractional part of delay time */
-      /* x2: sine of x1 (for interpolation) */
-      /* xpos: integer part of delay time (buffer position to read from) */
-
-      x1 = (double)indx + ((double)del[n] * (double)csound->esr);
-      while (UNLIKELY(x1 < 0.0)) x1 += (double)maxd;
-      xpos = (int32_t)x1;
-      x1 -= (double)xpos;
-      x2 = sin (PI * x1) / PI;
-      while (UNLIKELY(xpos >= maxd)) xpos -= maxd;
-
-      if (x1 * (1.0 - x1) > 0.00000001) {
-        n1 = (double)in1[n] * x2; n2 = (double)in2[n] * x2;
-        n3 = (double)in3[n] * x2; n4 = (double)in4[n] * x2;
-        xpos += (1 - i2);
-        while (UNLIKELY(xpos < 0)) xpos += maxd;
-        d = (double)(1 - i2) - x1;
-        for (i = i2; i--;) {
-          w = 1.0 - d*d*d2x; w *= (w / d++);
-          buf1[xpos] += (MYFLT) (n1 * w); buf2[xpos] += (MYFLT) (n2 * w);
-          buf3[xpos] += (MYFLT) (n3 * w); buf4[xpos] += (MYFLT) (n4 * w);
-          if (UNLIKELY(++xpos >= maxd)) xpos -= maxd;
-          w = 1.0 - d*d*d2x; w *= (w / d++);
-          buf1[xpos] -= (MYFLT) (n1 * w); buf2[xpos] -= (MYFLT) (n2 * w);
-          buf3[xpos] -= (MYFLT) (n3 * w); buf4[xpos] -= (MYFLT) (n4 * w);
-          if (UNLIKELY(++xpos >= maxd)) xpos -= maxd;
-        }
-      }
-      else {                                            /* integer sample */
-        xpos = (int32_t)((double)xpos + x1 + 0.5);       /* position */
-        if (UNLIKELY(xpos >= maxd)) xpos -= maxd;
-        buf1[xpos] += in1[n]; buf2[xpos] += in2[n];
-        buf3[xpos] += in3[n]; buf4[xpos] += in4[n];
-      }
-
-      out1[n] = buf1[indx]; buf1[indx] = FL(0.0);
-      out2[n] = buf2[indx]; buf2[indx] = FL(0.0);
-      out3[n] = buf3[indx]; buf3[indx] = FL(0.0);
-      out4[n] = buf4[indx]; buf4[indx] = FL(0.0);
-      if (UNLIKELY(++indx == maxd)) indx = 0;
-    }
-
-    p->left = indx;
-    return OK;
- err1:
-    return csound->PerfError(csound, &(p->h),
-                             Str("vdelay: not initialised"));
+    MYFLT *out[4], *in[4];
+    out[0] = p->sr1; out[1] = p->sr2; out[2] = p->sr3; out[3] = p->sr4;
+    in[0] = p->ain1; in[1] = p->ain2; in[2] = p->ain3; in[3] = p->ain4;
+    return vdelx_perf(csound, &(p->h), p->dl, 4, out, in, p->adel,
+                      p->interp_size, 1);
 }
 
 int32_t multitap_set(CSOUND *csound, MDEL *p)
 {
-    uint32_t n, i;
+    uint32_t i;
     MYFLT max = FL(0.0);
 
     //if (UNLIKELY(p->INOCOUNT/2 == (MYFLT)p->INOCOUNT*FL(0.5)))
@@ -838,49 +245,39 @@ int32_t multitap_set(CSOUND *csound, MDEL *p)
       if (max < *p->ndel[i]) max = *p->ndel[i];
     }
 
-    n = (uint32_t)(csound->esr * max * sizeof(MYFLT));
-    if (p->aux.auxp == NULL ||    /* allocate space for delay buffer */
-        n > p->aux.size)
-      csound->AuxAlloc(csound, n, &p->aux);
-    else {
-      memset(p->aux.auxp, 0, n);
-    }
-
-    p->left = 0;
-    p->max = (int32_t)(csound->esr * max);
+    delayline_init(csound, &p->dl, (uint32)(csound->esr * max), 1, 0);
     return OK;
 }
 
 int32_t multitap_play(CSOUND *csound, MDEL *p)
 {                               /* assign object data to local variables   */
-    int32_t  indx = p->left, delay;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t i, n, nsmps = CS_KSMPS;
-    MYFLT *out = p->sr, *in = p->ain;
-    MYFLT *buf = (MYFLT *)p->aux.auxp;
-    MYFLT max = (MYFLT)p->max;
+    uint32_t i, nsmps = CS_KSMPS;
+    int32_t  ntaps = (p->INOCOUNT - 1) / 2;
+    int32_t  del[VARGMAX/2];
+    MYFLT    gain[VARGMAX/2];
+    MYFLT *out = p->sr;
 
-    if (UNLIKELY(buf==NULL)) goto err1;           /* RWD fix */
+    if (UNLIKELY(p->dl.buf==NULL)) goto err1;           /* RWD fix */
     if (UNLIKELY(offset)) memset(out, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
       memset(&out[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n=offset; n<nsmps; n++) {
-      MYFLT v = FL(0.0);
-      buf[indx] = in[n];        /*      Write input     */
-
-      if (UNLIKELY(++indx == max)) indx = 0;   /*      Advance input pointer   */
-      for (i = 0; i < p->INOCOUNT - 1; i += 2) {
-        delay = indx - (int32_t)(csound->esr * *p->ndel[i]);
-        if (UNLIKELY(delay < 0))
-          delay += (int32_t)max;
-        v += buf[delay] * *p->ndel[i+1]; /*      Write output    */
-      }
-      out[n] = v;
+    if (UNLIKELY(offset >= nsmps)) return OK;
+
+    /* a tap reads one sample less than its delay, and a delay of zero
+       the oldest sample of the line */
+    for (i = 0; i < (uint32_t) ntaps; i++) {
+      del[i] = (int32_t)(csound->esr * *p->ndel[2*i]) - 1;
+      if (UNLIKELY(del[i] < 0))
+        del[i] += (int32_t) p->dl.len;
+      gain[i] = *p->ndel[2*i+1];
     }
-    p->left = indx;
+    delayline_write(&p->dl, &p->ain[offset], nsmps - offset);
+    delayline_read_taps(&p->dl, &out[offset], del, gain, ntaps,
+                        nsmps - offset);
     return OK;
  err1:
     return csound->PerfError(csound, &(p->h),
@@ -23,6 +23,7 @@
 
 #include "csoundCore.h"         /*                      AFILTERS.C        */
 #include "ugens5.h"
+#include "filtcoefs.h"
 #include <math.h>
 
 extern int32_t rsnset(CSOUND *csound, RESON *p);
@@ -453,16 +454,55 @@ static int32_t bbutset(CSOUND *csound, BBFIL *p)    /*      Band set-up
 }
 
 
+/* Runs the butterworth sections over n samples with coefficients a[1]
+   to a[5] given per sample in co, which are left in a */
+
+static void butter_filter_a(uint32_t n, const MYFLT *in, MYFLT *out,
+                            double *a, double co[5][FILT_CHUNK])
+{
+    double t, y;
+    uint32_t nn;
+    int32_t  k;
+
+    for (nn=0; nn<n; nn++) {
+      t = (double)in[nn] - co[3][nn] * a[6] - co[4][nn] * a[7];
+      t = csoundUndenormalizeDouble(t); /* Not needed on AMD */
+      y = t * co[0][nn] + co[1][nn] * a[6] + co[2][nn] * a[7];
+      a[7] = a[6];
+      a[6] = t;
+      out[nn] = (MYFLT)y;
+    }
+    for (k=0; k<5; k++)
+      a[k+1] = co[k][n-1];
+}
+
+/* The k-rate filter loop, for blocks in which the a-rate parameters
+   do not change */
+
+static void butter_filter_k(uint32_t n, const MYFLT *in, MYFLT *out,
+                            double *a)
+{
+    double t, y;
+    uint32_t nn;
+
+    for (nn=0; nn<n; nn++) {
+      t = (double)in[nn] - a[4] * a[6] - a[5] * a[7];
+      t = csoundUndenormalizeDouble(t); /* Not needed on AMD */
+      y = t * a[1] + a[2] * a[6] + a[3] * a[7];
+      a[7] = a[6];
+      a[6] = t;
+      out[nn] = (MYFLT)y;
+    }
+}
+
 static int32_t hibuta(CSOUND *csound, BFIL *p) /*      Hipass filter       */
 {
-    MYFLT    *out, *in;
+    MYFLT    *out, *in, *afc = p->afc;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     uint32_t nsmps = CS_KSMPS;
-    double   *a;
-    double   t, y;
-    uint32_t nn;
-    a = p->a;
+    double   co[5][FILT_CHUNK];
+    uint32_t nn, i, n;
 
     in = p->ain;
     out = p->sr;
@@ -476,48 +516,37 @@ static int32_t hibuta(CSOUND *csound, BFIL *p) /*      Hipass filter       */
       memcpy(&out[offset], &in[offset], (nsmps-offset)*sizeof(MYFLT));
       return OK;
     }
+    if (UNLIKELY(offset >= nsmps)) return OK;
 
-    /* if (p->afc[0] != p->lkf)      { */
-    /*   p->lkf = p->afc[0]; */
-    /*   c = tan((double)(csound->pidsr * p->lkf)); */
-
-    /*   a[1] = 1.0 / ( 1.0 + ROOT2 * c + c * c); */
-    /*   a[2] = -(a[1] + a[1]); */
-    /*   a[3] = a[1]; */
-    /*   a[4] = 2.0 * ( c*c - 1.0) * a[1]; */
-    /*   a[5] = ( 1.0 - ROOT2 * c + c * c) * a[1]; */
-    /* } */
-    for (nn=offset; nn<nsmps; nn++) {
-      if (p->afc[nn] != p->lkf)      {
-        double c;
-        p->lkf = p->afc[nn];
-        c = tan((double)(csound->pidsr * p->lkf));
-
-        a[1] = 1.0 / ( 1.0 + ROOT2 * c + c * c);
-        a[2] = -(a[1] + a[1]);
-        a[3] = a[1];
-        a[4] = 2.0 * ( c*c - 1.0) * a[1];
-        a[5] = ( 1.0 - ROOT2 * c + c * c) * a[1];
+    if (filt_unchanged(&afc[offset], nsmps-offset, p->lkf)) {
+      butter_filter_k(nsmps-offset, &in[offset], &out[offset], p->a);
+      return OK;
+    }
+    for (nn=offset; nn<nsmps; nn+=n) {
+      n = (nsmps-nn < FILT_CHUNK ? nsmps-nn : FILT_CHUNK);
+      for (i=0; i<n; i++) {
+        double c = filt_tan((double)(csound->pidsr * afc[nn+i]));
+        double a1 = 1.0 / ( 1.0 + ROOT2 * c + c * c);
+        co[0][i] = a1;
+        co[1][i] = -(a1 + a1);
+        co[2][i] = a1;
+        co[3][i] = 2.0 * ( c*c - 1.0) * a1;
+        co[4][i] = ( 1.0 - ROOT2 * c + c * c) * a1;
       }
-      t = (double)in[nn] - a[4] * a[6] - a[5] * a[7];
-      t = csoundUndenormalizeDouble(t); /* Not needed on AMD */
-      y = t * a[1] + a[2] * a[6] + a[3] * a[7];
-      a[7] = a[6];
-      a[6] = t;
-      out[nn] = (MYFLT)y;
+      butter_filter_a(n, &in[nn], &out[nn], p->a, co);
     }
+    p->lkf = afc[nsmps-1];
     return OK;
 }
 
 static int32_t lobuta(CSOUND *csound, BFIL *p)       /*      Lopass filter       */
 {
-    MYFLT    *out, *in;
+    MYFLT    *out, *in, *afc = p->afc;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     uint32_t nsmps = CS_KSMPS;
-    double   *a = p->a;
-    double   t, y;
-    uint32_t nn;
+    double   co[5][FILT_CHUNK];
+    uint32_t nn, i, n;
 
     in = p->ain;
     out = p->sr;
@@ -532,47 +561,49 @@ static int32_t lobuta(CSOUND *csound, BFIL *p)       /*      Lopass filter
       nsmps -= early;
       memset(&out[nsmps], '\0', early*sizeof(MYFLT));
     }
+    if (UNLIKELY(offset >= nsmps)) return OK;
 
-    /* if (p->afc[0] != p->lkf)      { */
-    /*   p->lkf = p->afc[0]; */
-    /*   c = 1.0 / tan((double)(csound->pidsr * p->lkf)); */
-    /*   a[1] = 1.0 / ( 1.0 + ROOT2 * c + c * c); */
-    /*   a[2] = a[1] + a[1]; */
-    /*   a[3] = a[1]; */
-    /*   a[4] = 2.0 * ( 1.0 - c*c) * a[1]; */
-    /*   a[5] = ( 1.0 - ROOT2 * c + c * c) * a[1]; */
-    /* } */
-
-    for (nn=offset; nn<nsmps; nn++) {
-      if (p->afc[nn] != p->lkf) {
-        double c;
-        p->lkf = p->afc[nn];
-        c = 1.0 / tan((double)(csound->pidsr * p->lkf));
-        a[1] = 1.0 / ( 1.0 + ROOT2 * c + c * c);
-        a[2] = a[1] + a[1];
-        a[3] = a[1];
-        a[4] = 2.0 * ( 1.0 - c*c) * a[1];
-        a[5] = ( 1.0 - ROOT2 * c + c * c) * a[1];
+    if (filt_unchanged(&afc[offset], nsmps-offset, p->lkf)) {
+      butter_filter_k(nsmps-offset, &in[offset], &out[offset], p->a);
+      return OK;
+    }
+    for (nn=offset; nn<nsmps; nn+=n) {
+      n = (nsmps-nn < FILT_CHUNK ? nsmps-nn : FILT_CHUNK);
+      for (i=0; i<n; i++) {
+        double c = 1.0 / filt_tan((double)(csound->pidsr * afc[nn+i]));
+        double a1 = 1.0 / ( 1.0 + ROOT2 * c + c * c);
+        co[0][i] = a1;
+        co[1][i] = a1 + a1;
+        co[2][i] = a1;
+        co[3][i] = 2.0 * ( 1.0 - c*c) * a1;
+        co[4][i] = ( 1.0 - ROOT2 * c + c * c) * a1;
       }
-      t = (double)in[nn] - a[4] * a[6] - a[5] * a[7];
-      t = csoundUndenormalizeDouble(t); /* Not needed on AMD */
-      y = t * a[1] + a[2] * a[6] + a[3] * a[7];
-      a[7] = a[6];
-      a[6] = t;
-      out[nn] = (MYFLT)y;
+      butter_filter_a(n, &in[nn], &out[nn], p->a, co);
     }
+    p->lkf = afc[nsmps-1];
     return OK;
 }
 
+/* Whether the band filter parameters are those of the last coefficients
+   over the block */
+
+static int32_t bband_unchanged(BBFIL *p, int32_t asgbw, int32_t asgfr,
+                               uint32_t offset, uint32_t nsmps)
+{
+    return (asgbw ? filt_unchanged(&p->kbw[offset], nsmps-offset, p->lkb)
+                  : *p->kbw == p->lkb) &&
+           (asgfr ? filt_unchanged(&p->kfo[offset], nsmps-offset, p->lkf)
+                  : *p->kfo == p->lkf);
+}
+
 static int32_t bppasxx(CSOUND *csound, BBFIL *p)      /*      Bandpass filter     */
 {
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     uint32_t nsmps = CS_KSMPS;
     MYFLT       *out, *in;
-    double *a = p->a;
-    double t, y;
-    uint32_t nn;
+    double   co[5][FILT_CHUNK];
+    uint32_t nn, i, n;
     int32_t asgbw = IS_ASIG_ARG(p->kbw), asgfr = IS_ASIG_ARG(p->kfo);
 
     in = p->ain;
@@ -586,41 +617,30 @@ static int32_t bppasxx(CSOUND *csound, BBFIL *p)      /*      Bandpass filter
       nsmps -= early;
       memset(&out[nsmps], '\0', early*sizeof(MYFLT));
     }
-    /* if (p->kbw[0] != p->lkb || p->kfo[0] != p->lkf) { */
-    /*   p->lkf = p->kfo[0]; */
-    /*   p->lkb = p->kbw[0]; */
-    /*   c = 1.0 / tan((double)(csound->pidsr * p->lkb)); */
-    /*   d = 2.0 * cos((double)(csound->tpidsr * p->lkf)); */
-    /*   a[1] = 1.0 / (1.0 + c); */
-    /*   a[2] = 0.0; */
-    /*   a[3] = -a[1]; */
-    /*   a[4] = - c * d * a[1]; */
-    /*   a[5] = (c - 1.0) * a[1]; */
-    /* } */
-    //butter_filter(nsmps, offset, in, out, p->a);
-    for (nn=offset; nn<nsmps; nn++) {
-      MYFLT bw, fr;
-      bw = (asgbw ? p->kbw[nn] : *p->kbw);
-      fr = (asgfr ? p->kfo[nn] : *p->kfo);
-      if (bw != p->lkb || fr != p->lkf) {
-        double c, d;
-        p->lkf = fr;
-        p->lkb = bw;
-        c = 1.0 / tan((double)(csound->pidsr * bw));
-        d = 2.0 * cos((double)(csound->tpidsr * fr));
-        a[1] = 1.0 / (1.0 + c);
-        a[2] = 0.0;
-        a[3] = -a[1];
-        a[4] = - c * d * a[1];
-        a[5] = (c - 1.0) * a[1];
+    if (UNLIKELY(offset >= nsmps)) return OK;
+
+    if (bband_unchanged(p, asgbw, asgfr, offset, nsmps)) {
+      butter_filter_k(nsmps-offset, &in[offset], &out[offset], p->a);
+      return OK;
+    }
+    for (nn=offset; nn<nsmps; nn+=n) {
+      n = (nsmps-nn < FILT_CHUNK ? nsmps-nn : FILT_CHUNK);
+      for (i=0; i<n; i++) {
+        MYFLT bw = (asgbw ? p->kbw[nn+i] : *p->kbw);
+        MYFLT fr = (asgfr ? p->kfo[nn+i] : *p->kfo);
+        double c = 1.0 / filt_tan((double)(csound->pidsr * bw));
+        double d = 2.0 * fm_cos((double)(csound->tpidsr * fr));
+        double a1 = 1.0 / (1.0 + c);
+        co[0][i] = a1;
+        co[1][i] = 0.0;
+        co[2][i] = -a1;
+        co[3][i] = - c * d * a1;
+        co[4][i] = (c - 1.0) * a1;
       }
-      t = (double)in[nn] - a[4] * a[6] - a[5] * a[7];
-      t = csoundUndenormalizeDouble(t); /* Not needed on AMD */
-      y = t * a[1] + a[2] * a[6] + a[3] * a[7];
-      a[7] = a[6];
-      a[6] = t;
-      out[nn] = (MYFLT)y;
+      butter_filter_a(n, &in[nn], &out[nn], p->a, co);
     }
+    p->lkb = (asgbw ? p->kbw[nsmps-1] : *p->kbw);
+    p->lkf = (asgfr ? p->kfo[nsmps-1] : *p->kfo);
     return OK;
 }
 
@@ -630,9 +650,8 @@ static int32_t bpcutxx(CSOUND *csound, BBFIL *p)      /*      Band reject filter
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     uint32_t nsmps = CS_KSMPS;
     MYFLT       *out, *in;
-    double *a = p->a;
-    double t, y;
-    uint32_t nn;
+    double   co[5][FILT_CHUNK];
+    uint32_t nn, i, n;
     int32_t
       asgbw = IS_ASIG_ARG(p->kbw), asgfr = IS_ASIG_ARG(p->kfo);
 
@@ -648,30 +667,30 @@ static int32_t bpcutxx(CSOUND *csound, BBFIL *p)      /*      Band reject filter
       memcpy(&out[offset], &in[offset], (nsmps-offset)*sizeof(MYFLT));
       return OK;
     }
+    if (UNLIKELY(offset >= nsmps)) return OK;
 
-    for (nn=offset; nn<nsmps; nn++) {
-      MYFLT bw, fr;
-      bw = (asgbw ? p->kbw[nn] : *p->kbw);
-      fr = (asgfr ? p->kfo[nn] : *p->kfo);
-      if (bw != p->lkb || fr != p->lkf) {
-        double c, d;
-        p->lkf = fr;
-        p->lkb = bw;
-        c = tan((double)(csound->pidsr * bw));
-        d = 2.0 * cos((double)(csound->tpidsr * fr));
-        a[1] = 1.0 / (1.0 + c);
-        a[2] = - d * a[1];
-        a[3] = a[1];
-        a[4] = a[2];
-        a[5] = (1.0 - c) * a[1];
+    if (bband_unchanged(p, asgbw, asgfr, offset, nsmps)) {
+      butter_filter_k(nsmps-offset, &in[offset], &out[offset], p->a);
+      return OK;
+    }
+    for (nn=offset; nn<nsmps; nn+=n) {
+      n = (nsmps-nn < FILT_CHUNK ? nsmps-nn : FILT_CHUNK);
+      for (i=0; i<n; i++) {
+        MYFLT bw = (asgbw ? p->kbw[nn+i] : *p->kbw);
+        MYFLT fr = (asgfr ? p->kfo[nn+i] : *p->kfo);
+        double c = filt_tan((double)(csound->pidsr * bw));
+        double d = 2.0 * fm_cos((double)(csound->tpidsr * fr));
+        double a1 = 1.0 / (1.0 + c);
+        co[0][i] = a1;
+        co[1][i] = - d * a1;
+        co[2][i] = a1;
+        co[3][i] = co[1][i];
+        co[4][i] = (1.0 - c) * a1;
       }
-      t = (double)in[nn] - a[4] * a[6] - a[5] * a[7];
-      t = csoundUndenormalizeDouble(t); /* Not needed on AMD */
-      y = t * a[1] + a[2] * a[6] + a[3] * a[7];
-      a[7] = a[6];
-      a[6] = t;
-      out[nn] = (MYFLT)y;
+      butter_filter_a(n, &in[nn], &out[nn], p->a, co);
     }
+    p->lkb = (asgbw ? p->kbw[nsmps-1] : *p->kbw);
+    p->lkf = (asgfr ? p->kfo[nsmps-1] : *p->kfo);
     return OK;
 }
 
@@ -284,7 +284,7 @@ static int32_t array_err(CSOUND* csound, ARRAY_SET *p)
 static int32_t array_set(CSOUND* csound, ARRAY_SET *p)
 {
     ARRAYDAT* dat = p->arrayDat;
-    MYFLT* mem = dat->data;
+    MYFLT* mem;
     int32_t i;
     int32_t end, index, incr;
 
@@ -303,6 +303,7 @@ static int32_t array_set(CSOUND* csound, ARRAY_SET *p)
                                    "for dimensions %d\n"),
                                indefArgCount, dat->dimensions);
     }
+    mem = dat->data;
     index = 0;
     for (i=0;i<indefArgCount; i++) {
       end = (int)(*p->indexes[i]);
@@ -468,6 +469,200 @@ static int32_t tabarithset2(CSOUND *csound, TABARITH2 *p)
     return OK;
 }
 
+/* Fused elementwise expressions over k- and i-rate arrays.  The
+   compiler (create_fused_array_expression) lowers an expression such
+   as (kA[] * kB[] + kC[]) / 2 to one call whose first argument is a
+   postfix program: a letter per operand, 'A' for the first, upper case
+   for arrays and lower case for scalars, and + - * / for the operators.
+   The program is run over blocks of elements, so intermediate results
+   stay in a small scratch area and each operator is a simple loop the
+   C compiler can vectorise. */
+
+#define TABEXPR_MAXARGS (26)
+#define TABEXPR_BLOCK   (64)
+
+typedef struct {
+  OPDS h;
+  ARRAYDAT  *ans;
+  STRINGDAT *prog;
+  void      *args[TABEXPR_MAXARGS];
+  /* internal */
+  int32_t   plen, depth, irate;
+  char      code[3*TABEXPR_MAXARGS+2];
+  AUXCH     scratch;
+} TABEXPR;
+
+typedef struct {
+  const MYFLT *v;
+  int32_t     scalar;
+} TABEXPR_ITEM;
+
+static int32_t tabexpr_error(CSOUND *csound, TABEXPR *p, int32_t i)
+{
+    if (p->irate)
+      return csound->InitError(csound,
+                               Str("division by zero in array-var "
+                                   "at index %d"), i);
+    return csound->PerfError(csound, &(p->h),
+                             Str("division by zero in array-var "
+                                 "at index %d"), i);
+}
+
+static inline int32_t tabexpr_total(ARRAYDAT *a)
+{
+    int32_t i, n = a->sizes[0];
+    for (i=1; i<a->dimensions; i++) n *= a->sizes[i];
+    return n;
+}
+
+static int32_t tabexpr_eval(CSOUND *csound, TABEXPR *p)
+{
+    TABEXPR_ITEM st[TABEXPR_MAXARGS];
+    MYFLT   sval[TABEXPR_MAXARGS];
+    MYFLT   *scratch = (MYFLT*) p->scratch.auxp;
+    ARRAYDAT *ans = p->ans;
+    int32_t i, j, n = -1, base, m, sp;
+
+    for (i=0; i<p->plen; i++) {
+      char c = p->code[i];
+      if (c >= 'A' && c <= 'Z') {
+        ARRAYDAT *a = (ARRAYDAT*) p->args[c-'A'];
+        int32_t k;
+        if (UNLIKELY(a->data == NULL))
+          return csound->PerfError(csound, &(p->h),
+                                   Str("array-variable not initialised"));
+        k = tabexpr_total(a);
+        if (n < 0 || k < n) n = k;
+      }
+    }
+    if (UNLIKELY(ans->data == NULL))
+      return csound->PerfError(csound, &(p->h),
+                               Str("array-variable not initialised"));
+    if (n > (int32_t) (ans->allocated / sizeof(MYFLT)))
+      n = (int32_t) (ans->allocated / sizeof(MYFLT));
+
+    for (base=0; base<n; base+=TABEXPR_BLOCK) {
+      m = n - base < TABEXPR_BLOCK ? n - base : TABEXPR_BLOCK;
+      for (i=0, sp=0; i<p->plen; i++) {
+        char c = p->code[i];
+        if (c >= 'A' && c <= 'Z') {
+          st[sp].v = ((ARRAYDAT*) p->args[c-'A'])->data + base;
+          st[sp++].scalar = 0;
+        }
+        else if (c >= 'a' && c <= 'z') {
+          st[sp].v = (MYFLT*) p->args[c-'a'];
+          st[sp++].scalar = 1;
+        }
+        else {
+          const MYFLT *a = st[sp-2].v, *b = st[sp-1].v;
+          int32_t as = st[sp-2].scalar, bs = st[sp-1].scalar;
+          MYFLT   *out;
+          sp--;
+          if (as && bs) {     /* scalar result, computed once per block */
+            MYFLT x = *a, y = *b;
+            switch (c) {
+            case '+': sval[sp-1] = x + y; break;
+            case '-': sval[sp-1] = x - y; break;
+            case '*': sval[sp-1] = x * y; break;
+            default:
+              if (UNLIKELY(y == FL(0.0))) return tabexpr_error(csound, p, base);
+              sval[sp-1] = x / y;
+            }
+            st[sp-1].v = &sval[sp-1];
+            continue;
+          }
+          out = (i == p->plen-1) ? ans->data + base :
+                                   scratch + (sp-1)*TABEXPR_BLOCK;
+          if (c == '/') {
+            if (bs) {
+              if (UNLIKELY(*b == FL(0.0))) return tabexpr_error(csound, p, base);
+            }
+            else for (j=0; j<m; j++)
+              if (UNLIKELY(b[j] == FL(0.0)))
+                return tabexpr_error(csound, p, base+j);
+          }
+#define TABEXPR_LOOPS(OP)                                       \
+          if (as) { MYFLT x = *a;                               \
+            for (j=0; j<m; j++) out[j] = x OP b[j]; }           \
+          else if (bs) { MYFLT y = *b;                          \
+            for (j=0; j<m; j++) out[j] = a[j] OP y; }           \
+          else for (j=0; j<m; j++) out[j] = a[j] OP b[j];
+          switch (c) {
+          case '+': TABEXPR_LOOPS(+) break;
+          case '-': TABEXPR_LOOPS(-) break;
+          case '*': TABEXPR_LOOPS(*) break;
+          default:  TABEXPR_LOOPS(/) break;
+          }
+#undef TABEXPR_LOOPS
+          st[sp-1].v = out;
+          st[sp-1].scalar = 0;
+        }
+      }
+    }
+    return OK;
+}
+
+static int32_t tabexpr_init(CSOUND *csound, TABEXPR *p)
+{
+    ARRAYDAT *shape = NULL;
+    const char *s = p->prog->data;
+    int32_t i, sp = 0, nargs = 0;
+
+    p->plen = (int32_t) strlen(s);
+    if (UNLIKELY(p->plen >= (int32_t) sizeof(p->code)))
+      return csound->InitError(csound, "%s", Str("array expression too long"));
+    strcpy(p->code, s);
+    p->depth = 0;
+    for (i=0; i<p->plen; i++) {
+      char c = s[i];
+      if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z')) {
+        int32_t k = (c >= 'a') ? c - 'a' : c - 'A';
+        if (UNLIKELY(k >= (int32_t) p->INOCOUNT - 1))
+          return csound->InitError(csound, "%s",
+                                   Str("invalid array expression"));
+        if (c <= 'Z') {
+          ARRAYDAT *a = (ARRAYDAT*) p->args[k];
+          if (UNLIKELY(a->data == NULL))
+            return csound->InitError(csound, "%s",
+                                     Str("array-variable not initialised"));
+          if (shape == NULL) shape = a;
+          else {
+            int32_t d;
+            if (UNLIKELY(a->dimensions != shape->dimensions))
+              return csound->InitError(csound, "%s",
+                         Str("Dimensions do not match in array arithmetic"));
+            for (d=0; d<a->dimensions; d++)
+              if (UNLIKELY(a->sizes[d] != shape->sizes[d]))
+                return csound->InitError(csound, "%s",
+                         Str("Dimensions do not match in array arithmetic"));
+          }
+        }
+        nargs++;
+        if (++sp > p->depth) p->depth = sp;
+      }
+      else if (strchr("+-*/", c) != NULL && sp >= 2) sp--;
+      else return csound->InitError(csound, "%s",
+                                    Str("invalid array expression"));
+    }
+    if (UNLIKELY(sp != 1 || shape == NULL || nargs != (int32_t) p->INOCOUNT-1))
+      return csound->InitError(csound, "%s", Str("invalid array expression"));
+    if (p->ans->data != shape->data)
+      tabinit_like(csound, p->ans, shape);
+    if (p->scratch.auxp == NULL ||
+        p->scratch.size < p->depth*TABEXPR_BLOCK*sizeof(MYFLT))
+      csound->AuxAlloc(csound, p->depth*TABEXPR_BLOCK*sizeof(MYFLT),
+                       &p->scratch);
+    p->irate = 0;
+    return OK;
+}
+
+static int32_t tabexpr_i(CSOUND *csound, TABEXPR *p)
+{
+    if (UNLIKELY(tabexpr_init(csound, p) != OK)) return NOTOK;
+    p->irate = 1;
+    return tabexpr_eval(csound, p);
+}
+
 static int32_t tabadd(CSOUND *csound, TABARITH *p)
 {
     ARRAYDAT *ans = p->ans;
@@ -2338,6 +2533,31 @@ static int32_t get_array_total_size(ARRAYDAT* dat)
     return size;
 }
 
+/* Gives dst the shape of src, cleared.  The storage is only
+   reallocated when it is too small, so an unchanged size never
+   allocates. */
+static void tabcopy_resize(CSOUND *csound, TABCPY *p, int32_t arrayTotalSize)
+{
+    size_t ss = p->src->arrayMemberSize * (size_t) arrayTotalSize;
+
+    if (p->dst->sizes == NULL || p->dst->dimensions != p->src->dimensions)
+      p->dst->sizes = csound->ReAlloc(csound, p->dst->sizes,
+                                      sizeof(int32_t) * p->src->dimensions);
+    p->dst->dimensions = p->src->dimensions;
+    memcpy(p->dst->sizes, p->src->sizes, sizeof(int32_t) * p->src->dimensions);
+
+    if (p->dst->data == NULL) {
+      p->dst->data = csound->Calloc(csound, ss);
+      p->dst->allocated = ss;
+    } else {
+      if (ss > p->dst->allocated) {
+        p->dst->data = csound->ReAlloc(csound, p->dst->data, ss);
+        p->dst->allocated = ss;
+      }
+      memset(p->dst->data, 0, ss);
+    }
+}
+
 static int32_t tabcopy(CSOUND *csound, TABCPY *p)
 {
     int32_t i, arrayTotalSize, memMyfltSize;
@@ -2358,21 +2578,8 @@ static int32_t tabcopy(CSOUND *csound, TABCPY *p)
     memMyfltSize = p->src->arrayMemberSize / sizeof(MYFLT);
     p->dst->arrayMemberSize = p->src->arrayMemberSize;
 
-    if (arrayTotalSize != get_array_total_size(p->dst)) {
-      p->dst->dimensions = p->src->dimensions;
-
-      p->dst->sizes = csound->Malloc(csound, sizeof(int32_t) * p->src->dimensions);
-      memcpy(p->dst->sizes, p->src->sizes, sizeof(int32_t) * p->src->dimensions);
-
-      if (p->dst->data == NULL) {
-        p->dst->data = csound->Calloc(csound,
-                                      p->src->arrayMemberSize * arrayTotalSize);
-      } else {
-        p->dst->data = csound->ReAlloc(csound, p->dst->data,
-                        p->src->arrayMemberSize * arrayTotalSize);
-        memset(p->dst->data, 0, p->src->arrayMemberSize * arrayTotalSize);
-      }
-    }
+    if (arrayTotalSize != get_array_total_size(p->dst))
+      tabcopy_resize(csound, p, arrayTotalSize);
 
 
     for (i = 0; i < arrayTotalSize; i++) {
@@ -2404,21 +2611,8 @@ static int32_t tabcopy1(CSOUND *csound, TABCPY *p)
     memMyfltSize = p->src->arrayMemberSize / sizeof(MYFLT);
     p->dst->arrayMemberSize = p->src->arrayMemberSize;
 
-    if (arrayTotalSize != get_array_total_size(p->dst)) {
-      p->dst->dimensions = p->src->dimensions;
-
-      p->dst->sizes = csound->Malloc(csound, sizeof(int32_t) * p->src->dimensions);
-      memcpy(p->dst->sizes, p->src->sizes, sizeof(int32_t) * p->src->dimensions);
-
-      if (p->dst->data == NULL) {
-        p->dst->data = csound->Calloc(csound,
-                                      p->src->arrayMemberSize * arrayTotalSize);
-      } else {
-        p->dst->data = csound->ReAlloc(csound, p->dst->data,
-                        p->src->arrayMemberSize * arrayTotalSize);
-        memset(p->dst->data, 0, p->src->arrayMemberSize * arrayTotalSize);
-      }
-    }
+    if (arrayTotalSize != get_array_total_size(p->dst))
+      tabcopy_resize(csound, p, arrayTotalSize);
 
 
     for (i = 0; i < arrayTotalSize; i++) {
@@ -2455,21 +2649,8 @@ static int32_t tabcopy2(CSOUND *csound, TABCPY *p)
     arrayTotalSize = get_array_total_size(p->src);
     p->dst->arrayMemberSize = p->src->arrayMemberSize;
 
-    if (arrayTotalSize != get_array_total_size(p->dst)) {
-      p->dst->dimensions = p->src->dimensions;
-
-      p->dst->sizes = csound->Malloc(csound, sizeof(int32_t) * p->src->dimensions);
-      memcpy(p->dst->sizes, p->src->sizes, sizeof(int32_t) * p->src->dimensions);
-
-      if (p->dst->data == NULL) {
-        p->dst->data = csound->Calloc(csound,
-                                      p->src->arrayMemberSize * arrayTotalSize);
-      } else {
-        p->dst->data = csound->ReAlloc(csound, p->dst->data,
-                        p->src->arrayMemberSize * arrayTotalSize);
-        memset(p->dst->data, 0, p->src->arrayMemberSize * arrayTotalSize);
-      }
-    }
+    if (arrayTotalSize != get_array_total_size(p->dst))
+      tabcopy_resize(csound, p, arrayTotalSize);
     dest = (MYFLT*)p->dst->data;
     src = (MYFLT*)p->src->data;
     for (i=0;i<p->dst->dimensions; i++) {
@@ -2688,25 +2869,125 @@ static int32_t trim(CSOUND *csound, TRIM *p)
 }
 
 
+static int arg_is_var(ARG *arg, CS_VARIABLE *var)
+{
+    for (; arg != NULL; arg = arg->next)
+      if (arg->type == ARG_LOCAL && arg->argPtr == var) return 1;
+    return 0;
+}
+
+/* ARRAY VIEWS
+
+   getrow and contiguous slicearray results can be views: the output
+   array's data points into the input's storage instead of holding a
+   copy, and is re-pointed on every pass in case the input has moved.
+   Whether the output is a view is kept by the opcode (TABSLICE view,
+   FFT n), not in ARRAYDAT, and a view owns no storage (allocated is
+   0).  No other opcode ever writes a view, since array_can_view()
+   allows one only when nothing else in the instrument writes the
+   output, so there is nothing to copy on write.  The output is let go at deinit, before
+   the instance's variables can be freed, so that the input's storage
+   is only ever freed by the input.
+
+   Can the output array of h be a view of its input array?  Only if
+   nothing else in the instrument can write either of them while the
+   view is in use: the input must be local and written only at init
+   time before h, and the output must not be written by any other
+   opcode.  Opcodes without outputs are assumed to write to their array
+   arguments. */
+static int array_can_view(CSOUND *csound, OPDS *h, ARRAYDAT *in,
+                          ARRAYDAT *out)
+{
+    OPTXT       *self = h->optext, *t;
+    CS_VARIABLE *invar, *outvar;
+    int         after = 0;
+    IGN(csound);
+
+    if (h->insdshead == NULL || h->insdshead->instr == NULL ||
+        self->t.inArgs == NULL || self->t.outArgs == NULL ||
+        self->t.inArgs->type != ARG_LOCAL ||
+        self->t.outArgs->type != ARG_LOCAL ||
+        in->data == NULL || in->arrayType != out->arrayType ||
+        in->arrayType->freeVariableMemory != NULL)
+      return 0;
+    invar = (CS_VARIABLE*) self->t.inArgs->argPtr;
+    outvar = (CS_VARIABLE*) self->t.outArgs->argPtr;
+    if (invar == outvar) return 0;
+    for (t = h->insdshead->instr->nxtop; t != NULL; t = t->nxtop) {
+      OENTRY *ep = t->t.oentry;
+      int    perf = (ep == NULL || (ep->thread & 6) != 0);
+      if (t == self) {
+        after = 1;
+        continue;
+      }
+      if (arg_is_var(t->t.outArgs, outvar) ||
+          ((after || perf) && arg_is_var(t->t.outArgs, invar)))
+        return 0;
+      if (t->t.outArgCount == 0 &&
+          (arg_is_var(t->t.inArgs, outvar) ||
+           ((after || perf) && arg_is_var(t->t.inArgs, invar))))
+        return 0;
+    }
+    return 1;
+}
+
+/* point out at size members of in, offset MYFLTs in */
+static void array_view(CSOUND *csound, ARRAYDAT *out, ARRAYDAT *in,
+                       size_t offset, int32_t size)
+{
+    if (out->dimensions != 1) {
+      out->sizes = (int32_t*) csound->ReAlloc(csound, out->sizes,
+                                              sizeof(int32_t));
+      out->dimensions = 1;
+    }
+    out->sizes[0] = size;
+    out->arrayMemberSize = in->arrayMemberSize;
+    out->data = in->data + offset;
+}
+
+/* make out a view of in: its own storage, if any, is freed, and *view
+   is set for the opcode; on a reinit it is a view already */
+static void array_view_init(CSOUND *csound, OPDS *h, ARRAYDAT *out,
+                            ARRAYDAT *in, size_t offset, int32_t size,
+                            int32_t *view,
+                            int32_t (*deinit)(CSOUND *, void *))
+{
+    if (!*view) {
+      if (out->data != NULL) csound->Free(csound, out->data);
+      out->allocated = 0;
+      *view = 1;
+      csound->RegisterDeinitCallback(csound, h, deinit);
+    }
+    array_view(csound, out, in, offset, size);
+}
+
+/* out stops being a view, and has no data until it is next initialised */
+static void array_unview(ARRAYDAT *out, int32_t *view)
+{
+    if (*view) {
+      out->data = NULL;
+      out->allocated = 0;
+      *view = 0;
+    }
+}
+
 typedef struct {
   OPDS h;
   ARRAYDAT *tab, *tabin;
   MYFLT    *start, *end, *inc;
   int32_t   len;
+  int32_t   view;               /* tab is a view of tabin */
 } TABSLICE;
 
-
-static int32_t tabslice(CSOUND *csound, TABSLICE *p) {
-
-    MYFLT *tabin = p->tabin->data;
-    int32_t start = (int32_t) *p->start;
+static int32_t tabslice_range(CSOUND *csound, TABSLICE *p,
+                              int32_t *start, int32_t *size)
+{
     int32_t end   = (int32_t) *p->end;
     int32_t inc   = (int32_t) *p->inc;
-    int32_t size = (end - start)/inc + 1;
-    int32_t i, destIndex;
-    int32_t memMyfltSize = p->tabin->arrayMemberSize / sizeof(MYFLT);
 
-    if (UNLIKELY(size < 0))
+    *start = (int32_t) *p->start;
+    *size = (end - *start)/inc + 1;
+    if (UNLIKELY(*size < 0))
       return csound->InitError(csound, "%s",
                                Str("inconsistent start, end parameters"));
     if (UNLIKELY(p->tabin->dimensions!=1 || end >= p->tabin->sizes[0])) {
@@ -2717,6 +2998,25 @@ static int32_t tabslice(CSOUND *csound, TABSLICE *p) {
     if (UNLIKELY(inc<=0))
       return csound->InitError(csound, "%s",
                                Str("slice increment must be positive"));
+    return OK;
+}
+
+static int32_t tabslice(CSOUND *csound, TABSLICE *p) {
+
+    MYFLT *tabin = p->tabin->data;
+    int32_t start, size;
+    int32_t inc   = (int32_t) *p->inc;
+    int32_t end   = (int32_t) *p->end;
+    int32_t i, destIndex;
+    int32_t memMyfltSize = p->tabin->arrayMemberSize / sizeof(MYFLT);
+
+    if (UNLIKELY(tabslice_range(csound, p, &start, &size) != OK))
+      return NOTOK;
+    if (p->view) {
+      /* the input may have moved since the last pass */
+      array_view(csound, p->tab, p->tabin, start*memMyfltSize, size);
+      return OK;
+    }
     tabinit(csound, p->tab, size);
 
     for (i = start, destIndex = 0; i < end + 1; i+=inc, destIndex++) {
@@ -2728,6 +3028,29 @@ static int32_t tabslice(CSOUND *csound, TABSLICE *p) {
     return OK;
 }
 
+static int32_t tabslice_deinit(CSOUND *csound, void *p) {
+    IGN(csound);
+    array_unview(((TABSLICE*) p)->tab, &((TABSLICE*) p)->view);
+    return OK;
+}
+
+/* a contiguous slice is taken as a view of the input when possible */
+static int32_t tabslice_init(CSOUND *csound, TABSLICE *p) {
+    int32_t start, size;
+
+    if (UNLIKELY(tabslice_range(csound, p, &start, &size) != OK))
+      return NOTOK;
+    if ((int32_t) *p->inc == 1 &&
+        array_can_view(csound, &p->h, p->tabin, p->tab)) {
+      array_view_init(csound, &p->h, p->tab, p->tabin,
+                      start*(p->tabin->arrayMemberSize / sizeof(MYFLT)),
+                      size, &p->view, tabslice_deinit);
+      return OK;
+    }
+    array_unview(p->tab, &p->view);
+    return tabslice(csound, p);
+}
+
 //#include "str_ops.h"
 //// This cheats using strcpy opcode fake
 //static int32_t tabsliceS(CSOUND *csound, TABSLICE *p) {
@@ -3449,10 +3772,35 @@ int32_t perf_iceps(CSOUND *csound, FFT *p) {
     return OK;
 }
 
+/* getrow: rows are contiguous, so the output is a view of the row
+   when array_can_view() allows it (p->n is set), a copy otherwise */
+static inline void rows_copy(CSOUND *csound, FFT *p, int32_t start)
+{
+    int32_t bytes =  p->in->sizes[1]*sizeof(MYFLT);
+    start *= p->in->sizes[1];
+    if (p->n) {
+      array_view(csound, p->out, p->in, start, p->in->sizes[1]);
+      return;
+    }
+    memcpy(p->out->data,p->in->data+start,bytes);
+}
+
+static int32_t rows_deinit(CSOUND *csound, void *p) {
+    IGN(csound);
+    array_unview(((FFT*) p)->out, &((FFT*) p)->n);
+    return OK;
+}
+
 int32_t rows_init(CSOUND *csound, FFT *p) {
     if (p->in->dimensions == 2) {
       int32_t siz = p->in->sizes[1];
-      tabinit(csound, p->out, siz);
+      if (array_can_view(csound, &(p->h), p->in, p->out))
+        array_view_init(csound, &(p->h), p->out, p->in, 0, siz,
+                        &p->n, rows_deinit);
+      else {
+        array_unview(p->out, &p->n);
+        tabinit(csound, p->out, siz);
+      }
       return OK;
     }
     else
@@ -3463,9 +3811,7 @@ int32_t rows_init(CSOUND *csound, FFT *p) {
 int32_t rows_perf(CSOUND *csound, FFT *p) {
     int32_t start = *((MYFLT *)p->in2);
     if (LIKELY(start < p->in->sizes[0])) {
-      int32_t bytes =  p->in->sizes[1]*sizeof(MYFLT);
-      start *= p->in->sizes[1];
-      memcpy(p->out->data,p->in->data+start,bytes);
+      rows_copy(csound, p, start);
       return OK;
     }
     else return csound->PerfError(csound,  &(p->h),
@@ -3476,9 +3822,7 @@ int32_t rows_i(CSOUND *csound, FFT *p) {
   if (rows_init(csound,p) == OK) {
    int32_t start = *((MYFLT *)p->in2);
    if (LIKELY(start < p->in->sizes[0])) {
-      int32_t bytes =  p->in->sizes[1]*sizeof(MYFLT);
-      start *= p->in->sizes[1];
-      memcpy(p->out->data,p->in->data+start,bytes);
+      rows_copy(csound, p, start);
       return OK;
     }
     else return csound->InitError(csound, "%s",
@@ -3530,6 +3874,8 @@ int32_t cols_i(CSOUND *csound, FFT *p) {
 }
 
 
+/* Grows p to at least rows x columns.  The storage is only reallocated
+   when it is too small, so an unchanged size never allocates. */
 static inline void tabensure2D(CSOUND *csound, ARRAYDAT *p,
                                int32_t rows, int32_t columns)
 {
@@ -3543,10 +3889,18 @@ static inline void tabensure2D(CSOUND *csound, ARRAYDAT *p,
       ss = p->arrayMemberSize*rows*columns;
       if (p->data==NULL) {
         p->data = (MYFLT*)csound->Calloc(csound, ss);
+        p->allocated = ss;
+      }
+      else if (ss > p->allocated) {
+        p->data = (MYFLT*) csound->ReAlloc(csound, p->data, ss);
+        memset((char*)(p->data)+p->allocated, '\0', ss-p->allocated);
+        p->allocated = ss;
+      }
+      if (p->dimensions != 2) {
+        p->sizes = (int32_t*)csound->ReAlloc(csound, p->sizes,
+                                             sizeof(int32_t)*2);
         p->dimensions = 2;
-        p->sizes = (int32_t*)csound->Malloc(csound, sizeof(int32_t)*2);
       }
-      else p->data = (MYFLT*) csound->ReAlloc(csound, p->data, ss);
       p->sizes[0] = rows;  p->sizes[1] = columns;
     }
 }
@@ -4041,6 +4395,10 @@ static OENTRY arrayvars_localops[] =
     { "i.Ai", sizeof(ARRAY_GET),0, 1,      "i",    "k[]m", (SUBR)array_get  },
     { "i.Ak", sizeof(ARRAY_GET),0, 1,      "i",    "k[]z", (SUBR)array_get  },
     /* ******************************************** */
+    {"##array_expr.k", sizeof(TABEXPR), 0, 3, "k[]", "S*",
+     (SUBR)tabexpr_init, (SUBR)tabexpr_eval},
+    {"##array_expr.i", sizeof(TABEXPR), 0, 1, "i[]", "S*",
+     (SUBR)tabexpr_i},
     {"##add.[s]", sizeof(TABARITH), 0, 3, "a[]", "a[]a[]",
      (SUBR)tabarithset, (SUBR)tabaadd},
     {"##add.[]", sizeof(TABARITH), 0, 3, "k[]", "k[]k[]",
@@ -4254,15 +4612,15 @@ static OENTRY arrayvars_localops[] =
     { "tabslice", sizeof(TABSLICE), _QQ, 2, "k[]", "k[]iip",
       NULL, (SUBR) tabslice, NULL },
     { "slicearray.i", sizeof(TABSLICE), 0, 1, "i[]", "i[]iip",
-      (SUBR) tabslice, NULL, NULL },
-    { "slicearray.k", sizeof(TABSLICE), 0, 2, "k[]", "k[]iip",
-      (SUBR) tabslice, (SUBR) tabslice, NULL },
-    { "slicearray.a", sizeof(TABSLICE), 0, 2, "a[]", "a[]iip",
-      (SUBR) tabslice, (SUBR) tabslice, NULL },
-    { "slicearray.S", sizeof(TABSLICE), 0, 2, "S[]", "S[]iip",
-      (SUBR) tabslice, (SUBR) tabslice, NULL },
+      (SUBR) tabslice_init, NULL, NULL },
+    { "slicearray.k", sizeof(TABSLICE), 0, 3, "k[]", "k[]iip",
+      (SUBR) tabslice_init, (SUBR) tabslice, NULL },
+    { "slicearray.a", sizeof(TABSLICE), 0, 3, "a[]", "a[]iip",
+      (SUBR) tabslice_init, (SUBR) tabslice, NULL },
+    { "slicearray.S", sizeof(TABSLICE), 0, 3, "S[]", "S[]iip",
+      (SUBR) tabslice_init, (SUBR) tabslice, NULL },
     { "slicearray_i", sizeof(TABSLICE), 0, 1, ".[]", "i[]iip",
-      (SUBR) tabslice, NULL },
+      (SUBR) tabslice_init, NULL },
     { "trim.i", sizeof(TRIM), WI, 1, "", "i[]i", (SUBR)trim_i, NULL },
     { "trim.k", sizeof(TRIM), WI, 2, "", ".[]k", NULL, (SUBR)trim },
     { "trim_i", sizeof(TRIM), WI, 1, "", ".[]i", (SUBR)trim_i, NULL },
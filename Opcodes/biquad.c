@@ -82,6 +82,43 @@ static int32_t biquad(CSOUND *csound, BIQUAD *p)
 
 /* A-rate version of above -- JPff August 2001 */
 
+static int32_t biquadset_a(CSOUND *csound, BIQUADA *p)
+{
+    /* state: xnm1, xnm2, ynm1 and ynm2 of each channel */
+    return fbank_init(csound, &p->fb, p->out, p->in, 1, 4,
+                      *p->reinit != FL(0.0));
+}
+
+static int32_t biquad_a(CSOUND *csound, BIQUADA *p)
+{
+    uint32_t offset = p->h.insdshead->ksmps_offset;
+    uint32_t early  = p->h.insdshead->ksmps_no_end;
+    uint32_t i, nsmps = CS_KSMPS - early;
+    int32_t  c, n = p->fb.nchnls;
+    double   *xnm1 = p->fb.state, *xnm2 = xnm1 + n;
+    double   *ynm1 = xnm2 + n, *ynm2 = ynm1 + n;
+    double a0 = 1.0 / *p->a0, a1 = a0 * *p->a1, a2 = a0 * *p->a2;
+    double b0 = a0 * *p->b0, b1 = a0 * *p->b1, b2 = a0 * *p->b2;
+
+    if (UNLIKELY(fbank_load(csound, &(p->h), &p->fb, p->in,
+                            offset, nsmps) != OK))
+      return NOTOK;
+    for (i = offset; i < nsmps; i++) {
+      MYFLT *x = &p->fb.x[i * n];
+      for (c = 0; c < n; c++) {
+        double xn = (double)x[c];
+        double yn = b0*xn + b1*xnm1[c] + b2*xnm2[c] - a1*ynm1[c] - a2*ynm2[c];
+        xnm2[c] = xnm1[c];
+        xnm1[c] = xn;
+        ynm2[c] = ynm1[c];
+        ynm1[c] = yn;
+        x[c] = (MYFLT)yn;
+      }
+    }
+    fbank_store(&p->fb, 0, p->out, offset, nsmps);
+    return OK;
+}
+
 static int32_t biquada(CSOUND *csound, BIQUAD *p)
 {
      IGN(csound);
@@ -1597,6 +1634,8 @@ static int32_t mode(CSOUND *csound, MODE *p)
 static OENTRY localops[] = {
   { "biquad", S(BIQUAD),   0, 3, "a", "akkkkkko",
                                  (SUBR)biquadset,  (SUBR)biquad },
+  { "biquad.A", S(BIQUADA), 0, 3, "a[]", "a[]kkkkkko",
+                                 (SUBR)biquadset_a,  (SUBR)biquad_a },
 { "biquada", S(BIQUAD),  0, 3, "a", "aaaaaaao",
                                  (SUBR)biquadset, (SUBR)biquada },
 { "moogvcf", S(MOOGVCF), 0, 3, "a", "axxpo",
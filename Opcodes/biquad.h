@@ -25,6 +25,7 @@
 
                                                         /* biquad.h */
 #include "stdopcod.h"
+#include "filterbank.h"
 
                                 /* Structure for biquadratic filter */
 typedef struct {
@@ -33,6 +34,14 @@ typedef struct {
     double  xnm1, xnm2, ynm1, ynm2;
 } BIQUAD;
 
+                                /* Bank of biquads over an audio array */
+typedef struct {
+    OPDS    h;
+    ARRAYDAT *out, *in;
+    MYFLT   *b0, *b1, *b2, *a0, *a1, *a2, *reinit;
+    FBANK   fb;
+} BIQUADA;
+
                                 /* Structure for moogvcf filter */
 typedef struct {
     OPDS    h;
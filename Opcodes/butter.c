@@ -26,6 +26,7 @@
 /*              Copyright (c) May 1994.  All rights reserved            */
 
 #include "stdopcod.h"
+#include "filterbank.h"
 
 typedef struct  {
         OPDS    h;
@@ -41,11 +42,42 @@ typedef struct  {
         double  a[8];
 } BBFIL;
 
+typedef struct  {
+        OPDS    h;
+        ARRAYDAT *sr, *ain;
+        MYFLT   *kfc, *istor;
+        MYFLT   lkf;
+        double  a[6];
+        FBANK   fb;
+} BFILA;
+
 #include <math.h>
 //#define ROOT2 (1.4142135623730950488)
 
 static void butter_filter(uint32_t, uint32_t, MYFLT *, MYFLT *, double *);
 
+static void hibut_coefs(CSOUND *csound, double *a, MYFLT kfc)
+{
+    double c = tan((double)(csound->pidsr * kfc));
+
+    a[1] = 1.0 / ( 1.0 + ROOT2 * c + c * c);
+    a[2] = -(a[1] + a[1]);
+    a[3] = a[1];
+    a[4] = 2.0 * ( c*c - 1.0) * a[1];
+    a[5] = ( 1.0 - ROOT2 * c + c * c) * a[1];
+}
+
+static void lobut_coefs(CSOUND *csound, double *a, MYFLT kfc)
+{
+    double c = 1.0 / tan((double)(csound->pidsr * kfc));
+
+    a[1] = 1.0 / ( 1.0 + ROOT2 * c + c * c);
+    a[2] = a[1] + a[1];
+    a[3] = a[1];
+    a[4] = 2.0 * ( 1.0 - c*c) * a[1];
+    a[5] = ( 1.0 - ROOT2 * c + c * c) * a[1];
+}
+
 int32_t butset(CSOUND *csound, BFIL *p)      /*      Hi/Lo pass set-up   */
 {
      IGN(csound);
@@ -77,17 +109,8 @@ static int32_t hibut(CSOUND *csound, BFIL *p)       /*      Hipass filter
     }
 
     if (*p->kfc != p->lkf)      {
-      double    *a, c;
-
-      a = p->a;
       p->lkf = *p->kfc;
-      c = tan((double)(csound->pidsr * p->lkf));
-
-      a[1] = 1.0 / ( 1.0 + ROOT2 * c + c * c);
-      a[2] = -(a[1] + a[1]);
-      a[3] = a[1];
-      a[4] = 2.0 * ( c*c - 1.0) * a[1];
-      a[5] = ( 1.0 - ROOT2 * c + c * c) * a[1];
+      hibut_coefs(csound, p->a, p->lkf);
     }
     butter_filter(nsmps, offset, in, out, p->a);
     return OK;
@@ -115,15 +138,8 @@ static int32_t lobut(CSOUND *csound, BFIL *p)       /*      Lopass filter
     }
 
     if (*p->kfc != p->lkf) {
-      double     *a, c;
-      a = p->a;
       p->lkf = *p->kfc;
-      c = 1.0 / tan((double)(csound->pidsr * p->lkf));
-      a[1] = 1.0 / ( 1.0 + ROOT2 * c + c * c);
-      a[2] = a[1] + a[1];
-      a[3] = a[1];
-      a[4] = 2.0 * ( 1.0 - c*c) * a[1];
-      a[5] = ( 1.0 - ROOT2 * c + c * c) * a[1];
+      lobut_coefs(csound, p->a, p->lkf);
     }
 
     butter_filter(nsmps, offset, in, out, p->a);
@@ -148,6 +164,71 @@ static void butter_filter(uint32_t n, uint32_t offset,
     }
 }
 
+/* Filter banks: one filter per channel of an audio array */
+
+static int32_t butset_a(CSOUND *csound, BFILA *p)
+{
+    if (*p->istor==FL(0.0)) p->lkf = FL(0.0);
+    /* state: a[6] and a[7] of each channel */
+    return fbank_init(csound, &p->fb, p->sr, p->ain, 1, 2,
+                      *p->istor != FL(0.0));
+}
+
+static void butter_bank(FBANK *fb, uint32_t offset, uint32_t nsmps,
+                        const double *a)
+{
+    int32_t  c, n = fb->nchnls;
+    double   *s1 = fb->state, *s2 = fb->state + n;
+    double   a1 = a[1], a2 = a[2], a3 = a[3], a4 = a[4], a5 = a[5];
+    uint32_t nn;
+
+    for (nn = offset; nn < nsmps; nn++) {
+      MYFLT *x = &fb->x[nn * n];
+      for (c = 0; c < n; c++) {
+        double t = (double)x[c] - a4 * s1[c] - a5 * s2[c];
+        t = csoundUndenormalizeDouble(t);
+        x[c] = (MYFLT)(t * a1 + a2 * s1[c] + a3 * s2[c]);
+        s2[c] = s1[c];
+        s1[c] = t;
+      }
+    }
+}
+
+static int32_t butter_bank_perf(CSOUND *csound, BFILA *p, int32_t high)
+{
+    uint32_t offset = p->h.insdshead->ksmps_offset;
+    uint32_t early  = p->h.insdshead->ksmps_no_end;
+    uint32_t nsmps = CS_KSMPS - early;
+
+    if (UNLIKELY(fbank_load(csound, &(p->h), &p->fb, p->ain,
+                            offset, nsmps) != OK))
+      return NOTOK;
+    if (*p->kfc <= FL(0.0)) {   /* hipass passes through, lopass is silent */
+      if (!high)
+        memset(p->fb.x, 0, (size_t) CS_KSMPS * p->fb.nchnls * sizeof(MYFLT));
+      fbank_store(&p->fb, 0, p->sr, offset, nsmps);
+      return OK;
+    }
+    if (*p->kfc != p->lkf) {
+      p->lkf = *p->kfc;
+      if (high) hibut_coefs(csound, p->a, p->lkf);
+      else lobut_coefs(csound, p->a, p->lkf);
+    }
+    butter_bank(&p->fb, offset, nsmps, p->a);
+    fbank_store(&p->fb, 0, p->sr, offset, nsmps);
+    return OK;
+}
+
+static int32_t hibut_a(CSOUND *csound, BFILA *p)
+{
+    return butter_bank_perf(csound, p, 1);
+}
+
+static int32_t lobut_a(CSOUND *csound, BFILA *p)
+{
+    return butter_bank_perf(csound, p, 0);
+}
+
 #define S(x)    sizeof(x)
 
 static OENTRY localops[] = {
@@ -155,6 +236,10 @@ static OENTRY localops[] = {
 { "butterlp.k", S(BFIL), 0, 3, "a",    "ako",  (SUBR)butset,   (SUBR)lobut  },
 { "buthp.k",    S(BFIL),  0, 3, "a",   "ako",  (SUBR)butset,   (SUBR)hibut  },
 { "butlp.k",    S(BFIL),  0, 3, "a",   "ako",  (SUBR)butset,   (SUBR)lobut  },
+{ "butterhp.A", S(BFILA), 0, 3, "a[]",  "a[]ko", (SUBR)butset_a, (SUBR)hibut_a },
+{ "butterlp.A", S(BFILA), 0, 3, "a[]",  "a[]ko", (SUBR)butset_a, (SUBR)lobut_a },
+{ "buthp.A",    S(BFILA), 0, 3, "a[]",  "a[]ko", (SUBR)butset_a, (SUBR)hibut_a },
+{ "butlp.A",    S(BFILA), 0, 3, "a[]",  "a[]ko", (SUBR)butset_a, (SUBR)lobut_a },
 };
 
 int32_t butter_init_(CSOUND *csound)
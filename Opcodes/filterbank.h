@@ -0,0 +1,123 @@
+/*
+    filterbank.h:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+#ifndef CSOUND_FILTERBANK_H
+#define CSOUND_FILTERBANK_H
+
+#include "arrays.h"
+
+/* Filter banks: the a[] versions of butterlp, butterhp, biquad,
+   moogladder and svfilter run one filter per element of the input
+   array, all with the same coefficients.
+
+   A recursive filter cannot be vectorised along time, but the channels
+   are independent, so the block is transposed so that the samples of
+   all the channels at one instant are contiguous, and each filter state
+   is kept as an array over the channels.  The inner loops of the banks
+   then run over channels with no dependency between iterations. */
+
+typedef struct {
+    int32_t nchnls;
+    MYFLT   *x;         /* nblocks blocks of ksmps x nchnls samples */
+    double  *state;     /* nstate arrays of nchnls values */
+    AUXCH   aux;
+} FBANK;
+
+/* Sizes the output array like the input and allocates the blocks and
+   nstate state arrays, zeroed unless keep is set and the channel count
+   is unchanged */
+static inline int32_t fbank_init(CSOUND *csound, FBANK *b, ARRAYDAT *out,
+                                 ARRAYDAT *in, int32_t nblocks,
+                                 int32_t nstate, int32_t keep)
+{
+    uint32_t span;
+    int32_t  n;
+    size_t   nbytes;
+
+    if (UNLIKELY(in->data == NULL || in->dimensions != 1))
+      return csound->InitError(csound, "%s",
+                               Str("filter bank input must be a "
+                                   "one-dimensional audio array"));
+    n = in->sizes[0];
+    span = in->arrayMemberSize / sizeof(MYFLT);
+    if (out != NULL) tabinit(csound, out, n);
+    nbytes = (size_t) n * (span * nblocks * sizeof(MYFLT)
+                           + nstate * sizeof(double));
+    if (keep && b->aux.auxp != NULL && b->nchnls == n &&
+        b->aux.size >= nbytes)
+      return OK;
+    if (b->aux.auxp == NULL || nbytes > b->aux.size)
+      csound->AuxAlloc(csound, nbytes, &b->aux);
+    else
+      memset(b->aux.auxp, 0, nbytes);
+    b->nchnls = n;
+    b->state = (double*) b->aux.auxp;
+    b->x = (MYFLT*) (b->state + (size_t) n * nstate);
+    return OK;
+}
+
+/* Transposes samples offset to nsmps of every channel into the first
+   block */
+static inline int32_t fbank_load(CSOUND *csound, OPDS *h, FBANK *b,
+                                 ARRAYDAT *in, uint32_t offset,
+                                 uint32_t nsmps)
+{
+    uint32_t span = in->arrayMemberSize / sizeof(MYFLT), i;
+    int32_t  c, n = b->nchnls;
+    MYFLT    *x = b->x;
+
+    if (UNLIKELY(x == NULL))
+      return csound->PerfError(csound, h, "%s",
+                               Str("filter bank not initialised"));
+    if (UNLIKELY(in->sizes[0] != n))
+      return csound->PerfError(csound, h,
+                               Str("filter bank input changed from %d to "
+                                   "%d channels"), n, in->sizes[0]);
+    for (c = 0; c < n; c++) {
+      const MYFLT *s = &in->data[c * span];
+      for (i = offset; i < nsmps; i++)
+        x[i * n + c] = s[i];
+    }
+    return OK;
+}
+
+/* Transposes block k back into the output array, with zeros outside
+   offset to nsmps */
+static inline void fbank_store(FBANK *b, int32_t k, ARRAYDAT *out,
+                               uint32_t offset, uint32_t nsmps)
+{
+    uint32_t span = out->arrayMemberSize / sizeof(MYFLT), i;
+    int32_t  c, n = b->nchnls;
+    const MYFLT *x = b->x + (size_t) k * span * n;
+
+    for (c = 0; c < n; c++) {
+      MYFLT *d = &out->data[c * span];
+      if (UNLIKELY(offset)) memset(d, '\0', offset * sizeof(MYFLT));
+      for (i = offset; i < nsmps; i++)
+        d[i] = x[i * n + c];
+      if (UNLIKELY(nsmps < span))
+        memset(&d[nsmps], '\0', (span - nsmps) * sizeof(MYFLT));
+    }
+}
+
+#endif
@@ -40,6 +40,7 @@ static CS_NOINLINE int32_t fout_deinit_callback(CSOUND *csound, void *p_)
     struct fileinTag  *pp;
     p->sf = (SNDFILE*) NULL;
     p->f = (FILE*) NULL;
+    p->async = 0;
     if (p->idx) {
       pp = &(((STDOPCOD_GLOBALS*) csound->stdOp_Env)->file_opened[p->idx - 1]);
       p->idx = 0;
@@ -164,7 +165,15 @@ static CS_NOINLINE int32_t fout_open_file(CSOUND *csound, FOUT_FILE *p, void *fp
       if ((strcmp(filemode, "rb") == 0 || (strcmp(filemode, "wb") == 0)))
             csFileType = CSFTYPE_OTHER_BINARY;
       else  csFileType = CSFTYPE_OTHER_TEXT;
-      fd = csound->FileOpen2(csound, &f, fileType, name, fileParams, "",
+      if (p != (FOUT_FILE*) NULL && forceSync == 0) {
+        /* fout streams: formatted by the file thread */
+        p->fd = fd = csound->FileOpenAsync(csound, &f, fileType, name,
+                                           fileParams, "", csFileType,
+                                           p->bufsize, 0);
+        p->async = 1;
+      }
+      else
+        fd = csound->FileOpen2(csound, &f, fileType, name, fileParams, "",
                                csFileType, 0);
       if (UNLIKELY(fd == NULL)) {
         csound->InitError(csound, Str("error opening file '%s'"), name);
@@ -174,6 +183,7 @@ static CS_NOINLINE int32_t fout_open_file(CSOUND *csound, FOUT_FILE *p, void *fp
       /* setvbuf(f, (char *) NULL, _IOLBF, 0); */ /* Ensure line buffering */
       pp->file_opened[idx].raw = f;
       pp->file_opened[idx].fd = fd;
+      pp->file_opened[idx].async = (p != (FOUT_FILE*) NULL && p->async);
     }
     else {
       SNDFILE *sf;
@@ -241,6 +251,7 @@ static CS_NOINLINE int32_t fout_open_file(CSOUND *csound, FOUT_FILE *p, void *fp
       pp->file_opened[idx].file = sf;
       pp->file_opened[idx].fd = fd;
       pp->file_opened[idx].do_scale = do_scale;
+      pp->file_opened[idx].async = p->async;
     }
     /* store file information */
     pp->file_opened[idx].name = name;
@@ -262,6 +273,11 @@ static CS_NOINLINE int32_t fout_open_file(CSOUND *csound, FOUT_FILE *p, void *fp
         p->sf = pp->file_opened[idx].file;
         p->f = (FILE*) NULL;
       }
+      /* writers sharing an asynchronous file all go through its ring */
+      if (fileType != CSFILE_SND_R) {
+        p->fd = pp->file_opened[idx].fd;
+        p->async = pp->file_opened[idx].async;
+      }
       p->idx = idx + 1;
       pp->file_opened[idx].refCount++;
       if (need_deinit) {
@@ -273,6 +289,40 @@ static CS_NOINLINE int32_t fout_open_file(CSOUND *csound, FOUT_FILE *p, void *fp
     return idx;
 }
 
+/* fout formats beyond the libsndfile table, written as text or as
+   binary columns (see csoundSetAsyncFormat()) by the file thread */
+#define FOUT_FORMAT_TEXT    51
+#define FOUT_FORMAT_COLUMNS 52
+
+static int32_t fout_open_stream(CSOUND *csound, FOUT_FILE *p, MYFLT *iFile,
+                                int32_t istring, int32_t format_,
+                                int32_t columns)
+{
+    int32_t format = (format_ == FOUT_FORMAT_TEXT ?
+                      ASYNC_FMT_TEXT : ASYNC_FMT_COLUMNS);
+    int32_t n = fout_open_file(csound, p, NULL, CSFILE_STD, iFile, istring,
+                               format == ASYNC_FMT_TEXT ? "w" : "wb", 0);
+    if (UNLIKELY(n < 0))
+      return NOTOK;
+    if (!p->async) {
+      /* a file opened by fiopen: text is still written with fprintf */
+      if (UNLIKELY(format != ASYNC_FMT_TEXT))
+        return csound->InitError(csound, Str("fout: cannot write columns "
+                                             "to a file opened by fiopen"));
+    }
+    else if (UNLIKELY(csound->SetAsyncFormat(csound, p->fd, format,
+                                             columns) != OK)) {
+      if (((STDOPCOD_GLOBALS*) csound->stdOp_Env)->file_opened[n].refCount > 1)
+        return csound->InitError(csound, Str("fout: '%s' is already written "
+                                             "in another format or with "
+                                             "another number of columns"),
+                                 csound->GetFileName(p->fd));
+      return csound->InitError(csound, Str("fout: cannot start writing '%s'"),
+                               csound->GetFileName(p->fd));
+    }
+    return n;
+}
+
 static int32_t outfile(CSOUND *csound, OUTFILE *p)
 {
     uint32_t offset = p->h.insdshead->ksmps_offset;
@@ -282,7 +332,7 @@ static int32_t outfile(CSOUND *csound, OUTFILE *p)
     MYFLT *buf = (MYFLT *) p->buf.auxp;
 
     if (UNLIKELY(early)) nsmps -= early;
-    if (p->f.sf == NULL) {
+    if (p->f.sf == NULL && p->f.async == 0) {
       if (p->f.f != NULL) { /* VL: make sure there is an open file */
         FILE  *fp = p->f.f;
         for (k = offset; k < nsmps; k++) {
@@ -324,7 +374,7 @@ static int32_t outfile_array(CSOUND *csound, OUTFILEA *p)
     MYFLT *data = p->tabin->data;
 
     if (UNLIKELY(early)) nsmps -= early;
-    if (p->f.sf == NULL) {
+    if (p->f.sf == NULL && p->f.async == 0) {
       if (p->f.f != NULL) { /* VL: make sure there is an open file */
         FILE  *fp = p->f.f;
         for (k = offset; k < nsmps; k++) {
@@ -394,7 +444,7 @@ static int32_t fout_flush_callback(CSOUND *csound, void *p_)
 {
     OUTFILE            *p = (OUTFILE*) p_;
 
-    if (p->f.sf != NULL && p->buf_pos > 0) {
+    if ((p->f.sf != NULL || p->f.async) && p->buf_pos > 0) {
       //#ifndef USE_DOUBLE
       //sf_write_float(p->f.sf, (float*) p->buf.auxp, p->buf_pos);
       //#else
@@ -412,7 +462,7 @@ static int32_t fouta_flush_callback(CSOUND *csound, void *p_)
 {
     OUTFILEA           *p = (OUTFILEA*) p_;
 
-    if (p->f.sf != NULL && p->buf_pos > 0) {
+    if ((p->f.sf != NULL || p->f.async) && p->buf_pos > 0) {
       //#ifndef USE_DOUBLE
       //sf_write_float(p->f.sf, (float*) p->buf.auxp, p->buf_pos);
       //#else
@@ -462,6 +512,14 @@ static int32_t outfile_set_S(CSOUND *csound, OUTFILE *p/*, int32_t istring*/)
       csound->AuxAlloc(csound, sizeof(MYFLT)*buf_reqd, &p->buf);
     }
     p->f.bufsize =  p->buf.size;
+    if (format_ == FOUT_FORMAT_TEXT || format_ == FOUT_FORMAT_COLUMNS) {
+      if (UNLIKELY(fout_open_stream(csound, &(p->f), p->fname, istring,
+                                    format_, p->nargs) < 0))
+        return NOTOK;
+      p->scaleFac = FL(1.0);
+      csound->RegisterDeinitCallback(csound, p, fout_flush_callback);
+      return OK;
+    }
     sfinfo.channels = p->nargs;
     n = fout_open_file(csound, &(p->f), NULL, CSFILE_SND_W,
                        p->fname, istring, &sfinfo, 0);
@@ -520,6 +578,14 @@ static int32_t outfile_set_A(CSOUND *csound, OUTFILEA *p)
       csound->AuxAlloc(csound, sizeof(MYFLT)*buf_reqd, &p->buf);
     }
     p->f.bufsize =  p->buf.size;
+    if (format_ == FOUT_FORMAT_TEXT || format_ == FOUT_FORMAT_COLUMNS) {
+      if (UNLIKELY(fout_open_stream(csound, &(p->f), p->fname, 1,
+                                    format_, len) < 0))
+        return NOTOK;
+      p->scaleFac = FL(1.0);
+      csound->RegisterDeinitCallback(csound, p, fouta_flush_callback);
+      return OK;
+    }
     sfinfo.channels = len;
     n = fout_open_file(csound, &(p->f), NULL, CSFILE_SND_W,
                        p->fname, 1, &sfinfo, 0);
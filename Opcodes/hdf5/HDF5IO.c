@@ -19,6 +19,7 @@
 
 #include "HDF5IO.h"
 #include <string.h>
+#include <stdarg.h>
 #ifdef _MSC_VER
 #include <io.h>
 #else
@@ -26,7 +27,11 @@
 #endif
 
 #define HDF5ERROR(x) if (UNLIKELY((x) == -1)) \
-    {csound->Die(csound, #x" error\nExiting\n");}
+    {HDF5IO_die(csound, #x" error\nExiting\n");}
+
+// Errors on the i/o thread are returned, the performance pass reports them
+#define HDF5CHECK(x) if (UNLIKELY((x) == -1)) \
+    {return NOTOK;}
 
 // Type strings to match the enum types
 static const char typeStrings[8][12] = {
@@ -162,7 +167,7 @@ HDF5File *HDF5IO_newHDF5File(CSOUND *csound, AUXCH *hdf5FileMemory,
       }
       else {
 
-        csound->Die(csound, "hdf5read: Error, file does not exist");
+        HDF5IO_die(csound, "hdf5read: Error, file does not exist");
       }
     }
     else {
@@ -256,6 +261,406 @@ bool HDF5IO_getSampleAccurate(CSOUND *csound)
     return parameters.sampleAccurate;
 }
 
+// Find if csound is running in real-time mode, a full or empty stream
+// buffer is not waited for in this mode
+
+bool HDF5IO_getRealtime(CSOUND *csound)
+{
+    OPARMS parameters = {0};
+    csound->GetOParms(csound, &parameters);
+    return parameters.realtime;
+}
+
+// Get the globals created when the plugin is loaded
+
+HDF5IOGlobals *HDF5IO_getGlobals(CSOUND *csound)
+{
+    HDF5IOGlobals *globals = csound->QueryGlobalVariable(csound, "HDF5IO");
+
+    if (UNLIKELY(globals == NULL)) {
+
+      csound->Die(csound, "%s", Str("HDF5IO: Error, globals not found, exiting"));
+    }
+
+    return globals;
+}
+
+// Take and release the globals mutex in the performance pass
+//
+// The flag tells HDF5IO_die to release the mutex before Die unwinds, the
+// i/o thread never dies so it takes the mutex directly
+
+void HDF5IO_lock(CSOUND *csound, HDF5IOGlobals *globals)
+{
+    csound->LockMutex(globals->mutex);
+    globals->isLocked = true;
+}
+
+void HDF5IO_unlock(CSOUND *csound, HDF5IOGlobals *globals)
+{
+    globals->isLocked = false;
+    csound->UnlockMutex(globals->mutex);
+}
+
+// Stop csound with an error, releasing the globals mutex if it is held
+
+void HDF5IO_die(CSOUND *csound, const char *format, ...)
+{
+    HDF5IOGlobals *globals = csound->QueryGlobalVariable(csound, "HDF5IO");
+    char message[1024];
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+
+    if (globals != NULL && globals->isLocked == true) {
+
+      HDF5IO_unlock(csound, globals);
+    }
+
+    csound->Die(csound, "%s", message);
+}
+
+// Get the amount of rows for a block of frames of an a-rate or k-rate dataset
+//
+// An a-rate row is one frame, so use the frames but at least ksmps
+// A k-rate row is one control period, so divide by ksmps, at least 1
+
+size_t HDF5IO_getRowCount(CSOUND *csound, ArgumentType type, int32_t frames)
+{
+    size_t ksmps = csound->GetKsmps(csound);
+
+    if (type == ARATE_VAR || type == ARATE_ARRAY) {
+
+      return (size_t)frames > ksmps ? (size_t)frames : ksmps;
+    }
+
+    return (size_t)frames / ksmps > 1 ? (size_t)frames / ksmps : 1;
+}
+
+// Set up a dataset to be streamed through the i/o thread
+//
+// A row is one element of the first dimension, so get the row size from the
+// remaining dimensions
+// Allocate the block dimensions and offset used to select rows in the file
+// Allocate the i/o buffer the thread reads or writes a block of rows with
+// Create the ring buffer of rows between the performance pass and the thread
+
+void HDF5IO_newDatasetStream(CSOUND *csound, HDF5Dataset *dataset,
+                             const hsize_t *rowDimensions, size_t ioRows,
+                             size_t ringRows)
+{
+    int32_t i;
+    dataset->rowSize = 1;
+
+    csound->AuxAlloc(csound, dataset->rank * sizeof(hsize_t),
+                     &dataset->blockDimensionsMemory);
+    dataset->blockDimensions = dataset->blockDimensionsMemory.auxp;
+
+    csound->AuxAlloc(csound, dataset->rank * sizeof(hsize_t),
+                     &dataset->blockOffsetMemory);
+    dataset->blockOffset = dataset->blockOffsetMemory.auxp;
+
+    for (i = 1; i < dataset->rank; ++i) {
+
+      dataset->rowSize *= rowDimensions[i];
+      dataset->blockDimensions[i] = rowDimensions[i];
+      dataset->blockOffset[i] = 0;
+    }
+
+    csound->AuxAlloc(csound, ioRows * dataset->rowSize * sizeof(MYFLT),
+                     &dataset->ioBufferMemory);
+    dataset->ioBuffer = dataset->ioBufferMemory.auxp;
+    dataset->ioBufferRows = ioRows;
+
+    dataset->ringBuffer =
+      csound->CreateCircularBuffer(csound, (int32_t)ringRows,
+                                   (int32_t)(dataset->rowSize * sizeof(MYFLT)));
+    dataset->pendingRows = 0;
+    dataset->pendingStart = 0;
+    dataset->ioOffset = 0;
+    dataset->lostRows = 0;
+    dataset->latePeriods = 0;
+    dataset->isStreamed = true;
+}
+
+// Write the rows queued by the performance pass to a streamed dataset
+//
+// Fill the i/o buffer from the ring buffer
+// Write once the buffer holds a whole chunk, or when draining, whatever is left
+// Enlarge the dataset to the end of the block, select the block as a hyperslab
+// and write it
+// Increment the file offset by the rows written
+
+int32_t HDF5IO_writeRows(CSOUND *csound, HDF5Stream *stream,
+                         HDF5Dataset *dataset, bool drain)
+{
+    while (true) {
+
+      dataset->pendingRows +=
+        csound->ReadCircularBuffer(csound, dataset->ringBuffer,
+                          &dataset->ioBuffer[dataset->pendingRows *
+                                             dataset->rowSize],
+                          (int32_t)(dataset->ioBufferRows - dataset->pendingRows));
+
+      if (dataset->pendingRows < dataset->ioBufferRows
+          &&
+          (drain == false || dataset->pendingRows == 0)) {
+
+        return OK;
+      }
+
+      dataset->blockOffset[0] = dataset->ioOffset;
+      dataset->blockDimensions[0] = dataset->pendingRows;
+      dataset->datasetSize[0] = dataset->ioOffset + dataset->pendingRows;
+
+      HDF5CHECK(H5Dset_extent(dataset->datasetID, dataset->datasetSize));
+      hid_t filespace = H5Dget_space(dataset->datasetID);
+      HDF5CHECK(filespace);
+      HDF5CHECK(H5Sselect_hyperslab(filespace, H5S_SELECT_SET,
+                                    dataset->blockOffset, NULL,
+                                    dataset->blockDimensions, NULL));
+      hid_t memspace = H5Screate_simple(dataset->rank, dataset->blockDimensions,
+                                        NULL);
+      HDF5CHECK(memspace);
+      HDF5CHECK(H5Dwrite(dataset->datasetID, stream->hdf5File->floatSize,
+                         memspace, filespace, H5P_DEFAULT, dataset->ioBuffer));
+      HDF5CHECK(H5Sclose(filespace));
+      HDF5CHECK(H5Sclose(memspace));
+
+      dataset->ioOffset += dataset->pendingRows;
+      dataset->pendingRows = 0;
+    }
+}
+
+// Read rows ahead of the performance pass from a streamed dataset
+//
+// If the i/o buffer is empty, read the next block of rows from the file,
+// unless all rows have been read
+// Queue as many of the rows in the i/o buffer as fit in the ring buffer
+// Stop when the ring buffer is full, the rows left are queued on the next call
+
+int32_t HDF5IO_readRows(CSOUND *csound, HDF5Stream *stream,
+                        HDF5Dataset *dataset)
+{
+    while (true) {
+
+      if (dataset->pendingRows == 0) {
+
+        if (dataset->ioOffset >= dataset->datasetSize[0]) {
+
+          return OK;
+        }
+
+        size_t rows = (size_t)(dataset->datasetSize[0] - dataset->ioOffset);
+
+        if (rows > dataset->ioBufferRows) {
+
+          rows = dataset->ioBufferRows;
+        }
+
+        dataset->blockOffset[0] = dataset->ioOffset;
+        dataset->blockDimensions[0] = rows;
+
+        hid_t filespace = H5Dget_space(dataset->datasetID);
+        HDF5CHECK(filespace);
+        HDF5CHECK(H5Sselect_hyperslab(filespace, H5S_SELECT_SET,
+                                      dataset->blockOffset, NULL,
+                                      dataset->blockDimensions, NULL));
+        hid_t memspace = H5Screate_simple(dataset->rank,
+                                          dataset->blockDimensions, NULL);
+        HDF5CHECK(memspace);
+        HDF5CHECK(H5Dread(dataset->datasetID, stream->hdf5File->floatSize,
+                          memspace, filespace, H5P_DEFAULT, dataset->ioBuffer));
+        HDF5CHECK(H5Sclose(filespace));
+        HDF5CHECK(H5Sclose(memspace));
+
+        dataset->ioOffset += rows;
+        dataset->pendingStart = 0;
+        dataset->pendingRows = rows;
+      }
+
+      size_t queued =
+        csound->WriteCircularBuffer(csound, dataset->ringBuffer,
+                                    &dataset->ioBuffer[dataset->pendingStart *
+                                                       dataset->rowSize],
+                                    (int32_t)dataset->pendingRows);
+      dataset->pendingStart += queued;
+      dataset->pendingRows -= queued;
+
+      if (dataset->pendingRows > 0) {
+
+        return OK;
+      }
+    }
+}
+
+// Move the rows of every streamed dataset of an opcode instance
+//
+// Must be called with the globals mutex held
+// After an error the stream is left alone, the performance pass reports it
+
+void HDF5IO_serviceStream(CSOUND *csound, HDF5Stream *stream, bool drain)
+{
+    int32_t i;
+
+    if (stream->error != 0) {
+
+      return;
+    }
+
+    for (i = 0; i < stream->datasetCount; ++i) {
+
+      HDF5Dataset *dataset = &stream->datasets[i];
+      int32_t result = OK;
+
+      if (dataset->isStreamed == false) {
+
+        continue;
+      }
+
+      if (stream->isWriter == true) {
+
+        result = HDF5IO_writeRows(csound, stream, dataset, drain);
+      }
+      else {
+
+        result = HDF5IO_readRows(csound, stream, dataset);
+      }
+
+      if (UNLIKELY(result != OK)) {
+
+        stream->error = 1;
+        return;
+      }
+    }
+}
+
+// The i/o thread
+//
+// Service every stream in the list, then sleep for about half a control period
+// The mutex is only tried so that the thread can always be stopped
+
+uintptr_t HDF5IO_thread(void *userData)
+{
+    CSOUND *csound = userData;
+    HDF5IOGlobals *globals = csound->QueryGlobalVariableNoCheck(csound, "HDF5IO");
+
+    while (globals->running != 0) {
+
+      if (csound->LockMutexNoWait(globals->mutex) == 0) {
+
+        HDF5Stream *stream;
+        for (stream = globals->streams; stream != NULL; stream = stream->next) {
+
+          HDF5IO_serviceStream(csound, stream, false);
+        }
+
+        csound->UnlockMutex(globals->mutex);
+      }
+
+      csound->Sleep(globals->period);
+    }
+
+    return 0;
+}
+
+// Add an opcode instance to the streams serviced by the i/o thread
+//
+// Must be called with the globals mutex held
+// Only add the stream if it has a-rate or k-rate datasets
+// Start the thread if it is not running
+
+void HDF5IO_startStream(CSOUND *csound, HDF5IOGlobals *globals,
+                        HDF5Stream *stream)
+{
+    int32_t i;
+    for (i = 0; i < stream->datasetCount; ++i) {
+
+      if (stream->datasets[i].isStreamed == true) {
+
+        break;
+      }
+    }
+
+    if (i == stream->datasetCount) {
+
+      return;
+    }
+
+    stream->next = globals->streams;
+    globals->streams = stream;
+
+    if (globals->thread == NULL) {
+
+      size_t period = (size_t)(500 * csound->GetKsmps(csound) /
+                               csound->GetSr(csound));
+      globals->period = period > 1 ? period : 1;
+      globals->running = 1;
+      globals->thread = csound->CreateThread(HDF5IO_thread, csound);
+    }
+}
+
+// Remove an opcode instance from the streams serviced by the i/o thread
+//
+// Must be called with the globals mutex held, after this the thread does not
+// touch the stream
+
+void HDF5IO_stopStream(HDF5IOGlobals *globals, HDF5Stream *stream)
+{
+    HDF5Stream **previous = &globals->streams;
+
+    while (*previous != NULL) {
+
+      if (*previous == stream) {
+
+        *previous = stream->next;
+        break;
+      }
+
+      previous = &(*previous)->next;
+    }
+
+    stream->next = NULL;
+}
+
+// Destroy the ring buffers of the streamed datasets of an opcode instance
+//
+// Warn about rows dropped from a full ring buffer or periods that waited for
+// an empty one
+
+void HDF5IO_deleteStreamBuffers(CSOUND *csound, HDF5Stream *stream)
+{
+    int32_t i;
+    for (i = 0; i < stream->datasetCount; ++i) {
+
+      HDF5Dataset *dataset = &stream->datasets[i];
+
+      if (dataset->isStreamed == false) {
+
+        continue;
+      }
+
+      if (UNLIKELY(dataset->lostRows != 0)) {
+
+        csound->Warning(csound, Str("hdf5write: %u rows of dataset %s were "
+                                    "dropped"),
+                        dataset->lostRows, dataset->datasetName);
+      }
+
+      if (UNLIKELY(dataset->latePeriods != 0)) {
+
+        csound->Warning(csound, Str("hdf5read: %u periods waited for dataset %s"),
+                        dataset->latePeriods, dataset->datasetName);
+      }
+
+      csound->DestroyCircularBuffer(csound, dataset->ringBuffer);
+      dataset->ringBuffer = NULL;
+      dataset->isStreamed = false;
+    }
+}
+
 
 // Set everything up so datasets can be written from the opcodes input variables,
 // i-rate datasets are written at initialisation all others are written on the
@@ -267,20 +672,37 @@ bool HDF5IO_getSampleAccurate(CSOUND *csound)
 // Check that the first argument is a string for the filename, check others
 // are not strings
 // Register the callback to close the hdf5 file when performance finishes
+// With the hdf5 mutex held:
 // Get the path argument and open a hdf5 file, if it doesn't exist create it
 // Create the datasets in the file so they can be written
+// Hand the a-rate and k-rate datasets to the i/o thread
 
 int32_t HDF5Write_initialise(CSOUND *csound, HDF5Write *self)
 {
+    HDF5IOGlobals *globals = HDF5IO_getGlobals(csound);
     self->ksmps = csound->GetKsmps(csound);
     self->inputArgumentCount = self->INOCOUNT - 1;
+    self->datasets = NULL;
+    self->stream.next = NULL;
+    self->stream.datasets = NULL;
+    self->stream.datasetCount = 0;
+    self->stream.isWriter = true;
+    self->stream.isRealtime = HDF5IO_getRealtime(csound);
+    self->stream.error = 0;
     HDF5Write_checkArgumentSanity(csound, self);
     csound->RegisterDeinitCallback(csound, self, HDF5Write_finish);
 
+    HDF5IO_lock(csound, globals);
     STRINGDAT *path = (STRINGDAT *)self->arguments[0];
     self->hdf5File = HDF5IO_newHDF5File(csound, &self->hdf5FileMemory, path, true);
     HDF5Write_createDatasets(csound, self);
 
+    self->stream.hdf5File = self->hdf5File;
+    self->stream.datasets = self->datasets;
+    self->stream.datasetCount = self->inputArgumentCount;
+    HDF5IO_startStream(csound, globals, &self->stream);
+    HDF5IO_unlock(csound, globals);
+
     return OK;
 }
 
@@ -308,15 +730,58 @@ void HDF5Write_writeData(CSOUND *csound, HDF5Write *self,
     HDF5ERROR(H5Sclose(filespace));
 }
 
+// Queue rows to be written by the i/o thread
+//
+// Write as many rows as fit in the ring buffer
+// If some did not fit, in real-time mode drop them and count them, otherwise
+// take the mutex and write the ring buffer to the file here to make space
+
+void HDF5Write_queueRows(CSOUND *csound, HDF5Write *self,
+                         HDF5Dataset *dataset, MYFLT *data, size_t rows)
+{
+    HDF5IOGlobals *globals = NULL;
+
+    while (true) {
+
+      size_t queued = csound->WriteCircularBuffer(csound, dataset->ringBuffer,
+                                                  data, (int32_t)rows);
+      rows -= queued;
+      data += queued * dataset->rowSize;
+
+      if (rows == 0) {
+
+        return;
+      }
+
+      if (self->stream.isRealtime == true || self->stream.error != 0) {
+
+        dataset->lostRows += (uint32_t)rows;
+        return;
+      }
+
+      if (globals == NULL) {
+
+        globals = HDF5IO_getGlobals(csound);
+      }
+
+      HDF5IO_lock(csound, globals);
+
+      if (UNLIKELY(HDF5IO_writeRows(csound, &self->stream, dataset,
+                                    false) != OK)) {
+
+        self->stream.error = 1;
+      }
+
+      HDF5IO_unlock(csound, globals);
+    }
+}
+
 // Write a-rate variables and arrays to the specified data set
 //
 // For sample accurate mode, get the offset and early variables
 // Calculate the size of the incoming vector
 // If the vector is 0 return, no more data to write
-// Expand the dataset size by ksmps, because data is written in chunks
-// For sample accurate mode the exact dataset size is set when writing is finished
-// Write the data to the dataset
-// Increment the offset by the size of the vector that was just written
+// Queue the vector, one row per sample, the i/o thread writes it
 
 void HDF5Write_writeAudioData(CSOUND *csound, HDF5Write *self,
                               HDF5Dataset *dataset, MYFLT *dataPointer)
@@ -326,41 +791,40 @@ void HDF5Write_writeAudioData(CSOUND *csound, HDF5Write *self,
 
     int32_t vectorSize = (int32_t)(self->ksmps - offset - early);
 
-    if (UNLIKELY(vectorSize == 0)) {
+    if (UNLIKELY(vectorSize <= 0)) {
       return;
     }
 
-    dataset->datasetSize[0] += self->ksmps;
-
-    HDF5Write_writeData(csound, self, dataset, &dataPointer[offset]);
-
-    dataset->offset[0] += vectorSize;
+    HDF5Write_queueRows(csound, self, dataset, &dataPointer[offset],
+                        (size_t)vectorSize);
 }
 
 // Write k-rate variables and arrays to the specified data set
 //
-// Increment the data set size by 1
-// Write the data to the dataset
-// Increment the offset by 1
+// Queue one row, the i/o thread writes it
 
 void HDF5Write_writeControlData(CSOUND *csound, HDF5Write *self,
                                 HDF5Dataset *dataset, MYFLT *dataPointer)
 {
-    dataset->datasetSize[0]++;
-
-    HDF5Write_writeData(csound, self, dataset, dataPointer);
-
-    dataset->offset[0]++;
+    HDF5Write_queueRows(csound, self, dataset, dataPointer, 1);
 }
 
 // Send each input argument to the necessary writing function
 //
+// Report an error if the i/o thread failed to write
 // Iterate through the dataset array, select the current
 // Depending on the dataset type send to the necessary write function
 
 int32_t HDF5Write_process(CSOUND *csound, HDF5Write *self)
 {
     int32_t i;
+
+    if (UNLIKELY(self->stream.error != 0)) {
+
+      return csound->PerfError(csound, &(self->h), "%s",
+                               Str("hdf5write: Error writing to file"));
+    }
+
     for (i = 0; i < self->inputArgumentCount; ++i) {
 
       HDF5Dataset *currentDataset = &self->datasets[i];
@@ -400,17 +864,28 @@ int32_t HDF5Write_process(CSOUND *csound, HDF5Write *self)
     return OK;
 }
 
-// Close the hdf5 file and set the a-rate dataset extents for sample accurate mode
+// Write the queued data and close the hdf5 file
 //
-// Check that the datasets exist
-// Iterate through the datasets, if a-rate, set the size to be the same as
-// current offset
-// Set the set extent of the dataset to the size
-// Close the datasets, then close the file
+// With the hdf5 mutex held:
+// Take the instance away from the i/o thread and write the rows still queued,
+// the dataset extents end at the last row written
+// Destroy the ring buffers
+// Check that the datasets exist, close them, then close the file
 
 int32_t HDF5Write_finish(CSOUND *csound, void *inReference)
 {
     HDF5Write *self = inReference;
+    HDF5IOGlobals *globals = HDF5IO_getGlobals(csound);
+
+    HDF5IO_lock(csound, globals);
+    HDF5IO_stopStream(globals, &self->stream);
+    HDF5IO_serviceStream(csound, &self->stream, true);
+    HDF5IO_deleteStreamBuffers(csound, &self->stream);
+
+    if (UNLIKELY(self->stream.error != 0)) {
+
+      csound->Warning(csound, "%s", Str("hdf5write: Error writing to file"));
+    }
 
     if (LIKELY(self->datasets != NULL)) {
       int32_t i;
@@ -418,33 +893,12 @@ int32_t HDF5Write_finish(CSOUND *csound, void *inReference)
 
         HDF5Dataset *dataset = &self->datasets[i];
 
-        switch (dataset->writeType) {
-
-        case ARATE_ARRAY: {
-
-          dataset->datasetSize[0] =
-            dataset->offset[0];
-          HDF5ERROR(H5Dset_extent(dataset->datasetID, dataset->datasetSize));
-          break;
-        }
-        case ARATE_VAR: {
-
-          dataset->datasetSize[0] =
-            dataset->offset[0];
-          HDF5ERROR(H5Dset_extent(dataset->datasetID, dataset->datasetSize));
-          break;
-        }
-        default: {
-
-          break;
-        }
-        }
-
         HDF5ERROR(H5Dclose(dataset->datasetID));
       }
     }
 
     HDF5ERROR(H5Fclose(self->hdf5File->fileHandle));
+    HDF5IO_unlock(csound, globals);
 
     return OK;
 }
@@ -463,7 +917,7 @@ void HDF5Write_checkArgumentSanity(CSOUND *csound, const HDF5Write *self)
 
     if (UNLIKELY(type != STRING_VAR)) {
 
-      csound->Die(csound, "%s", Str("hdf5write: Error, first argument does not "
+      HDF5IO_die(csound, "%s", Str("hdf5write: Error, first argument does not "
                               "appear to be a string, exiting"));
     }
 
@@ -475,7 +929,7 @@ void HDF5Write_checkArgumentSanity(CSOUND *csound, const HDF5Write *self)
                    ||
                    type == UNKNOWN)) {
 
-        csound->Die(csound, Str("hdf5write: Error, unable to identify type "
+        HDF5IO_die(csound, Str("hdf5write: Error, unable to identify type "
                                 "of argument %d"), i);
       }
     }
@@ -485,13 +939,16 @@ void HDF5Write_checkArgumentSanity(CSOUND *csound, const HDF5Write *self)
 //
 // Check to see if the dataset exists
 // If it exists delete it
-// Create the data space, set the writing chunk size and the empty space fill value
+// Create the data space, streamed datasets start empty
+// Set the writing chunk size and the empty space fill value
+// If compression is enabled, add the deflate filter to streamed datasets
 // Create the data set in the data space and write the argument type as a string
 // attribute
 
 void HDF5Write_initialiseHDF5Dataset(CSOUND *csound, HDF5Write *self,
                                      HDF5Dataset *dataset)
 {
+    HDF5IOGlobals *globals = HDF5IO_getGlobals(csound);
     htri_t result = H5Lexists(self->hdf5File->fileHandle,
                               dataset->datasetName, H5P_DEFAULT);
 
@@ -501,7 +958,10 @@ void HDF5Write_initialiseHDF5Dataset(CSOUND *csound, HDF5Write *self,
                           dataset->datasetName, H5P_DEFAULT));
     }
 
-    hid_t dataspaceID = H5Screate_simple(dataset->rank, dataset->chunkDimensions,
+    hid_t dataspaceID = H5Screate_simple(dataset->rank,
+                                         dataset->isStreamed == true ?
+                                         dataset->datasetSize :
+                                         dataset->chunkDimensions,
                                          dataset->maxDimensions);
     HDF5ERROR(dataspaceID);
     hid_t cparams = H5Pcreate(H5P_DATASET_CREATE);
@@ -513,6 +973,11 @@ void HDF5Write_initialiseHDF5Dataset(CSOUND *csound, HDF5Write *self,
 
     HDF5ERROR(H5Pset_fill_value(cparams, self->hdf5File->floatSize, &zero));
 
+    if (dataset->isStreamed == true && globals->deflateLevel > 0) {
+
+      HDF5ERROR(H5Pset_deflate(cparams, (unsigned)globals->deflateLevel));
+    }
+
     dataset->datasetID = H5Dcreate2(self->hdf5File->fileHandle,
                                     dataset->datasetName,
                                     self->hdf5File->floatSize,
@@ -530,10 +995,9 @@ void HDF5Write_initialiseHDF5Dataset(CSOUND *csound, HDF5Write *self,
 // Allocate arrays for the chunk sizes, maximum sizes, data set sizes and
 // offset sizes
 // Copy the sizes from the input array variables to the allocated size arrays
-// If it's an a-rate array set the last chunk dimension to ksmps, last max
-// dimension to unlimited and dataset size to 0
-// If it's a k-rate array set the last chunk dimension to 1 and last max
-// dimension to unlimited
+// If it's an a-rate or k-rate array set the first chunk dimension to the
+// configured chunk size in rows, first max dimension to unlimited and dataset
+// size to 0
 // If it's an i-rate array just return
 
 void HDF5Write_newArrayDataset(CSOUND *csound, HDF5Write *self,
@@ -575,27 +1039,24 @@ void HDF5Write_newArrayDataset(CSOUND *csound, HDF5Write *self,
 
     switch (dataset->writeType) {
 
-    case ARATE_ARRAY: {
+    case ARATE_ARRAY:
+    case KRATE_ARRAY: {
 
-      dataset->chunkDimensions[0] = self->ksmps;
+      dataset->chunkDimensions[0] =
+        HDF5IO_getRowCount(csound, dataset->writeType,
+                           HDF5IO_getGlobals(csound)->chunkFrames);
       dataset->maxDimensions[0] = H5S_UNLIMITED;
       dataset->datasetSize[0] = 0;
 
       break;
     }
-    case KRATE_ARRAY: {
-
-      dataset->chunkDimensions[0] = 1;
-      dataset->maxDimensions[0] = H5S_UNLIMITED;
-      break;
-    }
     case IRATE_ARRAY: {
 
       return;
     }
     default: {
 
-      csound->Die(csound, "%s", Str("This should not happen, exiting"));
+      HDF5IO_die(csound, "%s", Str("This should not happen, exiting"));
       break;
     }
     }
@@ -606,7 +1067,7 @@ void HDF5Write_newArrayDataset(CSOUND *csound, HDF5Write *self,
 // Set the rank to 1
 // Allocate memory for chunk sizes, maximum sizes, dataset sizes and offsets
 // If the argument is not an i-rate variable:
-//  Set the chunk dimensions to ksmps if a-rate, 1 if k-rate
+//  Set the chunk dimensions to the configured chunk size in rows
 //  Set maximum dimensions to unlimited
 //  Set the data size to 0
 // If it is an i-rate variable:
@@ -634,7 +1095,8 @@ void HDF5Write_newScalarDataset(CSOUND *csound, HDF5Write *self,
     if (dataset->writeType != IRATE_VAR) {
 
       dataset->chunkDimensions[0] =
-        dataset->writeType == ARATE_VAR ? self->ksmps : 1;
+        HDF5IO_getRowCount(csound, dataset->writeType,
+                           HDF5IO_getGlobals(csound)->chunkFrames);
       dataset->maxDimensions[0] = H5S_UNLIMITED;
       dataset->datasetSize[0] = 0;
     }
@@ -647,6 +1109,23 @@ void HDF5Write_newScalarDataset(CSOUND *csound, HDF5Write *self,
     dataset->offset[0] = 0;
 }
 
+// Set up an a-rate or k-rate dataset to be written by the i/o thread
+//
+// Rows are written to the file a chunk at a time
+// The ring buffer holds four chunks, or four control periods if that is more
+
+void HDF5Write_newDatasetStream(CSOUND *csound, HDF5Write *self,
+                                HDF5Dataset *dataset)
+{
+    size_t chunkRows = dataset->chunkDimensions[0];
+    size_t periodRows =
+      dataset->writeType == ARATE_VAR || dataset->writeType == ARATE_ARRAY ?
+      self->ksmps : 1;
+
+    HDF5IO_newDatasetStream(csound, dataset, dataset->chunkDimensions, chunkRows,
+                            4 * (chunkRows > periodRows ? chunkRows : periodRows));
+}
+
 // Create the datasets for each argument to be written
 //
 // Allocate the memory for the datasets array
@@ -657,6 +1136,7 @@ void HDF5Write_newScalarDataset(CSOUND *csound, HDF5Write *self,
 // Get the enum write type from the argument pointer
 // Depending on the write type set up the variables in the correct way for
 // writing during performance
+// If the variables are a-rate or k-rate set them up to be streamed
 // If the variables are i-rate set up the variables and write them
 
 void HDF5Write_createDatasets(CSOUND *csound, HDF5Write *self)
@@ -679,12 +1159,14 @@ void HDF5Write_createDatasets(CSOUND *csound, HDF5Write *self)
       case ARATE_ARRAY: {
 
         HDF5Write_newArrayDataset(csound, self, currentDataset);
+        HDF5Write_newDatasetStream(csound, self, currentDataset);
         HDF5Write_initialiseHDF5Dataset(csound, self, currentDataset);
         break;
       }
       case KRATE_ARRAY: {
 
         HDF5Write_newArrayDataset(csound, self, currentDataset);
+        HDF5Write_newDatasetStream(csound, self, currentDataset);
         HDF5Write_initialiseHDF5Dataset(csound, self, currentDataset);
         break;
       }
@@ -699,12 +1181,14 @@ void HDF5Write_createDatasets(CSOUND *csound, HDF5Write *self)
       case ARATE_VAR: {
 
         HDF5Write_newScalarDataset(csound, self, currentDataset);
+        HDF5Write_newDatasetStream(csound, self, currentDataset);
         HDF5Write_initialiseHDF5Dataset(csound, self, currentDataset);
         break;
       }
       case KRATE_VAR: {
 
         HDF5Write_newScalarDataset(csound, self, currentDataset);
+        HDF5Write_newDatasetStream(csound, self, currentDataset);
         HDF5Write_initialiseHDF5Dataset(csound, self, currentDataset);
         break;
       }
@@ -734,21 +1218,47 @@ void HDF5Write_createDatasets(CSOUND *csound, HDF5Write *self)
 // Register the finish callback to close the hdf5 file when performance
 // is finished
 // Check csound is running in sample accurate mode
+// With the hdf5 mutex held:
 // Get the path string from the first argument
 // Open the hdf5 file then open the hdf5 datasets
+// Fill the ring buffers of the a-rate and k-rate datasets, then hand them to
+// the i/o thread to be read ahead of performance
 
 int32_t HDF5Read_initialise(CSOUND *csound, HDF5Read *self)
 {
+    HDF5IOGlobals *globals = HDF5IO_getGlobals(csound);
     self->ksmps = csound->GetKsmps(csound);
     self->inputArgumentCount = self->INOCOUNT - 1;
     self->outputArgumentCount = self->OUTOCOUNT;
+    self->datasets = NULL;
+    self->stream.next = NULL;
+    self->stream.datasets = NULL;
+    self->stream.datasetCount = 0;
+    self->stream.isWriter = false;
+    self->stream.isRealtime = HDF5IO_getRealtime(csound);
+    self->stream.error = 0;
     HDF5Read_checkArgumentSanity(csound, self);
     csound->RegisterDeinitCallback(csound, self, HDF5Read_finish);
     self->isSampleAccurate = HDF5IO_getSampleAccurate(csound);
+
+    HDF5IO_lock(csound, globals);
     STRINGDAT *path = (STRINGDAT *)self->arguments[self->outputArgumentCount];
     self->hdf5File = HDF5IO_newHDF5File(csound, &self->hdf5FileMemory, path, false);
     HDF5Read_openDatasets(csound, self);
 
+    self->stream.hdf5File = self->hdf5File;
+    self->stream.datasets = self->datasets;
+    self->stream.datasetCount = self->inputArgumentCount;
+    HDF5IO_serviceStream(csound, &self->stream, false);
+    HDF5IO_startStream(csound, globals, &self->stream);
+    HDF5IO_unlock(csound, globals);
+
+    if (UNLIKELY(self->stream.error != 0)) {
+
+      return csound->InitError(csound, "%s",
+                               Str("hdf5read: Error reading from file"));
+    }
+
     return OK;
 }
 
@@ -805,6 +1315,66 @@ void HDF5Read_readData(CSOUND *csound, HDF5Read *self, HDF5Dataset *dataset,
 
 }
 
+// Take rows read ahead by the i/o thread
+//
+// Read as many rows as are in the ring buffer
+// If some are missing count the period as late; in real-time mode fill the
+// rest with zeros, otherwise take the mutex and read the rows here
+// After an error, or if reading here gave no rows, fill the rest with zeros
+
+void HDF5Read_dequeueRows(CSOUND *csound, HDF5Read *self, HDF5Dataset *dataset,
+                          MYFLT *data, size_t rows)
+{
+    HDF5IOGlobals *globals = NULL;
+    bool isLate = false;
+
+    while (true) {
+
+      size_t dequeued = csound->ReadCircularBuffer(csound, dataset->ringBuffer,
+                                                   data, (int32_t)rows);
+      rows -= dequeued;
+      data += dequeued * dataset->rowSize;
+
+      if (rows == 0) {
+
+        break;
+      }
+
+      if (self->stream.error != 0 || (isLate == true && dequeued == 0)) {
+
+        memset(data, 0, rows * dataset->rowSize * sizeof(MYFLT));
+        break;
+      }
+
+      isLate = true;
+
+      if (self->stream.isRealtime == true) {
+
+        memset(data, 0, rows * dataset->rowSize * sizeof(MYFLT));
+        break;
+      }
+
+      if (globals == NULL) {
+
+        globals = HDF5IO_getGlobals(csound);
+      }
+
+      HDF5IO_lock(csound, globals);
+
+      if (UNLIKELY(HDF5IO_readRows(csound, &self->stream, dataset) != OK)) {
+
+        self->stream.error = 1;
+      }
+
+      HDF5IO_unlock(csound, globals);
+    }
+
+    if (isLate == true) {
+
+      dataset->latePeriods++;
+    }
+}
+
 // Read data at audio rate from a hdf5 file dataset
 //
 // If the offset is larger than the size of the dataset there is no more
@@ -816,8 +1386,7 @@ void HDF5Read_readData(CSOUND *csound, HDF5Read *self, HDF5Dataset *dataset,
 // buffer to store read data so the stride can be corrected before
 // writing it to the array data, if not just point directly to array
 // data
-// Create the chunk dimensions variable, set the required size
-// Read data from the hdf5 file
+// Take the vector, one row per sample, from the rows read ahead
 // If the vector size is not equal to ksmps correct the stride of data
 // Increment the offset by the vector size
 
@@ -845,23 +1414,7 @@ void HDF5Read_readAudioData(CSOUND *csound, HDF5Read *self,
     MYFLT *dataPointer =
       vectorSize != self->ksmps ? dataset->sampleBuffer : inputDataPointer;
 
-        // FIXME if this is called frequently or on the audio thread then this won't
-        // work and will need a different solution
-#ifdef _MSC_VER
-    hsize_t* chunkDimensions = malloc (dataset->rank * sizeof (hsize_t));
-#else
-    hsize_t chunkDimensions[dataset->rank];
-#endif
-    memcpy(&chunkDimensions[1], &dataset->datasetSize[1],
-           sizeof(hsize_t) * dataset->rank);
-    chunkDimensions[0] = vectorSize;
-
-    memcpy (chunkDimensions, dataset->datasetSize,
-            sizeof (hsize_t) * dataset->rank);
-    chunkDimensions[dataset->rank - 1] = vectorSize;
-
-    HDF5Read_readData (csound, self, dataset, dataset->offset,
-                       chunkDimensions, dataPointer);
+    HDF5Read_dequeueRows(csound, self, dataset, dataPointer, vectorSize);
 
     if (vectorSize != self->ksmps) {
 
@@ -871,18 +1424,13 @@ void HDF5Read_readAudioData(CSOUND *csound, HDF5Read *self,
     }
 
     dataset->offset[0] += vectorSize;
-
-#ifdef _MSC_VER
-    free (chunkDimensions);
-#endif
 }
 
 // Read data at control rate from a hdf5 dataset
 //
 // If the offset of the dataset is larger than the data set size, no
 // more data to read to return
-// Create chunk dimension variable and set the appropriate size
-// Read the data from the dataset
+// Take one row from the rows read ahead
 // Increment the offset variable
 
 void HDF5Read_readControlData(CSOUND *csound, HDF5Read *self,
@@ -894,28 +1442,13 @@ void HDF5Read_readControlData(CSOUND *csound, HDF5Read *self,
       return;
     }
 
-        // FIXME if this is called frequently or on the audio thread then this won't
-        // work and will need a different solution
-#ifndef _MSC_VER
-    hsize_t chunkDimensions[dataset->rank];
-#else
-    hsize_t* chunkDimensions = malloc (dataset->rank * sizeof (hsize_t));
-#endif
-    memcpy(&chunkDimensions[1], &dataset->datasetSize[1],
-           sizeof(hsize_t) * (dataset->rank - 1));
-    chunkDimensions[0] = 1;
-
-    HDF5Read_readData(csound, self, dataset, dataset->offset,
-                      chunkDimensions, dataPointer);
+    HDF5Read_dequeueRows(csound, self, dataset, dataPointer, 1);
     dataset->offset[0]++;
-#ifdef _MSC_VER
-    free (chunkDimensions);
-#endif
-
 }
 
 // Read dataset variables during performance time
 //
+// Report an error if the i/o thread failed to read
 // Iterate through each of the opened datasets,
 // Depending on the dataset read type use the appropriate read function
 // to read the data
@@ -923,6 +1456,13 @@ void HDF5Read_readControlData(CSOUND *csound, HDF5Read *self,
 int32_t HDF5Read_process(CSOUND *csound, HDF5Read *self)
 {
     int32_t i;
+
+    if (UNLIKELY(self->stream.error != 0)) {
+
+      return csound->PerfError(csound, &(self->h), "%s",
+                               Str("hdf5read: Error reading from file"));
+    }
+
     for (i = 0; i < self->inputArgumentCount; ++i) {
 
       HDF5Dataset *dataset = &self->datasets[i];
@@ -968,14 +1508,22 @@ int32_t HDF5Read_process(CSOUND *csound, HDF5Read *self)
 
 // Close the necessary variables when reading has finished
 //
+// With the hdf5 mutex held:
+// Take the instance away from the i/o thread and destroy the ring buffers
 // Iterate through open datasets closing them in the hdf5 file
 // Close the hdf5 file
 
 int32_t HDF5Read_finish(CSOUND *csound, void *inReference)
 {
     HDF5Read *self = inReference;
+    HDF5IOGlobals *globals = HDF5IO_getGlobals(csound);
     int32_t i;
-    for (i = 0; i < self->inputArgumentCount; ++i) {
+
+    HDF5IO_lock(csound, globals);
+    HDF5IO_stopStream(globals, &self->stream);
+    HDF5IO_deleteStreamBuffers(csound, &self->stream);
+
+    for (i = 0; i < self->stream.datasetCount; ++i) {
 
       HDF5Dataset *dataset = &self->datasets[i];
 
@@ -983,6 +1531,7 @@ int32_t HDF5Read_finish(CSOUND *csound, void *inReference)
     }
 
     HDF5ERROR(H5Fclose(self->hdf5File->fileHandle));
+    HDF5IO_unlock(csound, globals);
 
     return OK;
 }
@@ -1000,12 +1549,12 @@ void HDF5Read_checkArgumentSanity(CSOUND *csound, const HDF5Read *self)
 
       if (self->inputArgumentCount > self->outputArgumentCount) {
 
-        csound->Die(csound, "%s", Str("hdf5read: Error, more input arguments than "
+        HDF5IO_die(csound, "%s", Str("hdf5read: Error, more input arguments than "
                                 "output arguments, exiting"));
       }
       else {
 
-        csound->Die(csound, "%s", Str("hdf5read: Error, more output arguments than "
+        HDF5IO_die(csound, "%s", Str("hdf5read: Error, more output arguments than "
                                 "input arguments, exiting"));
       }
     }
@@ -1020,23 +1569,23 @@ void HDF5Read_checkArgumentSanity(CSOUND *csound, const HDF5Read *self)
 
       if (UNLIKELY(inputType != STRING_VAR)) {
 
-        csound->Die(csound, Str("hdf5read: Error, input argument %d does not "
+        HDF5IO_die(csound, Str("hdf5read: Error, input argument %d does not "
                                 "appear to be a string, exiting"), i + 1);
       }
       else if (UNLIKELY(inputType == UNKNOWN)) {
 
-        csound->Die(csound, Str("hdf5read: Error, input argument %d type "
+        HDF5IO_die(csound, Str("hdf5read: Error, input argument %d type "
                                 "is unknown, exiting"), i + 1);
       }
 
       if (UNLIKELY(outputType == STRING_VAR)) {
 
-        csound->Die(csound, Str("hdf5read: Error, output argument %d appears "
+        HDF5IO_die(csound, Str("hdf5read: Error, output argument %d appears "
                                 "to be a string, exiting"), i + 1);
       }
       else if (UNLIKELY(outputType == UNKNOWN)) {
 
-        csound->Die(csound, Str("hdf5read: Error, output argument %d type "
+        HDF5IO_die(csound, Str("hdf5read: Error, output argument %d type "
                                 "is unknown, exiting"), i + 1);
       }
     }
@@ -1055,7 +1604,7 @@ void HDF5Read_initialiseHDF5Dataset(CSOUND *csound, HDF5Read *self,
 
     if (UNLIKELY(result <= 0)) {
 
-      csound->Die(csound, "%s", Str("hdf5read: Error, dataset does not exist or "
+      HDF5IO_die(csound, "%s", Str("hdf5read: Error, dataset does not exist or "
                               "cannot be found in file"));
     }
 
@@ -1122,7 +1671,7 @@ void HDF5Read_checkReadTypeSanity(CSOUND *csound, HDF5Read *self,
     }
     else {
 
-      csound->Die(csound, "%s", Str("hdf5read: Unable to read saved type of "
+      HDF5IO_die(csound, "%s", Str("hdf5read: Unable to read saved type of "
                               "dataset, exiting"));
     }
 }
@@ -1163,6 +1712,29 @@ void HDF5Read_allocateArray(CSOUND *csound, HDF5Dataset *dataset,
 }
 
 
+// Set up an a-rate or k-rate dataset to be read ahead by the i/o thread
+//
+// Rows are read from the file a chunk at a time
+// The ring buffer holds the configured lookahead in rows, at least a control
+// period
+
+void HDF5Read_newDatasetStream(CSOUND *csound, HDF5Read *self,
+                               HDF5Dataset *dataset)
+{
+    HDF5IOGlobals *globals = HDF5IO_getGlobals(csound);
+    size_t periodRows =
+      dataset->readType == ARATE_VAR || dataset->readType == ARATE_ARRAY ?
+      self->ksmps : 1;
+    size_t lookaheadRows = HDF5IO_getRowCount(csound, dataset->readType,
+                                              globals->lookaheadFrames);
+
+    HDF5IO_newDatasetStream(csound, dataset, dataset->datasetSize,
+                            HDF5IO_getRowCount(csound, dataset->readType,
+                                               globals->chunkFrames),
+                            lookaheadRows > periodRows ?
+                            lookaheadRows : periodRows);
+}
+
 // Initialise the dataset and prepare for reading an a-rate, k-rate or i-rate
 // array during performance time
 //
@@ -1176,6 +1748,7 @@ void HDF5Read_allocateArray(CSOUND *csound, HDF5Dataset *dataset,
 // Then allocate the array data for the output argument
 // Allocate the memory for the offset variable
 // If it's an a-rate array and sample accurate allocate data for the sample buffer
+// Set up the dataset to be read ahead by the i/o thread
 // Else if it's an i-rate array copy the array dimensions including the last one
 // Then allocate the array data for the output argument
 // Cast the argument pointer to an array, then read the data into the array from
@@ -1222,6 +1795,8 @@ void HDF5Read_initialiseArrayOutput(CSOUND *csound, HDF5Read *self,
                            &dataset->sampleBufferMemory);
           dataset->sampleBuffer = dataset->sampleBufferMemory.auxp;
       }
+
+      HDF5Read_newDatasetStream(csound, self, dataset);
 #ifdef _MSC_VER
       free (arrayDimensions);
 #endif
@@ -1259,8 +1834,9 @@ void HDF5Read_initialiseArrayOutput(CSOUND *csound, HDF5Read *self,
 // Allocate the dataset size memory, get the size of the dataset and copy to
 // the size memory
 // Allocate offset memory and set to 0
-// If the dataset is to be read at a-rate and we are running sample accurate
-// allocate the sample buffer
+// If the dataset is to be read at a-rate allocate the sample buffer, used in
+// sample accurate mode and for the last vector of the dataset
+// Set up the dataset to be read ahead by the i/o thread
 // Otherwise create array dimesions variable, set to 1, create offset variable,
 // set to 0 and read the i-rate variable
 
@@ -1288,9 +1864,7 @@ void HDF5Read_initialiseScalarOutput(CSOUND *csound, HDF5Read *self,
       dataset->offset = dataset->offsetMemory.auxp;
       memset(dataset->offset, 0, sizeof(hsize_t));
 
-      if (dataset->readType == ARATE_VAR
-          &&
-          self->isSampleAccurate == true) {
+      if (dataset->readType == ARATE_VAR) {
 
         csound->AuxAlloc(csound, self->ksmps * sizeof(MYFLT),
                          &dataset->sampleBufferMemory);
@@ -1298,6 +1872,11 @@ void HDF5Read_initialiseScalarOutput(CSOUND *csound, HDF5Read *self,
         dataset->elementCount = 1;
       }
 
+      if (dataset->readType != IRATE_VAR && dataset->readAll == false) {
+
+        HDF5Read_newDatasetStream(csound, self, dataset);
+      }
+
       if (dataset->readType == IRATE_VAR) {
 
         hsize_t arrayDimensions[1] = {1};
@@ -1412,4 +1991,85 @@ static OENTRY localops[] = {
   }
 };
 
-LINKAGE
+// Create the globals and the configuration variables when the plugin is loaded
+//
+// hdf5_chunk is the chunk size of a-rate and k-rate datasets in sample frames,
+// and the size of the blocks read and written by the i/o thread
+// hdf5_lookahead is how many sample frames are read ahead of performance
+// hdf5_deflate is the compression level of a-rate and k-rate datasets, 0 is
+// no compression
+
+PUBLIC int32_t csoundModuleCreate(CSOUND *csound)
+{
+    int32_t minimum = 1, maximum = 1 << 24;
+    int32_t minimumLevel = 0, maximumLevel = 9;
+
+    if (UNLIKELY(csound->CreateGlobalVariable(csound, "HDF5IO",
+                                              sizeof(HDF5IOGlobals)) != 0)) {
+
+      csound->ErrorMsg(csound, "%s", Str("HDF5IO: error allocating globals"));
+      return CSOUND_ERROR;
+    }
+
+    HDF5IOGlobals *globals = csound->QueryGlobalVariableNoCheck(csound, "HDF5IO");
+    globals->mutex = csound->Create_Mutex(1);
+    globals->chunkFrames = 4096;
+    globals->lookaheadFrames = 16384;
+    globals->deflateLevel = 0;
+
+    csound->CreateConfigurationVariable(csound, "hdf5_chunk",
+                                        &globals->chunkFrames,
+                                        CSOUNDCFG_INTEGER, 0, &minimum, &maximum,
+                                        Str("hdf5 dataset chunk size in sample "
+                                            "frames (default: 4096)"), NULL);
+    csound->CreateConfigurationVariable(csound, "hdf5_lookahead",
+                                        &globals->lookaheadFrames,
+                                        CSOUNDCFG_INTEGER, 0, &minimum, &maximum,
+                                        Str("hdf5read lookahead in sample "
+                                            "frames (default: 16384)"), NULL);
+    csound->CreateConfigurationVariable(csound, "hdf5_deflate",
+                                        &globals->deflateLevel,
+                                        CSOUNDCFG_INTEGER, 0,
+                                        &minimumLevel, &maximumLevel,
+                                        Str("hdf5write compression level, 0 to 9 "
+                                            "(default: 0, no compression)"), NULL);
+    return CSOUND_SUCCESS;
+}
+
+PUBLIC int32_t csoundModuleInit(CSOUND *csound)
+{
+    return csound->AppendOpcodes(csound, &(localops[0]),
+                                 (int32_t) (sizeof(localops) / sizeof(OENTRY)));
+}
+
+// Stop the i/o thread when the plugin is unloaded
+
+PUBLIC int32_t csoundModuleDestroy(CSOUND *csound)
+{
+    HDF5IOGlobals *globals = csound->QueryGlobalVariable(csound, "HDF5IO");
+
+    if (globals == NULL) {
+
+      return CSOUND_SUCCESS;
+    }
+
+    if (globals->thread != NULL) {
+
+      globals->running = 0;
+      csound->JoinThread(globals->thread);
+      globals->thread = NULL;
+    }
+
+    if (globals->mutex != NULL) {
+
+      csound->DestroyMutex(globals->mutex);
+      globals->mutex = NULL;
+    }
+
+    return CSOUND_SUCCESS;
+}
+
+PUBLIC int32_t csoundModuleInfo(void)
+{
+    return ((CS_APIVERSION << 16) + (CS_APISUBVER << 8) + (int32_t) sizeof(MYFLT));
+}
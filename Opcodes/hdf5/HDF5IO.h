@@ -71,6 +71,24 @@ typedef struct HDF5Dataset
 
     bool readAll;
 
+    // Streaming through the i/o thread, a row is one frame of an a-rate
+    // dataset or one control period of a k-rate dataset
+    bool isStreamed;
+    size_t rowSize;
+    void *ringBuffer;
+    MYFLT *ioBuffer;
+    AUXCH ioBufferMemory;
+    size_t ioBufferRows;
+    size_t pendingRows;
+    size_t pendingStart;
+    hsize_t ioOffset;
+    hsize_t *blockDimensions;
+    AUXCH blockDimensionsMemory;
+    hsize_t *blockOffset;
+    AUXCH blockOffsetMemory;
+    uint32_t lostRows;
+    uint32_t latePeriods;
+
 } HDF5Dataset;
 
 typedef struct HDF5File
@@ -87,6 +105,44 @@ HDF5File *HDF5IO_newHDF5File(CSOUND *csound, AUXCH *hdf5FileMemory,
 
 void HDF5IO_deleteHDF5File(CSOUND *csound, HDF5File *hdf5File);
 
+// The a-rate and k-rate datasets of an opcode instance, which are written
+// or read by the i/o thread while the instance is in the stream list
+
+typedef struct HDF5Stream
+{
+    struct HDF5Stream *next;
+    HDF5File *hdf5File;
+    HDF5Dataset *datasets;
+    int32_t datasetCount;
+    bool isWriter;
+    bool isRealtime;
+    volatile int32_t error;
+
+} HDF5Stream;
+
+// Shared by all instances, every call into the hdf5 library is made with
+// the mutex held as the library is not thread safe
+
+typedef struct HDF5IOGlobals
+{
+    void *thread;
+    void *mutex;
+    volatile int32_t running;
+    size_t period;
+    HDF5Stream *streams;
+    int32_t chunkFrames;
+    int32_t lookaheadFrames;
+    int32_t deflateLevel;
+    bool isLocked;              // the mutex is held by the performance pass
+
+} HDF5IOGlobals;
+
+void HDF5IO_lock(CSOUND *csound, HDF5IOGlobals *globals);
+
+void HDF5IO_unlock(CSOUND *csound, HDF5IOGlobals *globals);
+
+void HDF5IO_die(CSOUND *csound, const char *format, ...);
+
 typedef struct HDF5Write
 {
     OPDS h;
@@ -97,6 +153,7 @@ typedef struct HDF5Write
     AUXCH hdf5FileMemory;
     HDF5Dataset *datasets;
     AUXCH datasetsMemory;
+    HDF5Stream stream;
 
 } HDF5Write;
 
@@ -128,6 +185,7 @@ typedef struct HDF5Read
     HDF5Dataset *datasets;
     AUXCH datasetsMemory;
     bool isSampleAccurate;
+    HDF5Stream stream;
 
 } HDF5Read;
 
@@ -141,6 +141,135 @@ static int32_t swap4bytes(CSOUND* csound, MEMFIL* mfp)
 static int32_t (*swap4bytes)(CSOUND*, MEMFIL*) = NULL;
 #endif
 
+/* Shared cache of interpolated filters for hrtfmove.  The filters
+   (padded spectra of both ears, and the delay for min phase) are a
+   function of the data files, the mode and the direction only, so
+   instances with sources at the same position use the same filter:
+   directions are snapped to a grid of hrtfquantum degrees, and each
+   grid point is kept in a direct mapped table shared by all instances
+   of a Csound.  A hit replaces the interpolation, the four FFTs of the
+   min phase process and the two padding FFTs with a copy.  The audio
+   thread never waits: if the table is busy, the filter is computed as
+   before and not stored. */
+
+#define hrtfquantum (FL(0.5))
+#define HRTF_CACHE_SLOTS (1024)
+
+typedef struct {
+    const float *fpbeginl, *fpbeginr;
+    int32_t minphase, irlength;
+    int32_t angleq, elevq;
+    MYFLT delayfloat;
+    /* 2 * irlengthpad: left then right spectrum */
+    MYFLT spec[1];
+} HRTFCACHEENTRY;
+
+typedef struct {
+    void *lock;
+    HRTFCACHEENTRY *slots[HRTF_CACHE_SLOTS];
+} HRTFCACHE;
+
+static int32_t hrtf_cache_reset(CSOUND *csound, void *userData)
+{
+    HRTFCACHE *cache = (HRTFCACHE *) userData;
+    if (cache->lock != NULL) {
+      csound->DestroyMutex(cache->lock);
+      cache->lock = NULL;
+    }
+    return OK;
+}
+
+static HRTFCACHE *hrtf_cache_get_global(CSOUND *csound)
+{
+    HRTFCACHE *cache =
+      (HRTFCACHE *) csound->QueryGlobalVariable(csound, "hrtfmove_cache");
+    if (cache == NULL) {
+      if (UNLIKELY(csound->CreateGlobalVariable(csound, "hrtfmove_cache",
+                                                sizeof(HRTFCACHE)) != 0))
+        return NULL;
+      cache =
+        (HRTFCACHE *) csound->QueryGlobalVariable(csound, "hrtfmove_cache");
+      cache->lock = csound->Create_Mutex(0);
+      csound->RegisterResetCallback(csound, cache, hrtf_cache_reset);
+    }
+    return cache;
+}
+
+static uint32_t hrtf_cache_slot(const float *fpl, int32_t minphase,
+                                int32_t angleq, int32_t elevq)
+{
+    uint32_t h = (uint32_t) ((uintptr_t) fpl >> 4);
+    h = h * 31u + (uint32_t) minphase;
+    h = h * 31u + (uint32_t) angleq;
+    h = h * 31u + (uint32_t) elevq;
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    return h & (HRTF_CACHE_SLOTS - 1);
+}
+
+/* copies the cached filter for a direction into hrtflpad/hrtfrpad,
+   returns 0 if it is not cached or the cache is busy */
+static int32_t hrtf_cache_read(CSOUND *csound, HRTFCACHE *cache,
+                               const float *fpl, const float *fpr,
+                               int32_t minphase, int32_t irlength,
+                               int32_t irlengthpad, int32_t angleq,
+                               int32_t elevq, MYFLT *hrtflpad,
+                               MYFLT *hrtfrpad, MYFLT *delayfloat)
+{
+    HRTFCACHEENTRY *e;
+    int32_t found = 0;
+
+    if (cache == NULL || csound->LockMutexNoWait(cache->lock) != 0)
+      return 0;
+    e = cache->slots[hrtf_cache_slot(fpl, minphase, angleq, elevq)];
+    if (e != NULL && e->fpbeginl == fpl && e->fpbeginr == fpr &&
+        e->minphase == minphase && e->irlength == irlength &&
+        e->angleq == angleq && e->elevq == elevq) {
+      memcpy(hrtflpad, e->spec, irlengthpad * sizeof(MYFLT));
+      memcpy(hrtfrpad, e->spec + irlengthpad, irlengthpad * sizeof(MYFLT));
+      *delayfloat = e->delayfloat;
+      found = 1;
+    }
+    csound->UnlockMutex(cache->lock);
+    return found;
+}
+
+static void hrtf_cache_write(CSOUND *csound, HRTFCACHE *cache,
+                             const float *fpl, const float *fpr,
+                             int32_t minphase, int32_t irlength,
+                             int32_t irlengthpad, int32_t angleq,
+                             int32_t elevq, const MYFLT *hrtflpad,
+                             const MYFLT *hrtfrpad, MYFLT delayfloat)
+{
+    HRTFCACHEENTRY *e;
+    uint32_t slot;
+
+    if (cache == NULL || csound->LockMutexNoWait(cache->lock) != 0)
+      return;
+    slot = hrtf_cache_slot(fpl, minphase, angleq, elevq);
+    e = cache->slots[slot];
+    if (e == NULL || e->irlength < irlength) {
+      /* entries are sized for the largest filter stored in the slot */
+      if (e != NULL)
+        csound->Free(csound, e);
+      e = (HRTFCACHEENTRY *)
+        csound->Malloc(csound, sizeof(HRTFCACHEENTRY) +
+                       (2 * irlengthpad - 1) * sizeof(MYFLT));
+      cache->slots[slot] = e;
+    }
+    e->fpbeginl = fpl;
+    e->fpbeginr = fpr;
+    e->minphase = minphase;
+    e->irlength = irlength;
+    e->angleq = angleq;
+    e->elevq = elevq;
+    e->delayfloat = delayfloat;
+    memcpy(e->spec, hrtflpad, irlengthpad * sizeof(MYFLT));
+    memcpy(e->spec + irlengthpad, hrtfrpad, irlengthpad * sizeof(MYFLT));
+    csound->UnlockMutex(cache->lock);
+}
+
 /* Csound hrtf magnitude interpolation, phase truncation object */
 
 /* aleft,aright hrtfmove asrc, kaz, kel, ifilel->data, ifiler [, imode = 0,
@@ -216,6 +345,9 @@ typedef struct
         /* delay */
         AUXCH delmeml, delmemr;
         int32_t ptl, ptr, mdtl, mdtr;
+
+        /* shared filter cache */
+        HRTFCACHE *cache;
 }
 hrtfmove;
 
@@ -475,6 +607,8 @@ static int32_t hrtfmove_init(CSOUND *csound, hrtfmove *p)
     p->anglev = -1;
     p->elevv = -41;
 
+    p->cache = hrtf_cache_get_global(csound);
+
     return OK;
 }
 
@@ -513,6 +647,7 @@ static int32_t hrtfmove_process(CSOUND *csound, hrtfmove *p)
     float *fpindexr;
 
     int32_t i,elevindex, angleindex, skip = 0;
+    int32_t angleq, elevq;
 
     int32_t minphase = p->minphase;
     int32_t phasetrunc = p->phasetrunc;
@@ -641,6 +776,14 @@ static int32_t hrtfmove_process(CSOUND *csound, hrtfmove *p)
             while(angle >= FL(360.0))
               angle -= FL(360.0);
 
+            /* snap to the cache grid */
+            angleq = (int32_t)(angle / hrtfquantum + FL(0.5));
+            if(angleq >= (int32_t)(FL(360.0) / hrtfquantum))
+              angleq = 0;
+            elevq = (int32_t)((elev - minelev) / hrtfquantum + FL(0.5));
+            angle = angleq * hrtfquantum;
+            elev = elevq * hrtfquantum + minelev;
+
             /* only update if location changes! */
             if(angle != p->anglev || elev != p->elevv)
               {
@@ -753,6 +896,16 @@ static int32_t hrtfmove_process(CSOUND *csound, hrtfmove *p)
                 p->oldelevindex = elevindex;
                 p->oldangleindex = angleindex;
 
+                /* another instance may have been here already */
+                if(hrtf_cache_read(csound, p->cache, p->fpbeginl, p->fpbeginr,
+                                   minphase, irlength, irlengthpad,
+                                   angleq, elevq, hrtflpad, hrtfrpad,
+                                   &delayfloat))
+                  {
+                    p->delayfloat = delayfloat;
+                    goto filterdone;
+                  }
+
                 /* read 4 nearest HRTFs */
                 skip = 0;
                 /* switch l and r */
@@ -1152,6 +1305,11 @@ static int32_t hrtfmove_process(CSOUND *csound, hrtfmove *p)
 
                     p->delayfloat = delayfloat;
                   }
+                hrtf_cache_write(csound, p->cache, p->fpbeginl, p->fpbeginr,
+                                 minphase, irlength, irlengthpad,
+                                 angleq, elevq, hrtflpad, hrtfrpad,
+                                 delayfloat);
+              filterdone:
                 /* end of angle/elev change process */
                 p->elevv = elev;
                 p->anglev = angle;
@@ -21,6 +21,8 @@
     02110-1301 USA
 */
 #include "OpcodeBase.hpp"
+#include <cstring>
+#include <deque>
 #include <map>
 #include <vector>
 
@@ -33,41 +35,96 @@ using namespace csound;
 //#define ENABLE_MIXER_KDEBUG
 
 /**
- * The mixer busses are laid out:
- * busses[csound][bus][channel][frame].
- * std::map<CSOUND *, std::map<size_t, std::vector< std::vector<MYFLT> > > >
- * *busses = 0;
+ * The mixer busses and send matrix of one Csound instance.
  *
- * The mixer send matrix is laid out:
- * matrix[csound][send][bus].
- * std::map<CSOUND *, std::map<size_t, std::map<size_t, MYFLT> > > *matrix = 0;
- */
-
-/**
- * Creates the buss if it does not already exist.
+ * Each buss is one block of nchnls * ksmps frames, laid out
+ * block[channel * ksmps + frame]. A block is allocated when its buss
+ * is first used and never moves, so opcodes resolve their buss and
+ * channel to a pointer at init time.
+ *
+ * Each route from a send to a buss has one gain cell. The cells live
+ * in a deque, which does not move its elements either, so MixerSend
+ * and the level opcodes also hold a pointer to their gain. The maps
+ * from buss and send numbers are only searched at init time; nothing
+ * is looked up at k-rate or a-rate.
  */
-static void createBuss(CSOUND *csound, size_t buss) {
+struct Mixer {
+  size_t channels;
+  size_t frames;
+  std::map<size_t, MYFLT *> bussesForNumbers;
+  std::vector<MYFLT *> busses;
+  std::map<std::pair<size_t, size_t>, MYFLT *> gainsForRoutes;
+  std::deque<MYFLT> gains;
+  Mixer() : channels(0), frames(0) {}
+  ~Mixer() {
+    for (size_t i = 0, n = busses.size(); i < n; i++) {
+      delete[] busses[i];
+    }
+  }
+  /**
+   * Creates the buss if it does not already exist.
+   */
+  MYFLT *buss(CSOUND *csound, size_t buss) {
+    std::map<size_t, MYFLT *>::iterator it = bussesForNumbers.find(buss);
+    if (it != bussesForNumbers.end()) {
 #ifdef ENABLE_MIXER_IDEBUG
-  csound->Message(csound, "createBuss: csound %p buss %d...\n", csound, buss);
+      csound->Message(csound, "createBuss: buss already exists.\n");
 #endif
-  std::map<CSOUND *, std::map<size_t, std::vector<std::vector<MYFLT>>>>
-      *busses = 0;
-  csound::QueryGlobalPointer(csound, "busses", busses);
-  if ((*busses)[csound].find(buss) == (*busses)[csound].end()) {
-    size_t channels = csound->GetNchnls(csound);
-    size_t frames = csound->GetKsmps(csound);
-    (*busses)[csound][buss].resize(channels);
-    for (size_t channel = 0; channel < channels; channel++) {
-      (*busses)[csound][buss][channel].resize(frames);
+      return it->second;
+    }
+    if (busses.empty()) {
+      channels = csound->GetNchnls(csound);
+      frames = csound->GetKsmps(csound);
     }
+    MYFLT *block = new MYFLT[channels * frames]();
+    busses.push_back(block);
+    bussesForNumbers[buss] = block;
 #ifdef ENABLE_MIXER_IDEBUG
     csound->Message(csound, "createBuss: created buss.\n");
 #endif
-  } else {
+    return block;
+  }
+  /**
+   * Creates the route with a gain of 0 if it does not already exist.
+   */
+  MYFLT *gain(size_t send, size_t buss) {
+    std::pair<size_t, size_t> route(send, buss);
+    std::map<std::pair<size_t, size_t>, MYFLT *>::iterator it =
+        gainsForRoutes.find(route);
+    if (it != gainsForRoutes.end()) {
+      return it->second;
+    }
+    gains.push_back(FL(0.0));
+    gainsForRoutes[route] = &gains.back();
+    return &gains.back();
+  }
+  void clear() {
+    for (size_t i = 0, n = busses.size(); i < n; i++) {
+      std::memset(busses[i], 0, channels * frames * sizeof(MYFLT));
+    }
+  }
+};
+
+static Mixer *getMixer(CSOUND *csound) {
+  Mixer *mixer = 0;
+  csound::QueryGlobalPointer(csound, "mixer", mixer);
+  return mixer;
+}
+
+/**
+ * Returns the frames of channel of the buss, creating the buss if it
+ * does not already exist, or 0 if there is no such channel.
+ */
+static MYFLT *createBuss(CSOUND *csound, size_t buss, size_t channel) {
 #ifdef ENABLE_MIXER_IDEBUG
-    csound->Message(csound, "createBuss: buss already exists.\n");
+  csound->Message(csound, "createBuss: csound %p buss %d...\n", csound, buss);
 #endif
+  Mixer *mixer = getMixer(csound);
+  MYFLT *block = mixer->buss(csound, buss);
+  if (channel >= mixer->channels) {
+    return 0;
   }
+  return block + channel * mixer->frames;
 }
 
 /**
@@ -84,28 +141,29 @@ struct MixerSetLevel : public OpcodeBase<MixerSetLevel> {
   // State.
   size_t send;
   size_t buss;
-  std::map<CSOUND *, std::map<size_t, std::map<size_t, MYFLT>>> *matrix;
+  MYFLT *gain;
   int init(CSOUND *csound) {
 #ifdef ENABLE_MIXER_IDEBUG
     warn(csound, "MixerSetLevel::init...\n");
 #endif
-    csound::QueryGlobalPointer(csound, "matrix", matrix);
     send = static_cast<size_t>(*isend);
     buss = static_cast<size_t>(*ibuss);
-    createBuss(csound, buss);
-    (*matrix)[csound][send][buss] = *kgain;
+    createBuss(csound, buss, 0);
+    gain = getMixer(csound)->gain(send, buss);
+    *gain = *kgain;
 #ifdef ENABLE_MIXER_IDEBUG
     warn(csound, "MixerSetLevel::init: csound %p send %d buss %d gain %f\n",
-         csound, send, buss, (*matrix)[csound][send][buss]);
+         csound, send, buss, *gain);
 #endif
     return OK;
   }
   int kontrol(CSOUND *csound) {
-    (*matrix)[csound][send][buss] = *kgain;
+    IGN(csound);
+    *gain = *kgain;
 #ifdef ENABLE_MIXER_KDEBUG
     warn(csound, "MixerSetLevel::kontrol: csound %p send %d buss "
                  "%d gain %f\n",
-         csound, send, buss, (*matrix)[csound][send][buss]);
+         csound, send, buss, *gain);
 #endif
     return OK;
   }
@@ -125,23 +183,25 @@ struct MixerGetLevel : public OpcodeBase<MixerGetLevel> {
   // State.
   size_t send;
   size_t buss;
-  std::map<CSOUND *, std::map<size_t, std::map<size_t, MYFLT>>> *matrix;
+  MYFLT *gain;
   int init(CSOUND *csound) {
 #ifdef ENABLE_MIXER_IDEBUG
     warn(csound, "MixerGetLevel::init...\n");
 #endif
-    csound::QueryGlobalPointer(csound, "matrix", matrix);
     send = static_cast<size_t>(*isend);
     buss = static_cast<size_t>(*ibuss);
-    createBuss(csound, buss);
+    createBuss(csound, buss, 0);
+    gain = getMixer(csound)->gain(send, buss);
     return OK;
   }
   int noteoff(CSOUND *) { return OK; }
   int kontrol(CSOUND *csound) {
 #ifdef ENABLE_MIXER_KDEBUG
     warn(csound, "MixerGetLevel::kontrol...\n");
+#else
+    IGN(csound);
 #endif
-    *kgain = (*matrix)[csound][send][buss];
+    *kgain = *gain;
     return OK;
   }
 };
@@ -164,20 +224,22 @@ struct MixerSend : public OpcodeBase<MixerSend> {
   size_t channel;
   size_t frames;
   MYFLT *busspointer;
-  std::map<CSOUND *, std::map<size_t, std::vector<std::vector<MYFLT>>>> *busses;
-  std::map<CSOUND *, std::map<size_t, std::map<size_t, MYFLT>>> *matrix;
+  MYFLT *gain;
   int init(CSOUND *csound) {
 #ifdef ENABLE_MIXER_IDEBUG
     warn(csound, "MixerSend::init...\n");
 #endif
-    csound::QueryGlobalPointer(csound, "busses", busses);
-    csound::QueryGlobalPointer(csound, "matrix", matrix);
     send = static_cast<size_t>(*isend);
     buss = static_cast<size_t>(*ibuss);
-    createBuss(csound, buss);
     channel = static_cast<size_t>(*ichannel);
     frames = opds.insdshead->ksmps;
-    busspointer = &(*busses)[csound][buss][channel].front();
+    busspointer = createBuss(csound, buss, channel);
+    if (UNLIKELY(busspointer == 0)) {
+      return csound->InitError(csound, Str("MixerSend: no channel %d in "
+                                           "buss %d"),
+                               (int)channel, (int)buss);
+    }
+    gain = getMixer(csound)->gain(send, buss);
 #ifdef ENABLE_MIXER_IDEBUG
     warn(csound, "MixerSend::init: instance %p send %d buss "
                  "%d channel %d frames %d busspointer %p\n",
@@ -189,15 +251,23 @@ struct MixerSend : public OpcodeBase<MixerSend> {
   int audio(CSOUND *csound) {
 #ifdef ENABLE_MIXER_KDEBUG
     warn(csound, "MixerSend::audio...\n");
+#else
+    IGN(csound);
 #endif
-    MYFLT gain = (*matrix)[csound][send][buss];
-    for (size_t i = 0; i < frames; i++) {
-      busspointer[i] += (ainput[i] * gain);
+    const MYFLT g = *gain;
+    // Muted routes cost nothing; the others are one multiply-add per
+    // frame over contiguous buffers, which the compiler vectorizes.
+    if (g != FL(0.0)) {
+      MYFLT *bus = busspointer;
+      const MYFLT *input = ainput;
+      for (size_t i = 0; i < frames; i++) {
+        bus[i] += input[i] * g;
+      }
     }
 #ifdef ENABLE_MIXER_KDEBUG
     warn(csound, "MixerSend::audio: instance %d send %d buss "
                  "%d gain %f busspointer %p\n",
-         csound, send, buss, gain, busspointer);
+         csound, send, buss, g, busspointer);
 #endif
     return OK;
   }
@@ -221,17 +291,19 @@ struct MixerReceive : public OpcodeBase<MixerReceive> {
   size_t channel;
   size_t frames;
   MYFLT *busspointer;
-  std::map<CSOUND *, std::map<size_t, std::vector<std::vector<MYFLT>>>> *busses;
   int init(CSOUND *csound) {
-    csound::QueryGlobalPointer(csound, "busses", busses);
     buss = static_cast<size_t>(*ibuss);
     channel = static_cast<size_t>(*ichannel);
     frames = opds.insdshead->ksmps;
-    createBuss(csound, buss);
 #ifdef ENABLE_MIXER_IDEBUG
     warn(csound, "MixerReceive::init...\n");
 #endif
-    busspointer = &(*busses)[csound][buss][channel].front();
+    busspointer = createBuss(csound, buss, channel);
+    if (UNLIKELY(busspointer == 0)) {
+      return csound->InitError(csound, Str("MixerReceive: no channel %d in "
+                                           "buss %d"),
+                               (int)channel, (int)buss);
+    }
 #ifdef ENABLE_MIXER_IDEBUG
     warn(csound, "MixerReceive::init csound %p buss %d channel "
                  "%d frames %d busspointer %p\n",
@@ -246,9 +318,7 @@ struct MixerReceive : public OpcodeBase<MixerReceive> {
 #else
     IGN(csound);
 #endif
-    for (size_t i = 0; i < frames; i++) {
-      aoutput[i] = busspointer[i];
-    }
+    std::memcpy(aoutput, busspointer, frames * sizeof(MYFLT));
 #ifdef ENABLE_MIXER_KDEBUG
     warn(csound, "MixerReceive::audio aoutput %p busspointer %p\n", aoutput,
          buss);
@@ -268,31 +338,22 @@ struct MixerClear : public OpcodeBase<MixerClear> {
   // No output.
   // No input.
   // State.
-  std::map<CSOUND *, std::map<size_t, std::vector<std::vector<MYFLT>>>> *busses;
+  Mixer *mixer;
   int init(CSOUND *csound) {
-    csound::QueryGlobalPointer(csound, "busses", busses);
+    mixer = getMixer(csound);
     return OK;
   }
   int audio(CSOUND *csound) {
 #ifdef ENABLE_MIXER_KDEBUG
-    warn(csound, "MixerClear::audio...\n")
+    warn(csound, "MixerClear::audio...\n");
+#else
+    IGN(csound);
 #endif
-        for (std::map<size_t, std::vector<std::vector<MYFLT>>>::iterator busi =
-                 (*busses)[csound].begin();
-             busi != (*busses)[csound].end(); ++busi) {
-      for (std::vector<std::vector<MYFLT>>::iterator channeli =
-               busi->second.begin();
-           channeli != busi->second.end(); ++channeli) {
-        for (std::vector<MYFLT>::iterator framei = (*channeli).begin();
-             framei != (*channeli).end(); ++framei) {
-          *framei = 0;
-        }
-      }
-    }
+    mixer->clear();
 #ifdef ENABLE_MIXER_KDEBUG
-    warn(csound, "MixerClear::audio\n")
+    warn(csound, "MixerClear::audio\n");
 #endif
-        return OK;
+    return OK;
   }
 };
 
@@ -316,14 +377,8 @@ static OENTRY localops[] = {
     {NULL, 0, 0, 0, NULL, NULL, (SUBR)NULL, (SUBR)NULL, (SUBR)NULL}};
 
 PUBLIC int csoundModuleCreate_mixer(CSOUND *csound) {
-  std::map<CSOUND *, std::map<size_t, std::vector<std::vector<MYFLT>>>>
-      *busses = 0;
-  busses =
-      new std::map<CSOUND *, std::map<size_t, std::vector<std::vector<MYFLT>>>>;
-  csound::CreateGlobalPointer(csound, "busses", busses);
-  std::map<CSOUND *, std::map<size_t, std::map<size_t, MYFLT>>> *matrix = 0;
-  matrix = new std::map<CSOUND *, std::map<size_t, std::map<size_t, MYFLT>>>;
-  csound::CreateGlobalPointer(csound, "matrix", matrix);
+  Mixer *mixer = new Mixer;
+  csound::CreateGlobalPointer(csound, "mixer", mixer);
   return OK;
 }
 
@@ -342,48 +397,11 @@ PUBLIC int csoundModuleInit_mixer(CSOUND *csound) {
   return err;
 }
 
-/*
- * The mixer busses are laid out:
- * busses[csound][bus][channel][frame].
- * std::map<CSOUND *, std::map<size_t,
- *          std::vector< std::vector<MYFLT> > > > *busses = 0;
- * The mixer send matrix is laid out:
- * matrix[csound][send][bus].
- * std::map<CSOUND *, std::map<size_t, std::map<size_t, MYFLT> > > *matrix = 0;
- */
 PUBLIC int csoundModuleDestroy_mixer(CSOUND *csound) {
-  std::map<CSOUND *, std::map<size_t, std::vector<std::vector<MYFLT>>>>
-      *busses = 0;
-  csound::QueryGlobalPointer(csound, "busses", busses);
-  if (busses) {
-    for (std::map<size_t, std::vector<std::vector<MYFLT>>>::iterator busi =
-             (*busses)[csound].begin();
-         busi != (*busses)[csound].end(); ++busi) {
-      for (std::vector<std::vector<MYFLT>>::iterator channeli =
-               busi->second.begin();
-           channeli != busi->second.end(); ++channeli) {
-        channeli->resize(0);
-      }
-      busi->second.clear();
-    }
-    busses->clear();
-    csound->DestroyGlobalVariable(csound, "busses");
-    delete busses;
-    busses = nullptr;
-  }
-  std::map<CSOUND *, std::map<size_t, std::map<size_t, MYFLT>>> *matrix = 0;
-  csound::QueryGlobalPointer(csound, "matrix", matrix);
-  if (matrix) {
-    // std::map<CSOUND *, std::map<size_t, std::map<size_t, MYFLT> > >
-    for (std::map<size_t, std::map<size_t, MYFLT>>::iterator matrixi =
-             (*matrix)[csound].begin();
-         matrixi != (*matrix)[csound].end(); ++matrixi) {
-      matrixi->second.clear();
-    }
-    matrix->clear();
-    csound->DestroyGlobalVariable(csound, "matrix");
-    delete matrix;
-    matrix = nullptr;
+  Mixer *mixer = getMixer(csound);
+  if (mixer) {
+    csound->DestroyGlobalVariable(csound, "mixer");
+    delete mixer;
   }
   return OK;
 }
@@ -23,8 +23,10 @@
 */
 
 #include "stdopcod.h"
+#include "filterbank.h"
 
 #include "newfils.h"
+#include "filtcoefs.h"
 #include <math.h>
 
 static inline
@@ -153,6 +155,80 @@ static int32_t moogladder_process(CSOUND *csound, moogladder *p)
     return OK;
 }
 
+static int32_t moogladder_init_a(CSOUND *csound, moogladder_a *p)
+{
+    if (LIKELY(*p->istor == FL(0.0))) {
+      p->oldfreq = FL(0.0);
+      p->oldres = -FL(1.0);     /* ensure calculation on first cycle */
+    }
+    return fbank_init(csound, &p->fb, p->out, p->in, 1, 9,
+                      *p->istor != FL(0.0));
+}
+
+static int32_t moogladder_process_a(CSOUND *csound, moogladder_a *p)
+{
+    MYFLT   freq = *p->freq;
+    MYFLT   res = *p->res;
+    double  res4, acr, tune;
+    int32_t     c, j, n = p->fb.nchnls;
+    double  *d0 = p->fb.state, *d1 = d0 + n, *d2 = d1 + n, *d3 = d2 + n,
+            *d4 = d3 + n, *d5 = d4 + n;
+    double  *t0 = d5 + n, *t1 = t0 + n, *t2 = t1 + n;
+    uint32_t offset = p->h.insdshead->ksmps_offset;
+    uint32_t early  = p->h.insdshead->ksmps_no_end;
+    uint32_t i, nsmps = CS_KSMPS - early;
+
+    if (UNLIKELY(fbank_load(csound, &(p->h), &p->fb, p->in,
+                            offset, nsmps) != OK))
+      return NOTOK;
+    if (res < 0) res = 0;
+
+    if (p->oldfreq != freq || p->oldres != res) {
+      double  f, fc, fc2, fc3, fcr;
+      p->oldfreq = freq;
+      fc =  (double)(freq/CS_ESR);
+      f  =  0.5*fc;
+      fc2 = fc*fc;
+      fc3 = fc2*fc;
+      fcr = 1.8730*fc3 + 0.4955*fc2 - 0.6490*fc + 0.9988;
+      acr = -3.9364*fc2 + 1.8409*fc + 0.9968;
+      tune = (1.0 - exp(-(TWOPI*f*fcr))) / THERMAL;
+      p->oldres = res;
+      p->oldacr = acr;
+      p->oldtune = tune;
+    }
+    else {
+      res = p->oldres;
+      acr = p->oldacr;
+      tune = p->oldtune;
+    }
+    res4 = 4.0*(double)res*acr;
+
+    /* the stages of moogladder_process, across the channels */
+    for (i = offset; i < nsmps; i++) {
+      MYFLT *x = &p->fb.x[i * n];
+      for (j = 0; j < 2; j++) {
+        for (c = 0; c < n; c++) {
+          double input = x[c] - res4*d5[c], stg0, stg1, stg2, stg3;
+          d0[c] = stg0 = d0[c] + tune*(tanh(input*THERMAL) - t0[c]);
+          stg1 = d1[c] + tune*((t0[c] = tanh(stg0*THERMAL)) - t1[c]);
+          d1[c] = stg1;
+          stg2 = d2[c] + tune*((t1[c] = tanh(stg1*THERMAL)) - t2[c]);
+          d2[c] = stg2;
+          stg3 = d3[c] + tune*((t2[c] = tanh(stg2*THERMAL))
+                               - tanh(d3[c]*THERMAL));
+          d3[c] = stg3;
+          d5[c] = (stg3 + d4[c])*0.5;
+          d4[c] = stg3;
+        }
+      }
+      for (c = 0; c < n; c++)
+        x[c] = (MYFLT) d5[c];
+    }
+    fbank_store(&p->fb, 0, p->out, offset, nsmps);
+    return OK;
+}
+
 static int32_t moogladder_process_aa(CSOUND *csound, moogladder *p)
 {
     MYFLT   *out = p->out;
@@ -182,7 +258,7 @@ static int32_t moogladder_process_aa(CSOUND *csound, moogladder *p)
       /* frequency & amplitude correction  */
       fcr = 1.8730*fc3 + 0.4955*fc2 - 0.6490*fc + 0.9988;
       acr = -3.9364*fc2 + 1.8409*fc + 0.9968;
-      tune = (1.0 - exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
+      tune = (1.0 - fm_exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
       p->oldres = cres;
       p->oldacr = acr;
       p->oldtune = tune;
@@ -211,7 +287,7 @@ static int32_t moogladder_process_aa(CSOUND *csound, moogladder *p)
         /* frequency & amplitude correction  */
         fcr = 1.8730*fc3 + 0.4955*fc2 - 0.6490*fc + 0.9988;
         acr = -3.9364*fc2 + 1.8409*fc + 0.9968;
-        tune = (1.0 - exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
+        tune = (1.0 - fm_exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
         p->oldres = cres;
         p->oldacr = acr;
         p->oldtune = tune;
@@ -281,7 +357,7 @@ static int32_t moogladder_process_ak(CSOUND *csound, moogladder *p)
       /* frequency & amplitude correction  */
       fcr = 1.8730*fc3 + 0.4955*fc2 - 0.6490*fc + 0.9988;
       acr = -3.9364*fc2 + 1.8409*fc + 0.9968;
-      tune = (1.0 - exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
+      tune = (1.0 - fm_exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
       p->oldres = res;
       p->oldacr = acr;
       p->oldtune = tune;
@@ -310,7 +386,7 @@ static int32_t moogladder_process_ak(CSOUND *csound, moogladder *p)
         /* frequency & amplitude correction  */
         fcr = 1.8730*fc3 + 0.4955*fc2 - 0.6490*fc + 0.9988;
         acr = -3.9364*fc2 + 1.8409*fc + 0.9968;
-        tune = (1.0 - exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
+        tune = (1.0 - fm_exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
         p->oldacr = acr;
         p->oldtune = tune;
         res4 = 4.0*(double)res*acr;
@@ -380,7 +456,7 @@ static int32_t moogladder_process_ka(CSOUND *csound, moogladder *p)
       /* frequency & amplitude correction  */
       fcr = 1.8730*fc3 + 0.4955*fc2 - 0.6490*fc + 0.9988;
       acr = -3.9364*fc2 + 1.8409*fc + 0.9968;
-      tune = (1.0 - exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
+      tune = (1.0 - fm_exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
       p->oldres = cres;
       p->oldacr = acr;
       p->oldtune = tune;
@@ -408,7 +484,7 @@ static int32_t moogladder_process_ka(CSOUND *csound, moogladder *p)
         /* frequency & amplitude correction  */
         fcr = 1.8730*fc3 + 0.4955*fc2 - 0.6490*fc + 0.9988;
         acr = -3.9364*fc2 + 1.8409*fc + 0.9968;
-        tune = (1.0 - exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
+        tune = (1.0 - fm_exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
         p->oldres = cres = res[i];
         p->oldacr = acr;
         p->oldtune = tune;
@@ -559,7 +635,7 @@ static int32_t moogladder2_process_aa(CSOUND *csound, moogladder *p)
       /* frequency & amplitude correction  */
       fcr = 1.8730*fc3 + 0.4955*fc2 - 0.6490*fc + 0.9988;
       acr = -3.9364*fc2 + 1.8409*fc + 0.9968;
-      tune = (1.0 - exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
+      tune = (1.0 - fm_exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
       p->oldres = cres;
       p->oldacr = acr;
       p->oldtune = tune;
@@ -588,7 +664,7 @@ static int32_t moogladder2_process_aa(CSOUND *csound, moogladder *p)
         /* frequency & amplitude correction  */
         fcr = 1.8730*fc3 + 0.4955*fc2 - 0.6490*fc + 0.9988;
         acr = -3.9364*fc2 + 1.8409*fc + 0.9968;
-        tune = (1.0 - exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
+        tune = (1.0 - fm_exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
         p->oldres = cres;
         p->oldacr = acr;
         p->oldtune = tune;
@@ -658,7 +734,7 @@ static int32_t moogladder2_process_ak(CSOUND *csound, moogladder *p)
       /* frequency & amplitude correction  */
       fcr = 1.8730*fc3 + 0.4955*fc2 - 0.6490*fc + 0.9988;
       acr = -3.9364*fc2 + 1.8409*fc + 0.9968;
-      tune = (1.0 - exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
+      tune = (1.0 - fm_exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
       p->oldres = res;
       p->oldacr = acr;
       p->oldtune = tune;
@@ -687,7 +763,7 @@ static int32_t moogladder2_process_ak(CSOUND *csound, moogladder *p)
         /* frequency & amplitude correction  */
         fcr = 1.8730*fc3 + 0.4955*fc2 - 0.6490*fc + 0.9988;
         acr = -3.9364*fc2 + 1.8409*fc + 0.9968;
-        tune = (1.0 - exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
+        tune = (1.0 - fm_exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
         p->oldacr = acr;
         p->oldtune = tune;
         res4 = 4.0*(double)res*acr;
@@ -757,7 +833,7 @@ static int32_t moogladder2_process_ka(CSOUND *csound, moogladder *p)
       /* frequency & amplitude correction  */
       fcr = 1.8730*fc3 + 0.4955*fc2 - 0.6490*fc + 0.9988;
       acr = -3.9364*fc2 + 1.8409*fc + 0.9968;
-      tune = (1.0 - exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
+      tune = (1.0 - fm_exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
       p->oldres = cres;
       p->oldacr = acr;
       p->oldtune = tune;
@@ -785,7 +861,7 @@ static int32_t moogladder2_process_ka(CSOUND *csound, moogladder *p)
         /* frequency & amplitude correction  */
         fcr = 1.8730*fc3 + 0.4955*fc2 - 0.6490*fc + 0.9988;
         acr = -3.9364*fc2 + 1.8409*fc + 0.9968;
-        tune = (1.0 - exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
+        tune = (1.0 - fm_exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
         p->oldres = cres = res[i];
         p->oldacr = acr;
         p->oldtune = tune;
@@ -877,7 +953,9 @@ static int32_t statevar_process(CSOUND *csound,statevar *p)
       MYFLT fr = (asgfr ? freq[i] : *freq);
       MYFLT rs = (asgrs ? res[i] : *res);
       if (p->oldfreq != fr|| p->oldres != rs) {
-        f = 2.0*sin(fr*(double)csound->pidsr/ostimes);
+        double w = fr*(double)csound->pidsr/ostimes;
+        /* with an a-rate frequency this may change every sample */
+        f = 2.0*(asgfr ? fm_sin(w) : sin(w));
         q = 1.0/rs;
         lim = ((2.0 - f) *0.05)/ostimes;
         /* csound->Message(csound, "lim: %f, q: %f \n", lim, q); */
@@ -919,9 +997,30 @@ static int32_t fofilter_init(CSOUND *csound,fofilter *p)
       for (i=0;i<4; i++)
         p->delay[i] = 0.0;
     }
+    p->lfrq = p->lrs = p->ldc = -FL(1.0);  /* coefficients on first cycle */
+    p->rrad1 = p->rrad2 = p->cosang = 0.0;
     return OK;
 }
 
+/* one sample of the two resonators of fofilter */
+static inline double fofilter_tick(double *delay, double in, double rrad1,
+                                   double rrad2, double cosang)
+{
+    double w1, y1, w2, y2;
+
+    w1  = in + 2.0*rrad1*cosang*delay[0] - rrad1*rrad1*delay[1];
+    y1 =  w1 - delay[1];
+    delay[1] = delay[0];
+    delay[0] = w1;
+
+    w2  = in + 2.0*rrad2*cosang*delay[2] - rrad2*rrad2*delay[3];
+    y2 =  w2 - delay[3];
+    delay[3] = delay[2];
+    delay[2] = w2;
+
+    return y1 - y2;
+}
+
 static int32_t fofilter_process(CSOUND *csound,fofilter *p)
 {
     MYFLT  *out = p->out;
@@ -929,12 +1028,12 @@ static int32_t fofilter_process(CSOUND *csound,fofilter *p)
     MYFLT  *freq = p->freq;
     MYFLT  *ris = p->ris;
     MYFLT  *dec = p->dec;
-    double  *delay = p->delay,ang=0,fsc,rrad1=0,rrad2=0;
-    double  w1,y1,w2,y2;
+    double  *delay = p->delay,ang,fsc;
+    double  rrad1 = p->rrad1, rrad2 = p->rrad2, cosang = p->cosang;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     uint32_t i, nsmps = CS_KSMPS;
-    MYFLT lfrq = -FL(1.0), lrs = -FL(1.0), ldc = -FL(1.0);
+    MYFLT lfrq = p->lfrq, lrs = p->lrs, ldc = p->ldc;
     int32_t   asgfr = IS_ASIG_ARG(p->freq) , asgrs = IS_ASIG_ARG(p->ris);
     int32_t   asgdc = IS_ASIG_ARG(p->dec);
 
@@ -943,6 +1042,38 @@ static int32_t fofilter_process(CSOUND *csound,fofilter *p)
       nsmps -= early;
       memset(&out[nsmps], '\0', early*sizeof(MYFLT));
     }
+    if ((asgfr && !filt_unchanged(&freq[offset], nsmps-offset, lfrq)) ||
+        (asgrs && !filt_unchanged(&ris[offset], nsmps-offset, lrs)) ||
+        (asgdc && !filt_unchanged(&dec[offset], nsmps-offset, ldc))) {
+      /* a-rate parameters that change: the coefficients of up to
+         FILT_CHUNK samples at a time (H/filtcoefs.h), then the
+         recursion over them */
+      double   co[3][FILT_CHUNK];
+      uint32_t nn, n;
+      for (nn=offset; nn<nsmps; nn+=n) {
+        n = (nsmps-nn < FILT_CHUNK ? nsmps-nn : FILT_CHUNK);
+        for (i=0; i<n; i++) {
+          MYFLT frq = asgfr ? freq[nn+i] : *freq;
+          MYFLT rs = asgrs ? ris[nn+i] : *ris;
+          MYFLT dc = asgdc ? dec[nn+i] : *dec;
+          double w = (double)csound->tpidsr*frq;   /* pole angle */
+          double sc = fm_sin(w) - 3.0;              /* freq scl   */
+          co[0][i] = fm_pow(10.0, sc/(dc*CS_ESR));   /* filter radii */
+          co[1][i] = fm_pow(10.0, sc/(rs*CS_ESR));
+          co[2][i] = fm_cos(w);
+        }
+        for (i=0; i<n; i++)
+          out[nn+i] = (MYFLT) fofilter_tick(delay, in[nn+i], co[0][i],
+                                            co[1][i], co[2][i]);
+        rrad1 = co[0][n-1]; rrad2 = co[1][n-1]; cosang = co[2][n-1];
+      }
+      lfrq = asgfr ? freq[nsmps-1] : *freq;
+      lrs = asgrs ? ris[nsmps-1] : *ris;
+      ldc = asgdc ? dec[nsmps-1] : *dec;
+      p->lfrq = lfrq; p->lrs = lrs; p->ldc = ldc;
+      p->rrad1 = rrad1; p->rrad2 = rrad2; p->cosang = cosang;
+      return OK;
+    }
     for (i=offset;i<nsmps;i++) {
       MYFLT frq = asgfr ? freq[i] : *freq;
       MYFLT rs = asgrs ? ris[i] : *ris;
@@ -953,20 +1084,12 @@ static int32_t fofilter_process(CSOUND *csound,fofilter *p)
         fsc = sin(ang) - 3.0;                      /* freq scl   */
         rrad1 =  pow(10.0, fsc/(dc*CS_ESR));  /* filter radii */
         rrad2 =  pow(10.0, fsc/(rs*CS_ESR));
+        cosang = cos(ang);
       }
-
-      w1  = in[i] + 2.0*rrad1*cos(ang)*delay[0] - rrad1*rrad1*delay[1];
-      y1 =  w1 - delay[1];
-      delay[1] = delay[0];
-      delay[0] = w1;
-
-      w2  = in[i] + 2.0*rrad2*cos(ang)*delay[2] - rrad2*rrad2*delay[3];
-      y2 =  w2 - delay[3];
-      delay[3] = delay[2];
-      delay[2] = w2;
-
-      out[i] = (MYFLT) (y1 - y2);
+      out[i] = (MYFLT) fofilter_tick(delay, in[i], rrad1, rrad2, cosang);
     }
+    p->lfrq = lfrq; p->lrs = lrs; p->ldc = ldc;
+    p->rrad1 = rrad1; p->rrad2 = rrad2; p->cosang = cosang;
     return OK;
 }
 
@@ -2274,6 +2397,8 @@ static OENTRY localops[] =
    (SUBR) moogladder_init, (SUBR) moogladder_process_ak },
    {"moogladder.ka", sizeof(moogladder), 0, 3, "a", "akap",
    (SUBR) moogladder_init, (SUBR) moogladder_process_ka },
+   {"moogladder.A", sizeof(moogladder_a), 0, 3, "a[]", "a[]kkp",
+   (SUBR) moogladder_init_a, (SUBR) moogladder_process_a },
    {"moogladder2.kk", sizeof(moogladder), 0, 3, "a", "akkp",
    (SUBR) moogladder_init, (SUBR) moogladder2_process },
    {"moogladder2.aa", sizeof(moogladder), 0, 3, "a", "aaap",
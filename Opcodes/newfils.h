@@ -107,6 +107,22 @@ typedef struct _moogladder {
 static int32_t moogladder_init(CSOUND *csound,moogladder *p);
 static int32_t moogladder_process(CSOUND *csound,moogladder *p);
 
+/* bank of moogladders over the channels of an audio array */
+typedef struct _moogladder_a {
+  OPDS    h;
+  ARRAYDAT *out;
+  ARRAYDAT *in;
+  MYFLT   *freq;
+  MYFLT   *res;
+  MYFLT   *istor;
+
+  FBANK   fb;           /* state: delay[6] and tanhstg[3] per channel */
+  MYFLT   oldfreq;
+  MYFLT   oldres;
+  double  oldacr;
+  double  oldtune;
+} moogladder_a;
+
 typedef struct _statevar {
   OPDS    h;
   MYFLT   *outhp;
@@ -142,6 +158,8 @@ typedef struct _fofilter {
   MYFLT   *istor;
 
   double  delay[4];
+  MYFLT   lfrq, lrs, ldc;   /* coefficients of lfrq, lrs and ldc */
+  double  rrad1, rrad2, cosang;
 } fofilter;
 
 static int32_t fofilter_init(CSOUND *csound,fofilter *p);
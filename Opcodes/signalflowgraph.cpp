@@ -126,6 +126,7 @@
 #include "sysdep.h"
 #include "text.h"
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstdio>
 #include <cstring>
@@ -235,15 +236,103 @@ bool operator<(const EventBlock &a, const EventBlock &b) {
 // Identifiers are always "sourcename:outletname" and "sinkname:inletname",
 // or "sourcename:idname:outletname" and "sinkname:inletname."
 
+/**
+ * The instances of one outlet. Outlet init and noteoff change the
+ * instances with the ports lock held, then publish an immutable copy
+ * that inlets read at performance time without taking the lock. A
+ * replaced copy may still be read by an inlet in the same kperiod,
+ * so it is only deleted once the kcounter has moved on.
+ */
+template <typename T> struct OutletPort {
+  std::vector<T *> instances;
+  std::atomic<const std::vector<T *> *> snapshot;
+  std::vector<std::pair<uint64_t, const std::vector<T *> *>> retired;
+  OutletPort() : snapshot(new std::vector<T *>) {}
+  ~OutletPort() {
+    delete snapshot.load();
+    for (size_t i = 0, n = retired.size(); i < n; i++) {
+      delete retired[i].second;
+    }
+  }
+  /**
+   * The instances to sum; safe without the lock.
+   */
+  const std::vector<T *> &current() const {
+    return *snapshot.load(std::memory_order_acquire);
+  }
+  /**
+   * These must be called with the ports lock held.
+   */
+  bool add(CSOUND *csound, T *instance) {
+    if (std::find(instances.begin(), instances.end(), instance) !=
+        instances.end()) {
+      return false;
+    }
+    instances.push_back(instance);
+    publish(csound);
+    return true;
+  }
+  void remove(CSOUND *csound, T *instance) {
+    typename std::vector<T *>::iterator it =
+        std::find(instances.begin(), instances.end(), instance);
+    if (it != instances.end()) {
+      instances.erase(it);
+      publish(csound);
+    }
+  }
+  void publish(CSOUND *csound) {
+    uint64_t kcounter = csound->GetKcounter(csound);
+    retired.push_back(
+        std::make_pair(kcounter, snapshot.load(std::memory_order_relaxed)));
+    snapshot.store(new std::vector<T *>(instances), std::memory_order_release);
+    size_t kept = 0;
+    for (size_t i = 0, n = retired.size(); i < n; i++) {
+      if (retired[i].first < kcounter) {
+        delete retired[i].second;
+      } else {
+        retired[kept++] = retired[i];
+      }
+    }
+    retired.resize(kept);
+  }
+};
+
+/**
+ * Outlet ports by identifier. Ports are created on first use and live
+ * until the graph is cleared, so inlets resolve their connections to
+ * port pointers once, at init time.
+ */
+template <typename T> struct OutletPorts {
+  std::map<std::string, size_t> indexes;
+  std::vector<OutletPort<T> *> ports;
+  ~OutletPorts() { clear(); }
+  OutletPort<T> *operator[](const std::string &id) {
+    std::map<std::string, size_t>::iterator it = indexes.find(id);
+    if (it != indexes.end()) {
+      return ports[it->second];
+    }
+    indexes[id] = ports.size();
+    ports.push_back(new OutletPort<T>);
+    return ports.back();
+  }
+  void clear() {
+    for (size_t i = 0, n = ports.size(); i < n; i++) {
+      delete ports[i];
+    }
+    ports.clear();
+    indexes.clear();
+  }
+};
+
 struct SignalFlowGraphState {
   CSOUND *csound;
   void *signal_flow_ports_lock;
   void *signal_flow_ftables_lock;
-  std::map<std::string, std::vector<Outleta *>> aoutletsForSourceOutletIds;
-  std::map<std::string, std::vector<Outletk *>> koutletsForSourceOutletIds;
-  std::map<std::string, std::vector<Outletf *>> foutletsForSourceOutletIds;
-  std::map<std::string, std::vector<Outletv *>> voutletsForSourceOutletIds;
-  std::map<std::string, std::vector<Outletkid *>> kidoutletsForSourceOutletIds;
+  OutletPorts<Outleta> aoutletsForSourceOutletIds;
+  OutletPorts<Outletk> koutletsForSourceOutletIds;
+  OutletPorts<Outletf> foutletsForSourceOutletIds;
+  OutletPorts<Outletv> voutletsForSourceOutletIds;
+  OutletPorts<Outletkid> kidoutletsForSourceOutletIds;
   std::map<std::string, std::vector<Inleta *>> ainletsForSinkInletIds;
   std::map<std::string, std::vector<Inletk *>> kinletsForSinkInletIds;
   std::map<std::string, std::vector<Inletf *>> finletsForSinkInletIds;
@@ -251,11 +340,11 @@ struct SignalFlowGraphState {
   std::map<std::string, std::vector<Inletkid *>> kidinletsForSinkInletIds;
   std::map<std::string, std::vector<std::string>> connections;
   std::map<EventBlock, int> functionTablesForEvtblks;
-  std::vector<std::vector<std::vector<Outleta *> *> *> aoutletVectors;
-  std::vector<std::vector<std::vector<Outletk *> *> *> koutletVectors;
-  std::vector<std::vector<std::vector<Outletf *> *> *> foutletVectors;
-  std::vector<std::vector<std::vector<Outletv *> *> *> voutletVectors;
-  std::vector<std::vector<std::vector<Outletkid *> *> *> kidoutletVectors;
+  std::vector<std::vector<OutletPort<Outleta> *> *> aoutletVectors;
+  std::vector<std::vector<OutletPort<Outletk> *> *> koutletVectors;
+  std::vector<std::vector<OutletPort<Outletf> *> *> foutletVectors;
+  std::vector<std::vector<OutletPort<Outletv> *> *> voutletVectors;
+  std::vector<std::vector<OutletPort<Outletkid> *> *> kidoutletVectors;
   SignalFlowGraphState(CSOUND *csound_) {
     csound = csound_;
     signal_flow_ports_lock = csound->Create_Mutex(0);
@@ -265,15 +354,15 @@ struct SignalFlowGraphState {
   void clear() {
     LockGuard guard(csound, signal_flow_ports_lock);
 
-    for (std::vector<std::vector<std::vector<Outleta *> *> *>::iterator it = aoutletVectors.begin(), end = aoutletVectors.end(); it != end; it++)
+    for (std::vector<std::vector<OutletPort<Outleta> *> *>::iterator it = aoutletVectors.begin(), end = aoutletVectors.end(); it != end; it++)
       delete *it;
-    for (std::vector<std::vector<std::vector<Outletk *> *> *>::iterator it = koutletVectors.begin(), end = koutletVectors.end(); it != end; it++)
+    for (std::vector<std::vector<OutletPort<Outletk> *> *>::iterator it = koutletVectors.begin(), end = koutletVectors.end(); it != end; it++)
       delete *it;
-    for (std::vector<std::vector<std::vector<Outletf *> *> *>::iterator it = foutletVectors.begin(), end = foutletVectors.end(); it != end; it++)
+    for (std::vector<std::vector<OutletPort<Outletf> *> *>::iterator it = foutletVectors.begin(), end = foutletVectors.end(); it != end; it++)
       delete *it;
-    for (std::vector<std::vector<std::vector<Outletv *> *> *>::iterator it = voutletVectors.begin(), end = voutletVectors.end(); it != end; it++)
+    for (std::vector<std::vector<OutletPort<Outletv> *> *>::iterator it = voutletVectors.begin(), end = voutletVectors.end(); it != end; it++)
       delete *it;
-    for (std::vector<std::vector<std::vector<Outletkid *> *> *>::iterator it = kidoutletVectors.begin(), end = kidoutletVectors.end(); it != end; it++)
+    for (std::vector<std::vector<OutletPort<Outletkid> *> *>::iterator it = kidoutletVectors.begin(), end = kidoutletVectors.end(); it != end; it++)
       delete *it;
 
     aoutletsForSourceOutletIds.clear();
@@ -297,7 +386,9 @@ struct SignalFlowGraphState {
 
 // For true thread-safety, access to shared data must be protected.
 // We will use one critical section for each logically independent
-// potential data race here: ports and ftables.
+// potential data race here: ports and ftables. The ports lock is only
+// taken at init and noteoff; inlets sum the published OutletPort
+// snapshots without it.
 
 struct Outleta : public OpcodeNoteoffBase<Outleta> {
   /**
@@ -309,6 +400,7 @@ struct Outleta : public OpcodeNoteoffBase<Outleta> {
    * State.
    */
   char sourceOutletId[0x100];
+  OutletPort<Outleta> *port;
   SignalFlowGraphState *sfg_globals;
   int init(CSOUND *csound) {
     // warn(csound, "BEGAN Outleta::init()...\n");
@@ -323,25 +415,19 @@ struct Outleta : public OpcodeNoteoffBase<Outleta> {
       std::sprintf(sourceOutletId, "%d:%s", opds.insdshead->insno,
                    (char *)Sname->data);
     }
-    std::vector<Outleta *> &aoutlets =
-        sfg_globals->aoutletsForSourceOutletIds[sourceOutletId];
-    if (std::find(aoutlets.begin(), aoutlets.end(), this) == aoutlets.end()) {
-      aoutlets.push_back(this);
+    port = sfg_globals->aoutletsForSourceOutletIds[sourceOutletId];
+    if (port->add(csound, this)) {
       warn(csound, Str("Created instance 0x%x of %d instances of outlet %s\n"),
-           this, aoutlets.size(), sourceOutletId);
+           this, port->instances.size(), sourceOutletId);
     }
     // warn(csound, "ENDED Outleta::init()...\n");
     return OK;
   }
   int noteoff(CSOUND *csound) {
     LockGuard guard(csound, sfg_globals->signal_flow_ports_lock);
-    std::vector<Outleta *> &aoutlets =
-        sfg_globals->aoutletsForSourceOutletIds[sourceOutletId];
-    std::vector<Outleta *>::iterator thisoutlet =
-        std::find(aoutlets.begin(), aoutlets.end(), this);
-    aoutlets.erase(thisoutlet);
+    port->remove(csound, this);
     warn(csound, Str("Removed instance 0x%x of %d instances of outleta %s\n"),
-         this, aoutlets.size(), sourceOutletId);
+         this, port->instances.size(), sourceOutletId);
     return OK;
   }
 };
@@ -359,7 +445,7 @@ struct Inleta : public OpcodeBase<Inleta> {
    * State.
    */
   char sinkInletId[0x100];
-  std::vector<std::vector<Outleta *> *> *sourceOutlets;
+  std::vector<OutletPort<Outleta> *> *sourceOutlets;
   int sampleN;
   SignalFlowGraphState *sfg_globals;
   int init(CSOUND *csound) {
@@ -373,7 +459,7 @@ struct Inleta : public OpcodeBase<Inleta> {
     if (std::find(sfg_globals->aoutletVectors.begin(),
                   sfg_globals->aoutletVectors.end(),
                   sourceOutlets) == sfg_globals->aoutletVectors.end()) {
-      sourceOutlets = new std::vector<std::vector<Outleta *> *>;
+      sourceOutlets = new std::vector<OutletPort<Outleta> *>;
       sfg_globals->aoutletVectors.push_back(sourceOutlets);
     } else {
       sourceOutlets->clear();
@@ -401,11 +487,11 @@ struct Inleta : public OpcodeBase<Inleta> {
         sfg_globals->connections[sinkInletId];
     for (size_t i = 0, n = sourceOutletIds.size(); i < n; i++) {
       const std::string &sourceOutletId = sourceOutletIds[i];
-      std::vector<Outleta *> &aoutlets =
+      OutletPort<Outleta> *aoutlets =
           sfg_globals->aoutletsForSourceOutletIds[sourceOutletId];
-      if (std::find(sourceOutlets->begin(), sourceOutlets->end(), &aoutlets) ==
+      if (std::find(sourceOutlets->begin(), sourceOutlets->end(), aoutlets) ==
           sourceOutlets->end()) {
-        sourceOutlets->push_back(&aoutlets);
+        sourceOutlets->push_back(aoutlets);
         warn(csound, Str("Connected instances of outlet %s to instance 0x%x of "
                          "inlet %s.\n"),
              sourceOutletId.c_str(), this, sinkInletId);
@@ -416,32 +502,41 @@ struct Inleta : public OpcodeBase<Inleta> {
   }
   /**
    * Sum arate values from active outlets feeding this inlet.
+   * The first active outlet is copied rather than added to zeros,
+   * and the sums are plain loops over contiguous buffers that the
+   * compiler vectorizes.
    */
   int audio(CSOUND *csound) {
-    LockGuard guard(csound, sfg_globals->signal_flow_ports_lock);
-    // warn(csound, "BEGAN Inleta::audio()...\n");
-    // Zero the inlet buffer.
-    for (int sampleI = 0; sampleI < sampleN; sampleI++) {
-      asignal[sampleI] = FL(0.0);
-    }
+    IGN(csound);
+    MYFLT *sink = asignal;
+    bool empty = true;
     // Loop over the source connections...
     for (size_t sourceI = 0, sourceN = sourceOutlets->size(); sourceI < sourceN;
          sourceI++) {
       // Loop over the source connection instances...
-      std::vector<Outleta *> *instances = sourceOutlets->at(sourceI);
-      for (size_t instanceI = 0, instanceN = instances->size();
+      const std::vector<Outleta *> &instances = (*sourceOutlets)[sourceI]->current();
+      for (size_t instanceI = 0, instanceN = instances.size();
            instanceI < instanceN; instanceI++) {
-        Outleta *sourceOutlet = instances->at(instanceI);
+        const Outleta *sourceOutlet = instances[instanceI];
         // Skip inactive instances.
         if (sourceOutlet->opds.insdshead->actflg) {
-          for (int sampleI = 0, sampleN = ksmps(); sampleI < sampleN;
-               ++sampleI) {
-            asignal[sampleI] += sourceOutlet->asignal[sampleI];
+          const MYFLT *source = sourceOutlet->asignal;
+          if (empty) {
+            if (source != sink) {
+              std::memcpy(sink, source, sampleN * sizeof(MYFLT));
+            }
+            empty = false;
+          } else {
+            for (int sampleI = 0; sampleI < sampleN; ++sampleI) {
+              sink[sampleI] += source[sampleI];
+            }
           }
         }
       }
     }
-    // warn(csound, "ENDED Inleta::audio().\n");
+    if (empty) {
+      std::memset(sink, 0, sampleN * sizeof(MYFLT));
+    }
     return OK;
   }
 };
@@ -456,6 +551,7 @@ struct Outletk : public OpcodeNoteoffBase<Outletk> {
    * State.
    */
   char sourceOutletId[0x100];
+  OutletPort<Outletk> *port;
   SignalFlowGraphState *sfg_globals;
   int init(CSOUND *csound) {
     csound::QueryGlobalPointer(csound, "sfg_globals", sfg_globals);
@@ -468,24 +564,18 @@ struct Outletk : public OpcodeNoteoffBase<Outletk> {
       std::sprintf(sourceOutletId, "%d:%s", opds.insdshead->insno,
                    (char *)Sname->data);
     }
-    std::vector<Outletk *> &koutlets =
-        sfg_globals->koutletsForSourceOutletIds[sourceOutletId];
-    if (std::find(koutlets.begin(), koutlets.end(), this) == koutlets.end()) {
-      koutlets.push_back(this);
+    port = sfg_globals->koutletsForSourceOutletIds[sourceOutletId];
+    if (port->add(csound, this)) {
       warn(csound, Str("Created instance 0x%x of %d instances of outlet %s\n"),
-           this, koutlets.size(), sourceOutletId);
+           this, port->instances.size(), sourceOutletId);
     }
     return OK;
   }
   int noteoff(CSOUND *csound) {
     LockGuard guard(csound, sfg_globals->signal_flow_ports_lock);
-    std::vector<Outletk *> &koutlets =
-        sfg_globals->koutletsForSourceOutletIds[sourceOutletId];
-    std::vector<Outletk *>::iterator thisoutlet =
-        std::find(koutlets.begin(), koutlets.end(), this);
-    koutlets.erase(thisoutlet);
+    port->remove(csound, this);
     warn(csound, Str("Removed 0x%x of %d instances of outletk %s\n"), this,
-         koutlets.size(), sourceOutletId);
+         port->instances.size(), sourceOutletId);
     return OK;
   }
 };
@@ -503,7 +593,7 @@ struct Inletk : public OpcodeBase<Inletk> {
    * State.
    */
   char sinkInletId[0x100];
-  std::vector<std::vector<Outletk *> *> *sourceOutlets;
+  std::vector<OutletPort<Outletk> *> *sourceOutlets;
   int ksmps;
   SignalFlowGraphState *sfg_globals;
   int init(CSOUND *csound) {
@@ -513,7 +603,7 @@ struct Inletk : public OpcodeBase<Inletk> {
     if (std::find(sfg_globals->koutletVectors.begin(),
                   sfg_globals->koutletVectors.end(),
                   sourceOutlets) == sfg_globals->koutletVectors.end()) {
-      sourceOutlets = new std::vector<std::vector<Outletk *> *>;
+      sourceOutlets = new std::vector<OutletPort<Outletk> *>;
       sfg_globals->koutletVectors.push_back(sourceOutlets);
     } else {
       sourceOutlets->clear();
@@ -540,11 +630,11 @@ struct Inletk : public OpcodeBase<Inletk> {
         sfg_globals->connections[sinkInletId];
     for (size_t i = 0, n = sourceOutletIds.size(); i < n; i++) {
       const std::string &sourceOutletId = sourceOutletIds[i];
-      std::vector<Outletk *> &koutlets =
+      OutletPort<Outletk> *koutlets =
           sfg_globals->koutletsForSourceOutletIds[sourceOutletId];
-      if (std::find(sourceOutlets->begin(), sourceOutlets->end(), &koutlets) ==
+      if (std::find(sourceOutlets->begin(), sourceOutlets->end(), koutlets) ==
           sourceOutlets->end()) {
-        sourceOutlets->push_back(&koutlets);
+        sourceOutlets->push_back(koutlets);
         warn(csound, Str("Connected instances of outlet %s to instance 0x%x"
                          "of inlet %s.\n"),
              sourceOutletId.c_str(), this, sinkInletId);
@@ -556,17 +646,17 @@ struct Inletk : public OpcodeBase<Inletk> {
    * Sum krate values from active outlets feeding this inlet.
    */
   int kontrol(CSOUND *csound) {
-    LockGuard guard(csound, sfg_globals->signal_flow_ports_lock);
+    IGN(csound);
     // Zero the inlet buffer.
     *ksignal = FL(0.0);
     // Loop over the source connections...
     for (size_t sourceI = 0, sourceN = sourceOutlets->size(); sourceI < sourceN;
          sourceI++) {
       // Loop over the source connection instances...
-      const std::vector<Outletk *> *instances = sourceOutlets->at(sourceI);
-      for (size_t instanceI = 0, instanceN = instances->size();
+      const std::vector<Outletk *> &instances = (*sourceOutlets)[sourceI]->current();
+      for (size_t instanceI = 0, instanceN = instances.size();
            instanceI < instanceN; instanceI++) {
-        const Outletk *sourceOutlet = instances->at(instanceI);
+        const Outletk *sourceOutlet = instances[instanceI];
         // Skip inactive instances.
         if (sourceOutlet->opds.insdshead->actflg) {
           *ksignal += *sourceOutlet->ksignal;
@@ -587,6 +677,7 @@ struct Outletf : public OpcodeNoteoffBase<Outletf> {
    * State.
    */
   char sourceOutletId[0x100];
+  OutletPort<Outletf> *port;
   SignalFlowGraphState *sfg_globals;
   int init(CSOUND *csound) {
     csound::QueryGlobalPointer(csound, "sfg_globals", sfg_globals);
@@ -599,23 +690,18 @@ struct Outletf : public OpcodeNoteoffBase<Outletf> {
       std::sprintf(sourceOutletId, "%d:%s", opds.insdshead->insno,
                    (char *)Sname->data);
     }
-    std::vector<Outletf *> &foutlets =
-        sfg_globals->foutletsForSourceOutletIds[sourceOutletId];
-    if (std::find(foutlets.begin(), foutlets.end(), this) == foutlets.end()) {
-      foutlets.push_back(this);
+    port = sfg_globals->foutletsForSourceOutletIds[sourceOutletId];
+    if (port->add(csound, this)) {
       warn(csound, Str("Created instance 0x%x of outlet %s\n"), this,
            sourceOutletId);
     }
     return OK;
   }
   int noteoff(CSOUND *csound) {
-    std::vector<Outletf *> &foutlets =
-        sfg_globals->foutletsForSourceOutletIds[sourceOutletId];
-    std::vector<Outletf *>::iterator thisoutlet =
-        std::find(foutlets.begin(), foutlets.end(), this);
-    foutlets.erase(thisoutlet);
+    LockGuard guard(csound, sfg_globals->signal_flow_ports_lock);
+    port->remove(csound, this);
     warn(csound, Str("Removed 0x%x of %d instances of outletf %s\n"), this,
-         foutlets.size(), sourceOutletId);
+         port->instances.size(), sourceOutletId);
     return OK;
   }
 };
@@ -633,7 +719,7 @@ struct Inletf : public OpcodeBase<Inletf> {
    * State.
    */
   char sinkInletId[0x100];
-  std::vector<std::vector<Outletf *> *> *sourceOutlets;
+  std::vector<OutletPort<Outletf> *> *sourceOutlets;
   int ksmps;
   int lastframe;
   bool fsignalInitialized;
@@ -647,7 +733,7 @@ struct Inletf : public OpcodeBase<Inletf> {
     if (std::find(sfg_globals->foutletVectors.begin(),
                   sfg_globals->foutletVectors.end(),
                   sourceOutlets) == sfg_globals->foutletVectors.end()) {
-      sourceOutlets = new std::vector<std::vector<Outletf *> *>;
+      sourceOutlets = new std::vector<OutletPort<Outletf> *>;
       sfg_globals->foutletVectors.push_back(sourceOutlets);
     } else {
       sourceOutlets->clear();
@@ -674,11 +760,11 @@ struct Inletf : public OpcodeBase<Inletf> {
         sfg_globals->connections[sinkInletId];
     for (size_t i = 0, n = sourceOutletIds.size(); i < n; i++) {
       const std::string &sourceOutletId = sourceOutletIds[i];
-      std::vector<Outletf *> &foutlets =
+      OutletPort<Outletf> *foutlets =
           sfg_globals->foutletsForSourceOutletIds[sourceOutletId];
-      if (std::find(sourceOutlets->begin(), sourceOutlets->end(), &foutlets) ==
+      if (std::find(sourceOutlets->begin(), sourceOutlets->end(), foutlets) ==
           sourceOutlets->end()) {
-        sourceOutlets->push_back(&foutlets);
+        sourceOutlets->push_back(foutlets);
         warn(csound, Str("Connected instances of outlet %s to instance 0x%x of "
                          "inlet %s.\n"),
              sourceOutletId.c_str(), this, sinkInletId);
@@ -690,7 +776,6 @@ struct Inletf : public OpcodeBase<Inletf> {
    * Mix fsig values from active outlets feeding this inlet.
    */
   int audio(CSOUND *csound) {
-    LockGuard guard(csound, sfg_globals->signal_flow_ports_lock);
     int result = OK;
     float *sink = 0;
     float *source = 0;
@@ -700,10 +785,10 @@ struct Inletf : public OpcodeBase<Inletf> {
     for (size_t sourceI = 0, sourceN = sourceOutlets->size(); sourceI < sourceN;
          sourceI++) {
       // Loop over the source connection instances...
-      const std::vector<Outletf *> *instances = sourceOutlets->at(sourceI);
-      for (size_t instanceI = 0, instanceN = instances->size();
+      const std::vector<Outletf *> &instances = (*sourceOutlets)[sourceI]->current();
+      for (size_t instanceI = 0, instanceN = instances.size();
            instanceI < instanceN; instanceI++) {
-        const Outletf *sourceOutlet = instances->at(instanceI);
+        const Outletf *sourceOutlet = instances[instanceI];
         // Skip inactive instances.
         if (sourceOutlet->opds.insdshead->actflg) {
           if (!fsignalInitialized) {
@@ -783,6 +868,7 @@ struct Outletv : public OpcodeNoteoffBase<Outletv> {
    * State.
    */
   char sourceOutletId[0x100];
+  OutletPort<Outletv> *port;
   SignalFlowGraphState *sfg_globals;
   int init(CSOUND *csound) {
     warn(csound, "BEGAN Outletv::init()...\n");
@@ -797,14 +883,12 @@ struct Outletv : public OpcodeNoteoffBase<Outletv> {
       std::sprintf(sourceOutletId, "%d:%s", opds.insdshead->insno,
                    (char *)Sname->data);
     }
-    std::vector<Outletv *> &voutlets =
-        sfg_globals->voutletsForSourceOutletIds[sourceOutletId];
-    if (std::find(voutlets.begin(), voutlets.end(), this) == voutlets.end()) {
-      voutlets.push_back(this);
+    port = sfg_globals->voutletsForSourceOutletIds[sourceOutletId];
+    if (port->add(csound, this)) {
       warn(csound,
            Str("Created instance 0x%x of %d instances of outlet %s (out "
                "arraydat: 0x%x dims: %2d size: %4d [%4d] data: 0x%x (0x%x))\n"),
-           this, voutlets.size(), sourceOutletId, vsignal, vsignal->dimensions,
+           this, port->instances.size(), sourceOutletId, vsignal, vsignal->dimensions,
            vsignal->sizes[0], vsignal->arrayMemberSize, vsignal->data,
            &vsignal->data);
     }
@@ -813,13 +897,9 @@ struct Outletv : public OpcodeNoteoffBase<Outletv> {
   }
   int noteoff(CSOUND *csound) {
     LockGuard guard(csound, sfg_globals->signal_flow_ports_lock);
-    std::vector<Outletv *> &voutlets =
-        sfg_globals->voutletsForSourceOutletIds[sourceOutletId];
-    std::vector<Outletv *>::iterator thisoutlet =
-        std::find(voutlets.begin(), voutlets.end(), this);
-    voutlets.erase(thisoutlet);
+    port->remove(csound, this);
     warn(csound, Str("Removed 0x%x of %d instances of outletv %s\n"), this,
-         voutlets.size(), sourceOutletId);
+         port->instances.size(), sourceOutletId);
     return OK;
   }
 };
@@ -837,7 +917,7 @@ struct Inletv : public OpcodeBase<Inletv> {
    * State.
    */
   char sinkInletId[0x100];
-  std::vector<std::vector<Outletv *> *> *sourceOutlets;
+  std::vector<OutletPort<Outletv> *> *sourceOutlets;
   size_t arraySize;
   size_t myFltsPerArrayElement;
   int sampleN;
@@ -860,7 +940,7 @@ struct Inletv : public OpcodeBase<Inletv> {
     if (std::find(sfg_globals->voutletVectors.begin(),
                   sfg_globals->voutletVectors.end(),
                   sourceOutlets) == sfg_globals->voutletVectors.end()) {
-      sourceOutlets = new std::vector<std::vector<Outletv *> *>;
+      sourceOutlets = new std::vector<OutletPort<Outletv> *>;
       sfg_globals->voutletVectors.push_back(sourceOutlets);
     } else {
       sourceOutlets->clear();
@@ -890,11 +970,11 @@ struct Inletv : public OpcodeBase<Inletv> {
         sfg_globals->connections[sinkInletId];
     for (size_t i = 0, n = sourceOutletIds.size(); i < n; i++) {
       const std::string &sourceOutletId = sourceOutletIds[i];
-      std::vector<Outletv *> &voutlets =
+      OutletPort<Outletv> *voutlets =
           sfg_globals->voutletsForSourceOutletIds[sourceOutletId];
-      if (std::find(sourceOutlets->begin(), sourceOutlets->end(), &voutlets) ==
+      if (std::find(sourceOutlets->begin(), sourceOutlets->end(), voutlets) ==
           sourceOutlets->end()) {
-        sourceOutlets->push_back(&voutlets);
+        sourceOutlets->push_back(voutlets);
         warn(csound, Str("Connected instances of outlet %s to instance 0x%x of "
                          "inlet %s\n"),
              sourceOutletId.c_str(), this, sinkInletId);
@@ -907,33 +987,36 @@ struct Inletv : public OpcodeBase<Inletv> {
    * Sum values from active outlets feeding this inlet.
    */
   int audio(CSOUND *csound) {
-    // warn(csound, "BEGAN Inletv::audio()...\n");
-    LockGuard guard(csound, sfg_globals->signal_flow_ports_lock);
-    for (uint32_t signalI = 0; signalI < arraySize; ++signalI) {
-      vsignal->data[signalI] = FL(0.0);
-    }
+    IGN(csound);
+    MYFLT *sink = vsignal->data;
+    bool empty = true;
     // Loop over the source connections...
     for (size_t sourceI = 0, sourceN = sourceOutlets->size(); sourceI < sourceN;
          sourceI++) {
       // Loop over the source connection instances...
-      std::vector<Outletv *> *instances = sourceOutlets->at(sourceI);
-      for (size_t instanceI = 0, instanceN = instances->size();
+      const std::vector<Outletv *> &instances = (*sourceOutlets)[sourceI]->current();
+      for (size_t instanceI = 0, instanceN = instances.size();
            instanceI < instanceN; instanceI++) {
-        Outletv *sourceOutlet = instances->at(instanceI);
+        const Outletv *sourceOutlet = instances[instanceI];
         // Skip inactive instances.
         if (sourceOutlet->opds.insdshead->actflg) {
-          for (uint32_t signalI = 0; signalI < arraySize; ++signalI) {
-            ARRAYDAT *insignal = sourceOutlet->vsignal;
-            MYFLT *indata = insignal->data;
-            // warn(csound, "Inletv::audio: sourceOutlet: 0%x in arraydat: 0x%x
-            // data: 0x%x (0x%x)\n", sourceOutlet, insignal, indata,
-            // &insignal->data);
-            vsignal->data[signalI] += indata[signalI];
+          const MYFLT *source = sourceOutlet->vsignal->data;
+          if (empty) {
+            if (source != sink) {
+              std::memcpy(sink, source, arraySize * sizeof(MYFLT));
+            }
+            empty = false;
+          } else {
+            for (size_t signalI = 0; signalI < arraySize; ++signalI) {
+              sink[signalI] += source[signalI];
+            }
           }
         }
       }
     }
-    // warn(csound, "ENDED Inletv::audio().\n");
+    if (empty) {
+      std::memset(sink, 0, arraySize * sizeof(MYFLT));
+    }
     return OK;
   }
 };
@@ -950,6 +1033,7 @@ struct Outletkid : public OpcodeNoteoffBase<Outletkid> {
    */
   char sourceOutletId[0x100];
   char *instanceId;
+  OutletPort<Outletkid> *port;
   SignalFlowGraphState *sfg_globals;
   int init(CSOUND *csound) {
     csound::QueryGlobalPointer(csound, "sfg_globals", sfg_globals);
@@ -970,24 +1054,18 @@ struct Outletkid : public OpcodeNoteoffBase<Outletkid> {
       std::sprintf(sourceOutletId, "%d:%s", opds.insdshead->insno,
                    (char *)Sname->data);
     }
-    std::vector<Outletkid *> &koutlets =
-        sfg_globals->kidoutletsForSourceOutletIds[sourceOutletId];
-    if (std::find(koutlets.begin(), koutlets.end(), this) == koutlets.end()) {
-      koutlets.push_back(this);
+    port = sfg_globals->kidoutletsForSourceOutletIds[sourceOutletId];
+    if (port->add(csound, this)) {
       warn(csound, Str("Created instance 0x%x of %d instances of outlet %s\n"),
-           this, koutlets.size(), sourceOutletId);
+           this, port->instances.size(), sourceOutletId);
     }
     return OK;
   }
   int noteoff(CSOUND *csound) {
     LockGuard guard(csound, sfg_globals->signal_flow_ports_lock);
-    std::vector<Outletkid *> &koutlets =
-        sfg_globals->kidoutletsForSourceOutletIds[sourceOutletId];
-    std::vector<Outletkid *>::iterator thisoutlet =
-        std::find(koutlets.begin(), koutlets.end(), this);
-    koutlets.erase(thisoutlet);
+    port->remove(csound, this);
     warn(csound, Str("Removed 0x%x of %d instances of outletkid %s\n"), this,
-         koutlets.size(), sourceOutletId);
+         port->instances.size(), sourceOutletId);
     return OK;
   }
 };
@@ -1007,7 +1085,7 @@ struct Inletkid : public OpcodeBase<Inletkid> {
    */
   char sinkInletId[0x100];
   char *instanceId;
-  std::vector<std::vector<Outletkid *> *> *sourceOutlets;
+  std::vector<OutletPort<Outletkid> *> *sourceOutlets;
   int ksmps;
   SignalFlowGraphState *sfg_globals;
   int init(CSOUND *csound) {
@@ -1017,7 +1095,7 @@ struct Inletkid : public OpcodeBase<Inletkid> {
     if (std::find(sfg_globals->kidoutletVectors.begin(),
                   sfg_globals->kidoutletVectors.end(),
                   sourceOutlets) == sfg_globals->kidoutletVectors.end()) {
-      sourceOutlets = new std::vector<std::vector<Outletkid *> *>;
+      sourceOutlets = new std::vector<OutletPort<Outletkid> *>;
       sfg_globals->kidoutletVectors.push_back(sourceOutlets);
     } else {
       sourceOutlets->clear();
@@ -1046,11 +1124,11 @@ struct Inletkid : public OpcodeBase<Inletkid> {
         sfg_globals->connections[sinkInletId];
     for (size_t i = 0, n = sourceOutletIds.size(); i < n; i++) {
       const std::string &sourceOutletId = sourceOutletIds[i];
-      std::vector<Outletkid *> &koutlets =
+      OutletPort<Outletkid> *koutlets =
           sfg_globals->kidoutletsForSourceOutletIds[sourceOutletId];
-      if (std::find(sourceOutlets->begin(), sourceOutlets->end(), &koutlets) ==
+      if (std::find(sourceOutlets->begin(), sourceOutlets->end(), koutlets) ==
           sourceOutlets->end()) {
-        sourceOutlets->push_back(&koutlets);
+        sourceOutlets->push_back(koutlets);
         warn(csound, Str("Connected instances of outlet %s to instance 0x%x of "
                          "inlet %s.\n"),
              sourceOutletId.c_str(), this, sinkInletId);
@@ -1062,17 +1140,17 @@ struct Inletkid : public OpcodeBase<Inletkid> {
    * Replay instance signal.
    */
   int kontrol(CSOUND *csound) {
-    LockGuard guard(csound, sfg_globals->signal_flow_ports_lock);
+    IGN(csound);
     // Zero the / buffer.
     *ksignal = FL(0.0);
     // Loop over the source connections...
     for (size_t sourceI = 0, sourceN = sourceOutlets->size(); sourceI < sourceN;
          sourceI++) {
       // Loop over the source connection instances...
-      const std::vector<Outletkid *> *instances = sourceOutlets->at(sourceI);
-      for (size_t instanceI = 0, instanceN = instances->size();
+      const std::vector<Outletkid *> &instances = (*sourceOutlets)[sourceI]->current();
+      for (size_t instanceI = 0, instanceN = instances.size();
            instanceI < instanceN; instanceI++) {
-        const Outletkid *sourceOutlet = instances->at(instanceI);
+        const Outletkid *sourceOutlet = instances[instanceI];
         // Skip inactive instances and also all non-matching instances.
         if (sourceOutlet->opds.insdshead->actflg) {
           if (std::strcmp(sourceOutlet->instanceId, instanceId) == 0) {
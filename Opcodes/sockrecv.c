@@ -35,10 +35,12 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <sys/select.h>
 #define SOCKET_ERROR (-1)
 #endif
 #include <string.h>
 #include <errno.h>
+#include "sockstream.h"
 
 #define MAXBUFS 32
 #define MTU (1456)
@@ -106,6 +108,36 @@ typedef struct {
   struct sockaddr_in server_addr;
 } SOCKRECVSTR;
 
+#define SOCKSTREAM_MAXCHN   (16)
+#define SOCKSTREAM_SLOTS    (128)   /* packets queued to the perf thread */
+#define SOCKSTREAM_HIST     (256)   /* frames replayed to conceal a loss */
+#define SOCKSTREAM_FADE     (1024)  /* concealment fade out, in frames */
+#define SOCKSTREAM_MAXDRIFT (0.002) /* max. playback rate correction */
+
+typedef struct {
+  OPDS    h;
+  MYFLT   *asigs[SOCKSTREAM_MAXCHN];
+  MYFLT   *port, *latency, *maxlatency;
+  AUXCH   slots, lens, jb, flags, hist;
+  int32_t     sock, nchnls;
+  volatile int32_t threadon;
+  volatile int32_t qrd, qwr;    /* receiver thread -> perf thread */
+  CSOUND  *cs;
+  void    *thrid;
+  /* jitter buffer, owned by the performance thread */
+  int32_t started, playing;
+  int64_t size, mask;           /* jitter buffer length in frames */
+  int64_t newest;               /* end of the latest frame received */
+  int64_t clock;                /* frames performed */
+  double  rpos;                 /* read position in the stream */
+  double  minlat, maxlat;       /* latency bounds in frames */
+  double  depth, jitter, transit;
+  int32_t hastransit, hwp, conceal;
+  uint32_t seq;
+  uint32_t lost, reordered, late, bad, concealed;
+  struct sockaddr_in server_addr;
+} SOCKRECVM;
+
 static int32_t deinit_udpRecv(CSOUND *csound, void *pdata)
 {
     SOCKRECV *p = (SOCKRECV *) pdata;
@@ -431,6 +463,345 @@ static int32_t send_recvS(CSOUND *csound, SOCKRECV *p)
     return OK;
 }
 
+/* UDP network audio stream, see sockstream.h */
+
+static int32_t deinit_udpRecvm(CSOUND *csound, void *pdata)
+{
+    SOCKRECVM *p = (SOCKRECVM *) pdata;
+
+    p->threadon = 0;
+    csound->JoinThread(p->thrid);
+#ifndef WIN32
+    close(p->sock);
+#else
+    closesocket(p->sock);
+#endif
+    csound->Message(csound, Str("sockrecvm: %u packets lost, %u reordered, "
+                                "%u late, %u invalid; %u frames concealed\n"),
+                    p->lost, p->reordered, p->late, p->bad, p->concealed);
+    return OK;
+}
+
+/* waits up to 10 ms for the socket to become readable */
+static void udp_wait(int32_t sock)
+{
+    fd_set rset;
+    struct timeval tv;
+    FD_ZERO(&rset);
+    FD_SET(sock, &rset);
+    tv.tv_sec = 0;
+    tv.tv_usec = 10000;
+    select(sock + 1, &rset, NULL, NULL, &tv);
+}
+
+/* receives packets straight into the free slots of the queue */
+static uintptr_t udpRecvm(void *pdata)
+{
+    SOCKRECVM *p = (SOCKRECVM *) pdata;
+    unsigned char *slots = (unsigned char *) p->slots.auxp;
+    int32_t *lens = (int32_t *) p->lens.auxp;
+    CSOUND *csound = p->cs;
+#ifdef SOCKSTREAM_MMSG
+    struct mmsghdr msgs[SOCKSTREAM_BATCH];
+    struct iovec iovs[SOCKSTREAM_BATCH];
+#endif
+
+    while (p->threadon) {
+      int32_t wr = p->qwr, n, k;
+      int32_t nfree = (ATOMIC_GET(p->qrd) - wr - 1) & (SOCKSTREAM_SLOTS - 1);
+      if (nfree == 0) {         /* perf thread not keeping up */
+        csound->Sleep(1);
+        continue;
+      }
+#ifdef SOCKSTREAM_MMSG
+      if (nfree > SOCKSTREAM_BATCH) nfree = SOCKSTREAM_BATCH;
+      memset(msgs, 0, nfree * sizeof(struct mmsghdr));
+      for (k = 0; k < nfree; k++) {
+        iovs[k].iov_base =
+          slots + (size_t) ((wr + k) & (SOCKSTREAM_SLOTS - 1)) * SOCKSTREAM_MAXPKT;
+        iovs[k].iov_len = SOCKSTREAM_MAXPKT;
+        msgs[k].msg_hdr.msg_iov = &iovs[k];
+        msgs[k].msg_hdr.msg_iovlen = 1;
+      }
+      n = recvmmsg(p->sock, msgs, nfree, 0, NULL);
+      for (k = 0; k < n; k++)
+        lens[(wr + k) & (SOCKSTREAM_SLOTS - 1)] = (int32_t) msgs[k].msg_len;
+#else
+      {
+        struct sockaddr from;
+        socklen_t clilen = sizeof(from);
+        k = recvfrom(p->sock, (void *) (slots + (size_t) wr * SOCKSTREAM_MAXPKT),
+                     SOCKSTREAM_MAXPKT, 0, &from, &clilen);
+        n = k > 0 ? 1 : 0;
+        if (n) lens[wr] = k;
+      }
+#endif
+      if (n > 0) {
+        ATOMIC_SET(p->qwr, (wr + n) & (SOCKSTREAM_SLOTS - 1));
+      }
+      else udp_wait(p->sock);
+    }
+    return (uintptr_t) 0;
+}
+
+static int32_t init_recvm(CSOUND *csound, SOCKRECVM *p)
+{
+    int32_t nchnls = p->OUTOCOUNT;
+    double  sr = csound->GetSr(csound);
+#if defined(WIN32) && !defined(__CYGWIN__)
+    WSADATA wsaData = {0};
+    int32_t err;
+    if (UNLIKELY((err=WSAStartup(MAKEWORD(2,2), &wsaData))!= 0))
+      return csound->InitError(csound, Str("Winsock2 failed to start: %d"), err);
+#endif
+    if (UNLIKELY(*p->latency <= FL(0.0)))
+      return csound->InitError(csound, Str("sockrecvm: latency must be "
+                                           "positive"));
+    p->cs = csound;
+    p->nchnls = nchnls;
+    p->minlat = *p->latency * sr;
+    p->maxlat = *p->maxlatency > *p->latency ? *p->maxlatency * sr :
+      4.0 * p->minlat;
+    /* the jitter buffer covers the maximum latency and a packet either way */
+    for (p->size = 1024; p->size < 2 * (int64_t) p->maxlat + SOCKSTREAM_MAXPKT;
+         p->size <<= 1) ;
+    p->mask = p->size - 1;
+
+    p->sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (UNLIKELY(p->sock == SOCKET_ERROR)) {
+      return csound->InitError(csound, Str("creating socket"));
+    }
+#ifndef WIN32
+    if (UNLIKELY(fcntl(p->sock, F_SETFL, O_NONBLOCK)<0)) {
+      close(p->sock);
+      return csound->InitError(csound, Str("Cannot set nonblock"));
+    }
+#else
+    {
+      u_long argp = 1;
+      err = ioctlsocket(p->sock, FIONBIO, &argp);
+      if (UNLIKELY(err != NO_ERROR)) {
+        closesocket(p->sock);
+        return csound->InitError(csound, Str("Cannot set nonblock"));
+      }
+    }
+#endif
+    memset(&p->server_addr, 0, sizeof(p->server_addr));
+    p->server_addr.sin_family = AF_INET;    /* it is an INET address */
+    p->server_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    p->server_addr.sin_port = htons((int32_t) *p->port);    /* the port */
+    if (UNLIKELY(bind(p->sock, (struct sockaddr *) &p->server_addr,
+                      sizeof(p->server_addr)) == SOCKET_ERROR)) {
+#ifndef WIN32
+      close(p->sock);
+#else
+      closesocket(p->sock);
+#endif
+      return csound->InitError(csound, Str("bind failed"));
+    }
+
+    csound->AuxAlloc(csound, (size_t) SOCKSTREAM_SLOTS * SOCKSTREAM_MAXPKT,
+                     &p->slots);
+    csound->AuxAlloc(csound, SOCKSTREAM_SLOTS * sizeof(int32_t), &p->lens);
+    csound->AuxAlloc(csound, (size_t) p->size * nchnls * sizeof(MYFLT), &p->jb);
+    csound->AuxAlloc(csound, (size_t) p->size, &p->flags);
+    csound->AuxAlloc(csound, SOCKSTREAM_HIST * nchnls * sizeof(MYFLT),
+                     &p->hist);
+    p->qrd = p->qwr = 0;
+    p->started = p->playing = 0;
+    p->clock = 0;
+    p->jitter = 0.0;
+    p->hwp = p->conceal = 0;
+    p->lost = p->reordered = p->late = p->bad = p->concealed = 0;
+    p->threadon = 1;
+    p->thrid = csound->CreateThread(udpRecvm, (void *) p);
+    csound->RegisterDeinitCallback(csound, (void *) p, deinit_udpRecvm);
+    return OK;
+}
+
+/* stores a received packet in the jitter buffer */
+static void recvm_packet(CSOUND *csound, SOCKRECVM *p,
+                         const unsigned char *b, int32_t len)
+{
+    MYFLT   *jb = (MYFLT *) p->jb.auxp;
+    char    *flags = (char *) p->flags.auxp;
+    int32_t nch, nfr, cch, f, j, nchnls = p->nchnls;
+    uint32_t seq;
+    int64_t ts, rbase;
+    double  transit;
+
+    if (UNLIKELY(len < SOCKSTREAM_HDR ||
+                 sockstream_get16(b) != SOCKSTREAM_MAGIC ||
+                 b[2] != SOCKSTREAM_VERSION)) {
+      p->bad++;
+      return;
+    }
+    nch = b[3];
+    seq = sockstream_get32(b + 4);
+    ts = (int64_t) sockstream_get64(b + 8);
+    nfr = (int32_t) sockstream_get16(b + 16);
+    if (UNLIKELY(nch == 0 ||
+                 (int64_t) nfr * nch * 4 > (int64_t) len - SOCKSTREAM_HDR)) {
+      p->bad++;
+      return;
+    }
+    /* (re)synchronise at the start, or when the stream jumps, e.g. on a
+       sender restart */
+    rbase = (int64_t) p->rpos;
+    if (!p->started || ts + nfr <= rbase - p->size ||
+        ts + nfr > rbase + p->size) {
+      memset(flags, 0, (size_t) p->size);
+      p->started = 1;
+      p->playing = 0;
+      p->rpos = (double) ts;
+      p->newest = ts;
+      p->seq = seq - 1;
+      p->hastransit = 0;
+      rbase = ts;
+    }
+    /* loss and reordering statistics */
+    if ((int32_t) (seq - p->seq) > 0) {
+      p->lost += seq - p->seq - 1;
+      p->seq = seq;
+    }
+    else {
+      p->reordered++;
+      if (p->lost > 0) p->lost--;
+    }
+    /* interarrival jitter estimate, in frames (as RFC 3550) */
+    transit = (double) (p->clock - ts);
+    if (p->hastransit)
+      p->jitter += (fabs(transit - p->transit) - p->jitter) / 16.0;
+    p->transit = transit;
+    p->hastransit = 1;
+
+    if (ts + nfr <= rbase) {    /* too late to be played */
+      p->late++;
+      return;
+    }
+    cch = nch < nchnls ? nch : nchnls;
+    b += SOCKSTREAM_HDR;
+    for (f = 0; f < nfr; f++, b += nch * 4) {
+      int64_t pos = ts + f;
+      MYFLT   *fr;
+      if (pos < rbase) continue;
+      fr = jb + (size_t) (pos & p->mask) * nchnls;
+      for (j = 0; j < cch; j++)
+        fr[j] = sockstream_getf(b + j * 4) * csound->e0dbfs;
+      for ( ; j < nchnls; j++)
+        fr[j] = FL(0.0);
+      flags[pos & p->mask] = 1;
+    }
+    if (ts + nfr > p->newest) p->newest = ts + nfr;
+}
+
+static int32_t send_recvm(CSOUND *csound, SOCKRECVM *p)
+{
+    unsigned char *slots = (unsigned char *) p->slots.auxp;
+    int32_t *lens = (int32_t *) p->lens.auxp;
+    MYFLT   *jb = (MYFLT *) p->jb.auxp;
+    MYFLT   *hist = (MYFLT *) p->hist.auxp;
+    char    *flags = (char *) p->flags.auxp;
+    uint32_t offset = p->h.insdshead->ksmps_offset;
+    uint32_t early  = p->h.insdshead->ksmps_no_end;
+    uint32_t i, nsmps = CS_KSMPS;
+    int32_t rd, wr, j, nchnls = p->nchnls;
+    double  ratio = 1.0;
+
+    /* take the packets received since the last period */
+    rd = p->qrd;
+    wr = ATOMIC_GET(p->qwr);
+    for ( ; rd != wr; rd = (rd + 1) & (SOCKSTREAM_SLOTS - 1))
+      recvm_packet(csound, p, slots + (size_t) rd * SOCKSTREAM_MAXPKT,
+                   lens[rd]);
+    ATOMIC_SET(p->qrd, rd);
+
+    if (p->started) {
+      /* the target latency follows the measured jitter */
+      double target = p->minlat + 4.0 * p->jitter;
+      double depth = (double) p->newest - p->rpos;
+      if (target > p->maxlat) target = p->maxlat;
+      if (!p->playing) {
+        if (depth >= target) {
+          p->playing = 1;
+          p->depth = depth;
+          p->conceal = SOCKSTREAM_FADE;
+        }
+      }
+      else if (depth < -p->maxlat) {
+        p->started = p->playing = 0;        /* the stream has stopped */
+      }
+      else {
+        double err;
+        p->depth += (depth - p->depth) * 0.01;
+        err = p->depth - target;
+        if (fabs(err) > target + p->maxlat) {
+          /* too far off to correct smoothly */
+          int64_t k, i0 = (int64_t) p->rpos;
+          p->rpos = (double) p->newest - target;
+          p->depth = target;
+          for (k = i0; k < (int64_t) p->rpos && k < i0 + p->size; k++)
+            flags[k & p->mask] = 0;
+        }
+        else {
+          /* drift compensation: resample by a small ratio towards the
+             target latency */
+          ratio = 1.0 + err / csound->GetSr(csound);
+          if (ratio > 1.0 + SOCKSTREAM_MAXDRIFT)
+            ratio = 1.0 + SOCKSTREAM_MAXDRIFT;
+          else if (ratio < 1.0 - SOCKSTREAM_MAXDRIFT)
+            ratio = 1.0 - SOCKSTREAM_MAXDRIFT;
+        }
+      }
+    }
+
+    for (i = 0; i < nsmps; i++) {
+      int64_t i0, i1, k;
+      MYFLT   frac, *h = hist + (size_t) p->hwp * nchnls;
+      if (!p->playing) {
+        for (j = 0; j < nchnls; j++) p->asigs[j][i] = FL(0.0);
+        continue;
+      }
+      i0 = (int64_t) p->rpos;
+      frac = (MYFLT) (p->rpos - (double) i0);
+      if (flags[i0 & p->mask]) {
+        MYFLT *a = jb + (size_t) (i0 & p->mask) * nchnls;
+        MYFLT *b = flags[(i0 + 1) & p->mask] ?
+          jb + (size_t) ((i0 + 1) & p->mask) * nchnls : a;
+        for (j = 0; j < nchnls; j++)
+          h[j] = p->asigs[j][i] = a[j] + frac * (b[j] - a[j]);
+        p->hwp = (p->hwp + 1) % SOCKSTREAM_HIST;
+        p->conceal = 0;
+      }
+      else {
+        /* loss concealment: replay the last frames received, fading out */
+        MYFLT gain = p->conceal < SOCKSTREAM_FADE ?
+          FL(1.0) - (MYFLT) p->conceal / SOCKSTREAM_FADE : FL(0.0);
+        MYFLT *c = hist + (size_t) ((p->hwp + p->conceal) % SOCKSTREAM_HIST)
+          * nchnls;
+        for (j = 0; j < nchnls; j++)
+          p->asigs[j][i] = c[j] * gain;
+        if (p->conceal < SOCKSTREAM_FADE) {
+          p->conceal++;
+          p->concealed++;
+        }
+      }
+      p->rpos += ratio;
+      i1 = (int64_t) p->rpos;
+      for (k = i0; k < i1; k++)         /* frames read are free again */
+        flags[k & p->mask] = 0;
+    }
+    if (UNLIKELY(offset || early)) {
+      for (j = 0; j < nchnls; j++) {
+        memset(p->asigs[j], 0, offset * sizeof(MYFLT));
+        if (early)
+          memset(&p->asigs[j][nsmps - early], 0, early * sizeof(MYFLT));
+      }
+    }
+    p->clock += nsmps;
+    return OK;
+}
+
 /* TCP version */
 static int32_t init_srecv(CSOUND *csound, SOCKRECVT *p)
 {
@@ -773,6 +1144,9 @@ static OENTRY sockrecv_localops[] = {
   { "sockrecvs", S(SOCKRECV), 0, 3, "aa", "ii",
     (SUBR) init_recvS,
     (SUBR) send_recvS, NULL },
+  { "sockrecvm", S(SOCKRECVM), 0, 3, "mmmmmmmmmmmmmmmm", "iio",
+    (SUBR) init_recvm,
+    (SUBR) send_recvm, NULL },
   { "strecv", S(SOCKRECVT), 0, 3, "az", "Si",
     (SUBR) init_srecv,
     (SUBR) send_srecv, NULL },
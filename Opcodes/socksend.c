@@ -39,6 +39,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include "sockstream.h"
 
 extern  int32_t     inet_aton(const char *cp, struct in_addr *inp);
 
@@ -81,6 +82,20 @@ typedef struct {
   struct sockaddr_in server_addr;
 } SOCKSENDS;
 
+typedef struct {
+  OPDS    h;
+  STRINGDAT *ipaddress;
+  MYFLT   *port, *frames;
+  MYFLT   *asigs[VARGMAX];
+  AUXCH   aux;
+  int32_t     sock;
+  int32_t     nchnls, nframes, pktsize;
+  int32_t     npkt, wp;         /* complete packets, frames in the next */
+  uint32_t    seq;
+  uint64_t    ts;               /* stream position of the next packet */
+  struct sockaddr_in server_addr;
+} SOCKSENDM;
+
 #define MTU (1456)
 
 /* UDP version one channel */
@@ -340,6 +355,142 @@ static int32_t send_sendS(CSOUND *csound, SOCKSENDS *p)
     return OK;
 }
 
+/* UDP network audio stream, see sockstream.h */
+static int32_t sendm_deinit(CSOUND *csound, SOCKSENDM *p)
+{
+    IGN(csound);
+#ifndef WIN32
+    close(p->sock);
+#else
+    closesocket(p->sock);
+#endif
+    return OK;
+}
+
+static int32_t init_sendm(CSOUND *csound, SOCKSENDM *p)
+{
+    int32_t     nchnls = p->INOCOUNT - 3, nframes;
+#if defined(WIN32) && !defined(__CYGWIN__)
+    WSADATA wsaData = {0};
+    int32_t err;
+    if (UNLIKELY((err=WSAStartup(MAKEWORD(2,2), &wsaData))!= 0))
+      return csound->InitError(csound, Str("Winsock2 failed to start: %d"), err);
+#endif
+    if (UNLIKELY(nchnls < 1 || nchnls > 255))
+      return csound->InitError(csound, Str("socksendm: invalid number of "
+                                           "channels (%d)"), nchnls);
+    nframes = (int32_t) *p->frames;
+    if (nframes <= 0)
+      nframes = (SOCKSTREAM_MTU - SOCKSTREAM_HDR) / (nchnls * 4);
+    if (UNLIKELY(nframes < 1 ||
+                 SOCKSTREAM_HDR + nframes * nchnls * 4 > SOCKSTREAM_MAXPKT))
+      return csound->InitError(csound, Str("socksendm: a packet of %d frames "
+                                           "does not fit in %d bytes"),
+                               nframes, SOCKSTREAM_MAXPKT);
+    p->nchnls = nchnls;
+    p->nframes = nframes;
+    p->pktsize = SOCKSTREAM_HDR + nframes * nchnls * 4;
+    p->npkt = p->wp = 0;
+    p->seq = 0;
+    p->ts = 0;
+
+    p->sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (UNLIKELY(p->sock == SOCKET_ERROR)) {
+      return csound->InitError(csound, Str("creating socket"));
+    }
+    memset(&p->server_addr, 0, sizeof(p->server_addr));
+    p->server_addr.sin_family = AF_INET;    /* it is an INET address */
+#if defined(WIN32) && !defined(__CYGWIN__)
+    p->server_addr.sin_addr.S_un.S_addr =
+      inet_addr((const char *) p->ipaddress->data);
+#else
+    inet_aton((const char *) p->ipaddress->data,
+              &p->server_addr.sin_addr);    /* the server IP address */
+#endif
+    p->server_addr.sin_port = htons((int32_t) *p->port);    /* the port */
+    /* room for a batch of packets, sent together */
+    csound->AuxAlloc(csound, (size_t) SOCKSTREAM_BATCH * p->pktsize, &p->aux);
+    csound->RegisterDeinitCallback(csound, p,
+                                   (int32_t (*)(CSOUND*, void*)) sendm_deinit);
+    return OK;
+}
+
+/* sends the complete packets, and moves the one in progress to the
+   front of the batch */
+static int32_t sendm_flush(CSOUND *csound, SOCKSENDM *p)
+{
+    unsigned char *pkts = (unsigned char *) p->aux.auxp;
+#ifdef SOCKSTREAM_MMSG
+    struct mmsghdr msgs[SOCKSTREAM_BATCH];
+    struct iovec iovs[SOCKSTREAM_BATCH];
+    int32_t k, sent = 0;
+
+    memset(msgs, 0, p->npkt * sizeof(struct mmsghdr));
+    for (k = 0; k < p->npkt; k++) {
+      iovs[k].iov_base = pkts + (size_t) k * p->pktsize;
+      iovs[k].iov_len = p->pktsize;
+      msgs[k].msg_hdr.msg_name = &p->server_addr;
+      msgs[k].msg_hdr.msg_namelen = sizeof(p->server_addr);
+      msgs[k].msg_hdr.msg_iov = &iovs[k];
+      msgs[k].msg_hdr.msg_iovlen = 1;
+    }
+    while (sent < p->npkt) {
+      int32_t n = sendmmsg(p->sock, msgs + sent, p->npkt - sent, 0);
+      if (UNLIKELY(n <= 0))
+        return csound->PerfError(csound, &(p->h), Str("sendto failed"));
+      sent += n;
+    }
+#else
+    const struct sockaddr *to = (const struct sockaddr *) (&p->server_addr);
+    int32_t k;
+    for (k = 0; k < p->npkt; k++) {
+      if (UNLIKELY(sendto(p->sock, (void*) (pkts + (size_t) k * p->pktsize),
+                          p->pktsize, 0, to,
+                          sizeof(p->server_addr)) == SOCKET_ERROR))
+        return csound->PerfError(csound, &(p->h), Str("sendto failed"));
+    }
+#endif
+    if (p->wp > 0)
+      memmove(pkts, pkts + (size_t) p->npkt * p->pktsize,
+              SOCKSTREAM_HDR + (size_t) p->wp * p->nchnls * 4);
+    p->npkt = 0;
+    return OK;
+}
+
+static int32_t send_sendm(CSOUND *csound, SOCKSENDM *p)
+{
+    uint32_t i, nsmps = CS_KSMPS;
+    int32_t  j, nchnls = p->nchnls;
+    MYFLT    scal = FL(1.0) / csound->e0dbfs;
+
+    /* the whole control period is sent, to keep the stream continuous */
+    for (i = 0; i < nsmps; i++) {
+      unsigned char *pkt =
+        (unsigned char *) p->aux.auxp + (size_t) p->npkt * p->pktsize;
+      unsigned char *s;
+      if (p->wp == 0) {
+        sockstream_put16(pkt, SOCKSTREAM_MAGIC);
+        pkt[2] = SOCKSTREAM_VERSION;
+        pkt[3] = (unsigned char) nchnls;
+        sockstream_put32(pkt + 4, p->seq);
+        sockstream_put64(pkt + 8, p->ts);
+        sockstream_put16(pkt + 16, (uint32_t) p->nframes);
+        sockstream_put16(pkt + 18, 0);
+      }
+      s = pkt + SOCKSTREAM_HDR + (size_t) p->wp * nchnls * 4;
+      for (j = 0; j < nchnls; j++, s += 4)
+        sockstream_putf(s, p->asigs[j][i] * scal);
+      if (++p->wp == p->nframes) {
+        p->wp = 0;
+        p->seq++;
+        p->ts += p->nframes;
+        if (++p->npkt == SOCKSTREAM_BATCH && sendm_flush(csound, p) != OK)
+          return NOTOK;
+      }
+    }
+    return p->npkt > 0 ? sendm_flush(csound, p) : OK;
+}
+
 /* TCP version */
 
 static int32_t stsend_deinit(CSOUND *csound, SOCKSEND *p)
@@ -1025,6 +1176,8 @@ static OENTRY socksend_localops[] =
      (SUBR) send_send_Str, NULL },
    { "socksends", S(SOCKSENDS), 0, 3, "", "aaSiio", (SUBR) init_sendS,
      (SUBR) send_sendS },
+   { "socksendm", S(SOCKSENDM), 0, 3, "", "Siiy", (SUBR) init_sendm,
+     (SUBR) send_sendm },
    { "stsend", S(SOCKSEND), 0, 3, "", "aSi", (SUBR) init_ssend,
      (SUBR) send_ssend },
    { "OSCsend", S(OSCSEND2), 0, 3, "", "kSkSS*", (SUBR)osc_send2_init,
@@ -0,0 +1,103 @@
+/*
+  sockstream.h:
+
+  Copyright (C) 2026
+
+  This file is part of Csound.
+
+  The Csound Library is free software; you can redistribute it
+  and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  Csound is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with Csound; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301 USA
+*/
+
+/* Network audio stream packets, sent by socksendm and received by
+   sockrecvm.  Each UDP datagram has a header in network byte order
+
+     0  magic      u16   SOCKSTREAM_MAGIC
+     2  version    u8    SOCKSTREAM_VERSION
+     3  nchnls     u8    channels per frame
+     4  sequence   u32   packet count, for loss and reordering stats
+     8  timestamp  u64   stream position of the first frame, in frames
+    16  nframes    u16   frames in the packet
+    18  reserved   u16
+
+   followed by nframes interleaved frames of nchnls big-endian float32
+   samples, scaled to 0dbfs = 1.                                       */
+
+#ifndef SOCKSTREAM_H
+#define SOCKSTREAM_H
+
+#define SOCKSTREAM_MAGIC    (0x4353)    /* "CS" */
+#define SOCKSTREAM_VERSION  (1)
+#define SOCKSTREAM_HDR      (20)
+#define SOCKSTREAM_MAXPKT   (8192)      /* largest packet accepted */
+#define SOCKSTREAM_MTU      (1456)      /* default packet size */
+#define SOCKSTREAM_BATCH    (16)        /* packets per sendmmsg/recvmmsg */
+
+#if defined(LINUX) && defined(_GNU_SOURCE) && defined(MSG_WAITFORONE)
+#define SOCKSTREAM_MMSG
+#endif
+
+static inline void sockstream_put16(unsigned char *b, uint32_t v)
+{
+    b[0] = (unsigned char) (v >> 8);
+    b[1] = (unsigned char) v;
+}
+
+static inline void sockstream_put32(unsigned char *b, uint32_t v)
+{
+    b[0] = (unsigned char) (v >> 24);
+    b[1] = (unsigned char) (v >> 16);
+    b[2] = (unsigned char) (v >> 8);
+    b[3] = (unsigned char) v;
+}
+
+static inline void sockstream_put64(unsigned char *b, uint64_t v)
+{
+    sockstream_put32(b, (uint32_t) (v >> 32));
+    sockstream_put32(b + 4, (uint32_t) v);
+}
+
+static inline uint32_t sockstream_get16(const unsigned char *b)
+{
+    return ((uint32_t) b[0] << 8) | (uint32_t) b[1];
+}
+
+static inline uint32_t sockstream_get32(const unsigned char *b)
+{
+    return ((uint32_t) b[0] << 24) | ((uint32_t) b[1] << 16) |
+           ((uint32_t) b[2] << 8) | (uint32_t) b[3];
+}
+
+static inline uint64_t sockstream_get64(const unsigned char *b)
+{
+    return ((uint64_t) sockstream_get32(b) << 32) |
+           (uint64_t) sockstream_get32(b + 4);
+}
+
+static inline void sockstream_putf(unsigned char *b, MYFLT x)
+{
+    union { float f; uint32_t i; } u;
+    u.f = (float) x;
+    sockstream_put32(b, u.i);
+}
+
+static inline MYFLT sockstream_getf(const unsigned char *b)
+{
+    union { float f; uint32_t i; } u;
+    u.i = sockstream_get32(b);
+    return (MYFLT) u.f;
+}
+
+#endif
@@ -40,6 +40,7 @@ struct fileinTag {
     char        *name;        /* short name */
     int32_t         do_scale;     /* non-zero if 0dBFS scaling should be applied */
     uint32      refCount;   /* reference count, | 0x80000000 if close reqd */
+    int32_t     async;        /* written from the file thread */
 };
 
 typedef struct VCO2_TABLE_ARRAY_  VCO2_TABLE_ARRAY;
@@ -24,6 +24,7 @@
 /* ugsc.c -- Opcodes from Sean Costello <costello@seanet.com> */
 
 #include "stdopcod.h"
+#include "filterbank.h"
 #include "ugsc.h"
 
 /* svfilter.c
@@ -45,13 +46,15 @@ static int32_t svfset(CSOUND *csound, SVF *p)
       /* set initial delay states to 0 */
       p->ynm1 = p->ynm2 = FL(0.0);
     }
+    p->lfco = p->lq = -FL(1.0);   /* coefficients on the first cycle */
+    p->f1 = FL(0.0); p->q1 = p->scale = FL(1.0);
     return OK;
 }
 
 static int32_t svf(CSOUND *csound, SVF *p)
 {
-    MYFLT f1 = FL(0.0), q1 = FL(1.0), scale = FL(1.0),
-          lfco = -FL(1.0), lq = -FL(1.0);
+    MYFLT f1 = p->f1, q1 = p->q1, scale = p->scale,
+          lfco = p->lfco, lq = p->lq;
     MYFLT *low, *high, *band, *in, ynm1, ynm2;
     MYFLT low2, high2, band2;
     MYFLT *kfco = p->kfco, *kq = p->kq;
@@ -105,6 +108,8 @@ static int32_t svf(CSOUND *csound, SVF *p)
     }
     p->ynm1 = ynm1;
     p->ynm2 = ynm2;
+    p->lfco = lfco; p->lq = lq;
+    p->f1 = f1; p->q1 = q1; p->scale = scale;
     return OK;
 }
 
@@ -218,6 +223,9 @@ static int32_t resonzset(CSOUND *csound, RESONZ *p)
     }
     if (!(*p->istor))
       p->xnm1 = p->xnm2 = p->ynm1 = p->ynm2 = 0.0;
+    p->lcf = p->lbw = -FL(1.0);   /* coefficients on the first cycle */
+    p->r = p->c1 = p->c2 = 0.0;
+    p->scale = 1.0;
     return OK;
 }
 
@@ -235,12 +243,12 @@ static int32_t resonr(CSOUND *csound, RESONZ *p)
      *
      */
 
-    double r = 0.0, scale = 1.0; /* radius & scaling factor */
-    double c1=0.0, c2=0.0;   /* filter coefficients */
+    double r = p->r, scale = p->scale; /* radius & scaling factor */
+    double c1 = p->c1, c2 = p->c2;   /* filter coefficients */
     MYFLT *out, *in;
     double xn, yn, xnm1, xnm2, ynm1, ynm2;
     MYFLT *kcf = p->kcf, *kbw = p->kbw;
-    MYFLT lcf = -FL(1.0), lbw = -FL(1.0);
+    MYFLT lcf = p->lcf, lbw = p->lbw;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     uint32_t n, nsmps = CS_KSMPS;
@@ -282,6 +290,8 @@ static int32_t resonr(CSOUND *csound, RESONZ *p)
     p->xnm2 = xnm2;
     p->ynm1 = ynm1;
     p->ynm2 = ynm2;
+    p->lcf = lcf; p->lbw = lbw;
+    p->r = r; p->c1 = c1; p->c2 = c2; p->scale = scale;
     return OK;
 }
 
@@ -298,12 +308,12 @@ static int32_t resonz(CSOUND *csound, RESONZ *p)
      *
      */
 
-    double r = 0.0, scale = 1.0; /* radius & scaling factor */
-    double c1=0.0, c2=0.0;   /* filter coefficients */
+    double r = p->r, scale = p->scale; /* radius & scaling factor */
+    double c1 = p->c1, c2 = p->c2;   /* filter coefficients */
     MYFLT *out, *in;
     double xn, yn, xnm1, xnm2, ynm1, ynm2;
     MYFLT *kcf = p->kcf, *kbw = p->kbw;
-    MYFLT lcf = -FL(1.0), lbw = -FL(1.0);
+    MYFLT lcf = p->lcf, lbw = p->lbw;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     uint32_t n, nsmps = CS_KSMPS;
@@ -351,6 +361,8 @@ static int32_t resonz(CSOUND *csound, RESONZ *p)
     p->xnm2 = xnm2;
     p->ynm1 = ynm1;
     p->ynm2 = ynm2;
+    p->lcf = lcf; p->lbw = lbw;
+    p->r = r; p->c1 = c1; p->c2 = c2; p->scale = scale;
     return OK;
 }
 
@@ -543,6 +555,7 @@ static int32_t lp2_set(CSOUND *csound, LP2 *p)
      IGN(csound);
     if (!(*p->istor))
       p->ynm1 = p->ynm2 = 0.0;
+    p->lfco = p->lres = -FL(1.0);  /* coefficients on the first cycle */
     return OK;
 }
 
@@ -558,11 +571,15 @@ static int32_t lp2(CSOUND *csound, LP2 *p)
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     uint32_t n, nsmps = CS_KSMPS;
 
-    temp = (double)(csound->mpidsr * kfco / kres);
-      /* (-PI_F * kfco / (kres * CS_ESR)); */
-    a = 2.0 * cos((double) (kfco * csound->tpidsr)) * exp(temp);
-    b = exp(temp+temp);
-    c = 1.0 - a + b;
+    if (kfco != p->lfco || kres != p->lres) {
+      p->lfco = kfco; p->lres = kres;
+      temp = (double)(csound->mpidsr * kfco / kres);
+        /* (-PI_F * kfco / (kres * CS_ESR)); */
+      p->a = 2.0 * cos((double) (kfco * csound->tpidsr)) * exp(temp);
+      p->b = exp(temp+temp);
+      p->c = 1.0 - p->a + p->b;
+    }
+    a = p->a; b = p->b; c = p->c;
 
     out  = p->out;
     in   = p->in;
@@ -719,11 +736,65 @@ static int32_t lp2ak(CSOUND *csound, LP2 *p)
     return OK;
 }
 
+static int32_t svfset_a(CSOUND *csound, SVFA *p)
+{
+    /* blocks: low (from the input), high and band, state: ynm1, ynm2 */
+    if (UNLIKELY(fbank_init(csound, &p->fb, p->low, p->in, 3, 2,
+                            *p->iskip == FL(0.0)) != OK))
+      return NOTOK;
+    tabinit(csound, p->high, p->fb.nchnls);
+    tabinit(csound, p->band, p->fb.nchnls);
+    return OK;
+}
+
+static int32_t svf_a(CSOUND *csound, SVFA *p)
+{
+    MYFLT f1, q1, scale = FL(1.0);
+    MYFLT q = *p->kq;
+    uint32_t offset = p->h.insdshead->ksmps_offset;
+    uint32_t early  = p->h.insdshead->ksmps_no_end;
+    uint32_t n, nsmps = CS_KSMPS - early;
+    int32_t  c, nch = p->fb.nchnls;
+    uint32_t blk = (p->in->arrayMemberSize / sizeof(MYFLT)) * nch;
+    double   *ynm1 = p->fb.state, *ynm2 = ynm1 + nch;
+
+    if (UNLIKELY(fbank_load(csound, &(p->h), &p->fb, p->in,
+                            offset, nsmps) != OK))
+      return NOTOK;
+    /* the coefficients of svf */
+    f1 = FL(2.0) * (MYFLT)sin((double)(*p->kfco * csound->pidsr));
+    if (UNLIKELY(q<FL(0.000001))) q = FL(1.0);
+    q1 = FL(1.0) / q;
+    if (*p->iscl) scale = q1;
+
+    for (n=offset; n<nsmps; n++) {
+      MYFLT *low = &p->fb.x[n * nch];
+      MYFLT *high = low + blk, *band = high + blk;
+      for (c = 0; c < nch; c++) {
+        MYFLT y1 = (MYFLT) ynm1[c], y2 = (MYFLT) ynm2[c];
+        MYFLT low2 = y2 + f1 * y1;
+        MYFLT high2 = scale * low[c] - low2 - q1 * y1;
+        MYFLT band2 = f1 * high2 + y1;
+        low[c] = low2;
+        high[c] = high2;
+        band[c] = band2;
+        ynm1[c] = band2;
+        ynm2[c] = low2;
+      }
+    }
+    fbank_store(&p->fb, 0, p->low, offset, nsmps);
+    fbank_store(&p->fb, 1, p->high, offset, nsmps);
+    fbank_store(&p->fb, 2, p->band, offset, nsmps);
+    return OK;
+}
+
 #define S(x)    sizeof(x)
 
 static OENTRY localops[] =
   {
    { "svfilter", S(SVF),    0, 3, "aaa", "axxoo", (SUBR)svfset, (SUBR)svf    },
+   { "svfilter.A", S(SVFA), 0, 3, "a[]a[]a[]", "a[]kkoo",
+                                          (SUBR)svfset_a, (SUBR)svf_a  },
    { "hilbert", S(HILBERT), 0,3, "aa", "a", (SUBR)hilbertset, (SUBR)hilbert },
    { "resonr", S(RESONZ),   0,3, "a", "axxoo", (SUBR)resonzset, (SUBR)resonr},
    { "resonz", S(RESONZ),   0,3, "a", "axxoo", (SUBR)resonzset, (SUBR)resonz},
@@ -37,8 +37,17 @@ typedef struct {
         OPDS h;
   MYFLT *low, *high, *band, *in, *kfco, *kq, *iscl, *iskip;
         MYFLT ynm1, ynm2;
+        MYFLT lfco, lq, f1, q1, scale;  /* coefficients of lfco and lq */
 } SVF;
 
+/* svfilter bank over the channels of an audio array */
+typedef struct {
+        OPDS h;
+        ARRAYDAT *low, *high, *band, *in;
+        MYFLT *kfco, *kq, *iscl, *iskip;
+        FBANK fb;
+} SVFA;
+
 /* hilbert.h
  *
  * Copyright 1999, by Sean M. Costello
@@ -72,6 +81,8 @@ typedef struct {
         MYFLT *out, *in, *kcf, *kbw, *iscl, *istor;
         double xnm1, xnm2, ynm1, ynm2;
         int32_t scaletype, aratemod;
+        MYFLT lcf, lbw;                 /* coefficients of lcf and lbw */
+        double r, c1, c2, scale;
 } RESONZ;
 
 /* Structure for cascade of 2nd order allpass filters */
@@ -98,4 +109,6 @@ typedef struct {
         OPDS h;
         MYFLT *out, *in, *kfco, *kres, *istor;
         double ynm1, ynm2;
+        MYFLT lfco, lres;               /* coefficients of lfco and lres */
+        double a, b, c;
 } LP2;
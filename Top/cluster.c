@@ -0,0 +1,994 @@
+/*
+    cluster.c:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+/* Distributed rendering.
+ *
+ * With -+cluster_nodes=N, N Csound processes running the same orchestra
+ * and score share the instruments: node k (-+cluster_node=k) performs
+ * the events of the instruments whose number modulo N is k, and skips
+ * the others.  Node 0 is the coordinator; the others connect to it over
+ * TCP (-+cluster_host, -+cluster_port) and the nodes run in lock-step,
+ * synchronising at the end of each control period:
+ *
+ *   - each worker sends its audio output (spout) and the changes made
+ *     during the period to its control and audio channels: the new
+ *     value of a channel that was set, and the difference from the
+ *     value after the last merge for one that chnmix added to;
+ *   - the coordinator adds the workers' audio to its own output, merges
+ *     the changes of all nodes in node order and sends the merged
+ *     channel values back, with the line events it has received through
+ *     the API (csoundInputMessage()) or from the workers since the last
+ *     period.  A value set replaces the channel, the last node to set
+ *     it winning, and the differences of all the nodes that mixed into
+ *     it are added on top.
+ *
+ * So a channel written on one node is seen by all nodes in the next
+ * period, whether it is set by one node or mixed into by several, and
+ * line events start on the same period everywhere.  The i and d events
+ * an instrument schedules (event, event_i, schedule, nstance, schedkwhen)
+ * for an instrument of another node are sent as line events: a worker
+ * sends them to the coordinator with its changes, and they start a
+ * period or two after they would have otherwise.
+ *
+ * Integers and floating point values are sent in network byte order, and
+ * a node that does not answer within CLUSTER_RECV_TIMEOUT seconds is
+ * dropped.
+ */
+
+#include "csoundCore.h"
+#include "bus.h"
+#include "cluster.h"
+#include "insert.h"
+#if defined(WIN32) && !defined(__CYGWIN__)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#define close(s) closesocket(s)
+#else
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/time.h>
+#endif
+#include "namedins.h"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#define CLUSTER_MAGIC   (0x4C435343)    /* "CSCL" */
+#define CLUSTER_VERSION (3)
+#define CLUSTER_TIMEOUT (30)            /* seconds to wait for the nodes */
+#define CLUSTER_RECV_TIMEOUT (5)        /* seconds to wait for a frame */
+#define CLUSTER_MAX_FRAME (1 << 26)     /* the largest frame accepted */
+
+/* kinds of channel records */
+#define CLUSTER_SET     (0)             /* the value */
+#define CLUSTER_MIX     (1)             /* the change since the last merge */
+
+extern void csoundInputMessageInternal(CSOUND *csound, const char *message);
+
+/* a channel as seen by the cluster */
+typedef struct cluster_chn_s {
+    struct cluster_chn_s *touched;  /* next channel changed in the period */
+    MYFLT   *base;                  /* value after the last merge */
+    MYFLT   *sum;                   /* coordinator: changes in the period */
+    int     type, size, changed;
+    char    name[1];
+} CLUSTER_CHN;
+
+typedef struct {
+    char    *data;
+    size_t  len, size, pos;
+} CLUSTER_BUF;
+
+/* an orchestra channel and its cluster record */
+typedef struct {
+    CHNENTRY    *e;
+    CLUSTER_CHN *ch;
+} CLUSTER_MAP;
+
+typedef struct {
+    int     node, nodes;
+    int     *socks;         /* coordinator: per node, worker: [0] */
+    CS_HASH_TABLE *chans;
+    CLUSTER_MAP *map;       /* the channels of chn_db that are shared, */
+    int     nmap, dbcount;  /* ... as of when it had dbcount entries */
+    CLUSTER_CHN *touched;
+    CLUSTER_BUF out, in;
+    CLUSTER_BUF events;     /* line events for all nodes */
+    int32_t nevents;
+    spin_lock_t lock;       /* protects events and nevents */
+    CLUSTER_BUF sending;    /* the events of this period */
+    int64_t block;
+    int     warned;
+} CLUSTER;
+
+/* MESSAGE BUFFERS */
+
+static void buf_put(CSOUND *csound, CLUSTER_BUF *b, const void *p, size_t n)
+{
+    if (b->len + n > b->size) {
+      size_t size = b->size ? b->size : 4096;
+      while (size < b->len + n) size <<= 1;
+      b->data = (char*) csound->ReAlloc(csound, b->data, size);
+      b->size = size;
+    }
+    memcpy(b->data + b->len, p, n);
+    b->len += n;
+}
+
+static void buf_put_int(CSOUND *csound, CLUSTER_BUF *b, int32_t v)
+{
+    uint32_t u = htonl((uint32_t) v);
+    buf_put(csound, b, &u, sizeof(uint32_t));
+}
+
+/* overwrites the integer at pos, written as a placeholder */
+static void buf_set_int(CLUSTER_BUF *b, size_t pos, int32_t v)
+{
+    uint32_t u = htonl((uint32_t) v);
+    memcpy(b->data + pos, &u, sizeof(uint32_t));
+}
+
+static void buf_put_int64(CSOUND *csound, CLUSTER_BUF *b, int64_t v)
+{
+    buf_put_int(csound, b, (int32_t) ((uint64_t) v >> 32));
+    buf_put_int(csound, b, (int32_t) ((uint64_t) v & 0xFFFFFFFFU));
+}
+
+static void buf_put_double(CSOUND *csound, CLUSTER_BUF *b, double v)
+{
+    int64_t u;
+    memcpy(&u, &v, sizeof(double));
+    buf_put_int64(csound, b, u);
+}
+
+static void buf_put_flts(CSOUND *csound, CLUSTER_BUF *b,
+                         const MYFLT *v, int n)
+{
+    int i;
+    for (i = 0; i < n; i++) {
+#ifdef USE_DOUBLE
+      buf_put_double(csound, b, v[i]);
+#else
+      int32_t u;
+      memcpy(&u, &v[i], sizeof(float));
+      buf_put_int(csound, b, u);
+#endif
+    }
+}
+
+/* starts a frame, leaving room for its length */
+static void buf_begin(CSOUND *csound, CLUSTER_BUF *b)
+{
+    b->len = 0;
+    buf_put_int(csound, b, 0);
+}
+
+static int buf_get(CLUSTER_BUF *b, void *p, size_t n)
+{
+    if (UNLIKELY(b->pos + n > b->len)) return -1;
+    memcpy(p, b->data + b->pos, n);
+    b->pos += n;
+    return 0;
+}
+
+static int buf_get_int(CLUSTER_BUF *b, int32_t *v)
+{
+    uint32_t u;
+    if (buf_get(b, &u, sizeof(uint32_t)) != 0) return -1;
+    *v = (int32_t) ntohl(u);
+    return 0;
+}
+
+static int buf_get_int64(CLUSTER_BUF *b, int64_t *v)
+{
+    int32_t hi, lo;
+    if (buf_get_int(b, &hi) != 0 || buf_get_int(b, &lo) != 0) return -1;
+    *v = (int64_t) (((uint64_t) (uint32_t) hi << 32) | (uint32_t) lo);
+    return 0;
+}
+
+static int buf_get_double(CLUSTER_BUF *b, double *v)
+{
+    int64_t u;
+    if (buf_get_int64(b, &u) != 0) return -1;
+    memcpy(v, &u, sizeof(double));
+    return 0;
+}
+
+static int buf_get_flts(CLUSTER_BUF *b, MYFLT *v, int n)
+{
+    int i;
+    for (i = 0; i < n; i++) {
+#ifdef USE_DOUBLE
+      if (buf_get_double(b, &v[i]) != 0) return -1;
+#else
+      int32_t u;
+      if (buf_get_int(b, &u) != 0) return -1;
+      memcpy(&v[i], &u, sizeof(float));
+#endif
+    }
+    return 0;
+}
+
+/* appends the count and the NUL terminated strings of a list of events */
+static void buf_put_events(CSOUND *csound, CLUSTER_BUF *b,
+                           CLUSTER_BUF *events, int32_t nevents)
+{
+    buf_put_int(csound, b, nevents);
+    if (events->len > 0)
+      buf_put(csound, b, events->data, events->len);
+}
+
+/* SOCKETS */
+
+static int sock_write(int sock, const void *p, size_t n)
+{
+    const char *s = (const char*) p;
+    while (n > 0) {
+      int r = send(sock, s, n, MSG_NOSIGNAL);
+      if (r <= 0) {
+#ifndef WIN32
+        if (r < 0 && errno == EINTR) continue;
+#endif
+        return -1;
+      }
+      s += r;
+      n -= r;
+    }
+    return 0;
+}
+
+static int sock_read(int sock, void *p, size_t n)
+{
+    char *s = (char*) p;
+    while (n > 0) {
+      int r = recv(sock, s, n, 0);
+      if (r <= 0) {
+#ifndef WIN32
+        if (r < 0 && errno == EINTR) continue;
+#endif
+        return -1;
+      }
+      s += r;
+      n -= r;
+    }
+    return 0;
+}
+
+static int send_frame(int sock, CLUSTER_BUF *b)
+{
+    buf_set_int(b, 0, (int32_t) (b->len - sizeof(int32_t)));
+    return sock_write(sock, b->data, b->len);
+}
+
+static int recv_frame(CSOUND *csound, int sock, CLUSTER_BUF *b)
+{
+    uint32_t u;
+    int32_t  len;
+    if (sock_read(sock, &u, sizeof(uint32_t)) != 0)
+      return -1;
+    len = (int32_t) ntohl(u);
+    if (len < 0 || len > CLUSTER_MAX_FRAME)
+      return -1;
+    b->len = 0;
+    if ((size_t) len > b->size) {
+      b->data = (char*) csound->ReAlloc(csound, b->data, (size_t) len);
+      b->size = (size_t) len;
+    }
+    b->len = (size_t) len;
+    b->pos = 0;
+    return sock_read(sock, b->data, (size_t) len);
+}
+
+/* no delay for the small frames, and a timeout, so that a node that
+   stops answering is dropped instead of stopping the others */
+static void set_options(int sock)
+{
+    int one = 1;
+#if defined(WIN32) && !defined(__CYGWIN__)
+    DWORD tv = CLUSTER_RECV_TIMEOUT * 1000;
+#else
+    struct timeval tv;
+    tv.tv_sec = CLUSTER_RECV_TIMEOUT;
+    tv.tv_usec = 0;
+#endif
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (const char*) &one, sizeof(one));
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char*) &tv, sizeof(tv));
+    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, (const char*) &tv, sizeof(tv));
+}
+
+/* CHANNELS */
+
+static CLUSTER_CHN *cluster_chn(CSOUND *csound, CLUSTER *c,
+                                const char *name, int type)
+{
+    CLUSTER_CHN *ch = (CLUSTER_CHN*) cs_hash_table_get(csound, c->chans,
+                                                       (char*) name);
+    if (ch == NULL) {
+      ch = (CLUSTER_CHN*) csound->Calloc(csound,
+                                         sizeof(CLUSTER_CHN) + strlen(name));
+      strcpy(ch->name, name);
+      ch->type = type;
+      ch->size = (type == CSOUND_AUDIO_CHANNEL ? (int) csound->ksmps : 1);
+      ch->base = (MYFLT*) csound->Calloc(csound, ch->size * sizeof(MYFLT));
+      ch->sum = (MYFLT*) csound->Calloc(csound, ch->size * sizeof(MYFLT));
+      cs_hash_table_put(csound, c->chans, ch->name, ch);
+    }
+    return ch;
+}
+
+static void put_chn_header(CSOUND *csound, CLUSTER_BUF *b, CLUSTER_CHN *ch,
+                           int kind)
+{
+    unsigned char hdr[3];
+    hdr[0] = (unsigned char) ch->type;
+    hdr[1] = (unsigned char) kind;
+    hdr[2] = (unsigned char) strlen(ch->name);
+    buf_put(csound, b, hdr, 3);
+    buf_put(csound, b, ch->name, hdr[2]);
+}
+
+/* reads a channel record header; returns the channel, NULL if the
+   record is to be skipped, with *err set if it is malformed */
+static CLUSTER_CHN *get_chn_header(CSOUND *csound, CLUSTER *c,
+                                   CLUSTER_BUF *b, int *kind, int *err)
+{
+    unsigned char hdr[3];
+    char          name[256];
+    CLUSTER_CHN   *ch;
+    int           size;
+
+    if (buf_get(b, hdr, 3) != 0 || buf_get(b, name, hdr[2]) != 0 ||
+        (hdr[0] != CSOUND_CONTROL_CHANNEL && hdr[0] != CSOUND_AUDIO_CHANNEL) ||
+        (hdr[1] != CLUSTER_SET && hdr[1] != CLUSTER_MIX)) {
+      *err = 1;
+      return NULL;
+    }
+    name[hdr[2]] = '\0';
+    *kind = hdr[1];
+    ch = cluster_chn(csound, c, name, hdr[0]);
+    if (UNLIKELY(ch->type != hdr[0])) {   /* same name, other type */
+      size = (hdr[0] == CSOUND_AUDIO_CHANNEL ? (int) csound->ksmps : 1);
+      if (b->pos + size * sizeof(MYFLT) > b->len) *err = 1;
+      b->pos += size * sizeof(MYFLT);
+      return NULL;
+    }
+    return ch;
+}
+
+/* finds the shared channels of chn_db again, when there are new ones */
+static void map_channels(CSOUND *csound, CLUSTER *c)
+{
+    CONS_CELL *head, *items;
+    int       n = 0;
+
+    csoundLockMutex(csound->chn_db_lock);
+    c->map = (CLUSTER_MAP*) csound->ReAlloc(csound, c->map,
+                                            csound->chn_db->count *
+                                            sizeof(CLUSTER_MAP));
+    head = items = cs_hash_table_values(csound, csound->chn_db);
+    c->dbcount = csound->chn_db->count;
+    csoundUnlockMutex(csound->chn_db_lock);
+    for ( ; items != NULL; items = items->next) {
+      CHNENTRY    *e = (CHNENTRY*) items->value;
+      int         type = e->type & CSOUND_CHANNEL_TYPE_MASK;
+      CLUSTER_CHN *ch;
+      if ((type != CSOUND_CONTROL_CHANNEL && type != CSOUND_AUDIO_CHANNEL) ||
+          strlen(e->name) > 255)
+        continue;
+      ch = cluster_chn(csound, c, e->name, type);
+      if (ch->type != type) continue;
+      c->map[n].e = e;
+      c->map[n].ch = ch;
+      n++;
+    }
+    cs_cons_free(csound, head);
+    c->nmap = n;
+}
+
+/* appends the changes to this node's channels since the last merge:
+   the value of those set, and the difference for those mixed into */
+static void put_changes(CSOUND *csound, CLUSTER *c, CLUSTER_BUF *b)
+{
+    size_t    at = b->len;
+    int32_t   n = 0;
+    int       k, count;
+
+    buf_put_int(csound, b, 0);
+    csoundLockMutex(csound->chn_db_lock);
+    count = csound->chn_db != NULL ? csound->chn_db->count : 0;
+    csoundUnlockMutex(csound->chn_db_lock);
+    if (count != 0 && count != c->dbcount)
+      map_channels(csound, c);
+    for (k = 0; k < c->nmap; k++) {
+      CHNENTRY    *e = c->map[k].e;
+      CLUSTER_CHN *ch = c->map[k].ch;
+      int         written = e->written, i;
+      e->written = 0;
+      for (i = 0; i < ch->size && e->data[i] == ch->base[i]; i++) ;
+      if (written & CHN_WRITE_MIX) {
+        if (i == ch->size) continue;
+        put_chn_header(csound, b, ch, CLUSTER_MIX);
+        for (i = 0; i < ch->size; i++) {
+          MYFLT d = e->data[i] - ch->base[i];
+          buf_put_flts(csound, b, &d, 1);
+        }
+      }
+      else {
+        /* set to the value it had is still a write, that must win
+           over those of the nodes before this one */
+        if (i == ch->size && !(written & CHN_WRITE_SET)) continue;
+        put_chn_header(csound, b, ch, CLUSTER_SET);
+        buf_put_flts(csound, b, e->data, ch->size);
+      }
+      n++;
+    }
+    buf_set_int(b, at, n);
+}
+
+/* coordinator: merges the changes read from b into the period's values
+   and sums */
+static int merge_changes(CSOUND *csound, CLUSTER *c, CLUSTER_BUF *b)
+{
+    int32_t n;
+    int     err = 0;
+
+    if (buf_get_int(b, &n) != 0) return -1;
+    while (n-- > 0 && !err) {
+      int         kind, i;
+      CLUSTER_CHN *ch = get_chn_header(csound, c, b, &kind, &err);
+      if (ch == NULL) continue;
+      if (!ch->changed) {
+        ch->changed = 1;
+        memset(ch->sum, 0, ch->size * sizeof(MYFLT));
+        ch->touched = c->touched;
+        c->touched = ch;
+      }
+      if (kind == CLUSTER_SET) {
+        if (buf_get_flts(b, ch->base, ch->size) != 0) err = 1;
+        continue;
+      }
+      for (i = 0; i < ch->size && !err; i++) {
+        MYFLT d;
+        if (buf_get_flts(b, &d, 1) != 0) err = 1;
+        else ch->sum[i] += d;
+      }
+    }
+    return err ? -1 : 0;
+}
+
+/* writes the channel value, creating the channel if it is new here */
+static void set_chn(CSOUND *csound, CLUSTER_CHN *ch)
+{
+    MYFLT *p;
+    if (csoundGetChannelPtr(csound, &p, ch->name, ch->type |
+                            CSOUND_INPUT_CHANNEL | CSOUND_OUTPUT_CHANNEL)
+        == CSOUND_SUCCESS)
+      memcpy(p, ch->base, ch->size * sizeof(MYFLT));
+}
+
+/* coordinator: adds the sums and appends the merged values */
+static void put_merged(CSOUND *csound, CLUSTER *c, CLUSTER_BUF *b)
+{
+    CLUSTER_CHN *ch;
+    size_t      at = b->len;
+    int32_t     n = 0;
+
+    buf_put_int(csound, b, 0);
+    for (ch = c->touched; ch != NULL; ch = ch->touched) {
+      int i;
+      for (i = 0; i < ch->size; i++)
+        ch->base[i] += ch->sum[i];
+      ch->changed = 0;
+      set_chn(csound, ch);
+      put_chn_header(csound, b, ch, CLUSTER_SET);
+      buf_put_flts(csound, b, ch->base, ch->size);
+      n++;
+    }
+    c->touched = NULL;
+    buf_set_int(b, at, n);
+}
+
+/* worker: applies the merged values */
+static int get_merged(CSOUND *csound, CLUSTER *c, CLUSTER_BUF *b)
+{
+    int32_t n;
+    int     err = 0;
+
+    if (buf_get_int(b, &n) != 0) return -1;
+    while (n-- > 0 && !err) {
+      int         kind;
+      CLUSTER_CHN *ch = get_chn_header(csound, c, b, &kind, &err);
+      if (ch == NULL) continue;
+      if (buf_get_flts(b, ch->base, ch->size) != 0) err = 1;
+      else set_chn(csound, ch);
+    }
+    return err ? -1 : 0;
+}
+
+/* SYNCHRONISATION */
+
+static void drop_node(CSOUND *csound, CLUSTER *c, int k)
+{
+    csound->Warning(csound, Str("cluster: lost node %d\n"), k);
+    close(c->socks[k]);
+    c->socks[k] = -1;
+}
+
+/* appends a line event to those sent at the end of the period */
+static void put_event(CSOUND *csound, CLUSTER *c, const char *message)
+{
+    csoundSpinLock(&c->lock);
+    buf_put(csound, &c->events, message, strlen(message) + 1);
+    c->nevents++;
+    csoundSpinUnLock(&c->lock);
+}
+
+/* takes the line events of the period into c->sending, leaving the
+   buffer of the last ones for the API */
+static int32_t take_events(CLUSTER *c)
+{
+    CLUSTER_BUF events;
+    int32_t     nevents;
+
+    c->sending.len = 0;
+    csoundSpinLock(&c->lock);
+    events = c->events;
+    c->events = c->sending;
+    nevents = c->nevents;
+    c->nevents = 0;
+    csoundSpinUnLock(&c->lock);
+    c->sending = events;
+    return nevents;
+}
+
+/* reads nevents NUL terminated line events from b; the coordinator adds
+   them to those of the period, a worker schedules them */
+static void get_events(CSOUND *csound, CLUSTER *c, CLUSTER_BUF *b,
+                       int32_t nevents)
+{
+    while (nevents-- > 0 && b->pos < b->len) {
+      char *ev = b->data + b->pos;
+      size_t n = strnlen(ev, b->len - b->pos);
+      if (n == b->len - b->pos) break;    /* not terminated */
+      if (c->node == 0) put_event(csound, c, ev);
+      else csoundInputMessageInternal(csound, ev);
+      b->pos += n + 1;
+    }
+}
+
+static void sync_coordinator(CSOUND *csound, CLUSTER *c)
+{
+    CLUSTER_BUF *b = &c->in;
+    char        *ev, *evend;
+    int32_t     nevents;
+    int         k;
+
+    /* this node's changes, then the workers' in node order */
+    c->out.len = c->out.pos = 0;
+    put_changes(csound, c, &c->out);
+    merge_changes(csound, c, &c->out);
+    for (k = 1; k < c->nodes; k++) {
+      int32_t magic, active;
+      int64_t block;
+      if (c->socks[k] < 0) continue;
+      if (recv_frame(csound, c->socks[k], b) != 0 ||
+          buf_get_int(b, &magic) != 0 || magic != CLUSTER_MAGIC ||
+          buf_get_int64(b, &block) != 0 ||
+          buf_get_int(b, &active) != 0) {
+        drop_node(csound, c, k);
+        continue;
+      }
+      if (UNLIKELY(block != c->block && !c->warned)) {
+        csound->Warning(csound, Str("cluster: node %d is out of step\n"), k);
+        c->warned = 1;
+      }
+      if (active) {
+        MYFLT    *spraw = csound->spraw, v;
+        uint32_t i;
+        if (UNLIKELY(b->pos + csound->nspout * sizeof(MYFLT) > b->len)) {
+          drop_node(csound, c, k);
+          continue;
+        }
+        for (i = 0; i < csound->nspout; i++) {
+          buf_get_flts(b, &v, 1);
+          spraw[i] += v;
+        }
+        csound->spoutactive = 1;
+      }
+      if (merge_changes(csound, c, b) != 0 ||
+          buf_get_int(b, &nevents) != 0) {
+        drop_node(csound, c, k);
+        continue;
+      }
+      /* the line events the worker has received or forwarded */
+      get_events(csound, c, b, nevents);
+    }
+
+    /* send the merged channels and the line events to the workers */
+    buf_begin(csound, &c->out);
+    buf_put_int(csound, &c->out, CLUSTER_MAGIC);
+    buf_put_int64(csound, &c->out, c->block);
+    put_merged(csound, c, &c->out);
+    nevents = take_events(c);
+    buf_put_events(csound, &c->out, &c->sending, nevents);
+    for (k = 1; k < c->nodes; k++)
+      if (c->socks[k] >= 0 && send_frame(c->socks[k], &c->out) != 0)
+        drop_node(csound, c, k);
+    /* and schedule them here, so that they start on the same period */
+    ev = c->sending.data;
+    evend = ev + c->sending.len;
+    while (ev < evend) {
+      csoundInputMessageInternal(csound, ev);
+      ev += strlen(ev) + 1;
+    }
+}
+
+static void sync_worker(CSOUND *csound, CLUSTER *c)
+{
+    CLUSTER_BUF *b = &c->in;
+    int32_t     magic, nevents, active = csound->spoutactive;
+    int64_t     block;
+
+    buf_begin(csound, &c->out);
+    buf_put_int(csound, &c->out, CLUSTER_MAGIC);
+    buf_put_int64(csound, &c->out, c->block);
+    buf_put_int(csound, &c->out, active);
+    if (active)
+      buf_put_flts(csound, &c->out, csound->spraw, (int) csound->nspout);
+    put_changes(csound, c, &c->out);
+    nevents = take_events(c);
+    buf_put_events(csound, &c->out, &c->sending, nevents);
+    if (send_frame(c->socks[0], &c->out) != 0 ||
+        recv_frame(csound, c->socks[0], b) != 0 ||
+        buf_get_int(b, &magic) != 0 || magic != CLUSTER_MAGIC ||
+        buf_get_int64(b, &block) != 0 ||
+        get_merged(csound, c, b) != 0 ||
+        buf_get_int(b, &nevents) != 0) {
+      /* the coordinator has finished or stopped answering: so has this
+         node */
+      csound->Message(csound, Str("cluster: coordinator has closed the "
+                                  "connection\n"));
+      close(c->socks[0]);
+      c->socks[0] = -1;
+      csound->performState = -1;
+      return;
+    }
+    get_events(csound, c, b, nevents);
+    /* the coordinator outputs the audio of this node */
+    memset(csound->spraw, 0, csound->nspout * sizeof(MYFLT));
+    csound->spoutactive = 0;
+}
+
+/* called by kperf() when all instruments have performed the period */
+void csoundClusterSync(CSOUND *csound)
+{
+    CLUSTER *c = (CLUSTER*) csound->cluster;
+
+    c->block++;
+    if (c->node == 0) sync_coordinator(csound, c);
+    else if (c->socks[0] >= 0) sync_worker(csound, c);
+}
+
+int csoundClusterOwns(CSOUND *csound, int insno)
+{
+    CLUSTER *c = (CLUSTER*) csound->cluster;
+    return insno % c->nodes == c->node;
+}
+
+/* an i or d event scheduled by an instance of the orchestra, for an
+   instrument of another node: sends it to all nodes as a line event,
+   starting as many seconds from now as it would have.  Returns non-zero
+   if it was sent.  The events of instr 0 are scheduled on every node. */
+int csoundClusterForward(CSOUND *csound, INSDS *from, EVTBLK *evt,
+                         int64_t time_ofs)
+{
+    CLUSTER *c = (CLUSTER*) csound->cluster;
+    char    line[4096], *s = evt->strarg;
+    size_t  len;
+    double  start;
+    int     i, insno, n;
+
+    if (evt->opcod != 'i' && evt->opcod != 'd')
+      return 0;
+    /* the instrument a UDO instance is running in */
+    while (from != NULL && from->opcod_iobufs != NULL)
+      from = ((OPCOD_IOBUFS*) from->opcod_iobufs)->parent_ip;
+    if (from == NULL || from->insno == 0)
+      return 0;
+    if (csound->ISSTRCOD(evt->p[1])) {
+      if (s == NULL ||
+          (insno = (int) named_instr_find(csound, s)) == 0)
+        return 0;               /* reported where it is performed */
+    }
+    else
+      insno = (int) evt->p[1];
+    if (insno < 0) insno = -insno;
+    if (insno == 0 || csoundClusterOwns(csound, insno))
+      return 0;
+    start = (double) evt->p[2] +
+            (double) (time_ofs - csound->icurTime) / csound->esr;
+    len = snprintf(line, sizeof(line), "%c", evt->opcod);
+    for (i = 1; i <= evt->pcnt && len < sizeof(line); i++) {
+      if (i == 2)
+        n = snprintf(line + len, sizeof(line) - len, " %.17g",
+                     start > 0.0 ? start : 0.0);
+      else if (csound->ISSTRCOD(evt->p[i]) && s != NULL) {
+        n = snprintf(line + len, sizeof(line) - len, " \"%s\"", s);
+        s += strlen(s) + 1;
+      }
+      else
+        n = snprintf(line + len, sizeof(line) - len, " %.17g",
+                     (double) evt->p[i]);
+      len += n;
+    }
+    if (UNLIKELY(len >= sizeof(line) - 1)) {
+      csound->Warning(csound, Str("cluster: event for instr %d is too long "
+                                  "to send to node %d\n"),
+                      insno, insno % c->nodes);
+      return 1;
+    }
+    line[len++] = '\n';
+    line[len] = '\0';
+    put_event(csound, c, line);
+    return 1;
+}
+
+/* line events from the API: the coordinator sends them to all nodes */
+void csoundClusterInputMessage(CSOUND *csound, const char *message)
+{
+    CLUSTER *c = (CLUSTER*) csound->cluster;
+
+    if (c->node != 0) {
+      csoundInputMessageInternal(csound, message);
+      return;
+    }
+    put_event(csound, c, message);
+}
+
+/* CONNECTION */
+
+static int cluster_error(CSOUND *csound, const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    csound->ErrMsgV(csound, NULL, fmt, args);
+    va_end(args);
+    return CSOUND_ERROR;
+}
+
+static void put_hello(CSOUND *csound, CLUSTER_BUF *b, int node)
+{
+    double sr = (double) csound->esr;
+    buf_begin(csound, b);
+    buf_put_int(csound, b, CLUSTER_MAGIC);
+    buf_put_int(csound, b, CLUSTER_VERSION);
+    buf_put_int(csound, b, node);
+    buf_put_int(csound, b, (int32_t) sizeof(MYFLT));
+    buf_put_int(csound, b, (int32_t) csound->ksmps);
+    buf_put_int(csound, b, (int32_t) csound->nchnls);
+    buf_put_double(csound, b, sr);
+}
+
+/* coordinator: waits for all the workers to connect */
+static int cluster_accept(CSOUND *csound, CLUSTER *c, int port)
+{
+    struct sockaddr_in addr;
+    int      lsock, one = 1, waiting = c->nodes - 1;
+    double   deadline = csound->GetRealTime(csound->csRtClock) + CLUSTER_TIMEOUT;
+
+    if ((lsock = socket(AF_INET, SOCK_STREAM, 0)) < 0)
+      return cluster_error(csound, "%s", Str("cluster: creating socket"));
+    setsockopt(lsock, SOL_SOCKET, SO_REUSEADDR, (const char*) &one, sizeof(one));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons((unsigned short) port);
+    if (bind(lsock, (struct sockaddr*) &addr, sizeof(addr)) < 0 ||
+        listen(lsock, c->nodes) < 0) {
+      close(lsock);
+      return cluster_error(csound, Str("cluster: cannot listen on "
+                                           "port %d"), port);
+    }
+    csound->Message(csound, Str("cluster: waiting for %d nodes on port %d\n"),
+                    waiting, port);
+    while (waiting > 0) {
+      fd_set  rset;
+      struct timeval tv;
+      int32_t magic, version, node, fsize, ksmps, nchnls, status = 0;
+      double  sr;
+      int     s;
+
+      if (csound->GetRealTime(csound->csRtClock) > deadline) {
+        close(lsock);
+        return cluster_error(csound, Str("cluster: timed out waiting "
+                                             "for %d nodes"), waiting);
+      }
+      FD_ZERO(&rset);
+      FD_SET(lsock, &rset);
+      tv.tv_sec = 1;
+      tv.tv_usec = 0;
+      if (select(lsock + 1, &rset, NULL, NULL, &tv) <= 0 ||
+          (s = accept(lsock, NULL, NULL)) < 0)
+        continue;
+      set_options(s);
+      if (recv_frame(csound, s, &c->in) != 0 ||
+          buf_get_int(&c->in, &magic) != 0 ||
+          buf_get_int(&c->in, &version) != 0 ||
+          buf_get_int(&c->in, &node) != 0 ||
+          buf_get_int(&c->in, &fsize) != 0 ||
+          buf_get_int(&c->in, &ksmps) != 0 ||
+          buf_get_int(&c->in, &nchnls) != 0 ||
+          buf_get_double(&c->in, &sr) != 0 ||
+          magic != CLUSTER_MAGIC || version != CLUSTER_VERSION) {
+        close(s);
+        continue;
+      }
+      if (node <= 0 || node >= c->nodes || c->socks[node] >= 0) {
+        csound->Warning(csound, Str("cluster: rejecting node %d\n"), node);
+        status = -1;
+      }
+      else if (fsize != (int32_t) sizeof(MYFLT) ||
+               ksmps != (int32_t) csound->ksmps ||
+               nchnls != (int32_t) csound->nchnls || sr != csound->esr) {
+        csound->Warning(csound, Str("cluster: node %d has a different "
+                                    "sr, ksmps, nchnls or precision\n"), node);
+        status = -1;
+      }
+      buf_begin(csound, &c->out);
+      buf_put_int(csound, &c->out, status);
+      if (send_frame(s, &c->out) != 0 || status != 0) {
+        close(s);
+        continue;
+      }
+      c->socks[node] = s;
+      waiting--;
+      csound->Message(csound, Str("cluster: node %d connected\n"), node);
+    }
+    close(lsock);
+    return CSOUND_SUCCESS;
+}
+
+/* worker: connects to the coordinator, retrying until it is up */
+static int cluster_connect(CSOUND *csound, CLUSTER *c,
+                           const char *host, int port)
+{
+    struct sockaddr_in addr;
+    double  deadline = csound->GetRealTime(csound->csRtClock) + CLUSTER_TIMEOUT;
+    int32_t status;
+    int     s;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((unsigned short) port);
+    if (inet_pton(AF_INET, host, &addr.sin_addr) != 1)
+      return cluster_error(csound, Str("cluster: invalid address %s"),
+                               host);
+    while (1) {
+      if ((s = socket(AF_INET, SOCK_STREAM, 0)) < 0)
+        return cluster_error(csound, "%s",
+                                 Str("cluster: creating socket"));
+      if (connect(s, (struct sockaddr*) &addr, sizeof(addr)) == 0) break;
+      close(s);
+      if (csound->GetRealTime(csound->csRtClock) > deadline)
+        return cluster_error(csound, Str("cluster: cannot connect to "
+                                             "%s:%d"), host, port);
+      csoundSleep(100);
+    }
+    set_options(s);
+    put_hello(csound, &c->out, c->node);
+    if (send_frame(s, &c->out) != 0 || recv_frame(csound, s, &c->in) != 0 ||
+        buf_get_int(&c->in, &status) != 0 || status != 0) {
+      close(s);
+      return cluster_error(csound, "%s",
+                               Str("cluster: refused by the coordinator"));
+    }
+    c->socks[0] = s;
+    return CSOUND_SUCCESS;
+}
+
+static void cluster_free(CSOUND *csound, CLUSTER *c)
+{
+    CONS_CELL *head, *items;
+    int       k;
+
+    for (k = 0; k < c->nodes; k++)
+      if (c->socks[k] >= 0) close(c->socks[k]);
+    head = items = cs_hash_table_values(csound, c->chans);
+    for ( ; items != NULL; items = items->next) {
+      CLUSTER_CHN *ch = (CLUSTER_CHN*) items->value;
+      csound->Free(csound, ch->base);
+      csound->Free(csound, ch->sum);
+      csound->Free(csound, ch);
+    }
+    cs_cons_free(csound, head);
+    cs_hash_table_free(csound, c->chans);
+    csound->Free(csound, c->out.data);
+    csound->Free(csound, c->in.data);
+    csound->Free(csound, c->events.data);
+    csound->Free(csound, c->sending.data);
+    csound->Free(csound, c->map);
+    csound->Free(csound, c->socks);
+    csound->Free(csound, c);
+}
+
+/* called by csoundStart(): sets up the cluster if -+cluster_nodes > 1 */
+int csoundClusterStart(CSOUND *csound)
+{
+    int     *nodes = (int*) csound->QueryGlobalVariable(csound,
+                                                        "_CLUSTER_NODES");
+    int     *node = (int*) csound->QueryGlobalVariable(csound, "_CLUSTER_NODE");
+    int     *port = (int*) csound->QueryGlobalVariable(csound, "_CLUSTER_PORT");
+    char    *host = (char*) csound->QueryGlobalVariable(csound,
+                                                        "_CLUSTER_HOST");
+    CLUSTER *c;
+    int     k, err;
+
+    if (nodes == NULL || *nodes <= 1 || csound->cluster != NULL)
+      return CSOUND_SUCCESS;
+    if (UNLIKELY(*node < 0 || *node >= *nodes))
+      return cluster_error(csound, Str("cluster: node %d out of range "
+                                           "0 to %d"), *node, *nodes - 1);
+#if defined(WIN32) && !defined(__CYGWIN__)
+    {
+      WSADATA wsaData = {0};
+      if (WSAStartup(MAKEWORD(2,2), &wsaData) != 0)
+        return cluster_error(csound, "%s",
+                                 Str("cluster: Winsock2 failed to start"));
+    }
+#endif
+    c = (CLUSTER*) csound->Calloc(csound, sizeof(CLUSTER));
+    c->node = *node;
+    c->nodes = *nodes;
+    c->socks = (int*) csound->Calloc(csound, c->nodes * sizeof(int));
+    for (k = 0; k < c->nodes; k++) c->socks[k] = -1;
+    c->chans = cs_hash_table_create(csound);
+    csoundSpinLockInit(&c->lock);
+    if (c->node == 0)
+      err = cluster_accept(csound, c, *port);
+    else
+      err = cluster_connect(csound, c, *host ? host : "127.0.0.1", *port);
+    if (err != CSOUND_SUCCESS) {
+      cluster_free(csound, c);
+      return CSOUND_ERROR;
+    }
+    csound->cluster = c;
+    csound->Message(csound, Str("cluster: node %d of %d\n"),
+                    c->node, c->nodes);
+    return CSOUND_SUCCESS;
+}
+
+void csoundClusterClose(CSOUND *csound)
+{
+    CLUSTER *c = (CLUSTER*) csound->cluster;
+
+    if (c == NULL) return;
+    csound->cluster = NULL;
+    cluster_free(csound, c);
+}
@@ -68,6 +68,9 @@
 #include "csound_standard_types.h"
 
 #include "csdebug.h"
+#include "csprofile.h"
+#include "cluster.h"
+#include "bus.h"
 #include <time.h>
 
 extern void allocate_message_queue(CSOUND *csound);
@@ -84,6 +87,9 @@ static int  defaultCsoundYield(CSOUND *);
 static int  csoundDoCallback_(CSOUND *, void *, unsigned int);
 static void reset(CSOUND *);
 static int  csoundPerformKsmpsInternal(CSOUND *csound);
+static int  csoundSetAudioDriven(CSOUND *csound, int on);
+static int  csoundPerformAudioDriven(CSOUND *csound, int nframes);
+static int  audio_driven_wait(CSOUND *csound, int once);
 void csoundTableSetInternal(CSOUND *csound, int table, int index,
                                    MYFLT value);
 static INSTRTXT **csoundGetInstrumentList(CSOUND *csound);
@@ -142,21 +148,15 @@ void print_csound_version(CSOUND* csound)
 }
 
 static void free_opcode_table(CSOUND* csound) {
-    int i;
-    CS_HASH_TABLE_ITEM* bucket;
-    CONS_CELL* head;
-
-    for (i = 0; i < csound->opcodes->table_size; i++) {
-      bucket = csound->opcodes->buckets[i];
+    int pos = 0;
+    void* head;
 
-      while (bucket != NULL) {
-        head = bucket->value;
-        cs_cons_free_complete(csound, head);
-        bucket = bucket->next;
-      }
+    while (cs_hash_table_next(csound->opcodes, &pos, NULL, &head)) {
+      cs_cons_free_complete(csound, (CONS_CELL*) head);
     }
 
     cs_hash_table_free(csound, csound->opcodes);
+    opcode_signatures_reset(csound, NULL);
 }
 static void create_opcode_table(CSOUND *csound)
 {
@@ -167,6 +167,7 @@ static void create_opcode_table(CSOUND *csound)
       free_opcode_table(csound);
     }
     csound->opcodes = cs_hash_table_create(csound);
+    cs_hash_table_reserve(csound, csound->opcodes, 2048);
 
     /* Basic Entry1 stuff */
     err = csoundAppendOpcodes(csound, &(opcodlst_1[0]), -1);
@@ -509,10 +510,15 @@ static const CSOUND cenviron_ = {
     csoundErrCnt,
     csoundFTnp2Finde,
     csoundGetInstrument,
+    csoundSetAudioDriven,
+    csoundPerformAudioDriven,
+    csoundSetExternalMidiReadTimedCallback,
+    csoundSetAsyncFormat,
+    csoundRemoveSenseEventCallback,
     {
       NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
       NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-      NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL
+      NULL, NULL, NULL, NULL
     },
     /* ------- private data (not to be used by hosts or externals) ------- */
     /* callback function pointers */
@@ -1321,6 +1327,7 @@ PUBLIC CSOUND *csoundCreate(void *hostdata)
     csoundUnLock();
     csoundReset(csound);
     csound->API_lock = csoundCreateMutex(1);
+    csound->chn_db_lock = csoundCreateMutex(1);
     allocate_message_queue(csound);
     /* NB: as suggested by F Pinot, keep the
        address of the pointer to CSOUND inside
@@ -1398,6 +1405,8 @@ PUBLIC void csoundDestroy(CSOUND *csound)
       //csoundLockMutex(csound->API_lock);
       csoundDestroyMutex(csound->API_lock);
     }
+    if (csound->chn_db_lock != NULL)
+      csoundDestroyMutex(csound->chn_db_lock);
     /* clear the pointer */
     // *(csound->self) = NULL;
     free((void*) csound);
@@ -1496,10 +1505,20 @@ int dag_end_task(CSOUND *csound, int task);
 void dag_build(CSOUND *csound, INSDS *chain);
 void dag_reinit(CSOUND *csound);
 
+/* Runs the perf chain of an instance for one k-period (perf_chain() in
+   Engine/insert.c).  ip->pds is set to the first opcode so that it is not
+   NULL at perf time; after that only the opcodes that can jump, reinit
+   or turn the instance off keep it current. */
+static inline int perf_instance(CSOUND *csound, INSDS *ip, int thread)
+{
+    if (UNLIKELY(!ip->actflg)) return 0;
+    ip->pds = ip->nxtp;
+    return perf_chain(csound, ip, thread);
+}
+
 inline static int nodePerf(CSOUND *csound, int index, int numThreads)
 {
     INSDS *insds = NULL;
-    OPDS  *opstart = NULL;
     int played_count = 0;
     int which_task;
     INSDS **task_map = (INSDS**)csound->dag_task_map;
@@ -1507,7 +1526,6 @@ inline static int nodePerf(CSOUND *csound, int index, int numThreads)
 #define INVALID (-1)
 #define WAIT    (-2)
     int next_task = INVALID;
-    IGN(index);
 
     while (1) {
       int done;
@@ -1530,19 +1548,12 @@ inline static int nodePerf(CSOUND *csound, int index, int numThreads)
         done = insds->init_done;
 #endif
         if (done) {
-          opstart = (OPDS*)task_map[which_task];
           if (insds->ksmps == csound->ksmps) {
             insds->spin = csound->spin;
             insds->spout = csound->spraw;
             insds->kcounter =  csound->kcounter;
             csound->mode = 2;
-            while ((opstart = opstart->nxtp) != NULL) {
-              /* In case of jumping need this repeat of opstart */
-              opstart->insdshead->pds = opstart;
-              csound->op = csound->ids->optext->t.oentry->opname;
-              (*opstart->opadr)(csound, opstart); /* run each opcode */
-              opstart = opstart->insdshead->pds;
-            }
+            (void) perf_instance(csound, insds, index);
             csound->mode = 0;
           } else {
             int i, n = csound->nspout, start = 0;
@@ -1550,7 +1561,6 @@ inline static int nodePerf(CSOUND *csound, int index, int numThreads)
             int incr = csound->nchnls*lksmps;
             int offset =  insds->ksmps_offset;
             int early = insds->ksmps_no_end;
-            OPDS  *opstart;
             insds->spin = csound->spin;
             insds->spout = csound->spraw;
             insds->kcounter =  csound->kcounter*csound->ksmps;
@@ -1570,14 +1580,8 @@ inline static int nodePerf(CSOUND *csound, int index, int numThreads)
             }
 
             for (i=start; i < n; i+=incr, insds->spin+=incr, insds->spout+=incr) {
-              opstart = (OPDS*) insds;
               csound->mode = 2;
-              while ((opstart = opstart->nxtp) != NULL) {
-                opstart->insdshead->pds = opstart;
-                csound->op = csound->ids->optext->t.oentry->opname;
-                (*opstart->opadr)(csound, opstart); /* run each opcode */
-                opstart = opstart->insdshead->pds;
-              }
+              (void) perf_instance(csound, insds, index);
               csound->mode = 0;
               insds->kcounter++;
             }
@@ -1743,21 +1747,12 @@ int kperf_nodebug(CSOUND *csound)
           }
           done = ATOMIC_GET(ip->init_done);
           if (done == 1) {/* if init-pass has been done */
-            int error = 0;
-            OPDS  *opstart = (OPDS*) ip;
             ip->spin = csound->spin;
             ip->spout = csound->spraw;
             ip->kcounter =  csound->kcounter;
             if (ip->ksmps == csound->ksmps) {
               csound->mode = 2;
-              while (error == 0 &&
-                     (opstart = opstart->nxtp) != NULL &&
-                     ip->actflg) {
-                opstart->insdshead->pds = opstart;
-                csound->op = opstart->optext->t.opcod;
-                error = (*opstart->opadr)(csound, opstart); /* run each opcode */
-                opstart = opstart->insdshead->pds;
-              }
+              (void) perf_instance(csound, ip, 0);
               csound->mode = 0;
             } else {
                 int error = 0;
@@ -1766,7 +1761,6 @@ int kperf_nodebug(CSOUND *csound)
                 int incr = csound->nchnls*lksmps;
                 int offset =  ip->ksmps_offset;
                 int early = ip->ksmps_no_end;
-                OPDS  *opstart;
                 ip->spin = csound->spin;
                 ip->spout = csound->spraw;
                 ip->kcounter =  csound->kcounter*csound->ksmps/lksmps;
@@ -1786,16 +1780,9 @@ int kperf_nodebug(CSOUND *csound)
                 }
 
                 for (i=start; i < n; i+=incr, ip->spin+=incr, ip->spout+=incr) {
-                  opstart = (OPDS*) ip;
                   csound->mode = 2;
-                  while (error ==  0 && (opstart = opstart->nxtp) != NULL
-                         && ip->actflg) {
-                    opstart->insdshead->pds = opstart;
-                    csound->op = opstart->optext->t.opcod;
-                    //csound->ids->optext->t.oentry->opname;
-                    error = (*opstart->opadr)(csound, opstart); /* run each opcode */
-                    opstart = opstart->insdshead->pds;
-                  }
+                  if (LIKELY(error == 0))
+                    error = perf_instance(csound, ip, 0);
                   csound->mode = 0;
                   ip->kcounter++;
                 }
@@ -1809,11 +1796,20 @@ int kperf_nodebug(CSOUND *csound)
         }
       }
     }
+    {
+      void *prof = csound->profiler;
+      if (UNLIKELY(prof != NULL))
+        csoundProfilerTick(csound, prof);
+    }
 
     if (!csound->spoutactive) { /* results now in spout? */
       memset(csound->spout, 0, csound->nspout * sizeof(MYFLT));
       memset(csound->spraw, 0, csound->nspout * sizeof(MYFLT));
     }
+    if (UNLIKELY(csound->cluster != NULL))
+      csoundClusterSync(csound);
+    if (UNLIKELY(csound->chnShm != NULL))
+      csoundChannelShmEnd(csound);
     make_interleave(csound, lksmps);
     csound->spoutran(csound); /* send to audio_out */
     //#ifdef ANDROID
@@ -1912,8 +1908,6 @@ int kperf_debug(CSOUND *csound)
     INSDS *ip;
     csdebug_data_t *data = (csdebug_data_t *) csound->csdebug_data;
     int lksmps = csound->ksmps;
-    /* call message_dequeue to run API calls */
-    message_dequeue(csound);
 
     if (!data || data->status != CSDEBUG_STATUS_STOPPED) {
       /* update orchestra time */
@@ -1922,6 +1916,10 @@ int kperf_debug(CSOUND *csound)
       csound->curBeat += csound->curBeat_inc;
     }
 
+    /* call message_dequeue to run API calls, after the time update as in
+       kperf_nodebug(), so that timed channel writes are applied */
+    message_dequeue(csound);
+
     /* if skipping time on request by 'a' score statement: */
     if (UNLIKELY(csound->advanceCnt)) {
       csound->advanceCnt--;
@@ -2100,7 +2098,11 @@ int kperf_debug(CSOUND *csound)
       memset(csound->spout, 0, csound->nspout * sizeof(MYFLT));
       memset(csound->spraw, 0, csound->nspout * sizeof(MYFLT));
     }
-    else
+    if (UNLIKELY(csound->cluster != NULL))
+      csoundClusterSync(csound);
+    if (UNLIKELY(csound->chnShm != NULL))
+      csoundChannelShmEnd(csound);
+    if (csound->spoutactive)
       make_interleave(csound, lksmps);
     csound->spoutran(csound);               /*      send to audio_out  */
     }
@@ -2152,6 +2154,13 @@ PUBLIC int csoundPerformKsmps(CSOUND *csound)
                           "has not been called\n"));
       return CSOUND_ERROR;
     }
+    if (UNLIKELY(csound->audioDriven)) {
+      /* the audio module performs, return after its next period */
+      if (!audio_driven_wait(csound, 1))
+        return 0;
+      done = csound->audioDrivenDone;
+      return done ? done : 1;
+    }
     if (csound->jumpset == 0) {
       int returnValue;
       csound->jumpset = 1;
@@ -2218,6 +2227,13 @@ PUBLIC int csoundPerformBuffer(CSOUND *csound)
                           "has not been called\n"));
       return CSOUND_ERROR;
     }
+    if (UNLIKELY(csound->audioDriven)) {
+      /* the audio module performs, return after its next period */
+      if (!audio_driven_wait(csound, 1))
+        return 0;
+      done = csound->audioDrivenDone;
+      return done ? done : 1;
+    }
     /* Setup jmp for return after an exit(). */
     if (UNLIKELY((returnValue = setjmp(csound->exitjmp)))) {
 #ifndef MACOSX
@@ -2261,6 +2277,10 @@ PUBLIC int csoundPerform(CSOUND *csound)
     }
 
     csound->performState = 0;
+    if (UNLIKELY(csound->audioDriven)) {
+      audio_driven_wait(csound, 0);
+      return csound->audioDrivenDone;
+    }
     /* setup jmp for return after an exit() */
     if (UNLIKELY((returnValue = setjmp(csound->exitjmp)))) {
 #ifndef MACOSX
@@ -2291,6 +2311,161 @@ PUBLIC int csoundPerform(CSOUND *csound)
     return 0;
 }
 
+/* AUDIO DRIVEN PERFORMANCE
+ *
+ * A real-time audio module can run the performance from its own process
+ * callback, rather than exchanging buffers with a host thread that runs
+ * it.  The module arms this with SetAudioDriven(csound, 1) when it opens
+ * the device, then calls PerformAudioDriven() for each period.  The
+ * host's csoundPerform() starts the performance and waits for it to end;
+ * csoundPerformKsmps() and csoundPerformBuffer() start it and return
+ * after each period, so that the host can keep calling them.  The module
+ * calls SetAudioDriven(csound, 0) when it can no longer perform, which
+ * ends the performance with CSOUND_ERROR if it has not ended already.
+ */
+
+enum {
+    AUDIO_DRIVEN_OFF = 0,
+    AUDIO_DRIVEN_ARMED,         /* waiting for the host to start */
+    AUDIO_DRIVEN_RUNNING,
+    AUDIO_DRIVEN_DONE
+};
+
+/* moves the state from old to new, returns non-zero if it was old */
+static int audio_driven_move(CSOUND *csound, int old, int new)
+{
+#if defined(MSVC)
+    return (InterlockedCompareExchange((volatile long*) &csound->audioDriven,
+                                       new, old) == old);
+#elif defined(HAVE_ATOMIC_BUILTIN)
+    return __atomic_compare_exchange_n(&csound->audioDriven, &old, new, 0,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#else
+    if (csound->audioDriven != old)
+      return 0;
+    csound->audioDriven = new;
+    return 1;
+#endif
+}
+
+static int audio_driven_free(CSOUND *csound, void *p)
+{
+    (void) p;
+    csoundDestroyThreadLock(csound->audioDrivenLock);
+    csound->audioDrivenLock = NULL;
+    return 0;
+}
+
+static void audio_driven_end(CSOUND *csound, int done)
+{
+    csound->audioDrivenDone = done;
+    ATOMIC_SET(csound->audioDriven, AUDIO_DRIVEN_DONE);
+    csoundNotifyThreadLock(csound->audioDrivenLock);
+}
+
+static int csoundSetAudioDriven(CSOUND *csound, int on)
+{
+    if (!on) {
+      /* the module can no longer perform: end the performance, whether
+         or not the host has started it, so that its perform call
+         returns */
+      if (audio_driven_move(csound, AUDIO_DRIVEN_ARMED, AUDIO_DRIVEN_DONE) ||
+          audio_driven_move(csound, AUDIO_DRIVEN_RUNNING, AUDIO_DRIVEN_DONE))
+        audio_driven_end(csound, CSOUND_ERROR);
+      return CSOUND_SUCCESS;
+    }
+    if (csound->oparms->numThreads > 1) {
+      /* the -j workers are synchronised with the thread calling kperf */
+      csound->Warning(csound, "%s",
+                      Str("audio driven performance is not available "
+                          "with -j\n"));
+      return CSOUND_ERROR;
+    }
+    if (csound->audioDrivenLock == NULL) {
+      /* notified at the end of each period, and at the end */
+      csound->audioDrivenLock = csoundCreateThreadLock();
+      if (UNLIKELY(csound->audioDrivenLock == NULL))
+        return CSOUND_MEMORY;
+      csoundWaitThreadLock(csound->audioDrivenLock, 0);
+      csoundRegisterResetCallback(csound, NULL, audio_driven_free);
+    }
+    csound->audioDrivenDone = 0;
+    ATOMIC_SET(csound->audioDriven, AUDIO_DRIVEN_ARMED);
+    return CSOUND_SUCCESS;
+}
+
+/* Performs nframes sample frames, a multiple of ksmps.  Returns 0 if
+   they were performed, non-zero if the performance has ended, and
+   negative if it has not started yet; in the latter two cases the
+   module should output silence. */
+static int csoundPerformAudioDriven(CSOUND *csound, int nframes)
+{
+    int n, done = 0, returnValue, state;
+
+    state = ATOMIC_GET(csound->audioDriven);
+    if (state != AUDIO_DRIVEN_RUNNING)
+      return (state == AUDIO_DRIVEN_DONE ? 1 : -1);
+    /* setup jmp for return after an exit(), on this thread */
+    if (UNLIKELY((returnValue = setjmp(csound->exitjmp)))) {
+      if (!csound->oparms->realtime)
+        csoundUnlockMutex(csound->API_lock);
+      csoundMessage(csound,
+                    Str("Early return from audio driven performance.\n"));
+      audio_driven_end(csound, ((returnValue - CSOUND_EXITJMP_SUCCESS) |
+                                CSOUND_EXITJMP_SUCCESS));
+      return 1;
+    }
+    if (!csound->oparms->realtime) // no API lock in realtime mode
+      csoundLockMutex(csound->API_lock);
+    for (n = 0; n < nframes && !done; n += csound->ksmps) {
+      if (UNLIKELY(csound->performState != 0)) {
+        csoundMessage(csound, Str("csoundPerform(): stopped.\n"));
+        csound->performState = 0;
+        done = -1;
+        break;
+      }
+      do {
+        if (UNLIKELY((done = sensevents(csound)))) {
+          csoundMessage(csound,
+                        Str("Score finished in audio driven performance.\n"));
+          break;
+        }
+      } while (csound->kperf(csound));
+    }
+    if (!csound->oparms->realtime) // no API lock in realtime mode
+      csoundUnlockMutex(csound->API_lock);
+    if (done) {
+      audio_driven_end(csound, done > 0 ? done : 0);
+      return 1;
+    }
+    csoundNotifyThreadLock(csound->audioDrivenLock);
+    return 0;
+}
+
+/* called by the host's perform functions: let the module run the
+   performance, and wait for its end, or with once set for the end of
+   its next period.  Returns non-zero if the performance has ended, its
+   result is then in audioDrivenDone. */
+static int audio_driven_wait(CSOUND *csound, int once)
+{
+    int state;
+
+    audio_driven_move(csound, AUDIO_DRIVEN_ARMED, AUDIO_DRIVEN_RUNNING);
+    state = ATOMIC_GET(csound->audioDriven);
+    while (state == AUDIO_DRIVEN_RUNNING) {
+      csoundWaitThreadLockNoTimeout(csound->audioDrivenLock);
+      state = ATOMIC_GET(csound->audioDriven);
+      if (once)
+        break;
+    }
+    if (state == AUDIO_DRIVEN_DONE) {
+      /* wake any other thread waiting for the end */
+      csoundNotifyThreadLock(csound->audioDrivenLock);
+      return 1;
+    }
+    return 0;
+}
+
 /* stop a csoundPerform() running in another thread */
 
 PUBLIC void *csoundGetNamedGens(CSOUND *csound)
@@ -3036,6 +3211,15 @@ PUBLIC void csoundSetExternalMidiReadCallback(CSOUND *csound,
     csound->midiGlobals->MidiReadCallback = func;
 }
 
+PUBLIC void csoundSetExternalMidiReadTimedCallback(CSOUND *csound,
+                                                   int (*func)(CSOUND *,
+                                                               void *,
+                                                               unsigned char *,
+                                                               int *, int))
+{
+    csound->midiGlobals->MidiReadTimedCallback = func;
+}
+
 PUBLIC void csoundSetExternalMidiInCloseCallback(CSOUND *csound,
                                                  int (*func)(CSOUND *, void *))
 {
@@ -3132,6 +3316,7 @@ static CS_NOINLINE int opcode_list_new_oentry(CSOUND *csound,
     //printf("%p\n", entryCopy);
     memcpy(entryCopy, ep, sizeof(OENTRY));
     entryCopy->useropinfo = NULL;
+    opcode_signatures_reset(csound, shortName);
 
     if (head != NULL) {
         cs_cons_append(head, cs_cons(csound, entryCopy, NULL));
@@ -3311,6 +3496,7 @@ static void reset(CSOUND *csound)
     memcpy(p1, (void*) &(saved_env->first_callback_), (size_t) length);
     csound->csoundCallbacks_ = saved_env->csoundCallbacks_;
     csound->API_lock = saved_env->API_lock;
+    csound->chn_db_lock = saved_env->chn_db_lock;
 #ifdef HAVE_PTHREAD_SPIN_LOCK
     csound->memlock = saved_env->memlock;
     csound->spinlock = saved_env->spinlock;
@@ -3358,6 +3544,7 @@ PUBLIC void csoundSetMIDIModule(CSOUND *csound, const char *module){
       csound->SetMIDIDeviceListCallback(csound, midi_dev_list_dummy);
       csound->SetExternalMidiInOpenCallback(csound, DummyMidiInOpen);
       csound->SetExternalMidiReadCallback(csound,  DummyMidiRead);
+      csound->SetExternalMidiReadTimedCallback(csound, NULL);
       csound->SetExternalMidiInCloseCallback(csound, NULL);
       csound->SetExternalMidiOutOpenCallback(csound,  DummyMidiOutOpen);
       csound->SetExternalMidiWriteCallback(csound, DummyMidiWrite);
@@ -3602,6 +3789,103 @@ PUBLIC void csoundReset(CSOUND *csound)
                                       CSOUNDCFG_BOOLEAN, 0, NULL, NULL,
                                       Str("Ignore <CsOptions> in CSD files"
                                           " (default: no)"), NULL);
+    /* persistent cache of parsed orchestras (Engine/csound_orc_cache.c) */
+    max_len = 256;
+    csoundCreateGlobalVariable(csound, "_ORC_CACHE", (size_t) max_len);
+    csoundCreateConfigurationVariable(csound, "orc_cache",
+                                      csoundQueryGlobalVariable(csound,
+                                                                "_ORC_CACHE"),
+                                      CSOUNDCFG_STRING, 0, NULL, &max_len,
+                                      Str("Directory for caching parsed "
+                                          "orchestras (default: none)"), NULL);
+    /* perf-time profiler (Top/csprofile.c) */
+    csoundCreateGlobalVariable(csound, "_PROFILE", sizeof(int));
+    csoundCreateConfigurationVariable(csound, "profile",
+                                      csoundQueryGlobalVariable(csound,
+                                                                "_PROFILE"),
+                                      CSOUNDCFG_BOOLEAN, 0, NULL, NULL,
+                                      Str("Profile opcodes and instruments "
+                                          "(default: no)"), NULL);
+    csoundCreateGlobalVariable(csound, "_PROFILE_PERIOD", sizeof(int));
+    csoundCreateConfigurationVariable(csound, "profile_period",
+                                      csoundQueryGlobalVariable(csound,
+                                                        "_PROFILE_PERIOD"),
+                                      CSOUNDCFG_INTEGER, 0, NULL, NULL,
+                                      Str("Seconds between profile reports "
+                                          "(default: 0, at the end only)"),
+                                      NULL);
+    /* vectorised math kernels for a-rate opcodes (H/fastmath.h) */
+    csoundCreateGlobalVariable(csound, "_FAST_MATH", sizeof(int));
+    csoundCreateConfigurationVariable(csound, "fast_math",
+                                      csoundQueryGlobalVariable(csound,
+                                                                "_FAST_MATH"),
+                                      CSOUNDCFG_BOOLEAN, 0, NULL, NULL,
+                                      Str("Use polynomial approximations "
+                                          "for a-rate exp, log, sin and cos, "
+                                          "within 2 ulps of libm, and pow, "
+                                          "within 2 + 1.5 |y log2 x| ulps "
+                                          "(default: no)"), NULL);
+    /* distributed rendering (Top/cluster.c) */
+    csoundCreateGlobalVariable(csound, "_CLUSTER_NODES", sizeof(int));
+    csoundCreateConfigurationVariable(csound, "cluster_nodes",
+                                      csoundQueryGlobalVariable(csound,
+                                                        "_CLUSTER_NODES"),
+                                      CSOUNDCFG_INTEGER, 0, NULL, NULL,
+                                      Str("Number of processes sharing the "
+                                          "instruments (default: 1)"), NULL);
+    csoundCreateGlobalVariable(csound, "_CLUSTER_NODE", sizeof(int));
+    csoundCreateConfigurationVariable(csound, "cluster_node",
+                                      csoundQueryGlobalVariable(csound,
+                                                        "_CLUSTER_NODE"),
+                                      CSOUNDCFG_INTEGER, 0, NULL, NULL,
+                                      Str("Index of this process in the "
+                                          "cluster, 0 for the coordinator"),
+                                      NULL);
+    csoundCreateGlobalVariable(csound, "_CLUSTER_PORT", sizeof(int));
+    *((int*) csoundQueryGlobalVariable(csound, "_CLUSTER_PORT")) = 40400;
+    csoundCreateConfigurationVariable(csound, "cluster_port",
+                                      csoundQueryGlobalVariable(csound,
+                                                        "_CLUSTER_PORT"),
+                                      CSOUNDCFG_INTEGER, 0, NULL, NULL,
+                                      Str("TCP port of the cluster "
+                                          "coordinator (default: 40400)"),
+                                      NULL);
+    max_len = 256;
+    csoundCreateGlobalVariable(csound, "_CLUSTER_HOST", (size_t) max_len);
+    csoundCreateConfigurationVariable(csound, "cluster_host",
+                                      csoundQueryGlobalVariable(csound,
+                                                        "_CLUSTER_HOST"),
+                                      CSOUNDCFG_STRING, 0, NULL, &max_len,
+                                      Str("IP address of the cluster "
+                                          "coordinator (default: 127.0.0.1)"),
+                                      NULL);
+    /* shared memory channel bus (OOps/bus.c) */
+    csoundCreateGlobalVariable(csound, "_CHN_SHM", (size_t) max_len);
+    csoundCreateConfigurationVariable(csound, "chn_shm",
+                                      csoundQueryGlobalVariable(csound,
+                                                                "_CHN_SHM"),
+                                      CSOUNDCFG_STRING, 0, NULL, &max_len,
+                                      Str("Name of the shared memory object "
+                                          "for shared channels (e.g. /bus)"),
+                                      NULL);
+    csoundCreateGlobalVariable(csound, "_CHN_SHM_SLOTS", sizeof(int));
+    *((int*) csoundQueryGlobalVariable(csound, "_CHN_SHM_SLOTS")) = 64;
+    csoundCreateConfigurationVariable(csound, "chn_shm_slots",
+                                      csoundQueryGlobalVariable(csound,
+                                                        "_CHN_SHM_SLOTS"),
+                                      CSOUNDCFG_INTEGER, 0, NULL, NULL,
+                                      Str("Number of channels of the shared "
+                                          "memory bus (default: 64)"), NULL);
+    /* background file writer (Engine/envvar.c) */
+    csoundCreateGlobalVariable(csound, "_FILE_SYNC", sizeof(int));
+    csoundCreateConfigurationVariable(csound, "file_sync",
+                                      csoundQueryGlobalVariable(csound,
+                                                                "_FILE_SYNC"),
+                                      CSOUNDCFG_INTEGER, 0, NULL, NULL,
+                                      Str("Asynchronous writes: 0 leaves "
+                                          "them buffered, 1 flushes and 2 "
+                                          "syncs to disk after each block"),
+                                      NULL);
 }
 
 PUBLIC int csoundGetDebug(CSOUND *csound)
@@ -0,0 +1,362 @@
+/*
+    csprofile.c:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+/* Perf-time profiler.
+ *
+ * When csound->profiler is set, the perf loops in kperf() and the UDO
+ * and subinstr perf functions call the opcodes through the functions
+ * here, which read a monotonic clock around each call and add the
+ * time to a node keyed by the opcode's OPTXT.  Nodes are found through
+ * a fixed hash table whose chains are only ever prepended to, so the
+ * lookup takes no lock; creating a node takes a spinlock.  Counters
+ * are updated atomically since the same opcode may run on several
+ * -j threads at once.  When the profiler is off the cost is a single
+ * test per instrument instance (per opcode in UDO bodies).
+ *
+ * The hooks read csound->profiler once and use that pointer for the
+ * whole call, so csoundProfilerClean() only detaches the profiler; the
+ * perf thread or a -j worker may still be timing an opcode with it, so
+ * its memory is released by a reset callback, when no performance can
+ * be running.
+ */
+
+#include "csprofile.h"
+#include "insert.h"
+
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define PROF_BUCKETS  (1024)
+
+#if defined(MSVC)
+#define PROF_ADD(var, val) InterlockedExchangeAdd64((LONG64*) &(var), val)
+#elif defined(HAVE_ATOMIC_BUILTIN)
+#define PROF_ADD(var, val) __atomic_fetch_add(&(var), val, __ATOMIC_RELAXED)
+#else
+#define PROF_ADD(var, val) ((var) += (val))
+#endif
+
+/* publishing and reading the head of a hash chain */
+#if defined(HAVE_ATOMIC_BUILTIN)
+#define PROF_LOAD(var) __atomic_load_n(&(var), __ATOMIC_ACQUIRE)
+#define PROF_STORE(var, val) __atomic_store_n(&(var), val, __ATOMIC_RELEASE)
+#else
+#define PROF_LOAD(var) (*(PROF_NODE * volatile *) &(var))
+#define PROF_STORE(var, val) (*(PROF_NODE * volatile *) &(var) = (val))
+#endif
+
+typedef struct prof_node {
+    struct prof_node  *next;
+    const void        *key;           /* OPTXT of the opcode */
+    uint64_t          calls, ticks;
+    csprofile_entry_t info;
+} PROF_NODE;
+
+typedef struct {
+    PROF_NODE   *buckets[PROF_BUCKETS];
+    spin_lock_t lock;
+    double      tick;                 /* seconds per clock tick */
+    int         nthreads;
+    uint64_t    *thread_ticks;
+    uint64_t    next_report;          /* k-cycle of the next report */
+    uint64_t    period;               /* in k-cycles, 0 for none */
+} PROFILER;
+
+static inline uint64_t prof_clock(void)
+{
+#if defined(WIN32)
+    LARGE_INTEGER t;
+    QueryPerformanceCounter(&t);
+    return (uint64_t) t.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * UINT64_C(1000000000) + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+static void prof_describe(OPDS *op, csprofile_entry_t *e)
+{
+    INSDS *ip = op->insdshead;
+    OPCOD_IOBUFS *buf = (OPCOD_IOBUFS*) ip->opcod_iobufs;
+
+    strNcpy(e->opname, op->optext->t.opcod ? op->optext->t.opcod : "?",
+            sizeof(e->opname));
+    e->line = op->optext->t.linenum;
+    e->insno = ip->insno;
+    e->udo = (buf != NULL && buf->opcode_info != NULL);
+    if (e->udo)
+      strNcpy(e->instr, buf->opcode_info->name, sizeof(e->instr));
+    else if (ip->instr != NULL && ip->instr->insname != NULL)
+      strNcpy(e->instr, ip->instr->insname, sizeof(e->instr));
+    else
+      snprintf(e->instr, sizeof(e->instr), "%d", ip->insno);
+}
+
+static PROF_NODE *prof_node(CSOUND *csound, PROFILER *prof, OPDS *op)
+{
+    const void *key = (const void*) op->optext;
+    uint32_t   h = (uint32_t) (((uintptr_t) key >> 4) * 2654435761U) &
+                   (PROF_BUCKETS - 1);
+    PROF_NODE  *node;
+
+    for (node = PROF_LOAD(prof->buckets[h]); node != NULL; node = node->next)
+      if (node->key == key)
+        return node;
+    csoundSpinLock(&prof->lock);
+    for (node = prof->buckets[h]; node != NULL; node = node->next)
+      if (node->key == key)
+        break;
+    if (node == NULL) {
+      node = (PROF_NODE*) csound->Calloc(csound, sizeof(PROF_NODE));
+      node->key = key;
+      prof_describe(op, &node->info);
+      node->next = prof->buckets[h];
+      PROF_STORE(prof->buckets[h], node);
+    }
+    csoundSpinUnLock(&prof->lock);
+    return node;
+}
+
+static inline void prof_add(CSOUND *csound, PROFILER *prof,
+                            OPDS *op, uint64_t ticks)
+{
+    PROF_NODE *node = prof_node(csound, prof, op);
+    PROF_ADD(node->calls, 1);
+    PROF_ADD(node->ticks, ticks);
+}
+
+/* timed version of perf_chain(), for instruments and for the instances
+   of UDOs and subinstr, which pass thread -1 */
+int csoundProfileInstance(CSOUND *csound, void *profiler,
+                          INSDS *ip, int thread)
+{
+    PROFILER *prof = (PROFILER*) profiler;
+    OPDS     *opstart = (OPDS*) ip, *op;
+    uint64_t start = prof_clock(), t0, t1 = start;
+    int      error = 0;
+
+    while (error == 0 &&
+           (opstart = opstart->nxtp) != NULL &&
+           ip->actflg) {
+      op = opstart;
+      ip->pds = op;
+      t0 = prof_clock();
+      error = (*op->opadr)(csound, op);
+      t1 = prof_clock();
+      prof_add(csound, prof, op, t1 - t0);
+      opstart = ip->pds;
+    }
+    if (thread >= 0 && thread < prof->nthreads)
+      prof->thread_ticks[thread] += t1 - start;
+    return error;
+}
+
+/* called once per k-cycle, prints the periodic report */
+void csoundProfilerTick(CSOUND *csound, void *profiler)
+{
+    PROFILER *prof = (PROFILER*) profiler;
+    if (prof->period == 0 || csound->kcounter < prof->next_report)
+      return;
+    prof->next_report = csound->kcounter + prof->period;
+    csoundProfilerReport(csound, 10);
+}
+
+PUBLIC void csoundProfilerInit(CSOUND *csound)
+{
+    PROFILER *prof;
+    int      *period;
+
+    if (csound->profiler != NULL) return;
+    prof = (PROFILER*) csound->Calloc(csound, sizeof(PROFILER));
+#if defined(WIN32)
+    {
+      LARGE_INTEGER f;
+      QueryPerformanceFrequency(&f);
+      prof->tick = 1.0 / (double) f.QuadPart;
+    }
+#else
+    prof->tick = 1.0e-9;
+#endif
+    prof->nthreads = csound->oparms->numThreads > 1 ?
+                     csound->oparms->numThreads : 1;
+    prof->thread_ticks =
+      (uint64_t*) csound->Calloc(csound, prof->nthreads * sizeof(uint64_t));
+    csoundSpinLockInit(&prof->lock);
+    period = (int*) csound->QueryGlobalVariable(csound, "_PROFILE_PERIOD");
+    if (period != NULL && *period > 0 && csound->ekr > FL(0.0)) {
+      prof->period = (uint64_t) (*period * csound->ekr + FL(0.5));
+      prof->next_report = csound->kcounter + prof->period;
+    }
+    csound->profiler = prof;
+}
+
+/* frees a profiler detached by csoundProfilerClean() */
+static int prof_free(CSOUND *csound, void *p)
+{
+    PROFILER *prof = (PROFILER*) p;
+    int      i;
+
+    for (i = 0; i < PROF_BUCKETS; i++) {
+      PROF_NODE *node = prof->buckets[i], *nxt;
+      while (node != NULL) {
+        nxt = node->next;
+        csound->Free(csound, node);
+        node = nxt;
+      }
+    }
+    csound->Free(csound, prof->thread_ticks);
+    csound->Free(csound, prof);
+    return OK;
+}
+
+PUBLIC void csoundProfilerClean(CSOUND *csound)
+{
+    PROFILER *prof = (PROFILER*) csound->profiler;
+
+    if (prof == NULL) return;
+    csound->profiler = NULL;
+    csound->RegisterResetCallback(csound, prof, prof_free);
+}
+
+PUBLIC void csoundProfilerReset(CSOUND *csound)
+{
+    PROFILER  *prof = (PROFILER*) csound->profiler;
+    PROF_NODE *node;
+    int       i;
+
+    if (prof == NULL) return;
+    for (i = 0; i < PROF_BUCKETS; i++)
+      for (node = PROF_LOAD(prof->buckets[i]); node != NULL; node = node->next)
+        node->calls = node->ticks = 0;
+    for (i = 0; i < prof->nthreads; i++)
+      prof->thread_ticks[i] = 0;
+}
+
+static int prof_cmp(const void *a, const void *b)
+{
+    double x = ((const csprofile_entry_t*) a)->seconds;
+    double y = ((const csprofile_entry_t*) b)->seconds;
+    return x < y ? 1 : (x > y ? -1 : 0);
+}
+
+PUBLIC int csoundProfilerGetEntries(CSOUND *csound,
+                                    csprofile_entry_t **entries)
+{
+    PROFILER  *prof = (PROFILER*) csound->profiler;
+    PROF_NODE *node;
+    int       i, n = 0;
+
+    *entries = NULL;
+    if (prof == NULL) return 0;
+    for (i = 0; i < PROF_BUCKETS; i++)
+      for (node = PROF_LOAD(prof->buckets[i]); node != NULL; node = node->next)
+        n++;
+    if (n == 0) return 0;
+    *entries = (csprofile_entry_t*)
+      csound->Malloc(csound, n * sizeof(csprofile_entry_t));
+    n = 0;
+    for (i = 0; i < PROF_BUCKETS; i++)
+      for (node = PROF_LOAD(prof->buckets[i]); node != NULL;
+           node = node->next) {
+        csprofile_entry_t *e = &(*entries)[n++];
+        *e = node->info;
+        e->calls = node->calls;
+        e->seconds = (double) node->ticks * prof->tick;
+      }
+    qsort(*entries, n, sizeof(csprofile_entry_t), prof_cmp);
+    return n;
+}
+
+PUBLIC void csoundProfilerFreeEntries(CSOUND *csound,
+                                      csprofile_entry_t *entries)
+{
+    if (entries != NULL)
+      csound->Free(csound, entries);
+}
+
+PUBLIC int csoundProfilerGetThreadTimes(CSOUND *csound,
+                                        double *seconds, int max)
+{
+    PROFILER *prof = (PROFILER*) csound->profiler;
+    int      i;
+
+    if (prof == NULL) return 0;
+    for (i = 0; i < prof->nthreads && i < max; i++)
+      seconds[i] = (double) prof->thread_ticks[i] * prof->tick;
+    return prof->nthreads;
+}
+
+PUBLIC void csoundProfilerReport(CSOUND *csound, int maxlines)
+{
+    PROFILER          *prof = (PROFILER*) csound->profiler;
+    csprofile_entry_t *e, *instr;
+    double            total = 0.0;
+    int               i, j, n, ninstr = 0;
+
+    if (prof == NULL) return;
+    n = csoundProfilerGetEntries(csound, &e);
+    for (i = 0; i < n; i++)
+      if (!e[i].udo) total += e[i].seconds;
+    csound->Message(csound,
+                    Str("profile at %.3f s: %.3f s in instruments\n"),
+                    (double) csound->kcounter / csound->ekr, total);
+    if (n == 0) return;
+    csound->Message(csound, Str("  %-16s %-16s %6s %10s %10s %6s\n"),
+                    Str("opcode"), Str("instr"), Str("line"),
+                    Str("calls"), Str("seconds"), "%");
+    for (i = 0; i < n && (maxlines <= 0 || i < maxlines); i++)
+      csound->Message(csound, "  %-16s %-16s %6d %10llu %10.4f %6.2f\n",
+                      e[i].opname, e[i].instr, e[i].line,
+                      (unsigned long long) e[i].calls, e[i].seconds,
+                      total > 0.0 ? 100.0 * e[i].seconds / total : 0.0);
+    /* sum the top-level opcodes of each instrument */
+    instr = (csprofile_entry_t*)
+      csound->Calloc(csound, n * sizeof(csprofile_entry_t));
+    for (i = 0; i < n; i++) {
+      if (e[i].udo) continue;
+      for (j = 0; j < ninstr; j++)
+        if (strcmp(instr[j].instr, e[i].instr) == 0) break;
+      if (j == ninstr) {
+        instr[ninstr++] = e[i];
+        continue;
+      }
+      instr[j].seconds += e[i].seconds;
+    }
+    qsort(instr, ninstr, sizeof(csprofile_entry_t), prof_cmp);
+    csound->Message(csound, Str("  %-16s %10s %6s\n"),
+                    Str("instr"), Str("seconds"), "%");
+    for (i = 0; i < ninstr; i++)
+      csound->Message(csound, "  %-16s %10.4f %6.2f\n",
+                      instr[i].instr, instr[i].seconds,
+                      total > 0.0 ? 100.0 * instr[i].seconds / total : 0.0);
+    if (prof->nthreads > 1)
+      for (i = 0; i < prof->nthreads; i++)
+        csound->Message(csound, Str("  thread %d: %.4f s\n"), i,
+                        (double) prof->thread_ticks[i] * prof->tick);
+    csound->Free(csound, instr);
+    csoundProfilerFreeEntries(csound, e);
+}
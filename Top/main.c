@@ -31,6 +31,8 @@
 
 #include "cs_par_base.h"
 #include "cs_par_orc_semantics.h"
+#include "csprofile.h"
+#include "cluster.h"
 //#include "cs_par_dispatch.h"
 
 extern void allocate_message_queue(CSOUND *csound);
@@ -549,6 +551,18 @@ PUBLIC int csoundStart(CSOUND *csound) // DEBUG
 
       csound->WaitBarrier(csound->barrier2);
     }
+    { /* profiler requested with -+profile */
+      int *prof = (int*) csoundQueryGlobalVariable(csound, "_PROFILE");
+      if (prof != NULL && *prof)
+        csoundProfilerInit(csound);
+    }
+    { /* a-rate math kernels requested with -+fast_math */
+      int *fm = (int*) csoundQueryGlobalVariable(csound, "_FAST_MATH");
+      csound->fastMath = (fm != NULL && *fm);
+    }
+    /* distributed rendering requested with -+cluster_nodes */
+    if (UNLIKELY(csoundClusterStart(csound) != CSOUND_SUCCESS))
+      return CSOUND_ERROR;
     csound->engineStatus |= CS_STATE_COMP;
     if (csound->oparms->daemon > 1)
       csoundUDPServerStart(csound,csound->oparms->daemon);
@@ -35,8 +35,33 @@ typedef unsigned int u_int32_t;
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <sys/select.h>
 #endif
 
+#if defined(LINUX) && defined(_GNU_SOURCE) && defined(MSG_WAITFORONE)
+#define UDP_HAVE_RECVMMSG
+#define UDP_BATCH   (16)        /* datagrams per recvmmsg() */
+#else
+#define UDP_BATCH   (1)
+#endif
+#define UDP_DGRAM   (65536)     /* max. datagram size */
+#define UDP_QSIZE   (8192)      /* queued channel updates, a power of 2 */
+#define UDP_MAXHELD (256)
+
+/* channel bound to a binary protocol handle */
+typedef struct {
+  MYFLT   *ptr;
+  int     audio;
+} UDPCHAN;
+
+/* channel update queued to the performance thread */
+typedef struct {
+  MYFLT   *ptr;
+  int     audio;
+  int     offset;
+  MYFLT   value;
+} UDPUPDATE;
+
 typedef struct {
   int port;
   int     sock;
@@ -45,6 +70,16 @@ typedef struct {
   void  *cb;
   struct sockaddr_in server_addr;
   unsigned char status;
+  char    *orc, *orcp;          /* text message buffer, and end of a */
+  int     cont;                 /* ... {{ }} orchestra in progress */
+  UDPCHAN *chans;               /* binary protocol handles */
+  int     nchans;
+  UDPUPDATE *queue;             /* server thread -> performance thread */
+  volatile int qrd, qwr;
+  int     dropped;
+  UDPUPDATE held[UDP_MAXHELD];  /* audio steps to complete next period */
+  int     nheld;
+  int     applying;             /* udp_apply is registered */
 } UDPCOM;
 
 #define MAXSTR 1048576 /* 1MB */
@@ -100,122 +135,319 @@ static void udp_socksend(CSOUND *csound, int *sock, const char *addr,
 }
 
 
+/* BINARY PROTOCOL
+ *
+ * A datagram starting with the byte UDP_BIN holds binary messages for
+ * high rate control, with integers and values in network byte order:
+ *
+ *   UDP_BIN 'R' handle:u16 type:u8 name:string (NUL terminated)
+ *     binds handle to the control ('k') or audio ('a') input channel
+ *     name, creating the channel if needed;
+ *   UDP_BIN 'S' count:u16 then count times handle:u16 offset:u16 value:f64
+ *     sets channels by handle.  offset is the sample offset in the next
+ *     control period for audio channels, and is ignored for control ones.
+ *
+ * Several messages may follow each other in a datagram.  Names are only
+ * resolved on 'R', and updates are queued to the performance thread,
+ * which applies them all at the start of the next control period.
+ */
+
+#define UDP_BIN      (0x01)
+#define UDP_SETSIZE  (12)       /* bytes per 'S' record */
+
+static uint32_t udp_get16(const unsigned char *b)
+{
+  return ((uint32_t) b[0] << 8) | (uint32_t) b[1];
+}
+
+static double udp_getf64(const unsigned char *b)
+{
+  union { uint64_t i; double d; } u;
+  int k;
+  u.i = 0;
+  for (k = 0; k < 8; k++)
+    u.i = (u.i << 8) | (uint64_t) b[k];
+  return u.d;
+}
+
+static void udp_bind_handle(UDPCOM *p, uint32_t h, int type, const char *name)
+{
+  CSOUND *csound = p->cs;
+  MYFLT  *ptr;
+  int    ctype = (type == 'a' ? CSOUND_AUDIO_CHANNEL : CSOUND_CONTROL_CHANNEL);
+
+  if (h >= (uint32_t) p->nchans) {
+    uint32_t n = (h + 64) & ~63U;
+    p->chans = (UDPCHAN*) csound->ReAlloc(csound, p->chans,
+                                          n * sizeof(UDPCHAN));
+    memset(p->chans + p->nchans, 0, (n - p->nchans) * sizeof(UDPCHAN));
+    p->nchans = (int) n;
+  }
+  if (UNLIKELY(csoundGetChannelPtr(csound, &ptr, name,
+                                   ctype | CSOUND_INPUT_CHANNEL)
+               != CSOUND_SUCCESS)) {
+    csound->Warning(csound, Str("UDP Server: cannot bind channel %s"), name);
+    ptr = NULL;
+  }
+  p->chans[h].ptr = ptr;
+  p->chans[h].audio = (ctype == CSOUND_AUDIO_CHANNEL);
+}
+
+static void udp_queue_update(UDPCOM *p, UDPCHAN *c, int offset, MYFLT val)
+{
+  int wr = p->qwr, nxt = (wr + 1) & (UDP_QSIZE - 1);
+  if (UNLIKELY(nxt == ATOMIC_GET(p->qrd))) {
+    p->dropped++;
+    return;
+  }
+  p->queue[wr].ptr = c->ptr;
+  p->queue[wr].audio = c->audio;
+  p->queue[wr].offset = offset;
+  p->queue[wr].value = val;
+  ATOMIC_SET(p->qwr, nxt);
+}
+
+static void udp_binary(UDPCOM *p, const unsigned char *buf, int len)
+{
+  CSOUND *csound = p->cs;
+  int    pos = 0;
+
+  while (len - pos >= 4 && buf[pos] == UDP_BIN) {
+    const unsigned char *m = buf + pos;
+    if (m[1] == 'R' && len - pos >= 6) {
+      const char *name = (const char*) m + 5;
+      size_t     n = strnlen(name, len - pos - 5);
+      if (UNLIKELY(n == (size_t) (len - pos - 5))) break;   /* no NUL */
+      udp_bind_handle(p, udp_get16(m + 2), m[4], name);
+      pos += 5 + (int) n + 1;
+    }
+    else if (m[1] == 'S') {
+      uint32_t cnt = udp_get16(m + 2), i;
+      if (UNLIKELY(len - pos - 4 < (int) (cnt * UDP_SETSIZE))) break;
+      for (i = 0, m += 4; i < cnt; i++, m += UDP_SETSIZE) {
+        uint32_t h = udp_get16(m);
+        if (LIKELY(h < (uint32_t) p->nchans && p->chans[h].ptr != NULL))
+          udp_queue_update(p, &p->chans[h], (int) udp_get16(m + 2),
+                           (MYFLT) udp_getf64(m + 4));
+      }
+      pos += 4 + (int) (cnt * UDP_SETSIZE);
+    }
+    else break;
+  }
+  if (UNLIKELY(pos < len))
+    csound->Warning(csound, Str("UDP Server: malformed binary message"));
+}
+
+/* sense event callback: applies the queued updates in the performance
+   thread at the start of each control period */
+static void udp_apply(CSOUND *csound, void *userData)
+{
+  UDPCOM *p = (UDPCOM *) csound->QueryGlobalVariable(csound, "::UDPCOM");
+  int    rd, wr, i, ksmps = csound->ksmps;
+  IGN(userData);
+
+  if (p == NULL || p->queue == NULL) return;
+  /* audio steps set part way through the last period hold from now on */
+  for (i = 0; i < p->nheld; i++) {
+    MYFLT *a = p->held[i].ptr;
+    int   n;
+    for (n = 0; n < ksmps; n++) a[n] = p->held[i].value;
+  }
+  p->nheld = 0;
+  rd = p->qrd;
+  wr = ATOMIC_GET(p->qwr);
+  for ( ; rd != wr; rd = (rd + 1) & (UDP_QSIZE - 1)) {
+    UDPUPDATE *u = &p->queue[rd];
+    if (!u->audio) {
+      *u->ptr = u->value;
+      continue;
+    }
+    if (u->offset >= ksmps) u->offset = ksmps - 1;
+    for (i = u->offset; i < ksmps; i++) u->ptr[i] = u->value;
+    if (u->offset > 0 && p->nheld < UDP_MAXHELD)
+      p->held[p->nheld++] = *u;
+  }
+  ATOMIC_SET(p->qrd, rd);
+  if (UNLIKELY(p->dropped)) {
+    csound->Warning(csound, Str("UDP Server: %d channel updates dropped"),
+                    p->dropped);
+    p->dropped = 0;
+  }
+}
+
+/* TEXT PROTOCOL */
+
+/* handles a text message; returns 1 on a close request */
+static int udp_text(UDPCOM *p, char *msg, int received, int *sock)
+{
+  CSOUND *csound = p->cs;
+  char *orchestra = p->orcp;
+  size_t room = MAXSTR - (size_t) (orchestra - p->orc) - 1;
+
+  if ((size_t) received > room) received = (int) room;
+  memcpy(orchestra, msg, received);
+  orchestra[received] = '\0'; // terminate string
+  if(strlen(orchestra) < 2) return 0;
+  if (csound->oparms->echo)
+    csound->Message(csound, "%s", orchestra);
+  if (strncmp("!!close!!",orchestra,9)==0 ||
+      strncmp("##close##",orchestra,9)==0) {
+    csoundInputMessageAsync(csound, "e 0 0");
+    return 1;
+  }
+  if(*orchestra == '&') {
+    csoundInputMessageAsync(csound, orchestra+1);
+  }
+  else if(*orchestra == '$') {
+    csoundReadScoreAsync(csound, orchestra+1);
+  }
+  else if(*orchestra == '@') {
+    char chn[128];
+    MYFLT val;
+    sscanf(orchestra+1, "%s", chn);
+    val = atof(orchestra+1+strlen(chn));
+    csoundSetControlChannel(csound, chn, val);
+  }
+  else if(*orchestra == '%') {
+    char chn[128];
+    char *str;
+    sscanf(orchestra+1, "%s", chn);
+    str = cs_strdup(csound, orchestra+1+strlen(chn));
+    csoundSetStringChannel(csound, chn, str);
+    csound->Free(csound, str);
+  }
+  else if(*orchestra == ':') {
+    char addr[128], chn[128], *msg;
+    int sport, err = 0;
+    MYFLT val;
+    sscanf(orchestra+2, "%s", chn);
+    sscanf(orchestra+2+strlen(chn), "%s", addr);
+    sport = atoi(orchestra+3+strlen(addr)+strlen(chn));
+    if(*(orchestra+1) == '@') {
+      val = csoundGetControlChannel(csound, chn, &err);
+      msg = (char *) csound->Calloc(csound, strlen(chn) + 32);
+      sprintf(msg, "%s::%f", chn, val);
+    }
+    else if (*(orchestra+1) == '%') {
+      MYFLT  *pstring;
+      if (csoundGetChannelPtr(csound, &pstring, chn,
+                              CSOUND_STRING_CHANNEL | CSOUND_OUTPUT_CHANNEL)
+          == CSOUND_SUCCESS) {
+        STRINGDAT* stringdat = (STRINGDAT*) pstring;
+        int size = stringdat->size;
+        spin_lock_t *lock =
+          (spin_lock_t *) csoundGetChannelLock(csound, (char*) chn);
+        msg = (char *) csound->Calloc(csound, strlen(chn) + size);
+        if (lock != NULL)
+          csoundSpinLock(lock);
+        sprintf(msg, "%s::%s", chn, stringdat->data);
+        if (lock != NULL)
+          csoundSpinUnLock(lock);
+      } else err = -1;
+    }
+    else err = -1;
+    if(!err) {
+      udp_socksend(csound, sock, addr, sport,msg);
+      csound->Free(csound, msg);
+    }
+    else
+      csound->Warning(csound, Str("could not retrieve channel %s"), chn);
+  }
+  else if(*orchestra == '{' || p->cont) {
+    char *cp;
+    if((cp = strrchr(orchestra, '}')) != NULL) {
+      if(*(cp-1) != '}') {
+        *cp = '\0';
+        p->cont = 0;
+      }  else {
+        p->orcp += received;
+        p->cont = 1;
+      }
+    }
+    else {
+      p->orcp += received;
+      p->cont = 1;
+    }
+    if(!p->cont) {
+      p->orcp = p->orc;
+      //csound->Message(csound, "%s\n", orchestra+1);
+      csoundCompileOrcAsync(csound, p->orc+1);
+    }
+  }
+  else {
+    //csound->Message(csound, "%s\n", orchestra);
+    csoundCompileOrcAsync(csound, orchestra);
+  }
+  return 0;
+}
+
+/* waits up to 100 ms for the socket to become readable */
+static void udp_wait(UDPCOM *p)
+{
+  fd_set rset;
+  struct timeval tv;
+  FD_ZERO(&rset);
+  FD_SET(p->sock, &rset);
+  tv.tv_sec = 0;
+  tv.tv_usec = 100000;
+  select(p->sock + 1, &rset, NULL, NULL, &tv);
+}
+
 static uintptr_t udp_recv(void *pdata){
-  struct sockaddr from;
-  socklen_t clilen = sizeof(from);
   UDPCOM *p = (UDPCOM *) pdata;
   CSOUND *csound = p->cs;
   int port = p->port;
-  char *orchestra = csound->Calloc(csound, MAXSTR);
-  int sock = 0;
-  int received, cont = 0;
-  char *start = orchestra;
-  size_t timout = (size_t) lround(1000/csound->GetKr(csound));
+  char *bufs = csound->Malloc(csound, (size_t) UDP_BATCH * UDP_DGRAM);
+  int sock = 0, closing = 0;
+#ifdef UDP_HAVE_RECVMMSG
+  struct mmsghdr msgs[UDP_BATCH];
+  struct iovec iovs[UDP_BATCH];
+  int i;
+
+  memset(msgs, 0, sizeof(msgs));
+  for (i = 0; i < UDP_BATCH; i++) {
+    iovs[i].iov_base = bufs + (size_t) i * UDP_DGRAM;
+    iovs[i].iov_len = UDP_DGRAM;
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+#endif
 
+  p->orc = p->orcp = csound->Calloc(csound, MAXSTR);
+  p->cont = 0;
   csound->Message(csound, Str("UDP server started on port %d\n"),port);
-  while (p->status) {
+  while (p->status && !closing) {
+#ifdef UDP_HAVE_RECVMMSG
+    int n = recvmmsg(p->sock, msgs, UDP_BATCH, 0, NULL), k;
+    if (n <= 0) {
+      udp_wait(p);
+      continue;
+    }
+    for (k = 0; k < n && !closing; k++) {
+      char *buf = (char *) iovs[k].iov_base;
+      int received = (int) msgs[k].msg_len;
+#else
+    struct sockaddr from;
+    socklen_t clilen = sizeof(from);
+    char *buf = bufs;
+    int received;
     if ((received =
-         recvfrom(p->sock, (void *)orchestra, MAXSTR, 0, &from, &clilen)) <= 0) {
-      csoundSleep(timout ? timout : 1);
+         recvfrom(p->sock, (void *)buf, UDP_DGRAM, 0, &from, &clilen)) <= 0) {
+      udp_wait(p);
       continue;
     }
-    else {
-      orchestra[received] = '\0'; // terminate string
-      if(strlen(orchestra) < 2) continue;
-      if (csound->oparms->echo)
-        csound->Message(csound, "%s", orchestra);
-      if (strncmp("!!close!!",orchestra,9)==0 ||
-          strncmp("##close##",orchestra,9)==0) {
-        csoundInputMessageAsync(csound, "e 0 0");
-        break;
-      }
-      if(*orchestra == '&') {
-        csoundInputMessageAsync(csound, orchestra+1);
-      }
-      else if(*orchestra == '$') {
-        csoundReadScoreAsync(csound, orchestra+1);
-      }
-      else if(*orchestra == '@') {
-        char chn[128];
-        MYFLT val;
-        sscanf(orchestra+1, "%s", chn);
-        val = atof(orchestra+1+strlen(chn));
-        csoundSetControlChannel(csound, chn, val);
-      }
-      else if(*orchestra == '%') {
-        char chn[128];
-        char *str;
-        sscanf(orchestra+1, "%s", chn);
-        str = cs_strdup(csound, orchestra+1+strlen(chn));
-        csoundSetStringChannel(csound, chn, str);
-        csound->Free(csound, str);
-      }
-      else if(*orchestra == ':') {
-        char addr[128], chn[128], *msg;
-        int sport, err = 0;
-        MYFLT val;
-        sscanf(orchestra+2, "%s", chn);
-        sscanf(orchestra+2+strlen(chn), "%s", addr);
-        sport = atoi(orchestra+3+strlen(addr)+strlen(chn));
-        if(*(orchestra+1) == '@') {
-          val = csoundGetControlChannel(csound, chn, &err);
-          msg = (char *) csound->Calloc(csound, strlen(chn) + 32);
-          sprintf(msg, "%s::%f", chn, val);
-        }
-        else if (*(orchestra+1) == '%') {
-          MYFLT  *pstring;
-          if (csoundGetChannelPtr(csound, &pstring, chn,
-                                  CSOUND_STRING_CHANNEL | CSOUND_OUTPUT_CHANNEL)
-              == CSOUND_SUCCESS) {
-            STRINGDAT* stringdat = (STRINGDAT*) pstring;
-            int size = stringdat->size;
-            spin_lock_t *lock =
-              (spin_lock_t *) csoundGetChannelLock(csound, (char*) chn);
-            msg = (char *) csound->Calloc(csound, strlen(chn) + size);
-            if (lock != NULL)
-              csoundSpinLock(lock);
-            sprintf(msg, "%s::%s", chn, stringdat->data);
-            if (lock != NULL)
-              csoundSpinUnLock(lock);
-          } else err = -1;
-        }
-        else err = -1;
-        if(!err) {
-          udp_socksend(csound, &sock, addr, sport,msg);
-          csound->Free(csound, msg);
-        }
-        else
-          csound->Warning(csound, Str("could not retrieve channel %s"), chn);
-      }
-      else if(*orchestra == '{' || cont) {
-        char *cp;
-        if((cp = strrchr(orchestra, '}')) != NULL) {
-          if(*(cp-1) != '}') {
-            *cp = '\0';
-            cont = 0;
-          }  else {
-            orchestra += received;
-            cont = 1;
-          }
-        }
-        else {
-          orchestra += received;
-          cont = 1;
-        }
-        if(!cont) {
-          orchestra = start;
-          //csound->Message(csound, "%s\n", orchestra+1);
-          csoundCompileOrcAsync(csound, orchestra+1);
-        }
-      }
-      else {
-        //csound->Message(csound, "%s\n", orchestra);
-        csoundCompileOrcAsync(csound, orchestra);
-      }
+    {
+#endif
+      if (received > 0 && (unsigned char) *buf == UDP_BIN)
+        udp_binary(p, (unsigned char *) buf, received);
+      else
+        closing = udp_text(p, buf, received, &sock);
     }
   }
   csound->Message(csound, Str("UDP server on port %d stopped\n"),port);
-  csound->Free(csound, start);
+  csound->Free(csound, p->orc);
+  csound->Free(csound, bufs);
+  p->orc = p->orcp = NULL;
   // csound->Message(csound, "orchestra dealloc\n");
   if(sock > 0)
 #ifndef WIN32
@@ -277,6 +509,14 @@ static int udp_start(CSOUND *csound, UDPCOM *p)
 #endif
     return CSOUND_ERROR;
   }
+  /* queue for binary protocol updates, applied by udp_apply */
+  p->queue = (UDPUPDATE*) csound->Calloc(csound,
+                                         UDP_QSIZE * sizeof(UDPUPDATE));
+  p->qrd = p->qwr = 0;
+  if (!p->applying) {
+    csound->RegisterSenseEventCallback(csound, udp_apply, NULL);
+    p->applying = 1;
+  }
   /* set status flag */
   p->status = 1;
   /* create thread */
@@ -292,6 +532,19 @@ int csoundUDPServerClose(CSOUND *csound)
     p->status = 0;
     /* wait for server thread to close */
     csoundJoinThread(p->thrid);
+    /* take udp_apply out of the performance before freeing what it uses;
+       the API lock keeps this out of a control period in progress */
+    csoundLockMutex(csound->API_lock);
+    if (p->applying) {
+      csound->RemoveSenseEventCallback(csound, udp_apply, NULL);
+      p->applying = 0;
+    }
+    if (p->chans != NULL) csound->Free(csound, p->chans);
+    if (p->queue != NULL) {
+      UDPUPDATE *q = p->queue;
+      p->queue = NULL;
+      csound->Free(csound, q);
+    }
     /* close socket */
 #ifndef WIN32
     close(p->sock);
@@ -299,6 +552,7 @@ int csoundUDPServerClose(CSOUND *csound)
     closesocket(p->sock);
 #endif
     csound->DestroyGlobalVariable(csound,"::UDPCOM");
+    csoundUnlockMutex(csound->API_lock);
     return CSOUND_SUCCESS;
   }
   else return CSOUND_ERROR;
@@ -21,6 +21,8 @@
 
 #include "csoundCore.h"
 #include "csound_orc.h"
+#include "cluster.h"
+#include "bus.h"
 #include <stdlib.h>
 
 #ifdef USE_DOUBLE
@@ -34,7 +36,7 @@ int csoundKillInstanceInternal(CSOUND *csound, MYFLT instr, char *instrName,
 int csoundCompileTreeInternal(CSOUND *csound, TREE *root, int async);
 int csoundCompileOrcInternal(CSOUND *csound, const char *str, int async);
 void merge_state(CSOUND *csound, ENGINE_STATE *engineState,
-                 TYPE_TABLE* typetable, OPDS *ids);
+                 TYPE_TABLE* typetable, OPDS *ids, int parallel);
 void killInstance(CSOUND *csound, MYFLT instr, int insno, INSDS *ip,
                   int mode, int allow_release);
 void csoundInputMessageInternal(CSOUND *csound, const char *message);
@@ -51,7 +53,8 @@ void set_channel_data_ptr(CSOUND *csound, const char *name,
                           void *ptr, int newSize);
 
 enum {INPUT_MESSAGE=1, READ_SCORE, SCORE_EVENT, SCORE_EVENT_ABS,
-      TABLE_COPY_OUT, TABLE_COPY_IN, TABLE_SET, MERGE_STATE, KILL_INSTANCE};
+      TABLE_COPY_OUT, TABLE_COPY_IN, TABLE_SET, MERGE_STATE, KILL_INSTANCE,
+      CHANNEL_SET_AT};
 
 /* MAX QUEUE SIZE */
 #define API_MAX_QUEUE 1024
@@ -94,6 +97,71 @@ void allocate_message_queue(CSOUND *csound) {
 }
 
 
+/* line events from the API; in a cluster they go to all nodes */
+static void input_message(CSOUND *csound, const char *message) {
+  if (UNLIKELY(csound->cluster != NULL))
+    csoundClusterInputMessage(csound, message);
+  else
+    csoundInputMessageInternal(csound, message);
+}
+
+/* one record of a CHANNEL_SET_AT message */
+typedef struct {
+  CHNENTRY *chn;
+  MYFLT    value;
+  int      offset;
+} CHNSTEP;
+
+static inline MYFLT channel_load(MYFLT *pval)
+{
+#if defined(MSVC) || defined(HAVE_ATOMIC_BUILTIN)
+  union {
+    MYFLT d;
+    MYFLT_INT_TYPE i;
+  } x;
+#if defined(MSVC)
+  x.i = InterlockedExchangeAdd64((MYFLT_INT_TYPE *)pval, 0);
+#else
+  x.i = __atomic_load_n((MYFLT_INT_TYPE *)pval, __ATOMIC_SEQ_CST);
+#endif
+  return x.d;
+#else
+  return *pval;
+#endif
+}
+
+/* without atomics this takes the channel lock */
+static inline void channel_store(CHNENTRY *chn, MYFLT val)
+{
+#if defined(MSVC) || defined(HAVE_ATOMIC_BUILTIN)
+  union {
+    MYFLT d;
+    MYFLT_INT_TYPE i;
+  } x;
+  x.d = val;
+#if defined(MSVC)
+  InterlockedExchange64((MYFLT_INT_TYPE *)chn->data, x.i);
+#else
+  __atomic_store_n((MYFLT_INT_TYPE *)chn->data, x.i, __ATOMIC_SEQ_CST);
+#endif
+#else
+  csoundSpinLock(&chn->lock);
+  *chn->data = val;
+  csoundSpinUnLock(&chn->lock);
+#endif
+}
+
+/* a timed write, applied in the performance thread at the start of
+   the control period it is for */
+static void channel_step(CSOUND *csound, const CHNSTEP *st)
+{
+  CHNENTRY *chn = st->chn;
+  chn->prev = *chn->data;
+  chn->step = st->offset;
+  chn->stepk = csound->kcounter;
+  channel_store(chn, st->value);
+}
+
 /* enqueue should be called by the relevant API function */
 void *message_enqueue(CSOUND *csound, int32_t message, char *args,
                       int argsiz) {
@@ -138,7 +206,7 @@ void message_dequeue(CSOUND *csound) {
       case INPUT_MESSAGE:
         {
           const char *str = msg->args;
-          csoundInputMessageInternal(csound, str);
+          input_message(csound, str);
         }
 
         break;
@@ -222,7 +290,8 @@ void message_dequeue(CSOUND *csound) {
                  sizeof(TYPE_TABLE *));
           memcpy(&ids, msg->args + 2*ARG_ALIGN,
                  sizeof(OPDS *));
-          merge_state(csound, e, t, ids);
+          /* runs in the performance thread, so no worker threads */
+          merge_state(csound, e, t, ids, 0);
         }
         break;
       case KILL_INSTANCE:
@@ -242,6 +311,18 @@ void message_dequeue(CSOUND *csound) {
           killInstance(csound, instr, insno, ip, mode, rls);
         }
         break;
+      case CHANNEL_SET_AT:
+        {
+          int n, i;
+          CHNSTEP st;
+          memcpy(&n, msg->args, sizeof(int));
+          for (i = 0; i < n; i++) {
+            memcpy(&st, msg->args + ARG_ALIGN + i*sizeof(CHNSTEP),
+                   sizeof(CHNSTEP));
+            channel_step(csound, &st);
+          }
+        }
+        break;
       }
       msg->message = 0;
       rp += 1;
@@ -352,7 +433,7 @@ void mergeState_enqueue(CSOUND *csound, ENGINE_STATE *e, TYPE_TABLE* t, OPDS *id
 */
 void csoundInputMessage(CSOUND *csound, const char *message){
   csoundLockMutex(csound->API_lock);
-  csoundInputMessageInternal(csound, message);
+  input_message(csound, message);
   csoundUnlockMutex(csound->API_lock);
 }
 
@@ -504,139 +585,158 @@ int csoundKillInstanceAsync(CSOUND *csound, MYFLT instr, char *instrName,
 
 MYFLT csoundGetControlChannel(CSOUND *csound, const char *name, int *err)
 {
-  MYFLT *pval;
+  MYFLT *pval, val = FL(0.0);
   int err_;
-  union {
-    MYFLT d;
-    MYFLT_INT_TYPE i;
-  } x;
-  x.d = FL(0.0);
   if (UNLIKELY(strlen(name) == 0)) return FL(.0);
   if ((err_ = csoundGetChannelPtr(csound, &pval, name,
                                   CSOUND_CONTROL_CHANNEL | CSOUND_OUTPUT_CHANNEL))
       == CSOUND_SUCCESS) {
-#if defined(MSVC)
-    x.i = InterlockedExchangeAdd64((MYFLT_INT_TYPE *)pval, 0);
-#elif defined(HAVE_ATOMIC_BUILTIN)
-    x.i = __atomic_load_n((MYFLT_INT_TYPE *)pval, __ATOMIC_SEQ_CST);
-#else
-    x.d = *pval;
-#endif
+    val = channel_load(pval);
   }
   if (err) {
     *err = err_;
   }
-  return x.d;
+  return val;
 }
 
 void csoundSetControlChannel(CSOUND *csound, const char *name, MYFLT val){
-  MYFLT *pval;
-#if defined(MSVC) || defined(HAVE_ATOMIC_BUILTIN)
-  union {
-    MYFLT d;
-    MYFLT_INT_TYPE i;
-  } x;
-  x.d = val;
-#endif
-  if (csoundGetChannelPtr(csound, &pval, name,
-                          CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL)
-      == CSOUND_SUCCESS)
-
-#if defined(MSVC)
-    InterlockedExchange64((MYFLT_INT_TYPE *)pval, x.i);
-#elif defined(HAVE_ATOMIC_BUILTIN)
-    __atomic_store_n((MYFLT_INT_TYPE *)pval, x.i, __ATOMIC_SEQ_CST);
-#else
-  {
-    spin_lock_t *lock = (spin_lock_t *)
-      csoundGetChannelLock(csound, (char*) name);
-    csoundSpinLock(lock);
-    *pval  = val;
-    csoundSpinUnLock(lock);
-  }
-#endif
+  CS_CHANNEL *chn;
+  chn = csoundGetChannelHandle(csound, name,
+                               CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL);
+  if (chn != NULL)
+    channel_store(chn, val);
 }
 
 void csoundGetAudioChannel(CSOUND *csound, const char *name, MYFLT *samples)
 {
-
-  MYFLT  *psamples;
+  CS_CHANNEL *chn;
   if (strlen(name) == 0) return;
-  if (csoundGetChannelPtr(csound, &psamples, name,
-                          CSOUND_AUDIO_CHANNEL | CSOUND_OUTPUT_CHANNEL)
-      == CSOUND_SUCCESS) {
-    spin_lock_t *lock = (spin_lock_t *)csoundGetChannelLock(csound, (char*) name);
-    csoundSpinLock(lock);
-    memcpy(samples, psamples, csoundGetKsmps(csound)*sizeof(MYFLT));
-    csoundSpinUnLock(lock);
-  }
+  chn = csoundGetChannelHandle(csound, name,
+                               CSOUND_AUDIO_CHANNEL | CSOUND_OUTPUT_CHANNEL);
+  if (chn != NULL)
+    csoundGetAudioChannelH(csound, chn, samples);
 }
 
 void csoundSetAudioChannel(CSOUND *csound, const char *name, MYFLT *samples)
 {
-  MYFLT  *psamples;
-  if (csoundGetChannelPtr(csound, &psamples, name,
-                          CSOUND_AUDIO_CHANNEL | CSOUND_INPUT_CHANNEL)
-      == CSOUND_SUCCESS){
-    spin_lock_t *lock = (spin_lock_t *)csoundGetChannelLock(csound, (char*) name);
-    csoundSpinLock(lock);
-    memcpy(psamples, samples, csoundGetKsmps(csound)*sizeof(MYFLT));
-    csoundSpinUnLock(lock);
-  }
+  CS_CHANNEL *chn;
+  chn = csoundGetChannelHandle(csound, name,
+                               CSOUND_AUDIO_CHANNEL | CSOUND_INPUT_CHANNEL);
+  if (chn != NULL)
+    csoundSetAudioChannelH(csound, chn, samples);
 }
 
 void csoundSetStringChannel(CSOUND *csound, const char *name, char *string)
 {
-  MYFLT  *pstring;
+  CS_CHANNEL *chn;
+  chn = csoundGetChannelHandle(csound, name,
+                               CSOUND_STRING_CHANNEL | CSOUND_INPUT_CHANNEL);
+  if (chn != NULL)
+    csoundSetStringChannelH(csound, chn, string);
+}
 
-  if (csoundGetChannelPtr(csound, &pstring, name,
-                          CSOUND_STRING_CHANNEL | CSOUND_INPUT_CHANNEL)
-      == CSOUND_SUCCESS){
+void csoundGetStringChannel(CSOUND *csound, const char *name, char *string)
+{
+  CS_CHANNEL *chn;
+  if (strlen(name) == 0) return;
+  chn = csoundGetChannelHandle(csound, name,
+                               CSOUND_STRING_CHANNEL | CSOUND_OUTPUT_CHANNEL);
+  if (chn != NULL)
+    csoundGetStringChannelH(csound, chn, string);
+}
 
-    STRINGDAT* stringdat = (STRINGDAT*) pstring;
-    int    size = stringdat->size; //csoundGetChannelDatasize(csound, name);
-    spin_lock_t *lock = (spin_lock_t *) csoundGetChannelLock(csound, (char*) name);
+/* channel access by handle, without looking the name up */
 
-    if (lock != NULL) {
-      csoundSpinLock(lock);
-    }
+MYFLT csoundGetControlChannelH(CSOUND *csound, CS_CHANNEL *chn)
+{
+  IGN(csound);
+  return channel_load(chn->data);
+}
 
-    if (strlen(string) + 1 > (unsigned int) size) {
-      if (stringdat->data!=NULL) csound->Free(csound,stringdat->data);
-      stringdat->data = cs_strdup(csound, string);
-      stringdat->size = strlen(string) + 1;
-      //set_channel_data_ptr(csound,name,(void*)pstring, strlen(string)+1);
-    } else {
-      strcpy((char *) stringdat->data, string);
-    }
+void csoundSetControlChannelH(CSOUND *csound, CS_CHANNEL *chn, MYFLT val)
+{
+  IGN(csound);
+  channel_store(chn, val);
+}
 
-    if (lock != NULL) {
-      csoundSpinUnLock(lock);
-    }
+void csoundGetControlChannels(CSOUND *csound, CS_CHANNEL *const *chn,
+                              MYFLT *vals, int n)
+{
+  int i;
+  IGN(csound);
+  for (i = 0; i < n; i++)
+    vals[i] = channel_load(chn[i]->data);
+}
+
+void csoundSetControlChannels(CSOUND *csound, CS_CHANNEL *const *chn,
+                              const MYFLT *vals, int n)
+{
+  int i;
+  IGN(csound);
+  for (i = 0; i < n; i++)
+    channel_store(chn[i], vals[i]);
+}
+
+void csoundSetControlChannelsAt(CSOUND *csound, CS_CHANNEL *const *chn,
+                                const MYFLT *vals, const int *offsets, int n)
+{
+  int     i, argsize;
+  char    *args;
+  CHNSTEP st;
+  if (n <= 0) return;
+  argsize = ARG_ALIGN + n * (int) sizeof(CHNSTEP);
+  args = (char *) csound->Malloc(csound, argsize);
+  memcpy(args, &n, sizeof(int));
+  for (i = 0; i < n; i++) {
+    st.chn = chn[i];
+    st.value = vals[i];
+    st.offset = offsets != NULL ? offsets[i] : 0;
+    if (st.offset < 0 || st.offset >= csound->ksmps) st.offset = 0;
+    memcpy(args + ARG_ALIGN + i * sizeof(CHNSTEP), &st, sizeof(CHNSTEP));
   }
+  message_enqueue(csound, CHANNEL_SET_AT, args, argsize);
+  csound->Free(csound, args);
 }
 
-void csoundGetStringChannel(CSOUND *csound, const char *name, char *string)
+void csoundGetAudioChannelH(CSOUND *csound, CS_CHANNEL *chn, MYFLT *samples)
 {
-  MYFLT  *pstring;
-  char *chstring;
-  int n2;
-  if (strlen(name) == 0) return;
-  if (csoundGetChannelPtr(csound, &pstring, name,
-                          CSOUND_STRING_CHANNEL | CSOUND_OUTPUT_CHANNEL)
-      == CSOUND_SUCCESS){
-    spin_lock_t *lock = (spin_lock_t *) csoundGetChannelLock(csound, (char*) name);
-    chstring = ((STRINGDAT *) pstring)->data;
-    if (lock != NULL)
-      csoundSpinLock(lock);
-    if (string != NULL && chstring != NULL) {
-      n2 = strlen(chstring);
-      strNcpy(string,chstring, n2+1);
-      //string[n2] = '\0';
-    }
-    if (lock != NULL)
-      csoundSpinUnLock(lock);
+  csoundSpinLock(&chn->lock);
+  memcpy(samples, chn->data, csoundGetKsmps(csound)*sizeof(MYFLT));
+  csoundSpinUnLock(&chn->lock);
+}
+
+void csoundSetAudioChannelH(CSOUND *csound, CS_CHANNEL *chn,
+                            const MYFLT *samples)
+{
+  csoundSpinLock(&chn->lock);
+  memcpy(chn->data, samples, csoundGetKsmps(csound)*sizeof(MYFLT));
+  csoundSpinUnLock(&chn->lock);
+}
+
+void csoundSetStringChannelH(CSOUND *csound, CS_CHANNEL *chn,
+                             const char *string)
+{
+  STRINGDAT *stringdat = (STRINGDAT *) chn->data;
+  csoundSpinLock(&chn->lock);
+  if (strlen(string) + 1 > (unsigned int) stringdat->size) {
+    if (stringdat->data != NULL) csound->Free(csound, stringdat->data);
+    stringdat->data = cs_strdup(csound, (char *) string);
+    stringdat->size = strlen(string) + 1;
+  } else {
+    strcpy((char *) stringdat->data, string);
   }
+  csoundSpinUnLock(&chn->lock);
+}
+
+void csoundGetStringChannelH(CSOUND *csound, CS_CHANNEL *chn, char *string)
+{
+  char *chstring;
+  IGN(csound);
+  csoundSpinLock(&chn->lock);
+  chstring = ((STRINGDAT *) chn->data)->data;
+  if (string != NULL && chstring != NULL)
+    strNcpy(string, chstring, strlen(chstring) + 1);
+  csoundSpinUnLock(&chn->lock);
 }
 
 PUBLIC int csoundSetPvsChannel(CSOUND *csound, const PVSDATEXT *fin,
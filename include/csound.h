@@ -622,7 +622,10 @@ extern "C" {
     CSOUND_CHANNEL_TYPE_MASK =    15,
 
     CSOUND_INPUT_CHANNEL =       16,
-    CSOUND_OUTPUT_CHANNEL =       32
+    CSOUND_OUTPUT_CHANNEL =       32,
+
+    /* store the channel on the shared memory bus (csound_shm.h) */
+    CSOUND_SHARED_CHANNEL =       64
   } controlChannelType;
 
   typedef enum {
@@ -937,6 +940,10 @@ extern "C" {
    * Starts the UDP server on a supplied port number
    * returns CSOUND_SUCCESS if server has been started successfully,
    * otherwise, CSOUND_ERROR.
+   * Besides text messages, the server takes binary datagrams starting
+   * with the byte 0x01, which bind numeric handles to control or audio
+   * channels and set them by handle in batches (see Top/server.c);
+   * these updates are applied at the start of the next control period.
    */
   PUBLIC int csoundUDPServerStart(CSOUND *csound, unsigned int port);
 
@@ -1400,6 +1407,21 @@ extern "C" {
                                                             unsigned char *buf,
                                                             int nBytes));
 
+  /**
+   * Sets callback for reading timestamped real time MIDI input. It is
+   * used instead of the read callback when set, and also stores in
+   * offsets[i] the sample offset within the current control period
+   * (0 to ksmps - 1) at which the message holding buf[i] was received.
+   * With --sample-accurate, notes started by these messages begin at
+   * that offset.
+   */
+  PUBLIC void csoundSetExternalMidiReadTimedCallback(CSOUND *,
+                                                     int (*func)(CSOUND *,
+                                                            void *userData,
+                                                            unsigned char *buf,
+                                                            int *offsets,
+                                                            int nBytes));
+
   /**
    * Sets callback for closing real time MIDI input.
    */
@@ -1662,6 +1684,9 @@ extern "C" {
    * OR'd with the new value. Note that audio and string channels
    * can only be created after calling csoundCompile(), because the
    * storage size is not known until then.
+   * Control and audio channels created with CSOUND_SHARED_CHANNEL
+   * also set are stored on the shared memory bus named by the
+   * -+chn_shm option (see csound_shm.h), if there is one.
 
    * Return value is zero on success, or a negative error code,
    *   CSOUND_MEMORY  there is not enough memory for allocating the channel
@@ -1793,6 +1818,70 @@ extern "C" {
    */
   PUBLIC int csoundGetChannelDatasize(CSOUND *csound, const char *name);
 
+  /**
+   * Opaque handle to a channel of the bus, which can be used instead of
+   * the channel name to access it without looking the name up.
+   */
+  typedef struct channelEntry_s CS_CHANNEL;
+
+  /**
+   * Returns a handle to the channel called 'name', creating the channel
+   * first if it does not exist yet, as csoundGetChannelPtr() does with
+   * the same 'type'. Returns NULL if the channel cannot be created or
+   * exists with an incompatible type. The handle is valid until
+   * csoundReset() or csoundDestroy().
+   */
+  PUBLIC CS_CHANNEL *csoundGetChannelHandle(CSOUND *csound,
+                                            const char *name, int type);
+
+  /**
+   * Reads and writes control channels by handle. These do not lock, the
+   * value is read and stored atomically.
+   */
+  PUBLIC MYFLT csoundGetControlChannelH(CSOUND *csound, CS_CHANNEL *chn);
+  PUBLIC void csoundSetControlChannelH(CSOUND *csound, CS_CHANNEL *chn,
+                                       MYFLT val);
+
+  /**
+   * Reads or writes the control channels chn[0] ... chn[n-1] from or to
+   * vals[0] ... vals[n-1].
+   */
+  PUBLIC void csoundGetControlChannels(CSOUND *csound, CS_CHANNEL *const *chn,
+                                       MYFLT *vals, int n);
+  PUBLIC void csoundSetControlChannels(CSOUND *csound, CS_CHANNEL *const *chn,
+                                       const MYFLT *vals, int n);
+
+  /**
+   * Sets the control channels chn[0] ... chn[n-1] to vals[0] ...
+   * vals[n-1] at the start of the next control period. If offsets is not
+   * NULL, the value of chn[i] changes offsets[i] frames into that period
+   * for chnget opcodes that read the control channel at a-rate, which
+   * see the old value before; k-rate readers see the new value in that
+   * period. The whole call is queued as one asynchronous request.
+   */
+  PUBLIC void csoundSetControlChannelsAt(CSOUND *csound,
+                                         CS_CHANNEL *const *chn,
+                                         const MYFLT *vals,
+                                         const int *offsets, int n);
+
+  /**
+   * Copies an audio channel to or from samples (ksmps MYFLTs) by handle,
+   * under the channel lock.
+   */
+  PUBLIC void csoundGetAudioChannelH(CSOUND *csound, CS_CHANNEL *chn,
+                                     MYFLT *samples);
+  PUBLIC void csoundSetAudioChannelH(CSOUND *csound, CS_CHANNEL *chn,
+                                     const MYFLT *samples);
+
+  /**
+   * Copies a string channel to or from string by handle, under the
+   * channel lock (see csoundGetStringChannel()).
+   */
+  PUBLIC void csoundGetStringChannelH(CSOUND *csound, CS_CHANNEL *chn,
+                                      char *string);
+  PUBLIC void csoundSetStringChannelH(CSOUND *csound, CS_CHANNEL *chn,
+                                      const char *string);
+
   /** Sets the function which will be called whenever the invalue opcode
    * is used. */
   PUBLIC void
@@ -1893,6 +1982,17 @@ extern "C" {
                                               void (*func)(CSOUND *, void *),
                                               void *userData);
 
+  /**
+   * Remove a function registered with csoundRegisterSenseEventCallback(),
+   * matching both func and userData. This must not run concurrently with
+   * a control period: outside realtime mode it is serialised with the
+   * performance by the API lock.
+   * Returns zero on success, or CSOUND_ERROR if it was not registered.
+   */
+  PUBLIC int csoundRemoveSenseEventCallback(CSOUND *,
+                                            void (*func)(CSOUND *, void *),
+                                            void *userData);
+
   /**
    * Set the ASCII code of the most recent key pressed.
    * This value is used by the 'sensekey' opcode if a callback
@@ -214,6 +214,10 @@ extern int ISSTRCOD(MYFLT);
 #define ASYNC_GLOBAL 1
 #define ASYNC_LOCAL  2
 
+/* formats of asynchronous CSFILE_STD writers (SetAsyncFormat) */
+#define ASYNC_FMT_TEXT    1     /* a line of %g values per frame */
+#define ASYNC_FMT_COLUMNS 2     /* binary blocks of float columns */
+
 enum {FFT_LIB=0, PFFT_LIB, VDSP_LIB};
 enum {FFT_FWD=0, FFT_INV};
 
@@ -346,6 +350,9 @@ typedef struct CORFIL {
     int     instcnt;                /* Count number of instances ever */
     int     isNew;                  /* is this a new definition */
     int     nocheckpcnt;            /* Control checks on pcnt */
+    int32   *opdsoffs;              /* Offset of each opcode's data in an
+                                       instance, perf-time opcodes first */
+    int32   perfcnt;                /* Upper bound on perf chain length */
   } INSTRTXT;
 
   typedef struct namedInstr {
@@ -580,6 +587,17 @@ typedef struct CORFIL {
     CS_VAR_MEM  p3;
   } INSDS;
 
+#ifdef __BUILDING_LIBCSOUND
+  /* The perf chain of an instance as a NULL-terminated array.  instance()
+     keeps the pointer to it in the slot just below lclbas rather than in
+     INSDS, whose layout plugins depend on and whose p-fields run on past
+     its end.  Opcodes that can jump, reinit or turn their instance off
+     (_CF in their OENTRY, and UDO calls) are entered with PCHAIN_CF set
+     in the low bit of their pointer. */
+#define INSDS_PCHAIN(ip) (((struct opds ***) (ip)->lclbas)[-1])
+#define PCHAIN_CF        ((uintptr_t) 1)
+#endif
+
 #define CS_KSMPS     (p->h.insdshead->ksmps)
 #define CS_KCNT      (p->h.insdshead->kcounter)
 #define CS_EKR       (p->h.insdshead->ekr)
@@ -712,6 +730,8 @@ typedef struct CORFIL {
     int16   chan;
     int16   dat1;
     int16   dat2;
+    int32   offset;     /* sample offset in the control period received,
+                           not sent by the remote opcodes (REMOT_MEVENT) */
   } MEVENT;
 
   typedef struct SNDMEMFILE_ {
@@ -821,6 +841,9 @@ typedef struct CORFIL {
     unsigned char mbuf[MBUFSIZ];
     unsigned char *bufp, *endatp;
     int16   datreq, datcnt;
+    int     (*MidiReadTimedCallback)(CSOUND *, void *, unsigned char *,
+                                     int *, int);
+    int     mofs[MBUFSIZ];      /* sample offsets of the bytes in mbuf */
   } MGLOBAL;
 
   typedef struct eventnode {
@@ -1395,11 +1418,18 @@ typedef struct _message_queue_t_ {
     int (*GetErrorCnt)(CSOUND *);
     FUNC* (*FTnp2Finde)(CSOUND*, MYFLT *);
     INSTRTXT *(*GetInstrument)(CSOUND*, int, const char *);
+    int (*SetAudioDriven)(CSOUND *, int);
+    int (*PerformAudioDriven)(CSOUND *, int);
+    void (*SetExternalMidiReadTimedCallback)(CSOUND *,
+                int (*func)(CSOUND *, void *, unsigned char *, int *, int));
+    int  (*SetAsyncFormat)(CSOUND *, void *, int, int);
+    int (*RemoveSenseEventCallback)(CSOUND *, void (*func)(CSOUND *, void *),
+                                    void *userData);
     /**@}*/
     /** @name Placeholders
         To allow the API to grow while maintining backward binary compatibility. */
     /**@{ */
-    SUBR dummyfn_2[29];
+    SUBR dummyfn_2[24];
     /**@}*/
 #ifdef __BUILDING_LIBCSOUND
     /* ------- private data (not to be used by hosts or externals) ------- */
@@ -1821,6 +1851,17 @@ typedef struct _message_queue_t_ {
     int io_initialised;
     char *op;
     int  mode;
+    void *profiler;             /* perf-time profiler (Top/csprofile.c) */
+    volatile int audioDriven;   /* performance run by the audio module */
+    int  audioDrivenDone;       /* its result once it has ended */
+    void *audioDrivenLock;      /* notified after each of its periods */
+    void *cluster;              /* distributed rendering (Top/cluster.c) */
+    void *chnShm;               /* shared memory channel bus (OOps/bus.c) */
+    void *chn_db_lock;          /* held while chn_db is used (OOps/bus.c) */
+    void *opcodeSigs;           /* resolved opcode signatures
+                                   (Engine/csound_orc_semantics.c) */
+    int  fastMath;              /* -+fast_math: a-rate math through the
+                                   kernels of H/fastmath.h */
     /*struct CSOUND_ **self;*/
     /**@}*/
 #endif  /* __BUILDING_LIBCSOUND */
@@ -35,15 +35,21 @@ typedef struct _cons {
 } CONS_CELL;
 
 typedef struct _cs_hash_bucket_item {
-    char* key;
+    char* key;          /* NULL for an empty slot */
     void* value;
-    struct _cs_hash_bucket_item* next;
+    uint32_t hash;      /* hash of key */
 } CS_HASH_TABLE_ITEM;
 
+/* open addressing table, table_size is a power of two.
+   ABI change: buckets used to be chained lists of items with a next
+   pointer, and are now a flat array whose entries move on insertion,
+   removal and growth.  Plugins that walked buckets must be rebuilt and
+   use cs_hash_table_next(), cs_hash_table_keys() or
+   cs_hash_table_values() instead, and must not keep item pointers. */
 typedef struct _cs_hash_table {
     int table_size;
     int count;
-    CS_HASH_TABLE_ITEM** buckets;
+    CS_HASH_TABLE_ITEM* buckets;
 } CS_HASH_TABLE;
 
 /* FUNCTIONS FOR CONS CELL */
@@ -73,6 +79,17 @@ PUBLIC void cs_cons_free_complete(CSOUND* csound, CONS_CELL* head);
 /** Create CS_HASH_TABLE */
 PUBLIC CS_HASH_TABLE* cs_hash_table_create(CSOUND* csound);
 
+/** Grows the table so that it holds count entries without resizing. */
+PUBLIC void cs_hash_table_reserve(CSOUND* csound,
+                                  CS_HASH_TABLE* hashTable, int count);
+
+/** Iterates over the entries without allocating.  Start with *pos = 0;
+    each call stores the next entry's key and value (either pointer may
+    be NULL) and returns 1, or returns 0 when there are no more.  The
+    table must not be modified during the iteration. */
+PUBLIC int cs_hash_table_next(CS_HASH_TABLE* hashTable, int* pos,
+                              char** key, void** value);
+
 /** Retreive void* value for given char* key.  Returns NULL if no
     items founds for key. */
 PUBLIC void* cs_hash_table_get(CSOUND* csound,
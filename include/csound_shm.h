@@ -0,0 +1,204 @@
+/*
+    csound_shm.h:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+#ifndef CSOUND_SHM_H
+#define CSOUND_SHM_H
+
+/**
+* \file csound_shm.h
+*
+* Layout of the shared-memory channel bus.  When Csound is run with
+* -+chn_shm=/name, control and audio channels declared with the shared
+* bit (chn_k/chn_a mode 4, or CSOUND_SHARED_CHANNEL in the type passed to
+* csoundGetChannelPtr()) are stored in the POSIX shared memory object
+* /name as well as in the private heap.  Other processes can map the
+* object and read or write the channels without going through the API.
+* This header does not depend on libcsound.
+*
+* The segment starts with a csound_shm_header, followed by nslots
+* csound_shm_slot directory entries, followed by the channel data, each
+* channel at its own cache-line aligned offset.  Samples are stored as
+* MYFLT of the writing Csound (flt_size bytes), ksmps per audio channel
+* and one per control channel.
+*
+* Directory entries are added in order.  An instance adding a channel
+* claims the first free entry by changing its type from 0 to
+* CSOUND_SHM_CLAIMED with a compare-and-swap, fills it in and then
+* stores the channel type; an instance adding the same name at the
+* same time loses the swap, waits for the type and finds the name in
+* that entry.  nchannels is raised once the entry is complete.
+*
+* Every channel has a sequence counter used as a seqlock: it is odd
+* while somebody is writing the data.  Csound works on its own copy of
+* its channels: it reads them at the start of a control period (before
+* the score events and the host callbacks) and writes back those it has
+* changed at its end (before the audio output), holding the seqlock of
+* a channel only while it copies it.  The instance that created the
+* segment then increments the block counter in the header.  So a reader
+* that waits for the block counter to change and then calls
+* csound_shm_read() gets the output of the last period, and data written
+* with csound_shm_write() is seen by the next period that starts after
+* it, unless that Csound writes the channel itself in the same period.
+*
+* \code
+    int fd = shm_open("/mix", O_RDWR, 0);
+    csound_shm_header *h = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                                MAP_SHARED, fd, 0);
+    csound_shm_slot *out = csound_shm_find(h, "bus1");
+    uint64_t last = csound_shm_block(h);
+    for (;;) {
+      while (csound_shm_block(h) == last) ;  // or sleep
+      last = csound_shm_block(h);
+      csound_shm_read(h, out, buf);
+      ...
+    }
+* \endcode
+*
+* The size of the segment is csound_shm_size() of the header, or can
+* be taken from fstat().  Two Csound instances given the same name
+* share the segment, and channels of the same name are the same memory.
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CSOUND_SHM_MAGIC    (0x4D485343)    /* "CSHM" */
+#define CSOUND_SHM_VERSION  (1)
+#define CSOUND_SHM_NAMELEN  (64)
+#define CSOUND_SHM_ALIGN    (64)
+#define CSOUND_SHM_CLAIMED  (0x80000000U)   /* type of an entry being set */
+
+typedef struct csound_shm_header_s {
+    uint32_t  magic;            /* CSOUND_SHM_MAGIC once initialised */
+    uint32_t  version;
+    uint32_t  nslots;           /* size of the channel directory */
+    volatile uint32_t nchannels;   /* directory entries in use */
+    uint32_t  ksmps;
+    uint32_t  flt_size;         /* bytes per sample, 4 or 8 */
+    double    sr;
+    volatile uint64_t block;    /* control periods completed */
+    uint32_t  pad[6];
+} csound_shm_header;
+
+typedef struct csound_shm_slot_s {
+    char      name[CSOUND_SHM_NAMELEN];
+    volatile uint32_t type;     /* channel type, 0 while free */
+    uint32_t  size;             /* bytes of data */
+    uint64_t  offset;           /* of the data from the segment start */
+    volatile uint32_t seq;      /* seqlock, odd while being written */
+    uint32_t  pad[11];
+} csound_shm_slot;
+
+static inline size_t csound_shm_stride(uint32_t ksmps, uint32_t flt_size)
+{
+    size_t n = (size_t) ksmps * flt_size;
+    return (n + CSOUND_SHM_ALIGN - 1) & ~((size_t) CSOUND_SHM_ALIGN - 1);
+}
+
+static inline size_t csound_shm_size(const csound_shm_header *h)
+{
+    return sizeof(csound_shm_header) + h->nslots * sizeof(csound_shm_slot)
+      + h->nslots * csound_shm_stride(h->ksmps, h->flt_size);
+}
+
+static inline csound_shm_slot *csound_shm_slots(csound_shm_header *h)
+{
+    return (csound_shm_slot *) (h + 1);
+}
+
+static inline void *csound_shm_data(csound_shm_header *h,
+                                    const csound_shm_slot *s)
+{
+    return (char *) h + s->offset;
+}
+
+static inline uint64_t csound_shm_block(const csound_shm_header *h)
+{
+    return __atomic_load_n(&h->block, __ATOMIC_ACQUIRE);
+}
+
+/** Returns the directory entry of channel 'name', or NULL */
+static inline csound_shm_slot *csound_shm_find(csound_shm_header *h,
+                                               const char *name)
+{
+    uint32_t i, n = __atomic_load_n(&h->nchannels, __ATOMIC_ACQUIRE);
+    csound_shm_slot *s = csound_shm_slots(h);
+    uint32_t type;
+    for (i = 0; i < n && i < h->nslots; i++) {
+      type = __atomic_load_n(&s[i].type, __ATOMIC_ACQUIRE);
+      if (type != 0 && type != CSOUND_SHM_CLAIMED &&
+          strncmp(s[i].name, name, CSOUND_SHM_NAMELEN) == 0)
+        return &s[i];
+    }
+    return NULL;
+}
+
+/** Takes the write lock of a channel, returns 0 if it is busy */
+static inline int csound_shm_trylock(csound_shm_slot *s)
+{
+    uint32_t seq = __atomic_load_n(&s->seq, __ATOMIC_RELAXED);
+    return !(seq & 1) &&
+      __atomic_compare_exchange_n(&s->seq, &seq, seq + 1, 0,
+                                  __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+static inline void csound_shm_unlock(csound_shm_slot *s)
+{
+    __atomic_add_fetch(&s->seq, 1, __ATOMIC_RELEASE);
+}
+
+/** Copies a consistent snapshot of the channel into dst, returns 0 if
+    the channel is being written */
+static inline int csound_shm_tryread(csound_shm_header *h,
+                                     const csound_shm_slot *s, void *dst)
+{
+    uint32_t seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+    if (seq & 1) return 0;
+    memcpy(dst, csound_shm_data(h, s), s->size);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&s->seq, __ATOMIC_RELAXED) == seq;
+}
+
+static inline void csound_shm_read(csound_shm_header *h,
+                                   const csound_shm_slot *s, void *dst)
+{
+    while (!csound_shm_tryread(h, s, dst)) ;
+}
+
+static inline void csound_shm_write(csound_shm_header *h,
+                                    csound_shm_slot *s, const void *src)
+{
+    while (!csound_shm_trylock(s)) ;
+    memcpy(csound_shm_data(h, s), src, s->size);
+    csound_shm_unlock(s);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* CSOUND_SHM_H */
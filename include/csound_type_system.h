@@ -59,6 +59,10 @@ extern "C" {
 #define CS_VAR_TYPE_OFFSET (sizeof(CS_VAR_MEM) - sizeof(MYFLT))
 #endif
 
+/* a-rate vectors in an instrument's local memory start on a cache line,
+   which is also the widest SIMD load */
+#define CS_VAR_VECTOR_ALIGN (64)
+
     typedef struct csvariable {
         char* varName;
         CS_TYPE* varType;
@@ -112,7 +116,8 @@ extern "C" {
         CS_HASH_TABLE* table;
         CS_VARIABLE* head;
         CS_VARIABLE* tail;
-        int poolSize;
+        int poolSize;   /* bytes of local memory, including the type
+                           header in front of each variable */
         struct csvarpool* parent;
         int varCount;
         int synthArgCount;
@@ -0,0 +1,161 @@
+/*
+    csprofile.h:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+#ifndef CSPROFILE_H
+#define CSPROFILE_H
+
+/**
+* \file csprofile.h
+*
+* This header provides the performance profiler API which is part of
+* libcsound.  The profiler times every perf-time opcode call and
+* aggregates the time by opcode, instrument and orchestra line, and
+* the time spent by each performance thread.
+*
+* \code
+    CSOUND* csound = csoundCreate(NULL);
+    csoundCompileOrc(csound, orc);
+    csoundStart(csound);
+    csoundProfilerInit(csound);
+
+    // Run Csound Performance here
+
+    n = csoundProfilerGetEntries(csound, &entries);
+    // ... entries[0] is the most expensive opcode
+    csoundProfilerFreeEntries(csound, entries);
+    csoundProfilerClean(csound);
+    csoundDestroy(csound);
+* \endcode
+*
+* The profiler can also be enabled with the -+profile=1 option, in
+* which case a report is printed at the end of the performance, and
+* every -+profile_period=N seconds if that is set.
+*/
+
+#ifdef __BUILDING_LIBCSOUND
+#include "csoundCore.h"
+#else
+#include "csound.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup PROFILER Profiler
+ *
+ *  @{ */
+
+/** Time spent in one opcode of the orchestra */
+typedef struct csprofile_entry_s {
+    char     opname[32];    /* opcode name */
+    char     instr[64];     /* instrument number or name, or UDO name */
+    int      insno;         /* instrument number */
+    int      line;          /* orchestra line of the opcode */
+    int      udo;           /* non-zero if the opcode is in a UDO body */
+    uint64_t calls;         /* number of perf-time calls */
+    double   seconds;       /* total time in the opcode; for a UDO call
+                               this includes its body */
+} csprofile_entry_t;
+
+/** Start profiling.
+ *
+ * Until csoundProfilerClean() is called, each perf-time opcode call is
+ * timed.  Can be called before or during performance.
+ *
+ * @param csound A Csound instance
+ */
+PUBLIC void csoundProfilerInit(CSOUND *csound);
+
+/** Stop profiling.
+ *
+ * Can be called during performance.  The profiler data is freed at the
+ * next csoundReset() or csoundDestroy(), once no thread can be timing
+ * an opcode with it.
+ *
+ * @param csound A Csound instance
+ */
+PUBLIC void csoundProfilerClean(CSOUND *csound);
+
+/** Zero all counters of the profiler.
+ *
+ * @param csound A Csound instance
+ */
+PUBLIC void csoundProfilerReset(CSOUND *csound);
+
+/** Get the profile data, one entry per opcode of the orchestra.
+ *
+ * Entries are sorted by time, most expensive first.  The array must be
+ * freed with csoundProfilerFreeEntries().
+ *
+ * @param csound A Csound instance
+ * @param entries set to the entry array, or NULL if there is none
+ * @return the number of entries
+ */
+PUBLIC int csoundProfilerGetEntries(CSOUND *csound,
+                                    csprofile_entry_t **entries);
+
+/** Free an array returned by csoundProfilerGetEntries()
+ *
+ * @param csound A Csound instance
+ * @param entries the array
+ */
+PUBLIC void csoundProfilerFreeEntries(CSOUND *csound,
+                                      csprofile_entry_t *entries);
+
+/** Get the time spent performing instruments by each thread.
+ *
+ * Thread 0 is the thread calling csoundPerformKsmps(), 1 and above are
+ * the -j worker threads.
+ *
+ * @param csound A Csound instance
+ * @param seconds array filled with up to max values
+ * @param max size of the array
+ * @return the number of threads
+ */
+PUBLIC int csoundProfilerGetThreadTimes(CSOUND *csound,
+                                        double *seconds, int max);
+
+/** Print a profile report with the maxlines most expensive opcodes,
+ * the time per instrument and per thread.
+ *
+ * @param csound A Csound instance
+ * @param maxlines number of opcode lines, or 0 for all
+ */
+PUBLIC void csoundProfilerReport(CSOUND *csound, int maxlines);
+
+/** @}*/
+
+#ifdef __BUILDING_LIBCSOUND
+
+int csoundProfileInstance(CSOUND *csound, void *profiler,
+                          INSDS *ip, int thread);
+void csoundProfilerTick(CSOUND *csound, void *profiler);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -32,4 +32,6 @@ PUBLIC OENTRY* find_opcode_exact(CSOUND* csound, char* opname,
 /* find OENTRY with the specified name in opcode list */
 
 OENTRY* find_opcode(CSOUND *, char *);
+/* forget the resolved signatures of an opcode name (all if NULL) */
+void opcode_signatures_reset(CSOUND *csound, char *opname);
 #endif
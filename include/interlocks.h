@@ -50,6 +50,9 @@
 #define IW (0x0400)
 #define IB (0x0600)
 
+// Control flow: jumps, reinit or turns off its instance at perf time
+#define _CF (0x0800)
+
 //Deprecated
 #define _QQ (0x8000)
 
@@ -0,0 +1,135 @@
+/*
+ * File:   array_view_test.c
+ *
+ * getrow and contiguous slicearray results are views of their input
+ * (Opcodes/arrays.c) unless something else writes them, and they let go
+ * of the input's storage when the note ends.
+ */
+
+#define __BUILDING_LIBCSOUND
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "csoundCore.h"
+#include "csound_type_system.h"
+#include "CUnit/Basic.h"
+
+int init_suite1(void)
+{
+    return 0;
+}
+
+int clean_suite1(void)
+{
+    return 0;
+}
+
+static ARRAYDAT *instance_array(CSOUND *csound, INSDS *ip, const char *name)
+{
+    CS_VARIABLE *var =
+      csoundFindVariableWithName(csound, ip->instr->varPool, name);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(var);
+    return (ARRAYDAT *) (ip->lclbas + var->memBlockIndex);
+}
+
+void test_array_views(void)
+{
+    CSOUND   *csound;
+    INSDS    *ip;
+    ARRAYDAT *kin, *kmat, *ain, *kview, *aview, *krow, *kcopy;
+    int       ret;
+    const char *instrument =
+      "ksmps = 16\n"
+      "instr 1\n"
+      "kin[] fillarray 1, 2, 3, 4, 5, 6\n"
+      "kmat[][] init 3, 4\n"
+      "ain[] init 4\n"
+      "kview[] slicearray kin, 1, 3\n"
+      "aview[] slicearray ain, 2, 3\n"
+      "krow[] getrow kmat, 1\n"
+      "kcopy[] slicearray kin, 2, 4\n"
+      "kcopy[0] = 10\n"
+      "endin\n";
+
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-n");
+    ret = csoundCompileOrc(csound, instrument);
+    CU_ASSERT(ret == 0);
+    csoundReadScore(csound, "i 1 0 1");
+    ret = csoundStart(csound);
+    CU_ASSERT(ret == 0);
+    CU_ASSERT(csoundPerformKsmps(csound) == 0);
+    CU_ASSERT(csoundPerformKsmps(csound) == 0);
+
+    ip = csound->actanchor.nxtact;
+    CU_ASSERT_PTR_NOT_NULL_FATAL(ip);
+    kin = instance_array(csound, ip, "kin");
+    kmat = instance_array(csound, ip, "kmat");
+    ain = instance_array(csound, ip, "ain");
+    kview = instance_array(csound, ip, "kview");
+    aview = instance_array(csound, ip, "aview");
+    krow = instance_array(csound, ip, "krow");
+    kcopy = instance_array(csound, ip, "kcopy");
+
+    /* the views alias their inputs */
+    CU_ASSERT(kview->sizes[0] == 3);
+    CU_ASSERT_PTR_EQUAL(kview->data, kin->data + 1);
+    CU_ASSERT_EQUAL(kview->allocated, 0);
+    CU_ASSERT_PTR_EQUAL(aview->data,
+                        ain->data + 2 * (ain->arrayMemberSize / sizeof(MYFLT)));
+    CU_ASSERT(krow->sizes[0] == 4);
+    CU_ASSERT_PTR_EQUAL(krow->data, kmat->data + 4);
+    /* so a change to the input is seen through them */
+    kin->data[2] = FL(42.0);
+    CU_ASSERT_DOUBLE_EQUAL(kview->data[1], 42.0, 0.0);
+    kmat->data[5] = FL(7.0);
+    CU_ASSERT_DOUBLE_EQUAL(krow->data[1], 7.0, 0.0);
+
+    /* a written slice has its own data, and the input is untouched */
+    CU_ASSERT(kcopy->data < kin->data || kcopy->data >= kin->data + 6);
+    CU_ASSERT(kcopy->allocated >= 3 * sizeof(MYFLT));
+    CU_ASSERT(kcopy->sizes[0] == 3);
+    CU_ASSERT_DOUBLE_EQUAL(kcopy->data[0], 10.0, 0.0);
+    CU_ASSERT_DOUBLE_EQUAL(kin->data[2], 42.0, 0.0);
+
+    /* once the note has ended the views no longer point into the inputs,
+       which still have their own data */
+    while (csoundPerformKsmps(csound) == 0) ;
+    CU_ASSERT_PTR_NULL(kview->data);
+    CU_ASSERT_PTR_NULL(aview->data);
+    CU_ASSERT_PTR_NULL(krow->data);
+    CU_ASSERT_PTR_NOT_NULL(kin->data);
+    CU_ASSERT_PTR_NOT_NULL(kcopy->data);
+
+    csoundDestroy(csound);
+}
+
+int main()
+{
+    CU_pSuite pSuite = NULL;
+
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("array view tests", init_suite1, clean_suite1);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* add the tests to the suite */
+    if (NULL == CU_add_test(pSuite, "Test getrow and slicearray views",
+                            test_array_views))
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    return CU_get_error();
+}
@@ -2,6 +2,14 @@
 #include <string.h>
 #include <CUnit/Basic.h>
 #include "csound.h"
+#include "csdebug.h"
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "csound_shm.h"
+#endif
 
 int init_suite1(void)
 {
@@ -358,6 +366,285 @@ void test_string_channel(void)
     csoundDestroy(csound);
 }
 
+void test_channel_handles(void)
+{
+    const char orcH[] = "chn_k \"h1\", 3\n chn_k \"h2\", 3\n chn_a \"ha\", 3\n"
+      " instr 1\n a1 chnget \"h1\"\n chnset a1, \"ha\"\n endin\n";
+    CS_CHANNEL *chn[2];
+    MYFLT vals[2] = { 1.0, 2.0 }, out[2], audio[1024];
+    int offset = 3, i;
+
+    csoundSetGlobalEnv("OPCODE6DIR64", "../../");
+    CSOUND *csound = csoundCreate(0);
+    csoundCreateMessageBuffer(csound, 0);
+    csoundSetOption(csound, "--logfile=NULL");
+    csoundSetOption(csound, "-n");
+    csoundCompileOrc(csound, orcH);
+    csoundReadScore(csound, "i1 0 1\n");
+    CU_ASSERT(csoundStart(csound) == CSOUND_SUCCESS);
+
+    chn[0] = csoundGetChannelHandle(csound, "h1", CSOUND_CONTROL_CHANNEL |
+                                    CSOUND_INPUT_CHANNEL);
+    chn[1] = csoundGetChannelHandle(csound, "h2", CSOUND_CONTROL_CHANNEL |
+                                    CSOUND_INPUT_CHANNEL);
+    CU_ASSERT_PTR_NOT_NULL(chn[0]);
+    CU_ASSERT_PTR_NOT_NULL(chn[1]);
+    CU_ASSERT_PTR_NULL(csoundGetChannelHandle(csound, "ha",
+                                              CSOUND_CONTROL_CHANNEL |
+                                              CSOUND_INPUT_CHANNEL));
+
+    csoundSetControlChannels(csound, chn, vals, 2);
+    csoundGetControlChannels(csound, chn, out, 2);
+    CU_ASSERT_EQUAL(out[0], 1.0);
+    CU_ASSERT_EQUAL(out[1], 2.0);
+    CU_ASSERT_EQUAL(csoundGetControlChannel(csound, "h2", NULL), 2.0);
+    csoundSetControlChannelH(csound, chn[1], 3.0);
+    CU_ASSERT_EQUAL(csoundGetControlChannelH(csound, chn[1]), 3.0);
+
+    csoundPerformKsmps(csound);
+    csoundGetAudioChannel(csound, "ha", audio);
+    CU_ASSERT_EQUAL(audio[0], 1.0);
+
+    /* steps from 1 to 5 at frame 3 of the next period */
+    vals[0] = 5.0;
+    csoundSetControlChannelsAt(csound, chn, vals, &offset, 1);
+    csoundPerformKsmps(csound);
+    csoundGetAudioChannel(csound, "ha", audio);
+    for (i = 0; i < csoundGetKsmps(csound); i++)
+      CU_ASSERT_EQUAL(audio[i], i < offset ? 1.0 : 5.0);
+    CU_ASSERT_EQUAL(csoundGetControlChannelH(csound, chn[0]), 5.0);
+
+    csoundCleanup(csound);
+    csoundDestroyMessageBuffer(csound);
+    csoundDestroy(csound);
+}
+
+/* the same timed write, with the debugger's performance loop */
+void test_channel_steps_debug(void)
+{
+    const char orcH[] = "chn_k \"h1\", 3\n chn_a \"ha\", 3\n"
+      " instr 1\n a1 chnget \"h1\"\n chnset a1, \"ha\"\n endin\n";
+    CS_CHANNEL *chn;
+    MYFLT val = 5.0, audio[1024];
+    int offset = 3, i;
+
+    csoundSetGlobalEnv("OPCODE6DIR64", "../../");
+    CSOUND *csound = csoundCreate(0);
+    csoundCreateMessageBuffer(csound, 0);
+    csoundSetOption(csound, "--logfile=NULL");
+    csoundSetOption(csound, "-n");
+    csoundCompileOrc(csound, orcH);
+    csoundReadScore(csound, "i1 0 1\n");
+    CU_ASSERT(csoundStart(csound) == CSOUND_SUCCESS);
+    csoundDebuggerInit(csound);
+
+    chn = csoundGetChannelHandle(csound, "h1", CSOUND_CONTROL_CHANNEL |
+                                 CSOUND_INPUT_CHANNEL);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(chn);
+    csoundSetControlChannelH(csound, chn, 1.0);
+    csoundPerformKsmps(csound);
+    csoundSetControlChannelsAt(csound, &chn, &val, &offset, 1);
+    csoundPerformKsmps(csound);
+    csoundGetAudioChannel(csound, "ha", audio);
+    for (i = 0; i < csoundGetKsmps(csound); i++)
+      CU_ASSERT_EQUAL(audio[i], i < offset ? 1.0 : 5.0);
+
+    csoundDebuggerClean(csound);
+    csoundCleanup(csound);
+    csoundDestroyMessageBuffer(csound);
+    csoundDestroy(csound);
+}
+
+static uintptr_t create_channels(void *csound)
+{
+    char name[32];
+    MYFLT *p;
+    int i, bad = 0;
+
+    for (i = 0; i < 2000; i++) {
+      snprintf(name, sizeof(name), "dyn%d", i);
+      if (csoundGetChannelPtr((CSOUND *) csound, &p, name,
+                              CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL)
+          != CSOUND_SUCCESS)
+        bad++;
+    }
+    return (uintptr_t) bad;
+}
+
+/* lookups while another thread creates channels and grows the table */
+void test_channel_create_race(void)
+{
+    CSOUND *csound;
+    void *th;
+    MYFLT *p;
+    char name[32];
+    int i, err, misses = 0;
+
+    csound = csoundCreate(0);
+    csoundCreateMessageBuffer(csound, 0);
+    csoundSetOption(csound, "-n");
+    csoundCompileOrc(csound, orc1);
+    CU_ASSERT(csoundStart(csound) == CSOUND_SUCCESS);
+    csoundSetControlChannel(csound, "testing", 5.0);
+    th = csoundCreateThread(create_channels, csound);
+    for (i = 0; i < 20000; i++) {
+      if (csoundGetControlChannel(csound, "testing", &err) != 5.0 ||
+          err != CSOUND_SUCCESS)
+        misses++;
+    }
+    CU_ASSERT_EQUAL(csoundJoinThread(th), 0);
+    CU_ASSERT_EQUAL(misses, 0);
+    for (i = 0; i < 2000; i++) {
+      snprintf(name, sizeof(name), "dyn%d", i);
+      if (csoundGetChannelPtr(csound, &p, name, CSOUND_CONTROL_CHANNEL)
+          != CSOUND_SUCCESS)
+        misses++;
+    }
+    CU_ASSERT_EQUAL(misses, 0);
+    csoundCleanup(csound);
+    csoundDestroyMessageBuffer(csound);
+    csoundDestroy(csound);
+}
+
+#ifndef WIN32
+void test_shared_channels(void)
+{
+    const char orcShm[] = "chn_k \"in\", 5\n chn_k \"out\", 6\n"
+      " chn_a \"aout\", 6\n instr 1\n k1 chnget \"in\"\n"
+      " chnset k1 * 2, \"out\"\n a1 = k1\n chnset a1, \"aout\"\n endin\n";
+    char name[64], opt[96];
+    MYFLT in = 0.25, out = 0.0, aout[1024];
+    struct stat st;
+    csound_shm_header *h;
+    csound_shm_slot *sin, *sout, *saout;
+    uint64_t block;
+    int fd;
+
+    snprintf(name, sizeof(name), "/csound_test_%d", (int) getpid());
+    snprintf(opt, sizeof(opt), "-+chn_shm=%s", name);
+    csoundSetGlobalEnv("OPCODE6DIR64", "../../");
+    CSOUND *csound = csoundCreate(0);
+    csoundCreateMessageBuffer(csound, 0);
+    csoundSetOption(csound, "--logfile=NULL");
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, opt);
+    csoundCompileOrc(csound, orcShm);
+    csoundReadScore(csound, "i1 0 1\n");
+    CU_ASSERT(csoundStart(csound) == CSOUND_SUCCESS);
+
+    fd = shm_open(name, O_RDWR, 0);
+    CU_ASSERT_FATAL(fd >= 0);
+    CU_ASSERT(fstat(fd, &st) == 0);
+    h = (csound_shm_header *) mmap(NULL, (size_t) st.st_size,
+                                   PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    CU_ASSERT_FATAL(h != MAP_FAILED);
+    CU_ASSERT_EQUAL(h->magic, CSOUND_SHM_MAGIC);
+    CU_ASSERT_EQUAL(h->flt_size, sizeof(MYFLT));
+    CU_ASSERT_EQUAL(h->ksmps, (uint32_t) csoundGetKsmps(csound));
+    CU_ASSERT(csound_shm_size(h) <= (size_t) st.st_size);
+    CU_ASSERT_EQUAL(h->nchannels, 3);
+    sin = csound_shm_find(h, "in");
+    sout = csound_shm_find(h, "out");
+    saout = csound_shm_find(h, "aout");
+    CU_ASSERT_FATAL(sin != NULL && sout != NULL && saout != NULL);
+    CU_ASSERT_EQUAL(saout->size, csoundGetKsmps(csound) * sizeof(MYFLT));
+
+    csound_shm_write(h, sin, &in);
+    block = csound_shm_block(h);
+    csoundPerformKsmps(csound);
+    CU_ASSERT_EQUAL(csound_shm_block(h), block + 1);
+    csound_shm_read(h, sout, &out);
+    csound_shm_read(h, saout, aout);
+    CU_ASSERT_EQUAL(out, 0.5);
+    CU_ASSERT_EQUAL(aout[0], 0.25);
+    /* the same values seen through the API */
+    CU_ASSERT_EQUAL(csoundGetControlChannel(csound, "out", NULL), 0.5);
+    /* no channel is left locked between periods */
+    CU_ASSERT(csound_shm_tryread(h, sin, &out));
+    CU_ASSERT(csound_shm_tryread(h, sout, &out));
+    CU_ASSERT(csound_shm_tryread(h, saout, aout));
+    /* a value set through the API between periods is written out */
+    csoundSetControlChannel(csound, "in", 0.125);
+    csoundPerformKsmps(csound);
+    csound_shm_read(h, sin, &in);
+    csound_shm_read(h, sout, &out);
+    CU_ASSERT_EQUAL(in, 0.125);
+    CU_ASSERT_EQUAL(out, 0.25);
+
+    munmap((void *) h, (size_t) st.st_size);
+    csoundCleanup(csound);
+    csoundDestroyMessageBuffer(csound);
+    csoundDestroy(csound);
+    /* removed with the instance that created it */
+    CU_ASSERT(shm_open(name, O_RDWR, 0) < 0);
+}
+
+static uintptr_t start_shared(void *csound)
+{
+    return (uintptr_t) csoundStart((CSOUND *) csound);
+}
+
+/* two instances creating the segment and the same channels at once */
+void test_shared_channels_race(void)
+{
+    char orc[1024], name[64], opt[96];
+    CSOUND *cs[2];
+    void *th[2];
+    struct stat st;
+    csound_shm_header *h;
+    csound_shm_slot *s;
+    size_t len = 0;
+    int i, j, fd, run, count;
+
+    for (i = 0; i < 8; i++)
+      len += snprintf(orc + len, sizeof(orc) - len,
+                      "chn_k \"c%d\", 7\n", i);
+    for (run = 0; run < 20; run++) {
+      snprintf(name, sizeof(name), "/csound_race_%d_%d", (int) getpid(), run);
+      snprintf(opt, sizeof(opt), "-+chn_shm=%s", name);
+      for (i = 0; i < 2; i++) {
+        cs[i] = csoundCreate(0);
+        csoundCreateMessageBuffer(cs[i], 0);
+        csoundSetOption(cs[i], "-n");
+        csoundSetOption(cs[i], opt);
+        csoundCompileOrc(cs[i], orc);
+      }
+      for (i = 0; i < 2; i++)
+        th[i] = csoundCreateThread(start_shared, cs[i]);
+      for (i = 0; i < 2; i++)
+        CU_ASSERT_EQUAL(csoundJoinThread(th[i]), CSOUND_SUCCESS);
+
+      fd = shm_open(name, O_RDWR, 0);
+      CU_ASSERT_FATAL(fd >= 0);
+      CU_ASSERT(fstat(fd, &st) == 0);
+      h = (csound_shm_header *) mmap(NULL, (size_t) st.st_size,
+                                     PROT_READ | PROT_WRITE, MAP_SHARED,
+                                     fd, 0);
+      close(fd);
+      CU_ASSERT_FATAL(h != MAP_FAILED);
+      /* each name has one entry */
+      CU_ASSERT_EQUAL(h->nchannels, 8);
+      for (i = 0; i < 8; i++) {
+        char cname[16];
+        snprintf(cname, sizeof(cname), "c%d", i);
+        count = 0;
+        s = csound_shm_slots(h);
+        for (j = 0; j < (int) h->nchannels; j++)
+          if (strcmp(s[j].name, cname) == 0) count++;
+        CU_ASSERT_EQUAL(count, 1);
+      }
+      munmap((void *) h, (size_t) st.st_size);
+      for (i = 0; i < 2; i++) {
+        csoundCleanup(cs[i]);
+        csoundDestroyMessageBuffer(cs[i]);
+        csoundDestroy(cs[i]);
+      }
+      shm_unlink(name);
+    }
+}
+#endif
+
 int main(void)
 {
    CU_pSuite pSuite = NULL;
@@ -383,6 +670,16 @@ int main(void)
            || (NULL == CU_add_test(pSuite, "Invalid channels", test_invalid_channel))
            || (NULL == CU_add_test(pSuite, "Channel hints", test_chn_hints))
            || (NULL == CU_add_test(pSuite, "String channel", test_string_channel))
+           || (NULL == CU_add_test(pSuite, "Channel handles", test_channel_handles))
+           || (NULL == CU_add_test(pSuite, "Timed channel writes, debugger",
+                                   test_channel_steps_debug))
+           || (NULL == CU_add_test(pSuite, "Channel creation during lookups",
+                                   test_channel_create_race))
+#ifndef WIN32
+           || (NULL == CU_add_test(pSuite, "Shared channels", test_shared_channels))
+           || (NULL == CU_add_test(pSuite, "Shared channels, concurrent start",
+                                   test_shared_channels_race))
+#endif
        )
    {
       CU_cleanup_registry();
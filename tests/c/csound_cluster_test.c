@@ -0,0 +1,180 @@
+/*
+ * File:   csound_cluster_test.c
+ *
+ * Runs a coordinator and a worker node of a cluster in two threads of
+ * this process, connected through localhost.  The events an instrument
+ * schedules for an instrument of the other node are sent to it.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "csound.h"
+#include "CUnit/Basic.h"
+
+#define NCYCLES (20)
+
+static const char *orc =
+    "ksmps = 32\n"
+    "nchnls = 1\n"
+    "0dbfs = 1\n"
+    "chn_k \"shared\", 3\n"
+    "chn_k \"seen\", 3\n"
+    "chn_k \"over\", 3\n"
+    "chn_k \"heard\", 3\n"
+    "chn_a \"bus\", 3\n"
+    "chn_k \"fromworker\", 3\n"
+    "chn_k \"fromcoord\", 3\n"
+    "instr 1 ;; node 1\n"
+    "  event_i \"i\", 6, 0, 1, 0.125\n"
+    "  chnset 0.5, \"shared\"\n"
+    "  chnset 0.25, \"over\"\n"
+    "  a1 = 0.25\n"
+    "  chnmix a1, \"bus\"\n"
+    "endin\n"
+    "instr 2 ;; node 0\n"
+    "  event_i \"i\", 5, 0, 1, 0.375\n"
+    "  k1 chnget \"shared\"\n"
+    "  chnset k1, \"seen\"\n"
+    "  chnset 0.75, \"over\"\n"
+    "  a1 = 0.5\n"
+    "  chnmix a1, \"bus\"\n"
+    "endin\n"
+    "instr 4 ;; node 0, after the mixers of this node\n"
+    "  a1 chnget \"bus\"\n"
+    "  k1 downsamp a1\n"
+    "  chnset k1, \"heard\"\n"
+    "  chnclear \"bus\"\n"
+    "endin\n"
+    "instr 5 ;; node 1, scheduled by node 0\n"
+    "  chnset p4, \"fromcoord\"\n"
+    "endin\n"
+    "instr 6 ;; node 0, scheduled by node 1\n"
+    "  chnset p4, \"fromworker\"\n"
+    "endin\n";
+
+typedef struct {
+    CSOUND *csound;
+    int    result;
+} NODE;
+
+int init_suite1(void)
+{
+    return 0;
+}
+
+int clean_suite1(void)
+{
+    return 0;
+}
+
+static CSOUND *make_node(int node)
+{
+    CSOUND *csound = csoundCreate(NULL);
+    char   opt[32];
+    csoundCreateMessageBuffer(csound, 0);
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "-+cluster_nodes=2");
+    snprintf(opt, sizeof(opt), "-+cluster_node=%d", node);
+    csoundSetOption(csound, opt);
+    csoundSetOption(csound, "-+cluster_port=40461");
+    csoundCompileOrc(csound, orc);
+    csoundInputMessage(csound, "i 1 0 1\ni 2 0 1\ni 4 0 1\n");
+    return csound;
+}
+
+static uintptr_t run_node(void *data)
+{
+    NODE *n = (NODE *) data;
+    int  i;
+    n->result = csoundStart(n->csound);
+    for (i = 0; i < NCYCLES && n->result == 0; i++)
+      n->result = csoundPerformKsmps(n->csound);
+    return 0;
+}
+
+void test_cluster_channels(void)
+{
+    NODE   coordinator, worker;
+    void   *thread;
+    int    err;
+
+    coordinator.csound = make_node(0);
+    worker.csound = make_node(1);
+    thread = csoundCreateThread(run_node, &coordinator);
+    run_node(&worker);
+    csoundJoinThread(thread);
+    CU_ASSERT_EQUAL(coordinator.result, 0);
+    CU_ASSERT_EQUAL(worker.result, 0);
+
+    /* instr 1 only runs on node 1, instr 2 on node 0 */
+    CU_ASSERT_DOUBLE_EQUAL(csoundGetControlChannel(coordinator.csound,
+                                                   "shared", &err), 0.5, 1e-12);
+    CU_ASSERT_DOUBLE_EQUAL(csoundGetControlChannel(coordinator.csound,
+                                                   "seen", &err), 0.5, 1e-12);
+    CU_ASSERT_DOUBLE_EQUAL(csoundGetControlChannel(worker.csound,
+                                                   "seen", &err), 0.5, 1e-12);
+
+    /* both nodes set "over" every period: node 1 is merged last, and
+       its value stays, rather than the sum of the two */
+    CU_ASSERT_DOUBLE_EQUAL(csoundGetControlChannel(coordinator.csound,
+                                                   "over", &err), 0.25, 1e-12);
+    CU_ASSERT_DOUBLE_EQUAL(csoundGetControlChannel(worker.csound,
+                                                   "over", &err), 0.25, 1e-12);
+    /* both mix into "bus", which node 0 reads and clears: it hears the
+       sum of the two */
+    CU_ASSERT_DOUBLE_EQUAL(csoundGetControlChannel(coordinator.csound,
+                                                   "heard", &err), 0.75, 1e-12);
+    CU_ASSERT_DOUBLE_EQUAL(csoundGetControlChannel(worker.csound,
+                                                   "heard", &err), 0.75, 1e-12);
+
+    /* the events scheduled for the other node have been performed
+       there: both nodes see the channels they set */
+    CU_ASSERT_DOUBLE_EQUAL(csoundGetControlChannel(coordinator.csound,
+                                                   "fromworker", &err),
+                           0.125, 1e-12);
+    CU_ASSERT_DOUBLE_EQUAL(csoundGetControlChannel(worker.csound,
+                                                   "fromworker", &err),
+                           0.125, 1e-12);
+    CU_ASSERT_DOUBLE_EQUAL(csoundGetControlChannel(worker.csound,
+                                                   "fromcoord", &err),
+                           0.375, 1e-12);
+    CU_ASSERT_DOUBLE_EQUAL(csoundGetControlChannel(coordinator.csound,
+                                                   "fromcoord", &err),
+                           0.375, 1e-12);
+
+    csoundDestroyMessageBuffer(coordinator.csound);
+    csoundDestroyMessageBuffer(worker.csound);
+    csoundDestroy(coordinator.csound);
+    csoundDestroy(worker.csound);
+}
+
+int main()
+{
+    CU_pSuite pSuite = NULL;
+
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("Cluster tests", init_suite1, clean_suite1);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* add the tests to the suite */
+    if ((NULL == CU_add_test(pSuite, "Test cluster channels",
+                             test_cluster_channels))
+        ) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    return CU_get_error();
+}
@@ -147,6 +147,96 @@ void test_cs_hash_table_get_put_key(void) {
     csoundDestroy(csound);
 }
 
+void test_cs_hash_table_grow(void) {
+    CSOUND* csound = csoundCreate(NULL);
+    CS_HASH_TABLE* hashTable = cs_hash_table_create(csound);
+    int size = hashTable->table_size, i, found = 0;
+    char key[32];
+
+    for (i = 0; i < 1000; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        cs_hash_table_put(csound, hashTable, key, (void*) (intptr_t) (i + 1));
+    }
+    CU_ASSERT(hashTable->table_size > size);
+    CU_ASSERT(hashTable->count <= hashTable->table_size * 0.75);
+    CU_ASSERT_EQUAL(hashTable->count, 1000);
+    for (i = 0; i < 1000; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        if ((intptr_t) cs_hash_table_get(csound, hashTable, key) == i + 1)
+            found++;
+    }
+    CU_ASSERT_EQUAL(found, 1000);
+
+    csoundDestroy(csound);
+}
+
+void test_cs_hash_table_remove_in_cluster(void) {
+    CSOUND* csound = csoundCreate(NULL);
+    CS_HASH_TABLE* hashTable = cs_hash_table_create(csound);
+    uint32_t mask;
+    int i, j, n = 40, found = 0;
+    char keys[40][16], *removed = NULL;
+
+    for (i = 0; i < n; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "k%d", i);
+        cs_hash_table_put(csound, hashTable, keys[i], keys[i]);
+    }
+    /* an entry followed by one that was displaced from its home slot */
+    mask = (uint32_t) hashTable->table_size - 1;
+    for (i = 0; i < hashTable->table_size && removed == NULL; i++) {
+        CS_HASH_TABLE_ITEM *a = &hashTable->buckets[i];
+        CS_HASH_TABLE_ITEM *b = &hashTable->buckets[(i + 1) & mask];
+        if (a->key != NULL && b->key != NULL &&
+            (b->hash & mask) != ((i + 1) & mask))
+            removed = (char*) a->value;
+    }
+    CU_ASSERT_PTR_NOT_NULL_FATAL(removed);
+
+    cs_hash_table_remove(csound, hashTable, removed);
+    CU_ASSERT_EQUAL(hashTable->count, n - 1);
+    CU_ASSERT_PTR_NULL(cs_hash_table_get(csound, hashTable, removed));
+    for (j = 0; j < n; j++) {
+        if (keys[j] != removed &&
+            cs_hash_table_get(csound, hashTable, keys[j]) == keys[j])
+            found++;
+    }
+    CU_ASSERT_EQUAL(found, n - 1);
+
+    csoundDestroy(csound);
+}
+
+void test_cs_hash_table_reserve_next(void) {
+    CSOUND* csound = csoundCreate(NULL);
+    CS_HASH_TABLE* hashTable = cs_hash_table_create(csound);
+    int seen[1000] = { 0 };
+    int size, i, pos = 0, visits = 0, once = 1;
+    char key[32], *k;
+    void *v;
+
+    cs_hash_table_reserve(csound, hashTable, 1000);
+    size = hashTable->table_size;
+    CU_ASSERT(size * 0.75 >= 1000);
+    for (i = 0; i < 1000; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        cs_hash_table_put(csound, hashTable, key, (void*) (intptr_t) i);
+    }
+    /* no resize after the reservation */
+    CU_ASSERT_EQUAL(hashTable->table_size, size);
+
+    while (cs_hash_table_next(hashTable, &pos, &k, &v)) {
+        i = (int) (intptr_t) v;
+        snprintf(key, sizeof(key), "key%d", i);
+        CU_ASSERT_STRING_EQUAL(k, key);
+        if (seen[i]++) once = 0;
+        visits++;
+    }
+    CU_ASSERT_EQUAL(visits, 1000);
+    CU_ASSERT(once);
+    CU_ASSERT_EQUAL(cs_hash_table_next(hashTable, &pos, &k, &v), 0);
+
+    csoundDestroy(csound);
+}
+
 
 int main() {
     CU_pSuite pSuite = NULL;
@@ -167,7 +257,10 @@ int main() {
         (NULL == CU_add_test(pSuite, "Test cs_cons_append()", test_cs_cons_append)) ||
         (NULL == CU_add_test(pSuite, "Test cs_hash_table()", test_cs_hash_table)) ||
         (NULL == CU_add_test(pSuite, "Test cs_hash_table_merge()", test_cs_hash_table_merge)) ||
-        (NULL == CU_add_test(pSuite, "Test cs_hash_table_get_put_key()", test_cs_hash_table_get_put_key))) {
+        (NULL == CU_add_test(pSuite, "Test cs_hash_table_get_put_key()", test_cs_hash_table_get_put_key)) ||
+        (NULL == CU_add_test(pSuite, "Test cs_hash_table growth", test_cs_hash_table_grow)) ||
+        (NULL == CU_add_test(pSuite, "Test cs_hash_table_remove() in a cluster", test_cs_hash_table_remove_in_cluster)) ||
+        (NULL == CU_add_test(pSuite, "Test cs_hash_table_reserve() and cs_hash_table_next()", test_cs_hash_table_reserve_next))) {
         
         CU_cleanup_registry();
         return CU_get_error();
@@ -121,6 +121,28 @@ void test_find_opcode_new(void) {
 
 }
 
+void test_resolve_opcode_signatures(void) {
+    CSOUND* csound = csoundCreate(NULL);
+    OENTRIES* entries = find_opcode2(csound, "pcauchy");
+    OENTRY* opc = resolve_opcode(csound, entries, "k", "k");
+
+    /* resolved again from the signature index */
+    CU_ASSERT_PTR_NOT_NULL(opc);
+    CU_ASSERT_PTR_EQUAL(opc, resolve_opcode(csound, entries, "k", "k"));
+    CU_ASSERT_PTR_NOT_EQUAL(opc, resolve_opcode(csound, entries, "a", "k"));
+    CU_ASSERT_PTR_NULL(resolve_opcode(csound, entries, "S", "k"));
+    csound->Free(csound, entries);
+
+    /* adding an entry of the same name drops what was resolved */
+    CU_ASSERT_EQUAL(0, csoundAppendOpcode(csound, "pcauchy.S", sizeof(OPDS),
+                                          0, 1, "S", "k", NULL, NULL, NULL));
+    entries = find_opcode2(csound, "pcauchy");
+    CU_ASSERT_PTR_NOT_NULL(resolve_opcode(csound, entries, "S", "k"));
+    CU_ASSERT_PTR_EQUAL(opc, resolve_opcode(csound, entries, "k", "k"));
+    csound->Free(csound, entries);
+    csoundDestroy(csound);
+}
+
 void test_check_in_arg(void) {
     CU_ASSERT_FALSE(check_in_arg(NULL, NULL));
     CU_ASSERT_FALSE(check_in_arg("a", NULL));
@@ -278,6 +300,8 @@ int main()
     if ((NULL == CU_add_test(pSuite, "Test find_opcode2()", test_find_opcode2))
         || (NULL == CU_add_test(pSuite, "Test resolve_opcode()", test_resolve_opcode))
         || (NULL == CU_add_test(pSuite, "Test find_opcode_new()", test_find_opcode_new))
+        || (NULL == CU_add_test(pSuite, "Test resolve_opcode() signatures",
+                                test_resolve_opcode_signatures))
         || (NULL == CU_add_test(pSuite, "Test check_out_arg()", test_check_out_arg))
         || (NULL == CU_add_test(pSuite, "Test check_out_args()", test_check_out_args))
         || (NULL == CU_add_test(pSuite, "Test check_in_arg()", test_check_in_arg))
@@ -0,0 +1,158 @@
+/*
+ * File:   csound_profiler_test.c
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "csound.h"
+#include "csprofile.h"
+#include "CUnit/Basic.h"
+
+int init_suite1(void)
+{
+    return 0;
+}
+
+int clean_suite1(void)
+{
+    return 0;
+}
+
+void test_profiler_init(void)
+{
+    CSOUND* csound = csoundCreate(NULL);
+    csprofile_entry_t *entries;
+    csoundCreateMessageBuffer(csound, 0);
+    csoundProfilerInit(csound);
+    CU_ASSERT_EQUAL(csoundProfilerGetEntries(csound, &entries), 0);
+    CU_ASSERT_PTR_NULL(entries);
+    csoundProfilerClean(csound);
+    csoundDestroyMessageBuffer(csound);
+    csoundDestroy(csound);
+}
+
+void test_profiler_entries(void)
+{
+    int i, n, found = 0;
+    double t;
+    csprofile_entry_t *entries;
+    CSOUND* csound = csoundCreate(NULL);
+    csoundCreateMessageBuffer(csound, 0);
+    csoundSetOption(csound, "-n");
+    csoundCompileOrc(csound,
+                     "opcode Gain, a, ak\n"
+                     "ain, kg xin\n"
+                     "xout ain * kg\n"
+                     "endop\n"
+                     "instr 1\n"
+                     "asig oscili 0.1, 440\n"
+                     "asig Gain asig, 0.5\n"
+                     "endin\n");
+    csoundInputMessage(csound, "i 1 0 1");
+    csoundStart(csound);
+    csoundProfilerInit(csound);
+    for (i = 0; i < 10; i++)
+      csoundPerformKsmps(csound);
+
+    n = csoundProfilerGetEntries(csound, &entries);
+    CU_ASSERT(n >= 3);
+    for (i = 0; i < n; i++) {
+      if (strcmp(entries[i].opname, "oscili") == 0) {
+        CU_ASSERT_EQUAL(entries[i].calls, 10);
+        CU_ASSERT_STRING_EQUAL(entries[i].instr, "1");
+        CU_ASSERT_EQUAL(entries[i].udo, 0);
+        found++;
+      }
+      if (strcmp(entries[i].instr, "Gain") == 0) {
+        CU_ASSERT_EQUAL(entries[i].udo, 1);
+        found++;
+      }
+      if (i > 0)
+        CU_ASSERT(entries[i - 1].seconds >= entries[i].seconds);
+    }
+    CU_ASSERT(found >= 2);
+    csoundProfilerFreeEntries(csound, entries);
+
+    CU_ASSERT_EQUAL(csoundProfilerGetThreadTimes(csound, &t, 1), 1);
+    CU_ASSERT(t > 0.0);
+    csoundProfilerReset(csound);
+    n = csoundProfilerGetEntries(csound, &entries);
+    for (i = 0; i < n; i++)
+      CU_ASSERT_EQUAL(entries[i].calls, 0);
+    csoundProfilerFreeEntries(csound, entries);
+
+    csoundProfilerClean(csound);
+    csoundDestroyMessageBuffer(csound);
+    csoundDestroy(csound);
+}
+
+static uintptr_t perf_thread(void *data)
+{
+    CSOUND *csound = (CSOUND*) data;
+    while (csoundPerformKsmps(csound) == 0) ;
+    return 0;
+}
+
+/* the profiler is started and stopped while the perf thread and the
+   -j workers time opcodes with it */
+void test_profiler_clean_in_performance(void)
+{
+    CSOUND *csound = csoundCreate(NULL);
+    void   *thread;
+    int    i;
+
+    csoundCreateMessageBuffer(csound, 0);
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "-j2");
+    csoundSetOption(csound, "--ksmps=1");
+    csoundCompileOrc(csound,
+                     "instr 1\n"
+                     "asig oscili 0.1, 440 * p4\n"
+                     "asig butterlp asig, 1000\n"
+                     "endin\n");
+    csoundReadScore(csound, "i 1 0 2 1\ni 1 0 2 2\ni 1 0 2 3\n");
+    CU_ASSERT_FATAL(csoundStart(csound) == 0);
+    thread = csoundCreateThread(perf_thread, csound);
+    for (i = 0; i < 2000; i++) {
+      csoundProfilerInit(csound);
+      csoundProfilerClean(csound);
+    }
+    csoundJoinThread(thread);
+    csoundDestroyMessageBuffer(csound);
+    csoundDestroy(csound);
+}
+
+int main()
+{
+    CU_pSuite pSuite = NULL;
+
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("csound profiler tests", init_suite1, clean_suite1);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* add the tests to the suite */
+    if ((NULL == CU_add_test(pSuite, "Test profiler init", test_profiler_init))
+        || (NULL == CU_add_test(pSuite, "Test profiler entries",
+                                test_profiler_entries))
+        || (NULL == CU_add_test(pSuite, "Test profiler clean in performance",
+                                test_profiler_clean_in_performance))
+        )
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    return CU_get_error();
+}
@@ -0,0 +1,347 @@
+/*
+ * File:   delayline_test.c
+ *
+ * The vdelay family and multitap (OOps/vdelay.c, on the delay lines of
+ * OOps/delayline.c) against the loops they replaced, which are kept
+ * here: the output must be the same bit for bit, for a-rate and k-rate
+ * delays, delays outside the line and lines shorter than the sinc
+ * window.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "csound.h"
+#include "CUnit/Basic.h"
+
+#ifndef PI
+#define PI      (3.141592653589793238462643383279502884197)
+#endif
+
+int init_suite1(void)
+{
+    return 0;
+}
+
+int clean_suite1(void)
+{
+    return 0;
+}
+
+/* the original loops of OOps/vdelay.c, one sample at a time */
+
+typedef struct {
+    MYFLT   *buf;
+    int32_t maxd, indx;
+} REF;
+
+static void ref_init(REF *r, int32_t maxd, int32_t alloc)
+{
+    r->buf = (MYFLT *) calloc(alloc, sizeof(MYFLT));
+    r->maxd = maxd;
+    r->indx = 0;
+}
+
+static MYFLT ref_vdelay(REF *r, MYFLT in, MYFLT del, MYFLT esr)
+{
+    MYFLT  fv1, fv2, out;
+    int32_t v1, v2, maxd = r->maxd;
+
+    r->buf[r->indx] = in;
+    fv1 = r->indx - del * esr;
+    while (fv1 < FL(0.0)) fv1 += (MYFLT)maxd;
+    while (fv1 >= (MYFLT)maxd) fv1 -= (MYFLT)maxd;
+    if (fv1 < maxd - 1) fv2 = fv1 + FL(1.0);
+    else fv2 = FL(0.0);
+    v1 = (int32_t)fv1;
+    v2 = (int32_t)fv2;
+    out = r->buf[v1] + (fv1 - v1) * (r->buf[v2] - r->buf[v1]);
+    if (++r->indx == maxd) r->indx = 0;
+    return out;
+}
+
+static MYFLT ref_vdelay3(REF *r, MYFLT in, MYFLT del, MYFLT esr)
+{
+    MYFLT  fv1, w, x, y, z, *buf = r->buf;
+    int32_t v0, v1, v2, v3, maxd = r->maxd;
+
+    buf[r->indx] = in;
+    fv1 = del * (-esr);
+    v1 = (int32_t)fv1;
+    fv1 -= (MYFLT) v1;
+    v1 += r->indx;
+    if ((v1 < 0) || (fv1 < FL(0.0))) {
+      fv1++; v1--; while (v1 < 0) v1 += maxd;
+    }
+    else {
+      while (v1 >= maxd) v1 -= maxd;
+    }
+    v2 = (v1 == maxd - 1 ? 0 : v1 + 1);
+    v0 = (v1 == 0 ? maxd - 1 : v1 - 1);
+    v3 = (v2 == maxd - 1 ? 0 : v2 + 1);
+    z = fv1 * fv1; z--; z *= FL(0.1666666667);
+    y = fv1; y++; w = (y *= FL(0.5)); w--;
+    x = FL(3.0) * z; y -= x; w -= z; x -= fv1;
+    if (++r->indx == maxd) r->indx = 0;
+    return (w*buf[v0] + x*buf[v1] + y*buf[v2] + z*buf[v3]) * fv1 + buf[v1];
+}
+
+static MYFLT ref_vdelayx(REF *r, MYFLT in, MYFLT del, double esr, int wsize)
+{
+    double x1, x2, w, d, d2x, n1 = 0.0;
+    int32_t i, i2 = wsize >> 1, xpos, maxd = r->maxd;
+    MYFLT  out, *buf = r->buf;
+
+    d2x = (1.0 - pow((double)wsize * 0.85172, -0.89624)) / (double)(i2 * i2);
+    buf[r->indx] = in;
+    x1 = (double)r->indx - ((double)del * esr);
+    while (x1 < 0.0) x1 += (double)maxd;
+    xpos = (int32_t)x1;
+    x1 -= (double)xpos;
+    x2 = sin(PI * x1) / PI;
+    while (xpos >= maxd) xpos -= maxd;
+    if (x1 * (1.0 - x1) > 0.00000001) {
+      xpos += (1 - i2);
+      while (xpos < 0) xpos += maxd;
+      d = (double)(1 - i2) - x1;
+      for (i = i2; i--;) {
+        w = 1.0 - d*d*d2x; w *= (w / d++);
+        n1 += (double)buf[xpos] * w;
+        if (++xpos >= maxd) xpos -= maxd;
+        w = 1.0 - d*d*d2x; w *= (w / d++);
+        n1 -= (double)buf[xpos] * w;
+        if (++xpos >= maxd) xpos -= maxd;
+      }
+      out = (MYFLT) (n1 * x2);
+    }
+    else {
+      xpos = (int32_t)((double)xpos + x1 + 0.5);
+      if (xpos >= maxd) xpos -= maxd;
+      out = buf[xpos];
+    }
+    if (++r->indx == maxd) r->indx = 0;
+    return out;
+}
+
+static MYFLT ref_vdelayxw(REF *r, MYFLT in, MYFLT del, double esr, int wsize)
+{
+    double x1, x2, w, d, d2x, n1;
+    int32_t i, i2 = wsize >> 1, xpos, maxd = r->maxd;
+    MYFLT  out, *buf = r->buf;
+
+    d2x = (1.0 - pow((double)wsize * 0.85172, -0.89624)) / (double)(i2 * i2);
+    x1 = (double)r->indx + ((double)del * esr);
+    while (x1 < 0.0) x1 += (double)maxd;
+    xpos = (int32_t)x1;
+    x1 -= (double)xpos;
+    x2 = sin(PI * x1) / PI;
+    while (xpos >= maxd) xpos -= maxd;
+    if (x1 * (1.0 - x1) > 0.00000001) {
+      n1 = (double)in * x2;
+      xpos += (1 - i2);
+      while (xpos < 0) xpos += maxd;
+      d = (double)(1 - i2) - x1;
+      for (i = i2; i--;) {
+        w = 1.0 - d*d*d2x; w *= (w / d++);
+        buf[xpos] += (MYFLT) (n1 * w);
+        if (++xpos >= maxd) xpos -= maxd;
+        w = 1.0 - d*d*d2x; w *= (w / d++);
+        buf[xpos] -= (MYFLT) (n1 * w);
+        if (++xpos >= maxd) xpos -= maxd;
+      }
+    }
+    else {
+      xpos = (int32_t)((double)xpos + x1 + 0.5);
+      if (xpos >= maxd) xpos -= maxd;
+      buf[xpos] += in;
+    }
+    out = buf[r->indx]; buf[r->indx] = FL(0.0);
+    if (++r->indx == maxd) r->indx = 0;
+    return out;
+}
+
+/* taps of delays del[] in seconds and gains gain[] */
+static MYFLT ref_multitap(REF *r, MYFLT in, const MYFLT *del,
+                          const MYFLT *gain, int ntaps, MYFLT esr)
+{
+    MYFLT  v = FL(0.0);
+    int32_t i, delay;
+
+    r->buf[r->indx] = in;
+    if (++r->indx == r->maxd) r->indx = 0;
+    for (i = 0; i < ntaps; i++) {
+      delay = r->indx - (int32_t)(esr * del[i]);
+      if (delay < 0) delay += r->maxd;
+      v += r->buf[delay] * gain[i];
+    }
+    return v;
+}
+
+/* vdelay3 with a k-rate delay, a block of n samples */
+static void ref_vdelay3k(REF *r, MYFLT *out, const MYFLT *in, MYFLT del,
+                         MYFLT esr, int n)
+{
+    MYFLT  fv1, w, x, y, z, *buf = r->buf;
+    int32_t v0, v1, v2, v3, maxd = r->maxd, i;
+
+    fv1 = del * -esr; v1 = (int32_t)fv1; fv1 -= (MYFLT) v1;
+    v1 += r->indx;
+    if ((v1 < 0) || (fv1 < FL(0.0))) {
+      fv1++; v1--; while (v1 < 0) v1 += maxd;
+    }
+    else {
+      while (v1 >= maxd) v1 -= maxd;
+    }
+    z = fv1 * fv1; z--; z *= FL(0.1666666667);
+    y = fv1; y++; w = (y *= FL(0.5)); w--;
+    x = FL(3.0) * z; y -= x; w -= z; x -= fv1;
+    for (i = 0; i < n; i++) {
+      buf[r->indx] = in[i];
+      v2 = (v1 == maxd - 1 ? 0 : v1 + 1);
+      v0 = (v1 == 0 ? maxd - 1 : v1 - 1);
+      v3 = (v2 == maxd - 1 ? 0 : v2 + 1);
+      out[i] = (w*buf[v0] + x*buf[v1] + y*buf[v2] + z*buf[v3]) * fv1 + buf[v1];
+      if (++v1 >= maxd) v1 -= maxd;
+      if (++r->indx >= maxd) r->indx -= maxd;
+    }
+}
+
+static const char *orc =
+    "sr = 44100\n"
+    "ksmps = 16\n"
+    "nchnls = 1\n"
+    "0dbfs = 1\n"
+    "instr 1\n"
+    "  ain chnget \"in\"\n"
+    "  adel chnget \"del\"\n"
+    "  asdel chnget \"sdel\"\n"
+    "  kdel chnget \"kdel\"\n"
+    "  a0 vdelay ain, adel, 50\n"
+    "  a1 vdelay ain, kdel, 50\n"
+    "  a2 vdelay3 ain, adel, 50\n"
+    "  a3 vdelay3 ain, kdel, 50\n"
+    "  a4 vdelayx ain, asdel, 0.05, 8\n"
+    "  a5 vdelayxw ain, asdel, 0.05, 8\n"
+    "  a6 vdelayx ain, asdel, 0.0001, 8\n"
+    "  a7 multitap ain, 0.001, 0.5, 0.0123, 0.3, 0.05, 0.2\n"
+    "  chnset a0, \"o0\"\n"
+    "  chnset a1, \"o1\"\n"
+    "  chnset a2, \"o2\"\n"
+    "  chnset a3, \"o3\"\n"
+    "  chnset a4, \"o4\"\n"
+    "  chnset a5, \"o5\"\n"
+    "  chnset a6, \"o6\"\n"
+    "  chnset a7, \"o7\"\n"
+    "endin\n";
+
+static uint32_t seed = 12345;
+
+static MYFLT noise(void)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return (MYFLT) (seed >> 8) / (MYFLT) (1 << 24) * FL(2.0) - FL(1.0);
+}
+
+void test_vdelay_bit_exact(void)
+{
+    CSOUND *csound;
+    REF    r[8];
+    MYFLT  in[16], adel[16], sdel[16], kdel, o[8][16], ref3[16];
+    MYFLT  sr = FL(44100.0), esr = sr * FL(0.001);
+    MYFLT  tdel[3] = { FL(0.001), FL(0.0123), FL(0.05) };
+    MYFLT  tgain[3] = { FL(0.5), FL(0.3), FL(0.2) };
+    int32_t maxd = (int32_t) (FL(50.0) * esr);
+    int32_t maxx = (int32_t) (FL(0.05) * sr);
+    int32_t shortx = (int32_t) (FL(0.0001) * sr);
+    int    blk, i, k, t, bad[8] = { 0 };
+    char   name[8];
+
+    csoundSetGlobalEnv("OPCODE6DIR64", "../../");
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "-d");
+    CU_ASSERT_FATAL(csoundCompileOrc(csound, orc) == 0);
+    csoundReadScore(csound, "i1 0 10");
+    CU_ASSERT_FATAL(csoundStart(csound) == 0);
+    CU_ASSERT_EQUAL_FATAL(csoundGetKsmps(csound), 16);
+
+    for (k = 0; k < 4; k++)
+      ref_init(&r[k], maxd, maxd + 1);
+    ref_init(&r[4], maxx, maxx);
+    ref_init(&r[5], maxx, maxx);
+    ref_init(&r[6], shortx, shortx);
+    ref_init(&r[7], maxx, maxx);
+
+    for (blk = 0; blk < 2000; blk++) {
+      for (i = 0; i < 16; i++) {
+        t = blk * 16 + i;
+        in[i] = noise();
+        /* a wandering delay, with some outside the lines and integers */
+        adel[i] = FL(25.0) + FL(24.0) * sin(t * 0.001) + noise() * FL(3.0);
+        if (t % 997 == 0) adel[i] = FL(-3.7);
+        if (t % 1499 == 0) adel[i] = FL(120.3);
+        if (t % 501 == 0) adel[i] = FL(12.0);
+        sdel[i] = adel[i] * FL(0.001);
+      }
+      kdel = adel[0];
+      csoundSetAudioChannel(csound, "in", in);
+      csoundSetAudioChannel(csound, "del", adel);
+      csoundSetAudioChannel(csound, "sdel", sdel);
+      csoundSetControlChannel(csound, "kdel", kdel);
+      CU_ASSERT_EQUAL_FATAL(csoundPerformKsmps(csound), 0);
+      for (k = 0; k < 8; k++) {
+        snprintf(name, sizeof(name), "o%d", k);
+        csoundGetAudioChannel(csound, name, o[k]);
+      }
+      ref_vdelay3k(&r[3], ref3, in, kdel, esr, 16);
+      for (i = 0; i < 16; i++) {
+        bad[0] += o[0][i] != ref_vdelay(&r[0], in[i], adel[i], esr);
+        bad[1] += o[1][i] != ref_vdelay(&r[1], in[i], kdel, esr);
+        bad[2] += o[2][i] != ref_vdelay3(&r[2], in[i], adel[i], esr);
+        bad[3] += o[3][i] != ref3[i];
+        bad[4] += o[4][i] != ref_vdelayx(&r[4], in[i], sdel[i], sr, 8);
+        bad[5] += o[5][i] != ref_vdelayxw(&r[5], in[i], sdel[i], sr, 8);
+        bad[6] += o[6][i] != ref_vdelayx(&r[6], in[i], sdel[i], sr, 8);
+        bad[7] += o[7][i] != ref_multitap(&r[7], in[i], tdel, tgain, 3, sr);
+      }
+    }
+    for (k = 0; k < 8; k++) {
+      if (bad[k])
+        printf("\noutput o%d differs in %d samples\n", k, bad[k]);
+      CU_ASSERT_EQUAL(bad[k], 0);
+      free(r[k].buf);
+    }
+    csoundCleanup(csound);
+    csoundDestroy(csound);
+}
+
+int main()
+{
+    CU_pSuite pSuite = NULL;
+
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("delay line tests", init_suite1, clean_suite1);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* add the tests to the suite */
+    if (NULL == CU_add_test(pSuite, "Test the vdelay family bit for bit",
+                            test_vdelay_bit_exact))
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    return CU_get_error();
+}
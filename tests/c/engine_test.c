@@ -54,6 +54,58 @@ void test_compile_async(void)
     csoundDestroy(csound);
 }
 
+/* jumps, loops and turnoff in an instrument and in a UDO, the opcodes
+   the perf chain loop keeps ip->pds current for */
+void test_control_flow(void)
+{
+    CSOUND  *csound;
+    int     i, err;
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-n");
+    CU_ASSERT(csoundCompileOrc(csound,
+                               "ksmps = 10\n"
+                               "opcode count, k, k\n"
+                               "  kn xin\n"
+                               "  kc = 0\n"
+                               "  ki = 0\n"
+                               "loop:\n"
+                               "  kc += 1\n"
+                               "  loop_lt ki, 1, kn, loop\n"
+                               "  xout kc\n"
+                               "endop\n"
+                               "instr 1\n"
+                               "  kcnt init 0\n"
+                               "  kx count 5\n"
+                               "  chnset kx, \"udo\"\n"
+                               "  if kx != 5 kgoto skip\n"
+                               "  kcnt += 1\n"
+                               "skip:\n"
+                               "  chnset kcnt, \"cycles\"\n"
+                               "  kj = 0\n"
+                               "  ksum = 0\n"
+                               "sum:\n"
+                               "  ksum += kj\n"
+                               "  loop_lt kj, 1, 4, sum\n"
+                               "  chnset ksum, \"sum\"\n"
+                               "  if kcnt == 3 then\n"
+                               "    turnoff\n"
+                               "  endif\n"
+                               "  kafter init 0\n"
+                               "  kafter += 1\n"
+                               "  chnset kafter, \"after\"\n"
+                               "endin\n") == 0);
+    csoundReadScore(csound, "i1 0 1");
+    CU_ASSERT(csoundStart(csound) == 0);
+    for (i = 0; i < 10; i++)
+      csoundPerformKsmps(csound);
+    CU_ASSERT_EQUAL(csoundGetControlChannel(csound, "udo", &err), 5.0);
+    CU_ASSERT_EQUAL(csoundGetControlChannel(csound, "cycles", &err), 3.0);
+    CU_ASSERT_EQUAL(csoundGetControlChannel(csound, "sum", &err), 6.0);
+    /* turnoff stopped the third k-cycle before the last opcodes */
+    CU_ASSERT_EQUAL(csoundGetControlChannel(csound, "after", &err), 2.0);
+    csoundDestroy(csound);
+}
+
 int main()
 {
     CU_pSuite pSuite = NULL;
@@ -73,6 +125,8 @@ int main()
     if ((NULL == CU_add_test(pSuite, "Test daemon mode", test_daemon))
         || (NULL == CU_add_test(pSuite, "Test evalcode", test_eval_code))
 	|| (NULL == CU_add_test(pSuite, "Test compileAsync", test_compile_async)) 
+        || (NULL == CU_add_test(pSuite, "Test perf-time control flow",
+                                test_control_flow))
 	)
     {
         CU_cleanup_registry();
@@ -0,0 +1,175 @@
+/*
+ * File:   fastmath_test.c
+ *
+ * The a-rate math kernels of -+fast_math (H/fastmath.h) against the
+ * k-rate opcodes, which call libm, and the GEN09, GEN10 and GEN19
+ * harmonic sums (Engine/fgens.c).
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "csound.h"
+#include "CUnit/Basic.h"
+
+/* the errors allowed, of a few thousand ulps of MYFLT */
+#ifdef USE_DOUBLE
+#define MATH_TOL  1.0e-12
+#define GEN_TOL   1.0e-11
+#else
+#define MATH_TOL  1.0e-5
+#define GEN_TOL   1.0e-5
+#endif
+
+int init_suite1(void)
+{
+    return 0;
+}
+
+int clean_suite1(void)
+{
+    return 0;
+}
+
+static const char *orc =
+    "0dbfs = 1\n"
+    "nchnls = 1\n"
+    "ksmps = 16\n"
+    "gitab10 ftgen 1, 0, 16384, 10, 1, 0.5, 0.3, 0, 0.2\n"
+    "gitab09 ftgen 2, 0, 16384, 9, 1, 1, 0, 2, 0.5, 0, 3, 0.3, 0, "
+    "5, 0.2, 0\n"
+    "gitab19 ftgen 3, 0, 16384, 19, 1, 1, 0, 0, 2, 0.5, 0, 0, 3, 0.3, 0, 0, "
+    "5, 0.2, 0, 0\n"
+    /* not normalised, so that they hold the sums as GEN10 left them */
+    "girawp2 ftgen 4, 0, 16384, -10, 1, 0.5, 0.3, 0, 0.2\n"
+    "giraw ftgen 5, 0, 1000, -10, 1, 0.5, 0.3, 0, 0.2\n"
+    "instr 1\n"
+    "  kx line -3, p3, 3\n"
+    "  ax = kx\n"
+    "  ky = abs(kx) + 0.01\n"
+    "  ay = ky\n"
+    "  k1 = abs(k(exp(ax)) - exp(kx)) / exp(kx)\n"
+    "  k2 = abs(k(log(ay)) - log(ky))\n"
+    "  k3 = abs(k(sin(ax)) - sin(kx)) + abs(k(cos(ax)) - cos(kx))\n"
+    "  k4 = abs(k(ampdb(ax * 10)) - ampdb(kx * 10)) / ampdb(kx * 10)\n"
+    "  k5 = abs(k(powoftwo(ax)) - powoftwo(kx)) / powoftwo(kx)\n"
+    "  k6 = abs(k(pow(ay, 2.5)) - pow(ky, 2.5)) / pow(ky, 2.5)\n"
+    "  kmax init 0\n"
+    "  kmax max kmax, k1, k2, k3, k4, k5, k6\n"
+    "  chnset kmax, \"math\"\n"
+    "endin\n";
+
+void test_arate_math(void)
+{
+    CSOUND *csound;
+    MYFLT  err;
+    int    res;
+
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "-+fast_math=yes");
+    CU_ASSERT(csoundCompileOrc(csound, orc) == 0);
+    csoundReadScore(csound, "i1 0 0.1");
+    CU_ASSERT_FATAL(csoundStart(csound) == 0);
+    while (csoundPerformKsmps(csound) == 0) ;
+
+    err = csoundGetControlChannel(csound, "math", &res);
+    CU_ASSERT_EQUAL(res, CSOUND_SUCCESS);
+    if (!(err < MATH_TOL))
+      printf("\na-rate math differs from libm by %g\n", err);
+    CU_ASSERT(err < MATH_TOL);
+    csoundDestroy(csound);
+}
+
+/* the largest difference between two tables of n points */
+static double table_error(MYFLT *a, MYFLT *b, int n)
+{
+    double e = 0.0;
+    int    i;
+
+    for (i = 0; i < n; i++)
+      if (!(fabs(a[i] - b[i]) <= e))
+        e = fabs(a[i] - b[i]);
+    return e;
+}
+
+/* the number of points of the table that are not the sum GEN10 used to
+   compute, one sin() per point, highest harmonic first */
+static int gen10_mismatches(MYFLT *tab, int flen)
+{
+    const MYFLT amps[] = { 1.0, 0.5, 0.3, 0.0, 0.2 };
+    double tpdlen = 2.0 * M_PI / (double) flen;
+    MYFLT  sum;
+    int    h, n, bad = 0;
+
+    for (n = 0; n <= flen; n++) {
+      sum = 0.0;
+      for (h = 5; h > 0; h--)
+        if (amps[h - 1] != 0.0)
+          sum += (MYFLT) sin((double) ((n * h) % flen) * tpdlen) * amps[h - 1];
+      if (tab[n] != sum)
+        bad++;
+    }
+    return bad;
+}
+
+void test_gen_sums(void)
+{
+    CSOUND *csound;
+    MYFLT  *tab10, *tab09, *tab19, *tab;
+    double e09, e19;
+
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-n");
+    CU_ASSERT(csoundCompileOrc(csound, orc) == 0);
+    CU_ASSERT_FATAL(csoundStart(csound) == 0);
+
+    /* GEN09 and GEN19 against GEN10 for the same partials */
+    CU_ASSERT_FATAL(csoundGetTable(csound, &tab10, 1) == 16384);
+    CU_ASSERT_FATAL(csoundGetTable(csound, &tab09, 2) == 16384);
+    CU_ASSERT_FATAL(csoundGetTable(csound, &tab19, 3) == 16384);
+    e09 = table_error(tab09, tab10, 16385);
+    e19 = table_error(tab19, tab10, 16385);
+    if (!(e09 < GEN_TOL) || !(e19 < GEN_TOL))
+      printf("\nGEN09 %g and GEN19 %g differ from GEN10\n", e09, e19);
+    CU_ASSERT(e09 < GEN_TOL);
+    CU_ASSERT(e19 < GEN_TOL);
+
+    /* GEN10 is unchanged, for both the power of two and the other sizes */
+    CU_ASSERT_FATAL(csoundGetTable(csound, &tab, 4) == 16384);
+    CU_ASSERT_EQUAL(gen10_mismatches(tab, 16384), 0);
+    CU_ASSERT_FATAL(csoundGetTable(csound, &tab, 5) == 1000);
+    CU_ASSERT_EQUAL(gen10_mismatches(tab, 1000), 0);
+    csoundDestroy(csound);
+}
+
+int main()
+{
+    CU_pSuite pSuite = NULL;
+
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("fast math tests", init_suite1, clean_suite1);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* add the tests to the suite */
+    if ((NULL == CU_add_test(pSuite, "Test a-rate math against libm",
+                             test_arate_math)) ||
+        (NULL == CU_add_test(pSuite, "Test GEN harmonic sums",
+                             test_gen_sums)))
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    return CU_get_error();
+}
@@ -0,0 +1,99 @@
+/*
+ * File:   filtcoefs_test.c
+ *
+ * The tangent and cosine used for a-rate filter coefficients
+ * (H/filtcoefs.h, H/fastmath.h) against libm, over the arguments of
+ * audio frequencies.
+ */
+
+#define __BUILDING_LIBCSOUND
+
+#include <stdio.h>
+#include <math.h>
+#include "csoundCore.h"
+#include "../../H/filtcoefs.h"
+#include "CUnit/Basic.h"
+
+int init_suite1(void)
+{
+    return 0;
+}
+
+int clean_suite1(void)
+{
+    return 0;
+}
+
+/* the error of x in ulps of the exact value y */
+static double ulps(double x, double y)
+{
+    double u = nextafter(fabs(y), HUGE_VAL) - fabs(y);
+    return fabs(x - y) / u;
+}
+
+void test_filt_tan_cos(void)
+{
+    const double srs[] = { 8000.0, 22050.0, 44100.0, 48000.0, 96000.0,
+                           192000.0 };
+    double etan = 0.0, ecos = 0.0, e, x, c;
+    int    s, i, n = 200000;
+
+    for (s = 0; s < 6; s++)
+      for (i = 0; i < n; i++) {
+        /* PI*f/sr for butterworth filters, 2*PI*f/sr for the others,
+           for f from 0 to Nyquist */
+        x = PI * (0.5 * srs[s] * i / n) / srs[s];
+        e = ulps(filt_tan(x), tan(x));
+        if (e > etan) etan = e;
+        c = cos(2.0 * x);
+        /* near its zero the cosine is accurate to 2^-52 absolute */
+        e = fabs(c) < 0.5 ? fabs(fm_cos(2.0 * x) - c) / ldexp(1.0, -52) :
+                            ulps(fm_cos(2.0 * x), c);
+        if (e > ecos) ecos = e;
+      }
+    if (!(etan <= 2.0) || !(ecos <= 1.0))
+      printf("\nfilt_tan %g ulps, fm_cos %g ulps\n", etan, ecos);
+    CU_ASSERT(etan <= 2.0);
+    CU_ASSERT(ecos <= 1.0);
+
+    /* arguments of a few thousand, away from the poles */
+    etan = 0.0;
+    for (i = 1; i < n; i++) {
+      x = i * 0.015;
+      if (fabs(tan(x)) > 1.0e6) continue;
+      e = ulps(filt_tan(x), tan(x));
+      if (e > etan) etan = e;
+    }
+    CU_ASSERT(etan <= 2.0);
+}
+
+int main()
+{
+    CU_pSuite pSuite = NULL;
+
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("filter coefficient tests",
+                          init_suite1, clean_suite1);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* add the tests to the suite */
+    if (NULL == CU_add_test(pSuite, "Test filt_tan and fm_cos against libm",
+                            test_filt_tan_cos))
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    return CU_get_error();
+}
@@ -0,0 +1,131 @@
+/*
+ * File:   filterbank_test.c
+ *
+ * The array filter banks (Opcodes/filterbank.h) against the scalar
+ * filter of each of their channels.
+ */
+
+#include <stdio.h>
+#include "csound.h"
+#include "CUnit/Basic.h"
+
+int init_suite1(void)
+{
+    return 0;
+}
+
+int clean_suite1(void)
+{
+    return 0;
+}
+
+/* each output of each bank, with the scalar filter that computes it */
+static const char *outputs[][2] = {
+    { "alp", "butterlp" }, { "ahp", "butterhp" }, { "abq", "biquad" },
+    { "aml", "moogladder" }, { "alo", "svfilter lowpass" },
+    { "ahi", "svfilter highpass" }, { "abd", "svfilter bandpass" }
+};
+
+#define NOUTS   7
+#define NCHNLS  3
+
+void test_filterbanks(void)
+{
+    const char *head =
+      "0dbfs = 1\n"
+      "nchnls = 1\n"
+      "ksmps = 16\n"
+      "instr 1\n"
+      "  ain[] init 3\n"
+      "  ain[0] poscil 0.5, 110\n"
+      "  ain[1] poscil 0.5, 220\n"
+      "  ain[2] rand 0.5\n"
+      "  alp[] butterlp ain, 800\n"
+      "  ahp[] butterhp ain, 800\n"
+      "  abq[] biquad ain, 0.2, 0.4, 0.2, 1, -0.3, 0.1\n"
+      "  aml[] moogladder ain, 1200, 0.5\n"
+      "  alo[], ahi[], abd[] svfilter ain, 1000, 2\n";
+    char   orc[8192], name[64];
+    size_t len;
+    CSOUND *csound;
+    int    c, i, err;
+
+    /* the scalar filters of every channel, and the largest difference
+       of every output, which peak holds, on a channel of its own */
+    len = snprintf(orc, sizeof(orc), "%s", head);
+    for (c = 0; c < NCHNLS; c++) {
+      len += snprintf(orc + len, sizeof(orc) - len,
+                      "  alp%d butterlp ain[%d], 800\n"
+                      "  ahp%d butterhp ain[%d], 800\n"
+                      "  abq%d biquad ain[%d], 0.2, 0.4, 0.2, 1, -0.3, 0.1\n"
+                      "  aml%d moogladder ain[%d], 1200, 0.5\n"
+                      "  alo%d, ahi%d, abd%d svfilter ain[%d], 1000, 2\n"
+                      "  klevel%d peak alp%d\n"
+                      "  chnset klevel%d, \"level%d\"\n",
+                      c, c, c, c, c, c, c, c, c, c, c, c, c, c, c, c);
+      for (i = 0; i < NOUTS; i++)
+        len += snprintf(orc + len, sizeof(orc) - len,
+                        "  k%s%d peak %s[%d] - %s%d\n"
+                        "  chnset k%s%d, \"%s%d\"\n",
+                        outputs[i][0], c, outputs[i][0], c, outputs[i][0], c,
+                        outputs[i][0], c, outputs[i][0], c);
+    }
+    len += snprintf(orc + len, sizeof(orc) - len, "endin\n");
+    CU_ASSERT_FATAL(len < sizeof(orc));
+
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-n");
+    CU_ASSERT(csoundCompileOrc(csound, orc) == 0);
+    csoundReadScore(csound, "i1 0 0.1");
+    CU_ASSERT_FATAL(csoundStart(csound) == 0);
+    while (csoundPerformKsmps(csound) == 0) ;
+
+    for (c = 0; c < NCHNLS; c++) {
+      /* the filters have run on a signal */
+      snprintf(name, sizeof(name), "level%d", c);
+      CU_ASSERT(csoundGetControlChannel(csound, name, &err) > 0.01);
+      /* each bank computes the recurrence of its scalar filter in the
+         same order, for every channel */
+      for (i = 0; i < NOUTS; i++) {
+        MYFLT e;
+        snprintf(name, sizeof(name), "%s%d", outputs[i][0], c);
+        e = csoundGetControlChannel(csound, name, &err);
+        CU_ASSERT_EQUAL(err, CSOUND_SUCCESS);
+        if (!(e <= 1e-12))
+          printf("\n%s, channel %d: bank differs from the scalar filter "
+                 "by %g\n", outputs[i][1], c, e);
+        CU_ASSERT(e <= 1e-12);
+      }
+    }
+    csoundDestroy(csound);
+}
+
+int main()
+{
+    CU_pSuite pSuite = NULL;
+
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("Filter bank tests", init_suite1, clean_suite1);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* add the tests to the suite */
+    if (NULL == CU_add_test(pSuite, "Test filter banks against scalar filters",
+                            test_filterbanks))
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    return CU_get_error();
+}
@@ -0,0 +1,229 @@
+/*
+ * File:   hash_table_bench.c
+ *
+ * Compares CS_HASH_TABLE with the chained table it replaced (copied
+ * below) on inserts, successful and failed lookups, and iteration, for
+ * keys like the names of opcodes, channels and variables.
+ *
+ * usage: benchHashTable [nkeys [rounds]]
+ */
+
+#define __BUILDING_LIBCSOUND
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "csoundCore.h"
+
+/* the previous implementation: 8192 chained buckets, shift-xor hash */
+
+typedef struct chain_item {
+    char *key;
+    void *value;
+    struct chain_item *next;
+} CHAIN_ITEM;
+
+typedef struct {
+    int size, count;
+    CHAIN_ITEM **buckets;
+} CHAIN_TABLE;
+
+static unsigned int chain_hash(CHAIN_TABLE *t, const char *s)
+{
+    unsigned int h = 0;
+    while (*s != '\0')
+      h = (h << 4) ^ *s++;
+    return h % t->size;
+}
+
+static CHAIN_TABLE *chain_create(void)
+{
+    CHAIN_TABLE *t = calloc(1, sizeof(CHAIN_TABLE));
+    t->size = 8192;
+    t->buckets = calloc(t->size, sizeof(CHAIN_ITEM *));
+    return t;
+}
+
+static void *chain_get(CHAIN_TABLE *t, const char *key)
+{
+    CHAIN_ITEM *item = t->buckets[chain_hash(t, key)];
+    for ( ; item != NULL; item = item->next)
+      if (strcmp(key, item->key) == 0) return item->value;
+    return NULL;
+}
+
+static void chain_put(CHAIN_TABLE *t, const char *key, void *value);
+
+static void chain_resize(CHAIN_TABLE *t)
+{
+    CHAIN_ITEM **old = t->buckets;
+    int i, oldSize = t->size;
+    t->size *= 2;
+    t->count = 0;
+    t->buckets = calloc(t->size, sizeof(CHAIN_ITEM *));
+    for (i = 0; i < oldSize; i++) {
+      CHAIN_ITEM *item = old[i], *next;
+      for ( ; item != NULL; item = next) {
+        next = item->next;
+        chain_put(t, item->key, item->value);
+        free(item->key);
+        free(item);
+      }
+    }
+    free(old);
+}
+
+static void chain_put(CHAIN_TABLE *t, const char *key, void *value)
+{
+    unsigned int h = chain_hash(t, key);
+    CHAIN_ITEM *item = t->buckets[h], *n;
+    for ( ; item != NULL; item = item->next)
+      if (strcmp(key, item->key) == 0) {
+        item->value = value;
+        return;
+      }
+    if (t->count + 1 > t->size * 0.75) {
+      chain_resize(t);
+      h = chain_hash(t, key);
+    }
+    n = malloc(sizeof(CHAIN_ITEM));
+    n->key = strdup(key);
+    n->value = value;
+    n->next = t->buckets[h];
+    t->buckets[h] = n;
+    t->count++;
+}
+
+static void chain_free(CHAIN_TABLE *t)
+{
+    int i;
+    for (i = 0; i < t->size; i++) {
+      CHAIN_ITEM *item = t->buckets[i], *next;
+      for ( ; item != NULL; item = next) {
+        next = item->next;
+        free(item->key);
+        free(item);
+      }
+    }
+    free(t->buckets);
+    free(t);
+}
+
+/* keys in the style of orchestra names, shuffled so that lookups do
+   not follow the insertion order */
+static char **make_keys(int n, const char *prefix)
+{
+    static const char *stems[] = { "gkfreq", "asig", "chn_level", "kenv",
+                                   "reverb_send", "moogladder", "oscili" };
+    char **keys = malloc(n * sizeof(char *)), buf[64];
+    int i;
+    for (i = 0; i < n; i++) {
+      snprintf(buf, sizeof(buf), "%s%s_%d", prefix, stems[i % 7], i);
+      keys[i] = strdup(buf);
+    }
+    for (i = n - 1; i > 0; i--) {
+      int j = rand() % (i + 1);
+      char *tmp = keys[i];
+      keys[i] = keys[j];
+      keys[j] = tmp;
+    }
+    return keys;
+}
+
+int main(int argc, char **argv)
+{
+    int nkeys = argc > 1 ? atoi(argv[1]) : 4096;
+    int rounds = argc > 2 ? atoi(argv[2]) : 200;
+    char **keys = make_keys(nkeys, ""), **missing = make_keys(nkeys, "x");
+    RTCLOCK timer;
+    double t_put[2], t_hit[2], t_miss[2], t_iter[2];
+    long found = 0;
+    int i, r;
+    CSOUND *csound;
+
+    csoundInitialize(CSOUNDINIT_NO_ATEXIT);
+    csound = csoundCreate(NULL);
+
+    /* chained */
+    {
+      CHAIN_TABLE *t = NULL;
+      csoundInitTimerStruct(&timer);
+      for (r = 0; r < rounds; r++) {
+        if (t != NULL) chain_free(t);
+        t = chain_create();
+        for (i = 0; i < nkeys; i++) chain_put(t, keys[i], keys[i]);
+      }
+      t_put[0] = csoundGetRealTime(&timer);
+      csoundInitTimerStruct(&timer);
+      for (r = 0; r < rounds; r++)
+        for (i = 0; i < nkeys; i++) found += chain_get(t, keys[i]) != NULL;
+      t_hit[0] = csoundGetRealTime(&timer);
+      csoundInitTimerStruct(&timer);
+      for (r = 0; r < rounds; r++)
+        for (i = 0; i < nkeys; i++) found += chain_get(t, missing[i]) != NULL;
+      t_miss[0] = csoundGetRealTime(&timer);
+      csoundInitTimerStruct(&timer);
+      for (r = 0; r < rounds; r++)
+        for (i = 0; i < t->size; i++) {
+          CHAIN_ITEM *item;
+          for (item = t->buckets[i]; item != NULL; item = item->next)
+            found += item->value != NULL;
+        }
+      t_iter[0] = csoundGetRealTime(&timer);
+      chain_free(t);
+    }
+
+    /* open addressing */
+    {
+      CS_HASH_TABLE *t = NULL;
+      void *value;
+      int pos;
+      csoundInitTimerStruct(&timer);
+      for (r = 0; r < rounds; r++) {
+        if (t != NULL) cs_hash_table_free(csound, t);
+        t = cs_hash_table_create(csound);
+        for (i = 0; i < nkeys; i++)
+          cs_hash_table_put(csound, t, keys[i], keys[i]);
+      }
+      t_put[1] = csoundGetRealTime(&timer);
+      csoundInitTimerStruct(&timer);
+      for (r = 0; r < rounds; r++)
+        for (i = 0; i < nkeys; i++)
+          found += cs_hash_table_get(csound, t, keys[i]) != NULL;
+      t_hit[1] = csoundGetRealTime(&timer);
+      csoundInitTimerStruct(&timer);
+      for (r = 0; r < rounds; r++)
+        for (i = 0; i < nkeys; i++)
+          found += cs_hash_table_get(csound, t, missing[i]) != NULL;
+      t_miss[1] = csoundGetRealTime(&timer);
+      csoundInitTimerStruct(&timer);
+      for (r = 0; r < rounds; r++)
+        for (pos = 0; cs_hash_table_next(t, &pos, NULL, &value); )
+          found += value != NULL;
+      t_iter[1] = csoundGetRealTime(&timer);
+      cs_hash_table_free(csound, t);
+    }
+
+    printf("%d keys x %d rounds (%ld)\n", nkeys, rounds, found);
+    printf("%-10s %12s %12s\n", "ns/op", "chained", "open");
+    printf("%-10s %12.1f %12.1f\n", "put",
+           t_put[0] * 1e9 / ((double) nkeys * rounds),
+           t_put[1] * 1e9 / ((double) nkeys * rounds));
+    printf("%-10s %12.1f %12.1f\n", "get hit",
+           t_hit[0] * 1e9 / ((double) nkeys * rounds),
+           t_hit[1] * 1e9 / ((double) nkeys * rounds));
+    printf("%-10s %12.1f %12.1f\n", "get miss",
+           t_miss[0] * 1e9 / ((double) nkeys * rounds),
+           t_miss[1] * 1e9 / ((double) nkeys * rounds));
+    printf("%-10s %12.1f %12.1f\n", "iterate",
+           t_iter[0] * 1e9 / ((double) nkeys * rounds),
+           t_iter[1] * 1e9 / ((double) nkeys * rounds));
+    csoundDestroy(csound);
+    for (i = 0; i < nkeys; i++) {
+      free(keys[i]);
+      free(missing[i]);
+    }
+    free(keys);
+    free(missing);
+    return 0;
+}
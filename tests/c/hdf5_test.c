@@ -0,0 +1,115 @@
+/*
+ * File:   hdf5_test.c
+ *
+ * Signals written with hdf5write and read back with hdf5read
+ * (Opcodes/hdf5/HDF5IO.c), with chunks and a lookahead smaller than a
+ * control period, so that the performance pass does the file i/o itself
+ * whenever the i/o thread is behind.
+ */
+
+#include <stdio.h>
+#include "csound.h"
+#include "CUnit/Basic.h"
+
+int init_suite1(void)
+{
+    return 0;
+}
+
+int clean_suite1(void)
+{
+    remove("hdf5_roundtrip.h5");
+    return 0;
+}
+
+static const char *write_orc =
+    "ksmps = 64\n"
+    "instr 1\n"
+    "  asig phasor 100\n"
+    "  kcnt init 0\n"
+    "  kcnt += 1\n"
+    "  hdf5write \"hdf5_roundtrip.h5\", asig, kcnt\n"
+    "endin\n";
+
+static const char *read_orc =
+    "ksmps = 64\n"
+    "instr 1\n"
+    "  asig, kcnt hdf5read \"hdf5_roundtrip.h5\", \"asig\", \"kcnt\"\n"
+    "  aref phasor 100\n"
+    "  kref init 0\n"
+    "  kref += 1\n"
+    "  kaerr peak asig - aref\n"
+    "  kkerr init 0\n"
+    "  kkerr max kkerr, abs(kcnt - kref)\n"
+    "  chnset kaerr, \"aerr\"\n"
+    "  chnset kkerr, \"kerr\"\n"
+    "  chnset kcnt, \"kcnt\"\n"
+    "endin\n";
+
+static CSOUND *create(void)
+{
+    CSOUND *csound;
+    csoundSetGlobalEnv("OPCODE6DIR64", "../../");
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "-+hdf5_chunk=16");
+    csoundSetOption(csound, "-+hdf5_lookahead=16");
+    return csound;
+}
+
+void test_write_read(void)
+{
+    CSOUND *csound;
+    int    err;
+
+    csound = create();
+    CU_ASSERT_FATAL(csoundCompileOrc(csound, write_orc) == 0);
+    csoundReadScore(csound, "i1 0 0.5");
+    CU_ASSERT_FATAL(csoundStart(csound) == 0);
+    while (csoundPerformKsmps(csound) == 0) ;
+    csoundCleanup(csound);
+    csoundDestroy(csound);
+
+    csound = create();
+    CU_ASSERT_FATAL(csoundCompileOrc(csound, read_orc) == 0);
+    csoundReadScore(csound, "i1 0 0.5");
+    CU_ASSERT_FATAL(csoundStart(csound) == 0);
+    while (csoundPerformKsmps(csound) == 0) ;
+    /* every sample and control value as written */
+    CU_ASSERT(csoundGetControlChannel(csound, "kcnt", &err) > 300.0);
+    CU_ASSERT_EQUAL(err, CSOUND_SUCCESS);
+    CU_ASSERT_EQUAL(csoundGetControlChannel(csound, "aerr", &err), 0.0);
+    CU_ASSERT_EQUAL(csoundGetControlChannel(csound, "kerr", &err), 0.0);
+    csoundCleanup(csound);
+    csoundDestroy(csound);
+}
+
+int main()
+{
+    CU_pSuite pSuite = NULL;
+
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("hdf5 opcode tests", init_suite1, clean_suite1);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* add the tests to the suite */
+    if (NULL == CU_add_test(pSuite, "Test hdf5write and hdf5read round trip",
+                            test_write_read))
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    return CU_get_error();
+}
@@ -1,5 +1,8 @@
 #include "csound.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
 
 #include <CUnit/Basic.h>
 
@@ -283,6 +286,109 @@ void test_midi_hostbased(void)
     csoundReset(csound);
 }
 
+void test_fout_columns(void)
+{
+    CSOUND  *csound;
+    FILE    *f;
+    uint32_t hdr[4], n, i;
+    double  sr;
+    float   *data;
+    csound = csoundCreate(NULL);
+    const char  *instrument =
+            "ksmps = 10\n"
+            "instr 1 \n"
+            "a1 = 1\n"
+            "a2 = 2\n"
+            "fout \"fout_columns.bin\", 52, a1, a2\n"
+            "endin \n";
+    csoundSetOption(csound, "-n");
+    csoundCompileOrc(csound, instrument);
+    csoundReadScore(csound, "i 1 0 0.01");
+    int ret = csoundStart(csound);
+    CU_ASSERT(ret == 0);
+    ret = csoundPerform(csound);
+    CU_ASSERT(ret > 0);
+    csoundReset(csound);
+    csoundDestroy(csound);
+
+    f = fopen("fout_columns.bin", "rb");
+    CU_ASSERT_PTR_NOT_NULL(f);
+    if (f == NULL) return;
+    CU_ASSERT(fread(hdr, sizeof(uint32_t), 4, f) == 4);
+    CU_ASSERT(memcmp(hdr, "CSCF", 4) == 0);
+    CU_ASSERT(hdr[1] == 1 && hdr[2] == 2 && hdr[3] == sizeof(float));
+    CU_ASSERT(fread(&sr, sizeof(double), 1, f) == 1);
+    CU_ASSERT_DOUBLE_EQUAL(sr, 44100.0, 0.001);
+    CU_ASSERT(fread(&n, sizeof(uint32_t), 1, f) == 1);
+    CU_ASSERT(n > 0 && n <= 450);
+    data = (float *) malloc(2 * n * sizeof(float));
+    CU_ASSERT(fread(data, sizeof(float), 2 * n, f) == 2 * n);
+    for (i = 0; i < n; i++) {
+      CU_ASSERT_DOUBLE_EQUAL(data[i], 1.0, 0.0001);
+      CU_ASSERT_DOUBLE_EQUAL(data[n + i], 2.0, 0.0001);
+    }
+    free(data);
+    fclose(f);
+    remove("fout_columns.bin");
+}
+
+/* instances writing a file in another format, or with another number of
+   columns, fail at init and leave it as the first one writes it */
+void test_fout_mismatch(void)
+{
+    CSOUND  *csound;
+    FILE    *f;
+    uint32_t hdr[4], n, i, frames = 0;
+    double  sr;
+    float   v[2];
+    int     bad = 0;
+    csound = csoundCreate(NULL);
+    const char  *instrument =
+            "ksmps = 10\n"
+            "instr 1 \n"
+            "a1 = 1\n"
+            "a2 = 2\n"
+            "fout \"fout_mismatch.bin\", 52, a1, a2\n"
+            "endin \n"
+            "instr 2 \n"
+            "a1 = 3\n"
+            "fout \"fout_mismatch.bin\", 52, a1\n"
+            "endin \n"
+            "instr 3 \n"
+            "a1 = 4\n"
+            "a2 = 5\n"
+            "fout \"fout_mismatch.bin\", 51, a1, a2\n"
+            "endin \n";
+    csoundSetOption(csound, "-n");
+    csoundCompileOrc(csound, instrument);
+    csoundReadScore(csound, "i 1 0 0.01\ni 2 0 0.01\ni 3 0 0.01");
+    int ret = csoundStart(csound);
+    CU_ASSERT(ret == 0);
+    ret = csoundPerform(csound);
+    CU_ASSERT(ret > 0);
+    csoundReset(csound);
+    csoundDestroy(csound);
+
+    f = fopen("fout_mismatch.bin", "rb");
+    CU_ASSERT_PTR_NOT_NULL(f);
+    if (f == NULL) return;
+    CU_ASSERT(fread(hdr, sizeof(uint32_t), 4, f) == 4);
+    CU_ASSERT(hdr[2] == 2);
+    CU_ASSERT(fread(&sr, sizeof(double), 1, f) == 1);
+    while (fread(&n, sizeof(uint32_t), 1, f) == 1) {
+      for (i = 0; i < n; i++) {
+        if (fread(&v[0], sizeof(float), 1, f) != 1 || v[0] != 1.0f) bad++;
+      }
+      for (i = 0; i < n; i++) {
+        if (fread(&v[1], sizeof(float), 1, f) != 1 || v[1] != 2.0f) bad++;
+      }
+      frames += n;
+    }
+    CU_ASSERT(bad == 0);
+    CU_ASSERT(frames > 0);
+    fclose(f);
+    remove("fout_mismatch.bin");
+}
 
 int main()
 {
@@ -307,6 +413,9 @@ int main()
             || (NULL == CU_add_test(pSuite, "MIDI Modules\n", test_midi_modules))
             || (NULL == CU_add_test(pSuite, "MIDI Hostbased\n", test_midi_hostbased))
             || (NULL == CU_add_test(pSuite, "Audio realtime mode\n", test_audio_realtime_mode))
+            || (NULL == CU_add_test(pSuite, "fout columns\n", test_fout_columns))
+            || (NULL == CU_add_test(pSuite, "fout format mismatch\n",
+                                    test_fout_mismatch))
         )
     {
        CU_cleanup_registry();
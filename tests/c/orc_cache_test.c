@@ -0,0 +1,190 @@
+/*
+ * File:   orc_cache_test.c
+ *
+ * The orchestra cache (Engine/csound_orc_cache.c) falls back to parsing
+ * when its file is truncated, corrupt or nested too deep.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+#include "csound.h"
+#include "CUnit/Basic.h"
+
+static char dir[64];
+static char path[512];
+
+static const char *orc =
+    "instr 1\n"
+    "  kx = (p4 + 2) * 3\n"
+    "  chnset kx, \"x\"\n"
+    "endin\n";
+
+int init_suite1(void)
+{
+    strcpy(dir, "/tmp/csound-orc-cache-XXXXXX");
+    return mkdtemp(dir) == NULL;
+}
+
+int clean_suite1(void)
+{
+    DIR *d = opendir(dir);
+    struct dirent *e;
+    char name[512];
+
+    if (d != NULL) {
+      while ((e = readdir(d)) != NULL) {
+        if (e->d_name[0] == '.') continue;
+        snprintf(name, sizeof(name), "%s/%s", dir, e->d_name);
+        remove(name);
+      }
+      closedir(d);
+    }
+    rmdir(dir);
+    return 0;
+}
+
+/* compiles and runs the orchestra with the cache, returns channel x */
+static double run_orc(void)
+{
+    CSOUND *csound;
+    char   opt[128];
+    int    err;
+    double x;
+
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-n");
+    snprintf(opt, sizeof(opt), "-+orc_cache=%s", dir);
+    csoundSetOption(csound, opt);
+    CU_ASSERT(csoundCompileOrc(csound, orc) == 0);
+    csoundReadScore(csound, "i1 0 1 5");
+    CU_ASSERT(csoundStart(csound) == 0);
+    csoundPerformKsmps(csound);
+    x = csoundGetControlChannel(csound, "x", &err);
+    csoundDestroy(csound);
+    return x;
+}
+
+/* the path of the single cache file */
+static int find_cache_file(void)
+{
+    DIR *d = opendir(dir);
+    struct dirent *e;
+    int n = 0;
+
+    if (d == NULL) return 0;
+    while ((e = readdir(d)) != NULL) {
+      size_t len = strlen(e->d_name);
+      if (len > 4 && strcmp(e->d_name + len - 4, ".ast") == 0) {
+        snprintf(path, sizeof(path), "%s/%s", dir, e->d_name);
+        n++;
+      }
+    }
+    closedir(d);
+    return n == 1;
+}
+
+static long read_file(unsigned char **data)
+{
+    FILE *f = fopen(path, "rb");
+    long n;
+
+    if (f == NULL) return -1;
+    fseek(f, 0L, SEEK_END);
+    n = ftell(f);
+    fseek(f, 0L, SEEK_SET);
+    *data = (unsigned char*) malloc(n + 1);
+    n = (long) fread(*data, 1, n, f);
+    fclose(f);
+    return n;
+}
+
+static void write_file(const unsigned char *data, long n)
+{
+    FILE *f = fopen(path, "wb");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(f);
+    CU_ASSERT(fwrite(data, 1, n, f) == (size_t) n);
+    fclose(f);
+}
+
+void test_cache_fallback(void)
+{
+    unsigned char *data, *deep;
+    long   n, i, hdr = 4 * 4 + 2 * 8;
+    int    node[8] = { 1, 0, 0, 0, 0, 0, 0, 0 };
+
+    /* a cold and a warm start */
+    CU_ASSERT_DOUBLE_EQUAL(run_orc(), 21.0, 0.0);
+    CU_ASSERT_FATAL(find_cache_file());
+    CU_ASSERT_DOUBLE_EQUAL(run_orc(), 21.0, 0.0);
+    n = read_file(&data);
+    CU_ASSERT_FATAL(n > hdr + 8);
+
+    /* truncated */
+    write_file(data, hdr + (n - hdr) / 2);
+    CU_ASSERT_DOUBLE_EQUAL(run_orc(), 21.0, 0.0);
+
+    /* a byte of the tree changed */
+    data[hdr + (n - hdr) / 2] ^= 0x5a;
+    write_file(data, n);
+    CU_ASSERT_DOUBLE_EQUAL(run_orc(), 21.0, 0.0);
+    data[hdr + (n - hdr) / 2] ^= 0x5a;
+
+    /* a string length past the end of the file, for the name kx */
+    for (i = hdr; i + 6 <= n; i++) {
+      int v;
+      memcpy(&v, data + i, 4);
+      if (v == 2 && memcmp(data + i + 4, "kx", 2) == 0) {
+        v = 0x7fffffff;
+        memcpy(data + i, &v, 4);
+        break;
+      }
+    }
+    CU_ASSERT(i + 6 <= n);
+    write_file(data, n);
+    CU_ASSERT_DOUBLE_EQUAL(run_orc(), 21.0, 0.0);
+
+    /* nodes each the left child of the one before, 10000 deep; a node is
+       the marker, type, rate, len, line, locn and no value */
+    deep = (unsigned char*) calloc(hdr + 10000 * sizeof(node) + 4, 1);
+    memcpy(deep, data, hdr);
+    for (i = 0; i < 10000; i++)
+      memcpy(deep + hdr + i * sizeof(node), node, sizeof(node) - 4);
+    write_file(deep, hdr + 10000 * sizeof(node) + 4);
+    CU_ASSERT_DOUBLE_EQUAL(run_orc(), 21.0, 0.0);
+
+    free(deep);
+    free(data);
+}
+
+int main()
+{
+    CU_pSuite pSuite = NULL;
+
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("orchestra cache tests", init_suite1, clean_suite1);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* add the tests to the suite */
+    if (NULL == CU_add_test(pSuite, "Test fallback from bad cache files",
+                            test_cache_fallback))
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    return CU_get_error();
+}
@@ -0,0 +1,87 @@
+/*
+ * File:   orc_compile_bench.c
+ *
+ * Measures the time taken to compile a synthetic orchestra of many
+ * small instruments, first on an empty engine and then again as a
+ * recompilation (as in live coding).  The first compilation is timed in
+ * two parts: csoundParseOrc(), which parses and runs the semantic
+ * analysis on one thread, and csoundCompileTree(), which builds the
+ * instruments and shares their preparation out over the -j threads.
+ * Comparing a run with one thread against one with several shows what
+ * the threads gain and how much of the total stays serial.
+ *
+ * usage: benchOrcCompile [ninstr [nthreads]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "csound.h"
+
+static char *make_orc(int ninstr)
+{
+    const char *body =
+      "instr %d\n"
+      "  kenv linseg 0, p3*0.5, 1, p3*0.5, 0\n"
+      "  kfr = p4 * (1 + %d * 0.001)\n"
+      "  asig vco2 kenv * 0dbfs * 0.1, kfr\n"
+      "  asig moogladder asig, 2000 + kenv * 1000, 0.3\n"
+      "  ga%d = asig\n"
+      "  out asig\n"
+      "endin\n";
+    size_t size = 64 + (size_t) ninstr * (strlen(body) + 32);
+    char *orc = malloc(size), *p = orc;
+    int i;
+
+    p += sprintf(p, "sr=44100\nksmps=64\nnchnls=1\n0dbfs=1\n");
+    for (i = 1; i <= ninstr; i++)
+      p += sprintf(p, body, i, i, i);
+    return orc;
+}
+
+int main(int argc, char **argv)
+{
+    int ninstr = argc > 1 ? atoi(argv[1]) : 10000;
+    int nthreads = argc > 2 ? atoi(argv[2]) : 1;
+    char *orc = make_orc(ninstr), opt[32];
+    RTCLOCK timer;
+    double parse, build, second;
+    CSOUND *csound;
+    TREE *tree;
+
+    csoundInitialize(CSOUNDINIT_NO_ATEXIT);
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "-m0");
+    snprintf(opt, sizeof(opt), "-j%d", nthreads);
+    csoundSetOption(csound, opt);
+
+    csoundInitTimerStruct(&timer);
+    if ((tree = csoundParseOrc(csound, orc)) == NULL) {
+      fprintf(stderr, "parsing failed\n");
+      return 1;
+    }
+    parse = csoundGetRealTime(&timer);
+    csoundInitTimerStruct(&timer);
+    if (csoundCompileTree(csound, tree) != 0) {
+      fprintf(stderr, "compilation failed\n");
+      return 1;
+    }
+    build = csoundGetRealTime(&timer);
+    csoundDeleteTree(csound, tree);
+    csoundStart(csound);
+
+    csoundInitTimerStruct(&timer);
+    if (csoundCompileOrc(csound, orc) != 0) {
+      fprintf(stderr, "recompilation failed\n");
+      return 1;
+    }
+    second = csoundGetRealTime(&timer);
+
+    printf("%d instruments, %d threads: parse and analysis %.3f s, "
+           "instruments %.3f s, compile %.3f s, recompile %.3f s\n",
+           ninstr, nthreads, parse, build, parse + build, second);
+    csoundDestroy(csound);
+    free(orc);
+    return 0;
+}
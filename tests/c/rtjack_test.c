@@ -0,0 +1,279 @@
+/*
+ * File:   rtjack_test.c
+ *
+ * The JACK callback mode (InOut/rtjack.c, -+jack_callback) against a
+ * jackd with the dummy driver: csoundPerformKsmps() returns after each
+ * period the process callback performs, and a server shutdown ends
+ * csoundPerform() with an error.  JACK MIDI notes sent in one cycle
+ * start as far apart in samples as they were sent.  The path of jackd is
+ * the first argument; without it the tests are skipped.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <signal.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <jack/jack.h>
+#include <jack/midiport.h>
+#include "csound.h"
+#include "CUnit/Basic.h"
+
+extern char **environ;
+
+static const char *jackd = NULL;
+static pid_t jackd_pid = -1;
+
+static const char *orc =
+    "sr = 48000\n"
+    "ksmps = 64\n"
+    "nchnls = 2\n"
+    "0dbfs = 1\n"
+    "instr 1\n"
+    "  kcnt init 0\n"
+    "  kcnt += 1\n"
+    "  chnset kcnt, \"kcnt\"\n"
+    "  asig oscili 0.1, 440\n"
+    "  outs asig, asig\n"
+    "endin\n";
+
+int init_suite1(void)
+{
+    char name[64], *argv[12];
+    int  n = 0;
+
+    if (jackd == NULL)
+      return 0;
+    snprintf(name, sizeof(name), "csound-test-%d", (int) getpid());
+    setenv("JACK_DEFAULT_SERVER", name, 1);
+    argv[n++] = (char*) jackd;
+    argv[n++] = "-r";                   /* not realtime */
+    argv[n++] = "-n";
+    argv[n++] = name;
+    argv[n++] = "-d";
+    argv[n++] = "dummy";
+    argv[n++] = "-r";
+    argv[n++] = "48000";
+    argv[n++] = "-p";
+    argv[n++] = "256";
+    argv[n] = NULL;
+    if (posix_spawn(&jackd_pid, jackd, NULL, NULL, argv, environ) != 0)
+      jackd_pid = -1;
+    return 0;
+}
+
+static void stop_jackd(void)
+{
+    if (jackd_pid > 0) {
+      kill(jackd_pid, SIGTERM);
+      waitpid(jackd_pid, NULL, 0);
+      jackd_pid = -1;
+    }
+}
+
+int clean_suite1(void)
+{
+    stop_jackd();
+    return 0;
+}
+
+static const char *midi_orc =
+    "sr = 48000\n"
+    "ksmps = 64\n"
+    "nchnls = 2\n"
+    "0dbfs = 1\n"
+    "instr 1\n"
+    "  inum notnum\n"
+    "  Sname sprintf \"n%d\", inum\n"
+    "  chnset p2 * sr, Sname\n"
+    "endin\n";
+
+/* an instance in callback mode, started once the server accepts clients,
+   with JACK MIDI input from the port midi if not NULL */
+static CSOUND *start(const char *orch, const char *sco, const char *midi)
+{
+    CSOUND *csound;
+    char   opt[128];
+    int    i;
+
+    csoundSetGlobalEnv("OPCODE6DIR64", "../../");
+    for (i = 0; i < 50; i++) {
+      csound = csoundCreate(NULL);
+      csoundSetOption(csound, "-odac");
+      csoundSetOption(csound, "-+rtaudio=jack");
+      csoundSetOption(csound, "-+jack_callback=1");
+      csoundSetOption(csound, "-b256");
+      csoundSetOption(csound, "-B512");
+      csoundSetOption(csound, "-d");
+      if (midi != NULL) {
+        snprintf(opt, sizeof(opt), "-M%s", midi);
+        csoundSetOption(csound, "-+rtmidi=jack");
+        csoundSetOption(csound, opt);
+        csoundSetOption(csound, "--sample-accurate");
+      }
+      CU_ASSERT_FATAL(csoundCompileOrc(csound, orch) == 0);
+      csoundReadScore(csound, sco);
+      if (csoundStart(csound) == 0)
+        return csound;
+      csoundDestroy(csound);
+      csoundSleep(100);
+    }
+    return NULL;
+}
+
+void test_perform_ksmps(void)
+{
+    CSOUND *csound;
+    MYFLT  kcnt, last = 0.0;
+    int    err, res, calls = 0, monotonic = 1;
+
+    if (jackd_pid <= 0) {
+      printf("\njackd not available, skipped\n");
+      return;
+    }
+    csound = start(orc, "i1 0 0.5", NULL);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(csound);
+    /* each call returns after a period of 256 frames */
+    while ((res = csoundPerformKsmps(csound)) == 0) {
+      kcnt = csoundGetControlChannel(csound, "kcnt", &err);
+      if (kcnt < last)
+        monotonic = 0;
+      last = kcnt;
+      calls++;
+    }
+    CU_ASSERT(res > 0);
+    CU_ASSERT(monotonic);
+    /* 0.5 seconds are 93 periods and 375 control periods */
+    CU_ASSERT(calls > 45);
+    CU_ASSERT(last > 350.0);
+    csoundCleanup(csound);
+    csoundDestroy(csound);
+}
+
+static uintptr_t perform_thread(void *csound)
+{
+    return (uintptr_t) (intptr_t) csoundPerform((CSOUND*) csound);
+}
+
+/* a client sending two note ons 90 frames apart in one cycle */
+static jack_port_t *midi_out;
+static volatile int send_notes = 0;
+
+static int sender_process(jack_nframes_t nframes, void *arg)
+{
+    unsigned char on1[3] = { 0x90, 60, 100 }, on2[3] = { 0x90, 61, 100 };
+    void *buf = jack_port_get_buffer(midi_out, nframes);
+
+    (void) arg;
+    jack_midi_clear_buffer(buf);
+    if (send_notes == 1) {
+      jack_midi_event_write(buf, 10, on1, 3);
+      jack_midi_event_write(buf, 100, on2, 3);
+      send_notes = 2;
+    }
+    return 0;
+}
+
+void test_midi_spacing(void)
+{
+    jack_client_t *sender;
+    CSOUND *csound;
+    void   *thread;
+    MYFLT  n60, n61;
+    int    err;
+
+    if (jackd_pid <= 0) {
+      printf("\njackd not available, skipped\n");
+      return;
+    }
+    sender = jack_client_open("csound-test-sender", JackNoStartServer, NULL);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(sender);
+    midi_out = jack_port_register(sender, "out", JACK_DEFAULT_MIDI_TYPE,
+                                  JackPortIsOutput, 0);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(midi_out);
+    jack_set_process_callback(sender, sender_process, NULL);
+    CU_ASSERT_FATAL(jack_activate(sender) == 0);
+
+    csound = start(midi_orc, "f0 60", jack_port_name(midi_out));
+    CU_ASSERT_PTR_NOT_NULL_FATAL(csound);
+    thread = csoundCreateThread(perform_thread, csound);
+    csoundSleep(300);
+    send_notes = 1;
+    csoundSleep(300);
+    n60 = csoundGetControlChannel(csound, "n60", &err);
+    CU_ASSERT_EQUAL(err, CSOUND_SUCCESS);
+    n61 = csoundGetControlChannel(csound, "n61", &err);
+    CU_ASSERT_EQUAL(err, CSOUND_SUCCESS);
+    /* both played, at the samples they were sent at, across two control
+       periods of 64 */
+    CU_ASSERT(n60 > 0.0);
+    CU_ASSERT(fabs(n61 - n60 - 90.0) < 0.01);
+    csoundStop(csound);
+    csoundJoinThread(thread);
+    csoundCleanup(csound);
+    csoundDestroy(csound);
+    jack_client_close(sender);
+}
+
+void test_server_shutdown(void)
+{
+    CSOUND *csound;
+    void   *thread;
+    int    err, res;
+
+    if (jackd_pid <= 0) {
+      printf("\njackd not available, skipped\n");
+      return;
+    }
+    csound = start(orc, "i1 0 60", NULL);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(csound);
+    thread = csoundCreateThread(perform_thread, csound);
+    csoundSleep(300);
+    CU_ASSERT(csoundGetControlChannel(csound, "kcnt", &err) > 0.0);
+    /* the performance ends with an error instead of waiting for ever */
+    stop_jackd();
+    res = (int) (intptr_t) csoundJoinThread(thread);
+    CU_ASSERT_EQUAL(res, CSOUND_ERROR);
+    csoundCleanup(csound);
+    csoundDestroy(csound);
+}
+
+int main(int argc, char **argv)
+{
+    CU_pSuite pSuite = NULL;
+
+    if (argc > 1 && access(argv[1], X_OK) == 0)
+      jackd = argv[1];
+
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("JACK callback mode tests", init_suite1,
+                          clean_suite1);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* add the tests to the suite; the shutdown test stops the server */
+    if ((NULL == CU_add_test(pSuite, "Test csoundPerformKsmps per period",
+                             test_perform_ksmps)) ||
+        (NULL == CU_add_test(pSuite, "Test JACK MIDI note timing",
+                             test_midi_spacing)) ||
+        (NULL == CU_add_test(pSuite, "Test a JACK server shutdown",
+                             test_server_shutdown)))
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    return CU_get_error();
+}
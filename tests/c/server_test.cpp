@@ -28,7 +28,7 @@ int clean_suite1(void)
     #include "unistd.h"
 #endif
 
-void udp_send(const char* msg) {
+void udp_sendn(const void* msg, size_t len) {
     struct sockaddr_in server_addr;
     int sock;
 #if defined(WIN32) && !defined(__CYGWIN__)
@@ -63,11 +63,28 @@ void udp_send(const char* msg) {
   inet_aton("127.0.0.1", &server_addr.sin_addr);  
 #endif
   server_addr.sin_port = htons((int) 44100);    
-  sendto(sock, (void*) msg, strlen(msg)+1, 0,
+  sendto(sock, (const char*) msg, len, 0,
        (const struct sockaddr *) &server_addr,
 	 sizeof(server_addr));
 }
 
+void udp_send(const char* msg) {
+    udp_sendn(msg, strlen(msg)+1);
+}
+
+/* binary set message for a single handle */
+size_t udp_bin_set(unsigned char* b, int handle, int offset, double val) {
+    unsigned long long u;
+    int k;
+    memcpy(&u, &val, sizeof(double));
+    b[0] = 0x01; b[1] = 'S'; b[2] = 0; b[3] = 1;
+    b[4] = handle >> 8; b[5] = handle & 0xff;
+    b[6] = offset >> 8; b[7] = offset & 0xff;
+    for (k = 0; k < 8; k++)
+      b[8+k] = (unsigned char) (u >> (56 - 8*k));
+    return 16;
+}
+
 
 void test_server(void)
 {
@@ -93,6 +110,32 @@ void test_server(void)
     csound.Reset();
 }
 
+void test_server_binary(void)
+{
+    unsigned char msg[64];
+    int err;
+    size_t n;
+
+    Csound csound;
+    csound.SetOption((char*)"-n");
+    csound.SetOption((char*)"--port=44100");
+    csound.Start();
+    CsoundPerformanceThread performanceThread(csound.GetCsound());
+    performanceThread.Play();
+    /* bind handle 3 to control channel "amp" */
+    msg[0] = 0x01; msg[1] = 'R'; msg[2] = 0; msg[3] = 3; msg[4] = 'k';
+    strcpy((char*) msg + 5, "amp");
+    udp_sendn(msg, 9);
+    csoundSleep(500);
+    n = udp_bin_set(msg, 3, 0, 0.25);
+    udp_sendn(msg, n);
+    csoundSleep(500);
+    CU_ASSERT_DOUBLE_EQUAL(csound.GetChannel("amp", &err), 0.25, 1e-12);
+    udp_send("##close##");
+    performanceThread.Join();
+    csound.Cleanup();
+    csound.Reset();
+}
 
 int main()
 {
@@ -110,7 +153,9 @@ int main()
     }
 
     /* add the tests to the suite */
-    if ((NULL == CU_add_test(pSuite, "Test server", test_server))
+    if ((NULL == CU_add_test(pSuite, "Test server", test_server)) ||
+        (NULL == CU_add_test(pSuite, "Test server binary protocol",
+                             test_server_binary))
         )
     {
         CU_cleanup_registry();
@@ -0,0 +1,247 @@
+/*
+ * File:   sockstream_test.c
+ *
+ * socksendm packets (Opcodes/sockstream.h) received on a loopback socket,
+ * with a packet size that does not divide ksmps, and sockrecvm fed with
+ * reordered, dropped and malformed packets.
+ */
+
+#define __BUILDING_LIBCSOUND
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "csoundCore.h"
+#include "../../Opcodes/sockstream.h"
+#include "CUnit/Basic.h"
+
+#define NFRAMES  7
+#define NKSMPS   100
+
+int init_suite1(void)
+{
+    return 0;
+}
+
+int clean_suite1(void)
+{
+    return 0;
+}
+
+void test_sendm_loopback(void)
+{
+    CSOUND   *csound;
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    unsigned char pkt[SOCKSTREAM_MAXPKT];
+    char     orc[512];
+    int      sock, ret, n, f, bad = 0;
+    uint32_t seq = 0;
+
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    CU_ASSERT_FATAL(sock >= 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    CU_ASSERT_FATAL(bind(sock, (struct sockaddr *) &addr, sizeof(addr)) == 0);
+    CU_ASSERT_FATAL(getsockname(sock, (struct sockaddr *) &addr, &len) == 0);
+
+    /* with sr = 65536 the phasor steps by exactly 2^-16, so sample i of
+       the stream is i / 65536 */
+    snprintf(orc, sizeof(orc),
+             "sr = 65536\n"
+             "ksmps = 10\n"
+             "nchnls = 1\n"
+             "0dbfs = 1\n"
+             "instr 1\n"
+             "asig phasor 1\n"
+             "socksendm \"127.0.0.1\", %d, %d, asig\n"
+             "endin\n", ntohs(addr.sin_port), NFRAMES);
+
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-n");
+    ret = csoundCompileOrc(csound, orc);
+    CU_ASSERT(ret == 0);
+    csoundReadScore(csound, "i 1 0 10");
+    ret = csoundStart(csound);
+    CU_ASSERT(ret == 0);
+    for (n = 0; n < NKSMPS; n++)
+      CU_ASSERT(csoundPerformKsmps(csound) == 0);
+    csoundDestroy(csound);
+
+    /* every complete packet, in order, each carrying the frames that
+       follow the last one */
+    while ((n = recv(sock, pkt, sizeof(pkt), MSG_DONTWAIT)) > 0) {
+      CU_ASSERT(n == SOCKSTREAM_HDR + NFRAMES * 4);
+      CU_ASSERT(sockstream_get16(pkt) == SOCKSTREAM_MAGIC);
+      CU_ASSERT(pkt[3] == 1);
+      CU_ASSERT(sockstream_get32(pkt + 4) == seq);
+      CU_ASSERT(sockstream_get64(pkt + 8) == (uint64_t) seq * NFRAMES);
+      CU_ASSERT(sockstream_get16(pkt + 16) == NFRAMES);
+      for (f = 0; f < NFRAMES; f++) {
+        MYFLT x = sockstream_getf(pkt + SOCKSTREAM_HDR + f * 4);
+        if (x != (MYFLT) (seq * NFRAMES + f) / FL(65536.0))
+          bad++;
+      }
+      seq++;
+    }
+    CU_ASSERT(bad == 0);
+    CU_ASSERT(seq == (NKSMPS * 10) / NFRAMES);
+    close(sock);
+}
+
+#define RECV_PERIODS  200
+#define RECV_DROP     100     /* the packet that is never sent */
+
+/* the packet of sequence number seq, 32 frames of 0.5 */
+static void send_packet(int sock, struct sockaddr_in *to, uint32_t seq)
+{
+    unsigned char pkt[SOCKSTREAM_HDR + 32 * 4];
+    int f;
+
+    memset(pkt, 0, sizeof(pkt));
+    sockstream_put16(pkt, SOCKSTREAM_MAGIC);
+    pkt[2] = SOCKSTREAM_VERSION;
+    pkt[3] = 1;
+    sockstream_put32(pkt + 4, seq);
+    sockstream_put64(pkt + 8, (uint64_t) seq * 32);
+    sockstream_put16(pkt + 16, 32);
+    for (f = 0; f < 32; f++)
+      sockstream_putf(pkt + SOCKSTREAM_HDR + f * 4, FL(0.5));
+    sendto(sock, pkt, sizeof(pkt), 0, (struct sockaddr *) to, sizeof(*to));
+}
+
+void test_recvm_jitter(void)
+{
+    CSOUND   *csound;
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    MYFLT    out[32];
+    char     orc[512];
+    const char *msg;
+    unsigned int lost = 99, reordered = 99, late = 99, bad = 99, concealed = 0;
+    int      sock, port, n, i, seq, playing = 0, wrong = 0, quiet = 0;
+    unsigned char huge[SOCKSTREAM_HDR + 64];
+
+    /* a free port */
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    CU_ASSERT_FATAL(sock >= 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    CU_ASSERT_FATAL(bind(sock, (struct sockaddr *) &addr, sizeof(addr)) == 0);
+    CU_ASSERT_FATAL(getsockname(sock, (struct sockaddr *) &addr, &len) == 0);
+    port = ntohs(addr.sin_port);
+    close(sock);
+
+    snprintf(orc, sizeof(orc),
+             "sr = 32000\n"
+             "ksmps = 32\n"
+             "nchnls = 1\n"
+             "0dbfs = 1\n"
+             "instr 1\n"
+             "a1 sockrecvm %d, 0.01\n"
+             "chnset a1, \"out\"\n"
+             "endin\n", port);
+    csound = csoundCreate(NULL);
+    csoundCreateMessageBuffer(csound, 0);
+    csoundSetOption(csound, "-n");
+    CU_ASSERT(csoundCompileOrc(csound, orc) == 0);
+    csoundReadScore(csound, "i 1 0 0.2");
+    CU_ASSERT_FATAL(csoundStart(csound) == 0);
+    /* the first period binds the socket */
+    CU_ASSERT(csoundPerformKsmps(csound) == 0);
+
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    CU_ASSERT_FATAL(sock >= 0);
+    for (n = 0; n < RECV_PERIODS; n++) {
+      /* packet n, except that every tenth pair is swapped and one packet
+         is lost */
+      seq = (n % 10 == 4) ? n + 1 : (n % 10 == 5) ? n - 1 : n;
+      if (seq != RECV_DROP)
+        send_packet(sock, &addr, (uint32_t) seq);
+      if (n == 50) {
+        /* a header claiming 65535 frames of 255 channels */
+        memset(huge, 0, sizeof(huge));
+        sockstream_put16(huge, SOCKSTREAM_MAGIC);
+        huge[2] = SOCKSTREAM_VERSION;
+        huge[3] = 255;
+        sockstream_put16(huge + 16, 65535);
+        sendto(sock, huge, sizeof(huge), 0, (struct sockaddr *) &addr,
+               sizeof(addr));
+      }
+      usleep(2000);
+      if (csoundPerformKsmps(csound) != 0) break;
+      csoundGetAudioChannel(csound, "out", out);
+      for (i = 0; i < 32; i++) {
+        if (!playing) {
+          playing = (out[i] != FL(0.0));
+          if (!playing) continue;
+        }
+        /* the fade of the concealment starts from the last frame */
+        if (out[i] == FL(0.0)) quiet++;
+        else if (out[i] != FL(0.5)) wrong++;
+      }
+    }
+    close(sock);
+    CU_ASSERT(playing);
+    CU_ASSERT_EQUAL(quiet, 0);
+    /* only the frames of the lost packet are concealed, and fade */
+    CU_ASSERT(wrong > 0 && wrong < 64);
+    while (csoundPerformKsmps(csound) == 0) ;
+
+    while (csoundGetMessageCnt(csound) > 0) {
+      msg = csoundGetFirstMessage(csound);
+      if (strncmp(msg, "sockrecvm:", 10) == 0)
+        sscanf(msg, "sockrecvm: %u packets lost, %u reordered, %u late, "
+               "%u invalid; %u frames concealed",
+               &lost, &reordered, &late, &bad, &concealed);
+      csoundPopFirstMessage(csound);
+    }
+    CU_ASSERT_EQUAL(lost, 1);
+    CU_ASSERT_EQUAL(reordered, RECV_PERIODS / 10);
+    CU_ASSERT_EQUAL(late, 0);
+    CU_ASSERT_EQUAL(bad, 1);
+    CU_ASSERT(concealed >= 32);
+    csoundDestroyMessageBuffer(csound);
+    csoundDestroy(csound);
+}
+
+int main()
+{
+    CU_pSuite pSuite = NULL;
+
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("network audio stream tests",
+                          init_suite1, clean_suite1);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* add the tests to the suite */
+    if ((NULL == CU_add_test(pSuite, "Test socksendm over loopback",
+                             test_sendm_loopback)) ||
+        (NULL == CU_add_test(pSuite, "Test sockrecvm jitter buffer",
+                             test_recvm_jitter)))
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    return CU_get_error();
+}
@@ -131,6 +131,8 @@ def runTest():
 	["test_fsig_udo.csd", "UDO with f-sig arg"],
 	["test_karrays_udo.csd", "UDO with k[] arg"],
 	["test_arrays_addition.csd", "test array arithmetic (i.e. k[] + k[]"],
+	["test_arrays_fused.csd", "test fused array expressions (i.e. (k[] * k[] + k[]) / k)"],
+	["test_arrays_views.csd", "test getrow and slicearray views, copied when written"],
 	["test_arrays_fns.csd", "test functions on arrays (i.e. tabgen)", 1],
 	["test_polymorphic_udo.csd", "test polymorphic udo"],
 	["test_udo_a_array.csd", "test udo with a-array"],